@@ -15,6 +15,8 @@
  */
 #pragma once
 
+#include <numa.h>
+
 #include <cstdlib>
 #include <limits>
 #include <memory>
@@ -132,3 +134,82 @@ struct AlignedAllocator {
    */
   inline static shared_ptr_type make_shared(size_type n = 1) { return {allocate(n), std::free}; }
 };
+
+/**
+ * Stateful allocator that places memory on a specific NUMA node.
+ *
+ * - `any_node`: Behaves like `AlignedAllocator` (placement is up to the OS, i.e., first touch).
+ * - `interleave`: Pages are distributed round-robin across all NUMA nodes.
+ * - Otherwise: Pages are bound to the NUMA node with that index.
+ *
+ * libnuma allocates whole pages via mmap. Hence, this is intended for large and long-lived buffers.
+ */
+template <typename T, std::size_t ALIGNMENT = 64>
+struct NumaAllocator {
+  using value_type = T;
+  using size_type = std::size_t;
+
+  static constexpr size_type alignment{ALIGNMENT};
+  static_assert(alignment >=
+                alignof(value_type));  // Allocation alignment must exceed value alignment.
+  static_assert(!(alignment & (alignment - 1)));  // Ensure alignment is power of 2.
+
+  static constexpr int any_node{-1};
+  static constexpr int interleave{-2};
+
+  int node{any_node};
+
+  template <typename U>
+  struct rebind {
+    using other = NumaAllocator<U, alignment>;
+  };
+
+  constexpr NumaAllocator() noexcept = default;
+
+  constexpr explicit NumaAllocator(const int node) noexcept : node{node} {}
+
+  template <typename U>
+  constexpr NumaAllocator(const NumaAllocator<U, alignment>& other) noexcept : node{other.node} {}
+
+  [[nodiscard]] inline value_type* allocate(const size_type n) const {
+    if (n > max_size()) {
+      throw std::bad_array_new_length();
+    }
+    const size_type size{n * sizeof(value_type)};
+
+    void* p;
+    if (node == any_node) {
+      p = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    } else if (node == interleave) {
+      p = numa_alloc_interleaved(size);
+    } else {
+      p = numa_alloc_onnode(size, node);
+    }
+    if (p) {
+      return static_cast<value_type*>(p);
+    }
+
+    throw std::bad_alloc();
+  }
+
+  inline void deallocate(value_type* const p, const size_type n) const noexcept {
+    if (node == any_node) {
+      std::free(p);
+    } else {
+      numa_free(p, n * sizeof(value_type));
+    }
+  }
+
+  inline static size_type max_size() {
+    return (std::numeric_limits<size_type>::max() - alignment + 1) / sizeof(value_type);
+  }
+
+  template <typename U>
+  inline bool operator==(const NumaAllocator<U, alignment>& other) const {
+    return node == other.node;
+  }
+  template <typename U>
+  inline bool operator!=(const NumaAllocator<U, alignment>& other) const {
+    return node != other.node;
+  }
+};
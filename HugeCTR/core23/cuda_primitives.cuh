@@ -17,6 +17,7 @@
 #pragma once
 
 #include <cassert>
+#include <core23/details/philox.hpp>
 #include <core23/macros.hpp>
 #include <core23/tensor_view.hpp>
 
@@ -89,6 +90,28 @@ __global__ void transform_kernel(DstType *dst, const SrcType *src, int64_t num_e
   }
 }
 
+// Same values as philox_generate in details/host_launch_helpers.hpp, one counter per thread.
+template <typename Type, typename Distribution>
+__global__ void philox_kernel(Type *data, int64_t num_elements, uint64_t seed, uint64_t counter,
+                              Distribution dist) {
+  constexpr int64_t kValues = kPhiloxValuesPerCounter<Type>;
+  const int64_t num_counters = (num_elements + kValues - 1) / kValues;
+  const int64_t tid_base = blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t num_threads = blockDim.x * gridDim.x;
+  for (int64_t tid = tid_base; tid < num_counters; tid += num_threads) {
+    uint32_t words[4];
+    Type values[kValues];
+    philox4x32_10(seed, counter + tid, words);
+    dist(words, values);
+#pragma unroll
+    for (int64_t i = 0; i < kValues; ++i) {
+      if (tid * kValues + i < num_elements) {
+        data[tid * kValues + i] = values[i];
+      }
+    }
+  }
+}
+
 template <typename BuiltInType>
 __global__ void copy_kernel(TensorView<BuiltInType, 1> input_tensor,
                             TensorView<BuiltInType, 1> output_tensor) {
@@ -19,7 +19,9 @@
 #include <curand.h>
 
 #include <core23/cuda_stream.hpp>
+#include <atomic>
 #include <core23/device.hpp>
+#include <cstdint>
 #include <functional>
 #include <memory>
 
@@ -44,7 +46,10 @@ class CURANDGenerator final {
             [](curandGenerator_t* generator) {
               curandDestroyGenerator(*generator);
               delete generator;
-            }) {}
+            }),
+        seed_(seed),
+        rng_type_(rng_type),
+        philox_counter_(std::make_shared<std::atomic<uint64_t>>(0)) {}
   CURANDGenerator(const CURANDGenerator&) = default;
   CURANDGenerator(CURANDGenerator&&) = delete;
   CURANDGenerator& operator=(const CURANDGenerator&) = default;
@@ -56,9 +61,24 @@ class CURANDGenerator final {
   curandGenerator_t operator()() const { return generator(); }
   explicit operator curandGenerator_t() const noexcept { return generator(); }
 
+  unsigned long long seed() const { return seed_; }
+  curandRngType_t rng_type() const { return rng_type_; }
+
+  /**
+   * Reserves `num_counters` consecutive counters of the Philox stream (see details/philox.hpp)
+   * that CPU tensors and CURAND_RNG_PSEUDO_PHILOX4_32_10 generators draw from, and returns the
+   * first one. Copies of a generator share the stream.
+   */
+  uint64_t reserve_philox_counters(uint64_t num_counters) {
+    return philox_counter_->fetch_add(num_counters, std::memory_order_relaxed);
+  }
+
  private:
   curandGenerator_t generator() const { return generator_ ? *generator_ : 0; }
   std::shared_ptr<curandGenerator_t> generator_;
+  unsigned long long seed_;
+  curandRngType_t rng_type_;
+  std::shared_ptr<std::atomic<uint64_t>> philox_counter_;
 };
 
 inline bool operator==(CURANDGenerator lhs, CURANDGenerator rhs) { return lhs() == rhs(); }
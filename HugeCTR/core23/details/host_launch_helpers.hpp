@@ -18,19 +18,33 @@
 
 #include <algorithm>
 #include <core23/data_type_helpers.cuh>
+#include <core23/details/philox.hpp>
 #include <cstdint>
+#include <thread_pool.hpp>
 
 namespace HugeCTR {
 
 namespace core23 {
 
-template <typename Type>
-struct FillParams {
-  FillParams(Type* data, int64_t size, Type val) : data(data), size(size), val(val) {}
-  Type* data;
-  int64_t size;
-  Type val;
-};
+// Elements per chunk of the host loops below. A multiple of every kPhiloxValuesPerCounter.
+constexpr int64_t kHostChunkSize = 1 << 16;
+
+/**
+ * Calls `fn(begin, end)` for consecutive chunks of `[0, num_elements)` on the default ThreadPool.
+ * Chunks are small enough to balance the load and large enough for the inner loops to vectorize.
+ */
+template <typename Function>
+void host_parallel_for(int64_t num_elements, Function&& fn) {
+  const int64_t num_chunks = (num_elements + kHostChunkSize - 1) / kHostChunkSize;
+  if (num_chunks <= 1) {
+    fn(static_cast<int64_t>(0), num_elements);
+    return;
+  }
+  ThreadPool::get().parallel_for(num_chunks, [num_elements, &fn](size_t chunk) {
+    const int64_t begin = static_cast<int64_t>(chunk) * kHostChunkSize;
+    fn(begin, std::min(begin + kHostChunkSize, num_elements));
+  });
+}
 
 template <typename DstType, typename SrcType>
 struct CopyParams {
@@ -40,31 +54,43 @@ struct CopyParams {
   int64_t size;
 };
 
-template <typename DstType, typename SrcType, typename Op>
-struct TransformParams {
-  TransformParams(DstType* dst, const SrcType* src, int64_t size, Op op)
-      : dst(dst), src(src), size(size), op(op) {}
-  DstType* dst;
-  const SrcType* src;
-  int64_t size;
-  Op op;
-};
-
-template <typename Type>
-void fill_wrapper(void* user_data) {
-  FillParams<Type>* params = static_cast<FillParams<Type>*>(user_data);
-  std::fill(params->data, params->data + params->size, params->val);
-  delete params;
-}
-
 void copy_wrapper(void* user_data);
 
-template <typename DstType, typename SrcType, typename Op>
-void transform_wrapper(void* user_data) {
-  TransformParams<DstType, SrcType, Op>* params =
-      static_cast<TransformParams<DstType, SrcType, Op>*>(user_data);
-  std::transform(params->src, params->src + params->size, params->dst, params->op);
-  delete params;
+// Counters per batch of philox_generate. Batches are computed in a loop that vectorizes.
+constexpr int64_t kPhiloxBatchSize = 16;
+
+template <typename Type, typename Distribution>
+void philox_generate(Type* data, int64_t size, uint64_t seed, uint64_t counter,
+                     Distribution dist) {
+  constexpr int64_t kValues = kPhiloxValuesPerCounter<Type>;
+  host_parallel_for(size, [=](int64_t begin, int64_t end) {
+    // Chunks start at a counter boundary, and only the last one can end inside a counter.
+    const int64_t num_full = (end - begin) / kValues;
+    Type* out = data + begin;
+    const uint64_t first = counter + begin / kValues;
+    int64_t i = 0;
+    for (; i + kPhiloxBatchSize <= num_full; i += kPhiloxBatchSize) {
+      uint32_t words[kPhiloxBatchSize][4];
+      for (int64_t j = 0; j < kPhiloxBatchSize; ++j) {
+        philox4x32_10(seed, first + i + j, words[j]);
+      }
+      for (int64_t j = 0; j < kPhiloxBatchSize; ++j) {
+        dist(words[j], out + (i + j) * kValues);
+      }
+    }
+    for (; i < num_full; ++i) {
+      uint32_t words[4];
+      philox4x32_10(seed, first + i, words);
+      dist(words, out + i * kValues);
+    }
+    if (const int64_t rest = (end - begin) % kValues) {
+      uint32_t words[4];
+      Type values[kValues];
+      philox4x32_10(seed, first + num_full, words);
+      dist(words, values);
+      std::copy(values, values + rest, out + num_full * kValues);
+    }
+  });
 }
 
 }  // namespace core23
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cmath>
+#include <core23/macros.hpp>
+#include <cstdint>
+#include <type_traits>
+
+namespace HugeCTR {
+
+namespace core23 {
+
+/**
+ * Counter-based random number generation shared by the CPU and GPU paths of the random
+ * primitives. Philox4x32-10 maps a (seed, counter) pair to four 32-bit words; the same round
+ * function as cuRAND's Philox generator, i.e. curand_init(seed, 0, 4 * counter, &state) followed
+ * by curand4(&state) yields the same words.
+ *
+ * Element `i` of a request that starts at counter `c` only depends on the seed and on
+ * `c + i / kPhiloxValuesPerCounter<Type>`, so the result does not depend on how the elements are
+ * split among threads, and a CPU and a GPU tensor drawn from identically seeded generators hold
+ * the same values, up to the rounding of log, sin and cos.
+ */
+template <typename Type>
+constexpr int64_t kPhiloxValuesPerCounter = sizeof(uint32_t) * 4 / sizeof(Type);
+
+HCTR_HOST_DEVICE HCTR_INLINE void philox_mulhilo(uint32_t a, uint32_t b, uint32_t& hi,
+                                                 uint32_t& lo) {
+  const uint64_t product = static_cast<uint64_t>(a) * b;
+  hi = static_cast<uint32_t>(product >> 32);
+  lo = static_cast<uint32_t>(product);
+}
+
+HCTR_HOST_DEVICE HCTR_INLINE void philox4x32_10(const uint64_t seed, const uint64_t counter,
+                                                uint32_t (&words)[4]) {
+  uint32_t c0 = static_cast<uint32_t>(counter);
+  uint32_t c1 = static_cast<uint32_t>(counter >> 32);
+  uint32_t c2 = 0;
+  uint32_t c3 = 0;
+  uint32_t k0 = static_cast<uint32_t>(seed);
+  uint32_t k1 = static_cast<uint32_t>(seed >> 32);
+  for (int round = 0; round < 10; ++round) {
+    uint32_t hi0, lo0, hi1, lo1;
+    philox_mulhilo(0xD2511F53u, c0, hi0, lo0);
+    philox_mulhilo(0xCD9E8D57u, c2, hi1, lo1);
+    c0 = hi1 ^ c1 ^ k0;
+    c1 = lo1;
+    c2 = hi0 ^ c3 ^ k1;
+    c3 = lo0;
+    k0 += 0x9E3779B9u;
+    k1 += 0xBB67AE85u;
+  }
+  words[0] = c0;
+  words[1] = c1;
+  words[2] = c2;
+  words[3] = c3;
+}
+
+// (0, 1] from 32 and 53 random bits respectively, like curand_uniform(_double).
+HCTR_HOST_DEVICE HCTR_INLINE float philox_to_unit(uint32_t x) {
+  return x * 2.3283064e-10f + 1.1641532e-10f;
+}
+
+HCTR_HOST_DEVICE HCTR_INLINE double philox_to_unit(uint32_t x, uint32_t y) {
+  const uint64_t z = static_cast<uint64_t>(x) ^ (static_cast<uint64_t>(y) << (53 - 32));
+  return z * 1.1102230246251565e-16 + 5.5511151231257827e-17;
+}
+
+/**
+ * Distributions, called with the words of one counter to produce the
+ * kPhiloxValuesPerCounter<Type> values that belong to it.
+ */
+template <typename Type>
+struct PhiloxUniform {
+  static_assert(std::is_floating_point<Type>::value);
+  Type a;
+  Type b;
+
+  HCTR_HOST_DEVICE HCTR_INLINE void operator()(const uint32_t (&words)[4], Type* out) const {
+    if constexpr (std::is_same<Type, float>::value) {
+      out[0] = philox_to_unit(words[0]) * (b - a) + a;
+      out[1] = philox_to_unit(words[1]) * (b - a) + a;
+      out[2] = philox_to_unit(words[2]) * (b - a) + a;
+      out[3] = philox_to_unit(words[3]) * (b - a) + a;
+    } else {
+      out[0] = philox_to_unit(words[0], words[1]) * (b - a) + a;
+      out[1] = philox_to_unit(words[2], words[3]) * (b - a) + a;
+    }
+  }
+};
+
+// Box-Muller transform, one pair of values per 64 (float) or 128 (double) random bits.
+template <typename Type>
+struct PhiloxNormal {
+  static_assert(std::is_floating_point<Type>::value);
+  Type mean;
+  Type stddev;
+
+  HCTR_HOST_DEVICE HCTR_INLINE void operator()(const uint32_t (&words)[4], Type* out) const {
+    if constexpr (std::is_same<Type, float>::value) {
+      box_muller(philox_to_unit(words[0]), philox_to_unit(words[1]), out);
+      box_muller(philox_to_unit(words[2]), philox_to_unit(words[3]), out + 2);
+    } else {
+      box_muller(philox_to_unit(words[0], words[1]), philox_to_unit(words[2], words[3]), out);
+    }
+  }
+
+ private:
+  HCTR_HOST_DEVICE HCTR_INLINE void box_muller(Type u, Type v, Type* out) const {
+    constexpr Type two_pi = static_cast<Type>(6.283185307179586);
+    const Type radius = stddev * std::sqrt(static_cast<Type>(-2) * std::log(u));
+    out[0] = radius * std::cos(two_pi * v) + mean;
+    out[1] = radius * std::sin(two_pi * v) + mean;
+  }
+};
+
+}  // namespace core23
+
+}  // namespace HugeCTR
@@ -41,12 +41,13 @@ template <typename Type>
 void fill_cpu(Type* data, int64_t num_elements, const Type val, const Device& device,
               std::optional<CUDAStream> stream_or) {
   if (stream_or) {
-    FillParams<Type>* params = new FillParams<Type>(data, num_elements, val);
-    HCTR_LIB_THROW(cudaLaunchHostFunc(static_cast<cudaStream_t>(stream_or.value()),
-                                      static_cast<cudaHostFn_t>(fill_wrapper<Type>), params));
-  } else {
-    std::fill(data, data + num_elements, val);
+    // Fill on the calling thread and the default ThreadPool, once the work queued before us is
+    // done. A host function would block the stream's callback thread on the ThreadPool.
+    HCTR_LIB_THROW(cudaStreamSynchronize(static_cast<cudaStream_t>(stream_or.value())));
   }
+  host_parallel_for(num_elements, [data, val](int64_t begin, int64_t end) {
+    std::fill(data + begin, data + end, val);
+  });
 }
 
 template <typename Type>
@@ -95,10 +96,11 @@ void transform_async_common(DstType* dst, const SrcType* src, int64_t num_elemen
   DeviceGuard device_guard(src_device.type() == DeviceType::CPU ? dst_device : src_device);
   if (dst_device == src_device) {
     if (src_device.type() == DeviceType::CPU) {
-      TransformParams<DstType, SrcType, Op>* params =
-          new TransformParams<DstType, SrcType, Op>(dst, src, num_elements, op);
-      HCTR_LIB_THROW(cudaLaunchHostFunc(
-          stream(), static_cast<cudaHostFn_t>(transform_wrapper<DstType, SrcType, Op>), params));
+      // Like fill_cpu and philox_async, rather than in a host function.
+      HCTR_LIB_THROW(cudaStreamSynchronize(stream()));
+      host_parallel_for(num_elements, [dst, src, op](int64_t begin, int64_t end) {
+        std::transform(src + begin, src + end, dst + begin, op);
+      });
     } else {
       dim3 block(1024);
       dim3 grid((num_elements + block.x - 1) / block.x);
@@ -156,11 +158,42 @@ void convert_async(DstType* dst_data, const SrcType* src_data, int64_t num_eleme
                                                 const Device&, CUDAStream);
 ALL_DATA_CONVERSIONS_SUPPORTED(DEFINE_CONVERT_ASYNC_COMMON)
 
+// CPU tensors and Philox generators use the counter-based stream of details/philox.hpp.
+bool use_philox(const Device& device, const CURANDGenerator& generator) {
+  return device.type() == DeviceType::CPU ||
+         generator.rng_type() == CURAND_RNG_PSEUDO_PHILOX4_32_10;
+}
+
+template <typename Type, typename Distribution>
+void philox_async(Type* data, int64_t num_elements, Distribution dist, const Device& device,
+                  CURANDGenerator generator, CUDAStream stream) {
+  constexpr int64_t kValues = kPhiloxValuesPerCounter<Type>;
+  const int64_t num_counters = (num_elements + kValues - 1) / kValues;
+  const uint64_t counter = generator.reserve_philox_counters(num_counters);
+
+  if (device.type() == DeviceType::CPU) {
+    // Generate on the calling thread and the default ThreadPool rather than on the host callback
+    // thread of the stream, once the work queued before us is done.
+    HCTR_LIB_THROW(cudaStreamSynchronize(stream()));
+    philox_generate(data, num_elements, generator.seed(), counter, dist);
+  } else {
+    DeviceGuard device_guard(device);
+    dim3 block(1024);
+    dim3 grid((num_counters + block.x - 1) / block.x);
+    philox_kernel<<<grid, block, 0, stream()>>>(data, num_elements, generator.seed(), counter,
+                                                 dist);
+  }
+}
+
 template <typename Type>
 void uniform_async(Type* data, int64_t num_elements, const Type a, const Type b,
                    const Device& device, CURANDGenerator generator, CUDAStream stream) {
   static_assert(std::is_floating_point<Type>::value);
-  if (data == nullptr) return;
+  if (data == nullptr || num_elements == 0) return;
+  if (use_philox(device, generator)) {
+    philox_async(data, num_elements, PhiloxUniform<Type>{a, b}, device, generator, stream);
+    return;
+  }
 
   DeviceGuard device_guard(device);
   generator.set_stream(stream);
@@ -179,6 +212,10 @@ void normal_async(Type* data, int64_t num_elements, const Type mean, const Type
                   const Device& device, CURANDGenerator generator, CUDAStream stream) {
   static_assert(std::is_floating_point<Type>::value);
   if (data == nullptr || num_elements == 0) return;
+  if (use_philox(device, generator)) {
+    philox_async(data, num_elements, PhiloxNormal<Type>{mean, stddev}, device, generator, stream);
+    return;
+  }
 
   // in case odd length
   Type tmp[2];
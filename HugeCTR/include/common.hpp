@@ -64,7 +64,7 @@ namespace HugeCTR {
 
 #define WARP_SIZE 32
 
-enum class Check_t { Sum, None, Unknown };
+enum class Check_t { Sum, None, CRC32C, Unknown };
 
 enum class DataReaderType_t { Norm, Raw, Parquet, RawAsync };
 
@@ -182,7 +182,7 @@ struct AsyncParam {
 };
 
 typedef struct DataSetHeader_ {
-  long long error_check;        // 0: no error check; 1: check_sum
+  long long error_check;        // 0: no error check; 1: check_sum; 2: crc32c
   long long number_of_records;  // the number of samples in this data file
   long long label_dim;          // dimension of label
   long long dense_dim;          // dimension of dense feature
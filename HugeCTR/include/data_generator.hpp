@@ -20,6 +20,7 @@
 
 #include <common.hpp>
 #include <core23/logger.hpp>
+#include <data_readers/crc32c.hpp>
 #include <fstream>
 #include <memory>
 #include <random>
@@ -139,13 +140,13 @@ class Checker_Traits;
 template <>
 class Checker_Traits<Check_t::Sum> {
  public:
-  static char zero() { return 0; }
-
-  static char accum(char pre, char x) { return pre + x; }
-
-  static void write(int N, char* array, char chk_bits, std::ofstream& stream) {
+  static void write(int N, const char* array, std::ofstream& stream) {
+    char chk_bits = 0;
+    for (int i = 0; i < N; i++) {
+      chk_bits += array[i];
+    }
     stream.write(reinterpret_cast<char*>(&N), sizeof(int));
-    stream.write(reinterpret_cast<char*>(array), N);
+    stream.write(array, N);
     stream.write(reinterpret_cast<char*>(&chk_bits), sizeof(char));
   }
 
@@ -155,34 +156,37 @@ class Checker_Traits<Check_t::Sum> {
 template <>
 class Checker_Traits<Check_t::None> {
  public:
-  static char zero() { return 0; }
+  static void write(int N, const char* array, std::ofstream& stream) { stream.write(array, N); }
 
-  static char accum(char pre, char x) { return 0; }
+  static long long ID() { return 0; }
+};
 
-  static void write(int N, char* array, char chk_bits, std::ofstream& stream) {
-    stream.write(reinterpret_cast<char*>(array), N);
+template <>
+class Checker_Traits<Check_t::CRC32C> {
+ public:
+  static void write(int N, const char* array, std::ofstream& stream) {
+    uint32_t chk_bits = crc32c(array, N);
+    stream.write(reinterpret_cast<char*>(&N), sizeof(int));
+    stream.write(array, N);
+    stream.write(reinterpret_cast<char*>(&chk_bits), sizeof(uint32_t));
   }
 
-  static long long ID() { return 0; }
+  static long long ID() { return 2; }
 };
 
+/**
+ * Buffers one block (the header or one sample) and writes it with the checksum of `T`.
+ */
 template <Check_t T>
 class DataWriter {
   std::vector<char> array_;
   std::ofstream& stream_;
-  char check_char_{0};
 
  public:
-  DataWriter(std::ofstream& stream) : stream_(stream) { check_char_ = Checker_Traits<T>::zero(); }
-  void append(char* array, int N) {
-    for (int i = 0; i < N; i++) {
-      array_.push_back(array[i]);
-      check_char_ = Checker_Traits<T>::accum(check_char_, array[i]);
-    }
-  }
+  DataWriter(std::ofstream& stream) : stream_(stream) {}
+  void append(const char* array, int N) { array_.insert(array_.end(), array, array + N); }
   void write() {
-    Checker_Traits<T>::write(static_cast<int>(array_.size()), array_.data(), check_char_, stream_);
-    check_char_ = Checker_Traits<T>::zero();
+    Checker_Traits<T>::write(static_cast<int>(array_.size()), array_.data(), stream_);
     array_.clear();
   }
 };
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <common.hpp>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <data_readers/file_list.hpp>
+#include <data_readers/source.hpp>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace HugeCTR {
+
+/**
+ * Drop-in replacement for `FileSource` that serves reads from memory.
+ *
+ * A background thread reads the files of this source (`offset`, `offset + stride`, ...) in large
+ * aligned blocks with `pread` and queues them. While the reader consumes one block, the next one
+ * is being loaded. Once a file is exhausted, the thread continues with the next file, so that the
+ * first block of the next file is usually ready when `next_source` is called.
+ */
+class BufferedFileSource : public Source {
+ private:
+  struct Block {
+    unsigned int file_id{0}; /**< sequence number of the file (see `counter_`) */
+    std::unique_ptr<char, void (*)(void*)> data{nullptr, std::free};
+    size_t size{0};                  /**< valid bytes in data */
+    bool last{false};                /**< last block of the file */
+    Error_t error{Error_t::Success}; /**< `FileCannotOpen`, `EndOfFile` or `UnspecificError` */
+  };
+
+  FileList file_list_;    /**< file list of data set */
+  std::string file_name_; /**< file name of current file */
+  const long long offset_;
+  const long long stride_;
+  const bool repeat_;
+  const size_t block_size_;
+  const size_t num_blocks_;
+  unsigned int counter_{0};
+
+  // consumer state
+  Block current_;            /**< block that is being read */
+  size_t current_offset_{0}; /**< bytes of current_ that have been read */
+  bool has_block_{false};
+  bool is_open_{false};
+
+  // queue between the I/O thread and the consumer
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Block> ready_; /**< loaded blocks in file order */
+  std::vector<std::unique_ptr<char, void (*)(void*)>> free_; /**< buffers to be reused */
+  bool stop_{false};
+  std::thread io_thread_;
+
+  void io_loop();
+
+  Block pop_block();
+
+  void recycle(Block& block);
+
+  /**
+   * Slow path of `read`, when the request spans the end of the current block.
+   */
+  Error_t read_across_blocks(char* ptr, size_t bytes_to_read);
+
+ public:
+  /**
+   * Ctor
+   * @param offset id of the first file of this source
+   * @param stride distance between the ids of consecutive files of this source
+   * @param file_list file list of data set
+   * @param repeat restart from the first file after the last one
+   * @param block_size bytes per read (rounded up to a multiple of 4 KiB)
+   * @param num_blocks number of blocks that may be loaded ahead of the reader
+   */
+  BufferedFileSource(long long offset, long long stride, const std::string& file_list,
+                     bool repeat, size_t block_size = 8 * 1024 * 1024, size_t num_blocks = 2);
+
+  ~BufferedFileSource();
+
+  std::string get_current_file_name() { return file_name_; }
+
+  /**
+   * Read "bytes_to_read" byte to the memory associated to ptr.
+   * @param ptr pointer to user located buffer
+   * @param bytes_to_read bytes to read
+   * @return `FileCannotOpen` `OutOfBound` `Success` `UnspecificError`
+   */
+  Error_t read(char* ptr, size_t bytes_to_read) noexcept {
+    if (bytes_to_read <= current_.size - current_offset_) {
+      std::memcpy(ptr, current_.data.get() + current_offset_, bytes_to_read);
+      current_offset_ += bytes_to_read;
+      return Error_t::Success;
+    }
+    return read_across_blocks(ptr, bytes_to_read);
+  }
+
+  /**
+   * Start a new file to read.
+   * @return `Success`, `FileCannotOpen` or `UnspecificError`
+   */
+  Error_t next_source(long long expected_next_source_items) noexcept;
+
+  bool is_open() noexcept { return is_open_; }
+};
+
+}  // namespace HugeCTR
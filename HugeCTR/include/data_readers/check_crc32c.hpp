@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <common.hpp>
+#include <cstring>
+#include <data_readers/checker.hpp>
+#include <data_readers/crc32c.hpp>
+#include <data_readers/source.hpp>
+#include <vector>
+
+namespace HugeCTR {
+
+/**
+ * Checker for files written with `Check_t::CRC32C`. Each block (the header or one sample) is
+ * stored as `int length`, `length` bytes of data and the `uint32_t` CRC32C of the data. The whole
+ * block is read and verified at once, and then served from memory.
+ */
+class CheckCRC32C : public Checker {
+ private:
+  const int MAX_TRY_{10};
+  const int MAX_BLOCK_LENGTH_{1 << 30}; /**< longer blocks can only stem from a corrupt length */
+  std::vector<char> block_;             /**< current block */
+  size_t offset_;                       /**< bytes of block_ that have been read */
+  bool block_valid_;                    /**< whether block_ matched its check sum */
+ public:
+  CheckCRC32C(Source& src) : Checker(src), offset_(0), block_valid_(true) {}
+  /**
+   * Read "bytes_to_read" byte to the memory associated to ptr.
+   * Users don't need to manually maintain the check bit offset, just specify
+   * number of bytes you really want to see in ptr.
+   * Like `CheckSum`, a corrupt block is still served in full, and the read that consumes the
+   * last byte of it returns `DataCheckError`. So the reads stay aligned with the samples.
+   * @param ptr pointer to user located buffer
+   * @param bytes_to_read bytes to read
+   * @return `DataCheckError` `BrokenFile` `OutOfBound` `Success` `UnspecificError`
+   */
+  Error_t read(char* ptr, size_t bytes_to_read) noexcept {
+    try {
+      // load and verify the next block
+      if (offset_ == block_.size()) {
+        int length = 0;
+        Checker::src_.read(reinterpret_cast<char*>(&length), sizeof(int));
+        if (length <= 0) {
+          std::ostringstream os;
+          os << "block length " << length << " <= 0";
+          HCTR_OWN_THROW(Error_t::BrokenFile, os.str());
+        }
+        if (length > MAX_BLOCK_LENGTH_) {
+          std::ostringstream os;
+          os << "block length " << length << " > " << MAX_BLOCK_LENGTH_;
+          HCTR_OWN_THROW(Error_t::BrokenFile, os.str());
+        }
+        block_.resize(length);
+        Checker::src_.read(block_.data(), block_.size());
+        uint32_t check_sum = 0;
+        Checker::src_.read(reinterpret_cast<char*>(&check_sum), sizeof(uint32_t));
+        offset_ = 0;
+        block_valid_ = crc32c(block_.data(), block_.size()) == check_sum;
+      }
+      // if user read more data than expected, return `BrokenFile`.
+      // User should check this error and call next_source to new a source.
+      if (bytes_to_read > block_.size() - offset_) {
+        std::ostringstream os;
+        os << "bytes_to_read " << bytes_to_read << " > " << block_.size() - offset_;
+        HCTR_OWN_THROW(Error_t::BrokenFile, os.str());
+      }
+      std::memcpy(ptr, block_.data() + offset_, bytes_to_read);
+      offset_ += bytes_to_read;
+      // do the check when the block has been consumed.
+      if (offset_ == block_.size() && !block_valid_) {
+        return Error_t::DataCheckError;
+      }
+      return Error_t::Success;
+    } catch (const std::runtime_error& rt_err) {
+      HCTR_LOG_S(ERROR, WORLD) << rt_err.what() << std::endl;
+      return Error_t::BrokenFile;
+    }
+  }
+
+  /**
+   * Start a new file to read.
+   * @return `FileCannotOpen` or `UnspecificError`
+   */
+  Error_t next_source(long long expected_next_source_items) {
+    // initialize
+    block_.clear();
+    offset_ = 0;
+    block_valid_ = true;
+    for (int i = MAX_TRY_; i > 0; i--) {
+      Error_t flag_eof = Checker::src_.next_source(expected_next_source_items);
+      if (flag_eof == Error_t::Success || flag_eof == Error_t::EndOfFile) {
+        return flag_eof;
+      }
+    }
+    HCTR_OWN_THROW(Error_t::FileCannotOpen,
+                   "Checker::src_.next_source() == Error_t::Success failed");
+    return Error_t::FileCannotOpen;  // to elimate compile error
+  }
+};
+
+}  // namespace HugeCTR
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace HugeCTR {
+
+/**
+ * CRC32C (Castagnoli) of a memory block. Uses the SSE4.2 or ARMv8 CRC32 instructions if the CPU
+ * supports them, and a table-driven implementation otherwise.
+ * @param data pointer to the block
+ * @param size size of the block in bytes
+ * @param crc CRC of the preceding data, to checksum a block in several pieces
+ */
+uint32_t crc32c(const void* data, size_t size, uint32_t crc = 0);
+
+/**
+ * Table-driven (slicing-by-8) CRC32C, regardless of CPU support. `crc32c` falls back to it.
+ */
+uint32_t crc32c_sw(const void* data, size_t size, uint32_t crc = 0);
+
+}  // namespace HugeCTR
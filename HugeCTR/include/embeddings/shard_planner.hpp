@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <parallel_hashmap/phmap.h>
+
+#include <embeddings/embedding_collection.hpp>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace HugeCTR {
+
+// Key statistics of one embedding table, gathered from a sample of the training data.
+struct EmbeddingTableStats {
+  std::string name;
+  int64_t num_samples = 0;      // number of (sample, lookup) pairs that were scanned
+  int64_t num_keys = 0;         // number of keys in these samples
+  int64_t num_unique_keys = 0;  // number of distinct keys in these samples
+
+  // (number of keys, occurrences of each of these keys) in descending order of occurrences
+  std::vector<std::pair<int64_t, double>> frequency_histogram;
+
+  double avg_hotness() const {
+    return num_samples > 0 ? static_cast<double>(num_keys) / static_cast<double>(num_samples) : 0.;
+  }
+
+  // expected number of distinct keys among `num_draws` keys that follow the sampled distribution
+  double expected_unique_keys(double num_draws) const;
+};
+std::ostream &operator<<(std::ostream &os, const EmbeddingTableStats &p);
+
+class EmbeddingTableStatsCollector {
+ public:
+  // `num_samples` is the number of samples whose keys of one lookup of this table are in `keys`.
+  template <typename KeyType>
+  void add(const std::string &table_name, const KeyType *keys, size_t num_keys,
+           int64_t num_samples);
+
+  std::vector<EmbeddingTableStats> stats() const;
+
+ private:
+  struct TableCounter {
+    phmap::flat_hash_map<int64_t, int64_t> key_counts;
+    int64_t num_samples = 0;
+    int64_t num_keys = 0;
+  };
+  std::map<std::string, TableCounter> tables_;
+};
+
+struct ShardPlannerParams {
+  int num_gpus = 1;                 // global number of GPUs
+  int64_t global_batch_size = 0;    // samples per iteration across all GPUs
+  double gpu_memory_budget = 16e9;  // bytes per GPU for embedding weights and optimizer states
+  double dp_memory_fraction = 0.1;  // share of the budget that replicated tables may occupy
+  int emb_type_size = 4;            // bytes per embedding vector element
+  int key_type_size = 8;            // bytes per key
+  HugeCTR::Optimizer_t default_optimizer = HugeCTR::Optimizer_t::SGD;  // for tables w/o optimizer
+
+  double memory_bandwidth = 1.5e12;   // bytes/s for embedding vector reads and updates on one GPU
+  double network_bandwidth = 1.5e11;  // bytes/s one GPU can send (or receive) during all2all
+  double allreduce_bandwidth = 1.5e11;  // bytes/s algorithm bandwidth of the wgrad allreduce
+
+  int min_column_width = 8;  // column-wise sharding never splits a table below this ev_size
+  double imbalance_tolerance = 1.1;  // shards heavier than tolerance * ideal load are split
+  int max_refinement_steps = 1000;
+};
+
+// Output of the shard planner. `shard_matrix` and `shard_strategy` can be passed to
+// `EmbeddingCollectionConfig::shard` as is.
+struct ShardPlan {
+  std::vector<std::vector<std::string>> shard_matrix;  // num_gpus * table names
+  std::vector<ShardStrategy> shard_strategy;
+
+  // cost model estimates per GPU
+  std::vector<double> memory_per_gpu;       // bytes
+  std::vector<double> lookup_time_per_gpu;  // seconds per iteration
+  std::vector<double> comm_time_per_gpu;    // seconds per iteration
+
+  double estimated_iteration_time() const;
+};
+std::ostream &operator<<(std::ostream &os, const ShardPlan &p);
+
+// Chooses data-parallel or model-parallel placement, row-wise and column-wise sharding factors and
+// GPUs for every table of `config`, such that the per GPU memory budget holds and the slowest GPU
+// is as fast as possible under a simple cost model of lookup traffic, all2all and allreduce
+// volume. Tables without `stats` are assumed to have one key per lookup and uniform access.
+ShardPlan plan_embedding_shards(const EmbeddingCollectionConfig &config,
+                                const std::vector<EmbeddingTableStats> &stats,
+                                const ShardPlannerParams &params);
+
+}  // namespace HugeCTR
@@ -265,15 +265,10 @@ inline uint64_t rrxmrrxmsx_0(uint64_t x) {
 #ifdef HCTR_HPS_DB_PARALLEL_FOR_EACH_PART_
 #error HCTR_HPS_DB_PARALLEL_FOR_EACH_PART_ already defined. Potential naming conflict!
 #endif
-#define HCTR_HPS_DB_PARALLEL_FOR_EACH_PART_(...)                                        \
-  do {                                                                                  \
-    std::vector<std::future<void>> tasks;                                               \
-    tasks.reserve(num_partitions);                                                      \
-                                                                                        \
-    for (size_t part_index{0}; part_index < num_partitions; ++part_index) {             \
-      tasks.emplace_back(ThreadPool::get().submit([&, part_index]() { __VA_ARGS__; })); \
-    }                                                                                   \
-    ThreadPool::await(tasks.begin(), tasks.end());                                      \
+#define HCTR_HPS_DB_PARALLEL_FOR_EACH_PART_(...)                                         \
+  do {                                                                                   \
+    ThreadPool::get().parallel_for(num_partitions,                                       \
+                                   [&](const size_t part_index) { __VA_ARGS__; });       \
   } while (0)
 
 /**
@@ -17,11 +17,17 @@
 
 #include <parallel_hashmap/phmap.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <core/memory.hpp>
 #include <deque>
 #include <functional>
 #include <hps/database_backend.hpp>
+#include <hps/value_codec.hpp>
+#include <memory>
+#include <mutex>
 #include <shared_mutex>
 #include <thread>
 #include <thread_pool.hpp>
@@ -37,6 +43,24 @@ namespace HugeCTR {
 struct HashMapBackendParams final : public VolatileBackendParams {
   size_t allocation_rate{256L * 1024 *
                          1024};  // Number of additional bytes to allocate per allocation cycle.
+  DatabaseAccessTracking_t access_tracking{
+      DatabaseAccessTracking_t::Immediate};  // How hits are accounted for by the LRU/LFU policies.
+  size_t access_sample_rate{1};  // Deferred tracking: Only every n-th hit of a batch is recorded.
+  size_t access_log_capacity{1024L * 1024};  // Deferred tracking: Maximum number of records that
+                                             // are buffered per partition before dropping.
+  DatabaseValueCodec_t value_codec{
+      DatabaseValueCodec_t::None};  // Format in which values are kept in memory (see value_codec).
+  DatabaseNumaPlacement_t numa_placement{
+      DatabaseNumaPlacement_t::Default};  // How partitions are distributed across NUMA nodes.
+};
+
+/**
+ * Statistics of the deferred access tracking of a `HashMapBackend`.
+ */
+struct HashMapAccessStats final {
+  size_t num_applied{0};  // Number of records folded into the eviction metadata.
+  size_t num_dropped{0};  // Number of records dropped because a log was full.
+  size_t num_drains{0};   // Number of times the logs of a partition were folded in.
 };
 
 /**
@@ -59,6 +83,8 @@ class HashMapBackend final : public VolatileBackend<Key, HashMapBackendParams> {
    */
   HashMapBackend(const HashMapBackendParams& params);
 
+  ~HashMapBackend();
+
   bool is_shared() const override final { return false; }
 
   const char* get_name() const override { return "HashMapBackend"; }
@@ -92,17 +118,13 @@ class HashMapBackend final : public VolatileBackend<Key, HashMapBackendParams> {
   size_t dump_sst(const std::string& table_name, rocksdb::SstFileWriter& file) override;
 #endif  // HCTR_USE_ROCKS_DB
 
+  HashMapAccessStats access_stats() const;
+
  protected:
-#if 1
-  // Better performance on most systems.
-  using CharAllocator = AlignedAllocator<char>;
+  // Aligned allocation has better performance on most systems. Unless NUMA placement is enabled,
+  // this behaves like `AlignedAllocator`.
+  using CharAllocator = NumaAllocator<char>;
   static constexpr size_t value_page_alignment{CharAllocator::alignment};
-#else
-  using CharAllocator = std::allocator<char>;
-  // __STDCPP_DEFAULT_NEW_ALIGNMENT__ is actually 16 with current GCC. But we use sizeof(char) here
-  // which equates to have no padding.
-  static constexpr size_t value_page_alignment{sizeof(char)};
-#endif
   static_assert(value_page_alignment > 0);
 
   using ValuePage = std::vector<char, CharAllocator>;
@@ -117,33 +139,119 @@ class HashMapBackend final : public VolatileBackend<Key, HashMapBackendParams> {
     ValuePtr value;
   };
   using Entry = std::pair<const Key, Payload>;
+  using EntryMap = phmap::flat_hash_map<Key, Payload, phmap::Hash<Key>, phmap::EqualTo<Key>,
+                                        NumaAllocator<Entry>>;
+
+  // Hits that were recorded during `fetch`, but not yet folded into the payload metadata. Each
+  // record stands for `weight` hits of `key`, i.e., itself and the hits skipped by the sampling.
+  struct AccessRecord final {
+    Key key;
+    time_t time;
+    size_t weight;
+  };
+
+  // Each fetching thread appends to its own log; `busy` guards against the rare case that two
+  // threads map to the same log, and against draining a log while it is appended to.
+  struct alignas(64) AccessLog final {
+    std::atomic_flag busy = ATOMIC_FLAG_INIT;
+    std::vector<AccessRecord> records;
+  };
+
+  // The logs of a partition (one per hardware thread). Logs are drained by insert/evict, by a fetch
+  // that fills its log beyond half of its capacity, and periodically by `access_thread_`. Holding
+  // `draining` grants the right to alter the payload metadata while fetches are running.
+  struct AccessLogs final {
+    explicit AccessLogs(const size_t num_logs) : logs(num_logs) {}
+
+    std::atomic_flag draining = ATOMIC_FLAG_INIT;
+    std::vector<AccessLog> logs;
+  };
 
   struct Partition final {
     const uint32_t value_size;
+    const DatabaseValueCodec_t value_codec;
+    const uint32_t encoded_value_size;
     const size_t allocation_rate;
+    const CharAllocator char_allocator;
 
     // Pooled payload storage.
     std::vector<ValuePage> value_pages;
     std::vector<ValuePtr> value_slots;
 
     // Key -> Payload map.
-    phmap::flat_hash_map<Key, Payload> entries;
+    EntryMap entries;
+
+    // Deferred access tracking.
+    std::unique_ptr<AccessLogs> access_logs;
 
     Partition() = delete;
 
-    Partition(const uint32_t value_size, const HashMapBackendParams& params)
-        : value_size{value_size}, allocation_rate{params.allocation_rate} {}
+    Partition(const uint32_t value_size, const HashMapBackendParams& params, const int numa_node)
+        : value_size{value_size},
+          value_codec{params.value_codec},
+          encoded_value_size{value_codec_encoded_size(params.value_codec, value_size)},
+          allocation_rate{params.allocation_rate},
+          char_allocator{numa_node},
+          entries{typename EntryMap::allocator_type{numa_node}} {
+      if (params.access_tracking == DatabaseAccessTracking_t::Deferred &&
+          params.overflow_policy != DatabaseOverflowPolicy_t::EvictRandom) {
+        access_logs =
+            std::make_unique<AccessLogs>(std::max(std::thread::hardware_concurrency(), 1U));
+      }
+    }
   };
 
   // Actual data.
-  CharAllocator char_allocator_;
   std::unordered_map<std::string, std::vector<Partition>> tables_;
 
   // Access control.
   mutable std::shared_mutex read_write_guard_;
 
+  // NUMA placement. With `DatabaseNumaPlacement_t::Local`, partition `i` is kept on NUMA node
+  // `numa_nodes_[i % numa_nodes_.size()]` and processed by the workers in `numa_workers_[...]`.
+  // The worker pools of a node are shared with the other backends in this process.
+  DatabaseNumaPlacement_t numa_placement_;
+  std::vector<int> numa_nodes_;
+  std::vector<ThreadPool*> numa_workers_;
+
+  int numa_node_of_part_(size_t part_index) const;
+
+  template <typename Function>
+  void for_each_part_(size_t num_partitions, const Function& fn) const;
+
+  inline const CharAllocator& char_allocator_for_(const Partition& part) const {
+    return part.char_allocator;
+  }
+
+  // Batched lookup. Keys are resolved in groups to overlap the memory accesses of multiple keys.
+  static constexpr size_t fetch_group_size{16};
+
+  template <typename HitOp>
+  size_t fetch_group_(Partition& part, const Key* const* group, size_t group_size, const Key* keys,
+                      char* values, size_t value_stride, const DatabaseMissCallback& on_miss,
+                      const HitOp& on_hit) const;
+
   // Overflow resolution.
   size_t resolve_overflow_(const std::string& table_name, size_t part_index, Partition& part);
+
+  // Deferred access tracking. Records are stamped with `access_clock_` instead of reading the clock
+  // in `fetch`. `access_thread_` advances it and drains the logs every `access_drain_interval`.
+  static constexpr std::chrono::seconds access_drain_interval{1};
+
+  mutable std::atomic<time_t> access_clock_;
+  mutable std::atomic<size_t> num_access_applied_{0};
+  mutable std::atomic<size_t> num_access_dropped_{0};
+  mutable std::atomic<size_t> num_access_drains_{0};
+
+  std::mutex access_thread_guard_;
+  std::condition_variable access_thread_semaphore_;
+  bool access_thread_terminate_{false};
+  std::thread access_thread_;
+
+  void run_access_thread_();
+
+  void record_accesses_(Partition& part, const std::vector<Key>& keys, size_t num_hits) const;
+  size_t apply_access_log_(Partition& part) const;
 };
 
 // TODO: Remove me!
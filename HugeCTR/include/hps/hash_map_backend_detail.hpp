@@ -17,6 +17,7 @@
 
 #include <hps/database_backend_detail.hpp>
 #include <hps/inference_utils.hpp>
+#include <hps/value_codec.hpp>
 #include <thread_pool.hpp>
 #include <type_traits>
 
@@ -26,6 +27,17 @@ namespace HugeCTR {
 #pragma GCC diagnostic push
 #pragma GCC diagnostic error "-Wconversion"
 
+/**
+ * HashMap Backend / Per-partition parallelism (respects the NUMA placement of the partitions).
+ */
+#ifdef HCTR_HPS_HASH_MAP_PARALLEL_FOR_EACH_PART_
+#error HCTR_HPS_HASH_MAP_PARALLEL_FOR_EACH_PART_ already defined. Potential naming conflict!
+#endif
+#define HCTR_HPS_HASH_MAP_PARALLEL_FOR_EACH_PART_(...)                             \
+  do {                                                                             \
+    for_each_part_(num_partitions, [&](const size_t part_index) { __VA_ARGS__; }); \
+  } while (0)
+
 /**
  * HashMap Backend / Contains
  */
@@ -91,7 +103,8 @@ namespace HugeCTR {
                                                                                              \
       /* Race-conditions here are deliberately ignored because insignificant in practice. */ \
       __VA_ARGS__;                                                                           \
-      std::copy_n(payload.value, part.value_size, &values[(k - keys) * value_stride]);       \
+      value_codec_decode(part.value_codec, &payload.value[0], part.value_size,               \
+                         &values[(k - keys) * value_stride]);                                \
     } else {                                                                                 \
       on_miss(k - keys);                                                                     \
       ++miss_count;                                                                          \
@@ -120,6 +133,75 @@ namespace HugeCTR {
     return true;                                                                              \
   }()
 
+/**
+ * HashMap Backend / Fetch (grouped)
+ *
+ * Collects up to `fetch_group_size` keys that belong to the partition and resolves them together
+ * (see `HashMapBackend::fetch_group_`). `HIT_OP` is invoked as `HIT_OP(payload, k)` for each hit.
+ */
+#ifdef HCTR_HPS_HASH_MAP_FETCH_GROUP_
+#error HCTR_HPS_HASH_MAP_FETCH_GROUP_ already defined. Potential naming conflict!
+#endif
+#define HCTR_HPS_HASH_MAP_FETCH_GROUP_(MODE, HIT_OP)                                            \
+  do {                                                                                          \
+    static_assert(std::is_same_v<decltype(miss_count), size_t>);                                \
+    static_assert(std::is_same_v<decltype(value_stride), const size_t>);                        \
+    static_assert(std::is_same_v<decltype(values), char* const>);                               \
+                                                                                                \
+    const Key* group[fetch_group_size];                                                         \
+    size_t group_size{0};                                                                       \
+    HCTR_HPS_DB_APPLY_(MODE, {                                                                  \
+      group[group_size++] = k;                                                                  \
+      if (group_size == fetch_group_size) {                                                     \
+        miss_count +=                                                                           \
+            fetch_group_(part, group, group_size, keys, values, value_stride, on_miss, HIT_OP); \
+        group_size = 0;                                                                         \
+      }                                                                                         \
+    });                                                                                         \
+    miss_count +=                                                                               \
+        fetch_group_(part, group, group_size, keys, values, value_stride, on_miss, HIT_OP);     \
+  } while (0)
+
+/**
+ * Instead of updating the payload metadata, deferred access tracking (sampled and) records hits
+ * in a buffer that is local to the calling thread. The buffer is appended to the thread's access
+ * log of the partition once per batch, along with the number of hits it was sampled from.
+ */
+#ifdef HCTR_HPS_HASH_MAP_FETCH_GROUPED_
+#error HCTR_HPS_HASH_MAP_FETCH_GROUPED_ already defined. Potential naming conflict!
+#endif
+#define HCTR_HPS_HASH_MAP_FETCH_GROUPED_(MODE)                                                \
+  [&]() {                                                                                     \
+    static_assert(std::is_same_v<decltype(overflow_policy), const DatabaseOverflowPolicy_t>); \
+    static_assert(std::is_same_v<decltype(access_tracking), const DatabaseAccessTracking_t>); \
+    static_assert(std::is_same_v<decltype(access_sample_rate), const size_t>);                \
+    static_assert(std::is_same_v<decltype(access_buffer), std::vector<Key>>);                 \
+                                                                                              \
+    if (overflow_policy == DatabaseOverflowPolicy_t::EvictRandom) {                           \
+      const auto ignore_hit{[](Payload&, const Key*) {}};                                     \
+      HCTR_HPS_HASH_MAP_FETCH_GROUP_(MODE, ignore_hit);                                       \
+    } else if (access_tracking == DatabaseAccessTracking_t::Deferred) {                       \
+      access_buffer.clear();                                                                  \
+      size_t num_hits{0};                                                                     \
+      const auto record_hit{[&](Payload&, const Key* const k) {                               \
+        if (num_hits++ % access_sample_rate == 0) {                                           \
+          access_buffer.emplace_back(*k);                                                     \
+        }                                                                                     \
+      }};                                                                                     \
+      HCTR_HPS_HASH_MAP_FETCH_GROUP_(MODE, record_hit);                                       \
+      record_accesses_(part, access_buffer, num_hits);                                        \
+    } else if (overflow_policy == DatabaseOverflowPolicy_t::EvictLeastUsed) {                 \
+      const auto count_hit{[](Payload& payload, const Key*) { ++payload.access_count; }};     \
+      HCTR_HPS_HASH_MAP_FETCH_GROUP_(MODE, count_hit);                                        \
+    } else if (overflow_policy == DatabaseOverflowPolicy_t::EvictOldest) {                    \
+      const time_t now{std::time(nullptr)};                                                   \
+      const auto stamp_hit{                                                                   \
+          [now](Payload& payload, const Key*) { payload.last_access = now; }};                \
+      HCTR_HPS_HASH_MAP_FETCH_GROUP_(MODE, stamp_hit);                                        \
+    }                                                                                         \
+    return true;                                                                              \
+  }()
+
 /**
  * HashMap Backend / Insert
  */
@@ -144,13 +226,13 @@ namespace HugeCTR {
     if (res.second) {                                                                        \
       /* If no free space, allocate another buffer, and fill pointer queue. */               \
       if (part.value_slots.empty()) {                                                        \
-        const size_t stride{(value_size + value_page_alignment - 1) / value_page_alignment * \
-                            value_page_alignment};                                           \
+        const size_t stride{(part.encoded_value_size + value_page_alignment - 1) /           \
+                            value_page_alignment * value_page_alignment};                    \
         const size_t num_values{part.allocation_rate / stride};                              \
         HCTR_CHECK(num_values > 0);                                                          \
                                                                                              \
         /* Get more memory. */                                                               \
-        part.value_pages.emplace_back(num_values* stride, char_allocator_);                  \
+        part.value_pages.emplace_back(num_values* stride, char_allocator_for_(part));        \
         ValuePage& value_page{part.value_pages.back()};                                      \
                                                                                              \
         /* Stock up slot references. */                                                      \
@@ -167,7 +249,8 @@ namespace HugeCTR {
       ++num_inserts;                                                                         \
     }                                                                                        \
                                                                                              \
-    std::copy_n(&values[(k - keys) * value_stride], value_size, payload.value);              \
+    value_codec_encode(part.value_codec, &values[(k - keys) * value_stride], value_size,     \
+                       &payload.value[0]);                                                   \
   } while (0)
 
 /**
@@ -20,6 +20,7 @@
 #include <hps/embedding_cache_base.hpp>
 #include <hps/hier_parameter_server_base.hpp>
 #include <hps/inference_utils.hpp>
+#include <hps/key_trace.hpp>
 #include <hps/memory_pool.hpp>
 #include <hps/message.hpp>
 #include <iostream>
@@ -81,8 +82,13 @@ class HierParameterServer : public HierParameterServerBase {
   std::unique_ptr<DatabaseBackendBase<TypeHashKey>> persistent_db_;
   bool persistent_db_initialize_after_startup_;
 
+  // Records the keys of all lookups (if enabled).
+  std::unique_ptr<KeyTraceWriter> key_trace_;
+
   // Realtime data ingestion.
   std::unique_ptr<MessageSource<TypeHashKey>> volatile_db_source_;
+  std::unique_ptr<MessageSource<TypeHashKey>>
+      volatile_db_near_cache_source_;  // Keeps the near cache of a shared volatile DB coherent.
   std::unique_ptr<MessageSource<TypeHashKey>> persistent_db_source_;
 
   // Buffer pool that manages workspace and refreshspace of embedding caches
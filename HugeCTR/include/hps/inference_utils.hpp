@@ -57,6 +57,21 @@ enum class DatabaseOverflowPolicy_t {
   EvictLeastUsed,
   EvictOldest,
 };
+enum class DatabaseAccessTracking_t {
+  Immediate,  // Update eviction metadata of an entry directly on every hit.
+  Deferred,   // Buffer (sampled) hits and fold them into the eviction metadata lazily.
+};
+enum class DatabaseValueCodec_t {
+  None,  // Store values as-is.
+  FP16,  // Store fp32 values as IEEE half precision floats.
+  BF16,  // Store fp32 values as bfloat16.
+  Int8,  // Store fp32 values as int8 with a per-row scale.
+};
+enum class DatabaseNumaPlacement_t {
+  Default,      // Leave memory placement and scheduling to the OS.
+  Local,        // Assign partitions to NUMA nodes. Memory and work stay on the partition's node.
+  Interleaved,  // Interleave the memory pages of all partitions across all NUMA nodes.
+};
 enum class UpdateSourceType_t {
   Null,
   KafkaMessageQueue,
@@ -116,6 +131,45 @@ constexpr const char* hctr_enum_to_c_str(const DatabaseOverflowPolicy_t value) {
       return "<unknown DatabaseOverflowPolicy_t value>";
   }
 }
+constexpr const char* hctr_enum_to_c_str(const DatabaseAccessTracking_t value) {
+  // Remark: Dependent functions assume lower-case, and underscore separated.
+  switch (value) {
+    case DatabaseAccessTracking_t::Immediate:
+      return "immediate";
+    case DatabaseAccessTracking_t::Deferred:
+      return "deferred";
+    default:
+      return "<unknown DatabaseAccessTracking_t value>";
+  }
+}
+constexpr const char* hctr_enum_to_c_str(const DatabaseValueCodec_t value) {
+  // Remark: Dependent functions assume lower-case, and underscore separated.
+  switch (value) {
+    case DatabaseValueCodec_t::None:
+      return "none";
+    case DatabaseValueCodec_t::FP16:
+      return "fp16";
+    case DatabaseValueCodec_t::BF16:
+      return "bf16";
+    case DatabaseValueCodec_t::Int8:
+      return "int8";
+    default:
+      return "<unknown DatabaseValueCodec_t value>";
+  }
+}
+constexpr const char* hctr_enum_to_c_str(const DatabaseNumaPlacement_t value) {
+  // Remark: Dependent functions assume lower-case, and underscore separated.
+  switch (value) {
+    case DatabaseNumaPlacement_t::Default:
+      return "default";
+    case DatabaseNumaPlacement_t::Local:
+      return "local";
+    case DatabaseNumaPlacement_t::Interleaved:
+      return "interleaved";
+    default:
+      return "<unknown DatabaseNumaPlacement_t value>";
+  }
+}
 constexpr const char* hctr_enum_to_c_str(const UpdateSourceType_t value) {
   // Remark: Dependent functions assume lower-case, and underscore separated.
   switch (value) {
@@ -134,6 +188,15 @@ inline std::ostream& operator<<(std::ostream& os, DatabaseType_t value) {
 inline std::ostream& operator<<(std::ostream& os, DatabaseOverflowPolicy_t value) {
   return os << hctr_enum_to_c_str(value);
 }
+inline std::ostream& operator<<(std::ostream& os, DatabaseAccessTracking_t value) {
+  return os << hctr_enum_to_c_str(value);
+}
+inline std::ostream& operator<<(std::ostream& os, DatabaseValueCodec_t value) {
+  return os << hctr_enum_to_c_str(value);
+}
+inline std::ostream& operator<<(std::ostream& os, DatabaseNumaPlacement_t value) {
+  return os << hctr_enum_to_c_str(value);
+}
 inline std::ostream& operator<<(std::ostream& os, UpdateSourceType_t value) {
   return os << hctr_enum_to_c_str(value);
 }
@@ -148,6 +211,12 @@ UpdateSourceType_t get_hps_updatesource_type(const nlohmann::json& json, const s
                                              UpdateSourceType_t default_value);
 DatabaseOverflowPolicy_t get_hps_overflow_policy(const nlohmann::json& json, const std::string& key,
                                                  DatabaseOverflowPolicy_t default_value);
+DatabaseAccessTracking_t get_hps_access_tracking(const nlohmann::json& json, const std::string& key,
+                                                 DatabaseAccessTracking_t default_value);
+DatabaseValueCodec_t get_hps_value_codec(const nlohmann::json& json, const std::string& key,
+                                         DatabaseValueCodec_t default_value);
+DatabaseNumaPlacement_t get_hps_numa_placement(const nlohmann::json& json, const std::string& key,
+                                               DatabaseNumaPlacement_t default_value);
 EmbeddingCacheType_t get_hps_embeddingcache_type(const nlohmann::json& json, const std::string& key,
                                                  EmbeddingCacheType_t default_value);
 
@@ -160,13 +229,23 @@ struct VolatileDatabaseParams {
   std::string password;
   size_t num_partitions{16};
   size_t allocation_rate{256L * 1024 * 1024};  // Only used with HashMap type backends.
+  DatabaseValueCodec_t value_codec{
+      DatabaseValueCodec_t::None};  // Storage format of values (only for HashMap type backends).
+  DatabaseNumaPlacement_t numa_placement{
+      DatabaseNumaPlacement_t::Default};  // Only used with HashMap type backends.
   size_t shared_memory_size{
       16L * 1024 * 1024 *
       1024};  // Size-limit of the shared memory (only for Multi-Process hashmap).
   std::string shared_memory_name{
       "hctr_mp_hash_map_database"};  // Name of the shared memory (only for Multi-Process hashmap).
   bool shared_memory_auto_remove{true};
-  size_t num_node_connections{5};  // Only used with Redis backend.
+  size_t num_node_connections{5};              // Only used with Redis backend.
+  size_t num_slots_per_partition{1};           // Only used with Redis backend.
+  size_t num_refresh_workers{4};               // Only used with Redis backend.
+  size_t refresh_window_ms{10};                // Only used with Redis backend.
+  size_t max_pending_refreshes{1024L * 1024};  // Only used with Redis backend.
+  size_t near_cache_capacity{0};  // Bytes per table (only used with Redis backend; 0 = disabled).
+  size_t near_cache_ttl_ms{1000};              // Only used with Redis backend.
   size_t max_batch_size{64L * 1024};
 
   bool enable_tls{false};
@@ -179,6 +258,10 @@ struct VolatileDatabaseParams {
   size_t overflow_margin{std::numeric_limits<size_t>::max()};
   DatabaseOverflowPolicy_t overflow_policy{DatabaseOverflowPolicy_t::EvictRandom};
   double overflow_resolution_target{0.8};
+  DatabaseAccessTracking_t access_tracking{
+      DatabaseAccessTracking_t::Immediate};  // HashMap and ParallelHashMap backends only.
+  size_t access_sample_rate{1};              // Deferred access tracking: Record every n-th hit.
+  size_t access_log_capacity{1024L * 1024};  // Deferred access tracking: Records per partition.
 
   // Caching behavior related.
   bool initialize_after_startup{true};
@@ -374,6 +457,9 @@ struct parameter_server_config {
   VolatileDatabaseParams volatile_db;
   PersistentDatabaseParams persistent_db;
   UpdateSourceParams update_source;
+  // Key trace recording (for offline cache simulation).
+  std::string key_trace_path;                          // Empty = disabled.
+  size_t key_trace_max_size{4L * 1024 * 1024 * 1024};  // Maximum file size in bytes.
   parameter_server_config(
       std::map<std::string, std::vector<std::string>> emb_table_name,
       std::map<std::string, std::vector<size_t>> embedding_vec_size,
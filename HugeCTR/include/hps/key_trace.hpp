@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <core/macro.hpp>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace HugeCTR {
+
+/**
+ * Key traces record the keys of every lookup, so that cache configurations can be evaluated offline
+ * (see `tools/cache_simulator`).
+ *
+ * File layout (little endian):
+ *
+ * - Header: `char magic[8] = "HPSKTRC1"`, `uint32_t key_size` (4 or 8 bytes).
+ * - One record per lookup: `uint32_t tag_size`, `char tag[tag_size]`, `uint64_t time` (nanoseconds
+ *   since the trace was opened), `uint64_t num_keys`, `keys[num_keys]`.
+ */
+constexpr char KEY_TRACE_MAGIC[8]{'H', 'P', 'S', 'K', 'T', 'R', 'C', '1'};
+
+class KeyTraceWriter final {
+ public:
+  HCTR_DISALLOW_COPY_AND_MOVE(KeyTraceWriter);
+
+  KeyTraceWriter() = delete;
+
+  /**
+   * @param path Output file (will be overwritten).
+   * @param key_size Size of each key in bytes.
+   * @param max_size Once the file reaches this size (in bytes), further lookups are not recorded.
+   */
+  KeyTraceWriter(const std::string& path, uint32_t key_size, size_t max_size);
+
+  ~KeyTraceWriter();
+
+  /**
+   * Appends a record. Thread-safe. The record is only buffered here and written to the file by a
+   * background thread. If the buffer is full or writing failed, the record is dropped.
+   */
+  void write(const std::string& tag, const void* keys, size_t num_keys);
+
+ private:
+  // Records are written out once this many bytes are buffered, or after `flush_interval`.
+  static constexpr size_t flush_size{1024L * 1024};
+  static constexpr std::chrono::milliseconds flush_interval{100};
+  // Records that arrive while this many bytes await being written are dropped.
+  static constexpr size_t max_pending_size{64L * 1024 * 1024};
+
+  void run_();
+
+  const std::string path_;
+  const uint32_t key_size_;
+  const size_t max_size_;
+  const std::chrono::steady_clock::time_point begin_;
+
+  std::ofstream file_;  // Only accessed by `thread_` once it was started.
+
+  std::mutex guard_;
+  std::condition_variable semaphore_;
+  std::vector<char> pending_;  // Encoded records that await being written.
+  size_t num_pending_{0};
+  size_t size_{0};  // Size of the file, including the pending records.
+  bool size_limit_reached_{false};
+  bool buffer_overflowed_{false};
+  bool terminate_{false};
+
+  std::atomic<bool> failed_{false};  // Set once writing failed. Disables tracing.
+  std::atomic<size_t> num_records_{0};
+  std::atomic<size_t> num_dropped_{0};
+
+  std::thread thread_;
+};
+
+class KeyTraceReader final {
+ public:
+  HCTR_DISALLOW_COPY_AND_MOVE(KeyTraceReader);
+
+  KeyTraceReader() = delete;
+
+  KeyTraceReader(const std::string& path);
+
+  inline uint32_t key_size() const { return key_size_; }
+
+  /**
+   * Reads the next record. Keys are widened to 64 bit.
+   *
+   * @return `false` if the end of the trace was reached.
+   */
+  bool next(std::string& tag, uint64_t& time, std::vector<int64_t>& keys);
+
+ private:
+  std::ifstream file_;
+  uint32_t key_size_;
+  std::vector<char> buffer_;
+};
+
+}  // namespace HugeCTR
@@ -24,6 +24,7 @@
 #include <boost/unordered_map.hpp>
 #include <core/macro.hpp>
 #include <hps/database_backend.hpp>
+#include <hps/value_codec.hpp>
 
 namespace HugeCTR {
 
@@ -41,6 +42,8 @@ struct MultiProcessHashMapBackendParams final : public VolatileBackendParams {
   std::chrono::nanoseconds heart_beat_frequency{std::chrono::milliseconds{
       100}};               // Frequency at which we tick up the heart-beat frequency counter.
   bool auto_remove{true};  // Remove SHM if this is the last process to detach from the SHM.
+  DatabaseValueCodec_t value_codec{
+      DatabaseValueCodec_t::None};  // Format in which values are kept in memory (see value_codec).
 };
 
 template <typename Key>
@@ -126,6 +129,8 @@ class MultiProcessHashMapBackend final
 
   struct Partition final {
     uint32_t value_size;
+    DatabaseValueCodec_t value_codec;
+    uint32_t encoded_value_size;
     size_t allocation_rate;
     size_t overflow_margin;
     DatabaseOverflowPolicy_t overflow_policy;
@@ -143,6 +148,8 @@ class MultiProcessHashMapBackend final
     Partition(const uint32_t value_size, const MultiProcessHashMapBackendParams& params,
               Segment& segment)
         : value_size{value_size},
+          value_codec{params.value_codec},
+          encoded_value_size{value_codec_encoded_size(params.value_codec, value_size)},
           allocation_rate{params.allocation_rate},
           overflow_margin{params.overflow_margin},
           overflow_policy{params.overflow_policy},
@@ -186,6 +193,10 @@ class MultiProcessHashMapBackend final
   std::thread heart_;
   bool is_process_connected_() const;
 
+  inline const SegmentAllocator<char>& char_allocator_for_(const Partition&) const {
+    return char_allocator_;
+  }
+
   // Overflow resolution.
   size_t resolve_overflow_(const std::string& table_name, size_t part_index, Partition& part);
 };
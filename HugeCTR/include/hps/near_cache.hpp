@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <parallel_hashmap/phmap.h>
+
+#include <atomic>
+#include <chrono>
+#include <core/macro.hpp>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace HugeCTR {
+
+// TODO: Remove me!
+#pragma GCC diagnostic push
+#pragma GCC diagnostic error "-Wconversion"
+
+struct NearCacheParams final {
+  size_t capacity{0};  // Memory budget for cached values of each table (in bytes). 0 = disabled.
+  size_t num_shards{64};  // Number of independently locked shards per table.
+  std::chrono::milliseconds ttl{
+      1000};  // Entries older than this are not served anymore, which bounds the staleness in
+              // case an invalidation is missed. 0 = entries never expire.
+};
+
+struct NearCacheStats final {
+  size_t num_hits{0};
+  size_t num_misses{0};
+  size_t num_expired{0};      // Misses due to entries that outlived the TTL.
+  size_t num_admitted{0};     // Values that were added to the cache.
+  size_t num_rejected{0};     // Values that lost the admission test against the eviction victim.
+  size_t num_invalidated{0};  // Entries dropped because the underlying value was changed.
+  std::chrono::nanoseconds avg_age{0};  // Mean age of the values that were served.
+  std::chrono::nanoseconds max_age{0};  // Maximum age of the values that were served.
+
+  inline double hit_rate() const {
+    const size_t num_lookups{num_hits + num_misses};
+    return num_lookups ? static_cast<double>(num_hits) / static_cast<double>(num_lookups) : 0.0;
+  }
+};
+
+/**
+ * Approximate access frequencies (count-min sketch with 4 bit counters). All counters are halved
+ * after `10 * capacity` increments, so that the estimates reflect recent popularity.
+ */
+class FrequencySketch final {
+ public:
+  FrequencySketch() = delete;
+
+  FrequencySketch(size_t capacity);
+
+  void increment(uint64_t hash);
+
+  uint32_t estimate(uint64_t hash) const;
+
+ private:
+  std::vector<uint64_t> table_;  // 16 counters per word.
+  uint64_t mask_;
+  size_t sample_size_;
+  size_t num_samples_{0};
+
+  void reset_();
+};
+
+/**
+ * Small in-process cache for remote volatile databases. Each table holds a bounded number of
+ * values. Entries are replaced using the CLOCK algorithm, but a new value is only admitted if it is
+ * accessed more frequently than the value it would replace (TinyLFU). Hence, one-off accesses don't
+ * flush hot keys.
+ *
+ * The cache is not coherent by itself. Owners must `update` or `invalidate` keys whose values
+ * changed.
+ *
+ * @tparam Key The data-type that is used for keys.
+ */
+template <typename Key>
+class NearCache final {
+ public:
+  HCTR_DISALLOW_COPY_AND_MOVE(NearCache);
+
+  NearCache() = delete;
+
+  NearCache(const NearCacheParams& params);
+
+  /**
+   * Looks up keys and copies the values of all cached keys.
+   *
+   * @param num_indices Number of keys to look up.
+   * @param indices Positions of the keys to look up (`nullptr` to look up `keys[0..num_indices)`).
+   * @param missing Receives the positions of all keys that were not served from the cache.
+   * @param generation Receives the invalidation counter of the table (see `insert`).
+   *
+   * @return Number of hits.
+   */
+  size_t fetch(const std::string& table_name, size_t num_indices, const size_t* indices,
+               const Key* keys, char* values, size_t value_stride, std::vector<size_t>& missing,
+               uint64_t& generation);
+
+  /**
+   * Offers values that were just fetched from the remote database.
+   *
+   * @param num_indices Number of values.
+   * @param indices Positions of the keys and values in `keys` and `values`.
+   * @param generation Invalidation counter returned by the `fetch` that preceded the remote
+   * lookup. If keys of the table were invalidated in the meantime, the values are discarded.
+   */
+  void insert(const std::string& table_name, size_t num_indices, const size_t* indices,
+              const Key* keys, const char* values, size_t value_stride, uint64_t generation);
+
+  /**
+   * Overwrites the values of keys that are cached, and discards any values that are being fetched
+   * concurrently. Keys that are not cached are not added.
+   */
+  void update(const std::string& table_name, size_t num_pairs, const Key* keys, const char* values,
+              uint32_t value_size, size_t value_stride);
+
+  void invalidate(const std::string& table_name, size_t num_keys, const Key* keys);
+
+  void invalidate(const std::string& table_name);
+
+  NearCacheStats stats() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Shard final {
+    std::mutex guard;
+    phmap::flat_hash_map<Key, uint32_t> index;  // Key -> slot.
+    std::vector<Key> keys;
+    std::vector<int64_t> stamps;  // Time of insertion (nanoseconds since the epoch of `Clock`).
+    std::vector<bool> referenced;
+    std::vector<char> values;
+    size_t hand{0};
+    FrequencySketch sketch;
+
+    Shard(size_t capacity, size_t value_stride);
+  };
+
+  struct Table final {
+    const size_t value_stride;
+    std::atomic<uint64_t> generation{0};  // Incremented by every invalidation.
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    Table(size_t value_stride) : value_stride{value_stride} {}
+  };
+
+  const NearCacheParams params_;
+
+  mutable std::shared_mutex tables_guard_;
+  std::unordered_map<std::string, std::unique_ptr<Table>> tables_;
+
+  std::atomic<size_t> num_hits_{0};
+  std::atomic<size_t> num_misses_{0};
+  std::atomic<size_t> num_expired_{0};
+  std::atomic<size_t> num_admitted_{0};
+  std::atomic<size_t> num_rejected_{0};
+  std::atomic<size_t> num_invalidated_{0};
+  std::atomic<int64_t> total_age_{0};
+  std::atomic<int64_t> max_age_{0};
+
+  Table* get_table_(const std::string& table_name) const;
+
+  Table* get_or_create_table_(const std::string& table_name, size_t value_stride);
+};
+
+// TODO: Remove me!
+#pragma GCC diagnostic pop
+
+}  // namespace HugeCTR
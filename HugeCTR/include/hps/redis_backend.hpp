@@ -17,8 +17,20 @@
 
 #include <sw/redis++/redis++.h>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <hps/database_backend.hpp>
+#include <hps/near_cache.hpp>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace HugeCTR {
 
@@ -44,6 +56,36 @@ struct RedisClusterBackendParams final : public VolatileBackendParams {
   std::string client_key{"client_key.pem"};           // Private key to use for this client.
   std::string server_name_identification{
       "redis.localhost"};  // SNI to request (can deviate from connection address).
+
+  size_t num_slots_per_partition{1};  // Each partition is spread across this many hash tags (and
+                                      // hence Redis cluster slots), so that a partition can be
+                                      // served by multiple nodes. Like `num_partitions`, this must
+                                      // not be changed after writing the first data to a table.
+
+  size_t num_refresh_workers{4};  // Number of background queues/workers that refresh LRU/LFU
+                                  // metadata. Partitions are assigned to queues round-robin.
+  std::chrono::milliseconds refresh_window{
+      10};  // Refreshes of the same key within this time window are coalesced into one update.
+  size_t max_pending_refreshes{1024L *
+                               1024};  // Maximum number of keys waiting in each refresh queue.
+                                       // While a queue is full, further refreshes are dropped
+                                       // (i.e., metadata is updated for a sample of accesses).
+
+  NearCacheParams near_cache;  // In-process cache for hot values (disabled by default).
+};
+
+/**
+ * Statistics of the background metadata refresh queues of a `RedisClusterBackend`.
+ */
+struct RedisRefreshStats final {
+  size_t queue_depth{0};      // Number of keys currently awaiting a refresh (all queues).
+  size_t max_queue_depth{0};  // Highest number of keys awaiting a refresh in any queue so far.
+  size_t num_queued{0};       // Number of refreshes accepted so far.
+  size_t num_coalesced{0};    // Number of refreshes merged with a pending refresh of the same key.
+  size_t num_dropped{0};      // Number of refreshes dropped because a queue was full.
+  size_t num_flushed{0};      // Number of keys whose metadata was written to Redis.
+  std::chrono::nanoseconds avg_lag{0};  // Mean time from queuing to applying a refresh.
+  std::chrono::nanoseconds max_lag{0};  // Maximum time from queuing to applying a refresh.
 };
 
 #ifdef HCTR_USE_REDIS
@@ -103,11 +145,78 @@ class RedisClusterBackend final : public VolatileBackend<Key, RedisClusterBacken
 
   size_t dump_bin(const std::string& table_name, std::ofstream& file) override;
 
+  RedisRefreshStats refresh_stats() const;
+
+  NearCacheStats near_cache_stats() const;
+
+  /**
+   * Applies changes that were made to the table by other processes to the near cache (if enabled).
+   * Updates and evictions performed by this backend are applied automatically.
+   *
+   * @param values The new values (`nullptr` if the keys were evicted).
+   */
+  void update_near_cache(const std::string& table_name, size_t num_pairs, const Key* keys,
+                         const char* values, uint32_t value_size, size_t value_stride);
+
 #ifdef HCTR_USE_ROCKS_DB
   size_t dump_sst(const std::string& table_name, rocksdb::SstFileWriter& file) override;
 #endif  // HCTR_USE_ROCKS_DB
 
  protected:
+  /**
+   * Name of the Redis hash that holds the values (`suffix = 'v'`) or metadata (`suffix = 't'`) of a
+   * storage partition.
+   *
+   * Storage partitions are the slots of all partitions (i.e., `num_partitions *
+   * num_slots_per_partition` hashes). Slot `part_index` belongs to partition `part_index %
+   * num_partitions`. With 1 slot per partition, the layout is identical to the unsliced layout.
+   */
+  std::string make_hkey_(const std::string& table_name, size_t part_index, char suffix) const;
+
+  size_t slot_of_(const Key& key) const;
+
+  /**
+   * Groups the keys by storage partition (counting sort). Afterwards, the positions of the keys
+   * that belong to storage partition `s` are `slot_indices[slot_offsets[s]]` to
+   * `slot_indices[slot_offsets[s + 1] - 1]`.
+   */
+  void group_by_slot_(size_t num_keys, const Key* keys, std::vector<size_t>& slot_offsets,
+                      std::vector<size_t>& slot_indices) const;
+
+  void group_by_slot_(size_t num_indices, const size_t* indices, const Key* keys,
+                      std::vector<size_t>& slot_offsets, std::vector<size_t>& slot_indices) const;
+
+  /**
+   * Fetches grouped keys from all storage partitions concurrently. The `HMGET` batches of each
+   * storage partition are sent as one pipeline.
+   *
+   * @return The number of misses.
+   */
+  size_t fetch_slots_(const std::string& table_name, const std::vector<size_t>& slot_offsets,
+                      const std::vector<size_t>& slot_indices, const Key* keys, char* values,
+                      size_t value_stride, const DatabaseMissCallback& on_miss,
+                      const std::chrono::high_resolution_clock::time_point& begin,
+                      const std::chrono::nanoseconds& time_budget, size_t& skip_count);
+
+  /**
+   * Fetches the values from Redis (i.e., bypasses the near cache).
+   */
+  size_t fetch_remote_(const std::string& table_name, size_t num_indices, const size_t* indices,
+                       const Key* keys, char* values, size_t value_stride,
+                       const DatabaseMissCallback& on_miss,
+                       const std::chrono::nanoseconds& time_budget);
+
+  /**
+   * Serves the keys from the near cache where possible, and fetches the remaining values from
+   * Redis. Values found in Redis are offered to the near cache.
+   *
+   * @param indices Positions of the keys to look up (`nullptr` to look up all `num_indices` keys).
+   */
+  size_t fetch_cached_(const std::string& table_name, size_t num_indices, const size_t* indices,
+                       const Key* keys, char* values, size_t value_stride,
+                       const DatabaseMissCallback& on_miss,
+                       const std::chrono::nanoseconds& time_budget);
+
   /**
    * Called internally during `insert` if insertion causes an overflow situation.
    */
@@ -118,11 +227,11 @@ class RedisClusterBackend final : public VolatileBackend<Key, RedisClusterBacken
    *
    * @param table_name Name of the affected table.
    * @param part_index Index of the part that is affected.
-   * @param keys The keys which need a refresh.
-   * @param amount Relative amount to add to LFU counters.
+   * @param keys_amounts The keys which need a refresh, and the relative amounts to add to their LFU
+   * counters.
    */
   void refresh_metadata_lfu_inc_(const std::string& table_name, size_t part_index,
-                                 const std::vector<Key>& keys, long long amount);
+                                 const std::vector<std::pair<Key, long long>>& keys_amounts);
   /**
    * Called asynchronously by the `background_worker_` to refresh the metadata of certain entries.
    *
@@ -140,19 +249,70 @@ class RedisClusterBackend final : public VolatileBackend<Key, RedisClusterBacken
    * @param table_name Name of the affected table.
    * @param part_index Index of the part that is affected.
    * @param keys The keys which need a refresh.
-   * @param time Unix timestamp value to fill in.
+   * @param times Unix timestamp value to fill in for each key.
    */
   void refresh_metadata_lru_(const std::string& table_name, size_t part_index,
-                             const std::vector<Key>& keys, time_t time);
+                             const std::vector<Key>& keys, const std::vector<time_t>& times);
 
   void queue_metadata_refresh_(const std::string& table_name, size_t part_index,
                                std::shared_ptr<std::vector<Key>>&& keys);
 
+  /**
+   * Called by the `background_worker_` to apply all refreshes that are pending in a queue.
+   */
+  void flush_refresh_queue_(size_t queue_index);
+
+  /**
+   * Body of the `refresh_timer_` thread. Hands queues over to the `background_worker_` once their
+   * refresh window has passed.
+   */
+  void run_refresh_timer_();
+
+  /**
+   * Refreshes that are waiting to be applied. Each partition is served by one queue, and each queue
+   * is flushed by at most one worker at a time.
+   */
+  struct RefreshQueue final {
+    std::mutex guard;
+    // (table_name, part_index) -> key -> LFU increment (`EvictLeastUsed`) or timestamp
+    // (`EvictOldest`).
+    std::map<std::pair<std::string, size_t>, std::unordered_map<Key, long long>> pending;
+    size_t num_pending{0};
+    bool scheduled{false};
+    std::chrono::steady_clock::time_point first_queued;
+
+    std::atomic<size_t> max_depth{0};
+    std::atomic<size_t> num_queued{0};
+    std::atomic<size_t> num_coalesced{0};
+    std::atomic<size_t> num_dropped{0};
+    std::atomic<size_t> num_flushed{0};
+    std::atomic<size_t> num_flushes{0};
+    std::atomic<int64_t> total_lag{0};
+    std::atomic<int64_t> max_lag{0};
+  };
+
  protected:
+  const size_t num_slots_;
+  const size_t slot_overflow_margin_;
+  const size_t slot_overflow_resolution_margin_;
+
   std::unique_ptr<sw::redis::RedisCluster> redis_;
 
-  // Worker used to update timestamps and carry out overflow handling.
-  mutable ThreadPool background_worker_{"redis bg worker", 1};
+  std::unique_ptr<NearCache<Key>> near_cache_;  // `nullptr` if disabled.
+
+  std::vector<std::unique_ptr<RefreshQueue>> refresh_queues_;
+
+  // Workers used to update timestamps and carry out overflow handling.
+  mutable ThreadPool background_worker_;
+
+  // (deadline, queue_index) of the queues that wait for their refresh window to pass.
+  using RefreshDeadline = std::pair<std::chrono::steady_clock::time_point, size_t>;
+  std::priority_queue<RefreshDeadline, std::vector<RefreshDeadline>, std::greater<RefreshDeadline>>
+      refresh_deadlines_;
+  std::mutex refresh_timer_guard_;
+  std::condition_variable refresh_timer_semaphore_;
+  bool refresh_timer_terminate_{false};
+  std::thread refresh_timer_;
 };
 
 #endif  // HCTR_USE_REDIS
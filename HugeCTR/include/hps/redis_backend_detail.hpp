@@ -211,7 +211,8 @@ class RedisDirectValueInserter final
                                   char* const values, const size_t value_stride,
                                   const std::function<void(size_t)>& on_miss, size_t& miss_count,
                                   const DatabaseOverflowPolicy_t overflow_policy,
-                                  std::shared_ptr<std::vector<Key>>& touched_keys)
+                                  std::shared_ptr<std::vector<Key>>& touched_keys,
+                                  const size_t first_index = 0)
       : keys{keys},
         k_views{&k_views},
         values{values},
@@ -219,7 +220,8 @@ class RedisDirectValueInserter final
         on_miss{&on_miss},
         miss_count(&miss_count),
         overflow_policy{overflow_policy},
-        touched_keys{&touched_keys} {}
+        touched_keys{&touched_keys},
+        index{first_index} {}
 
   inline RedisDirectValueInserter& operator=(sw::redis::Optional<sw::redis::StringView>&& v_view) {
     const Key* const k{reinterpret_cast<const Key*>(k_views->at(index++).data())};
@@ -254,7 +256,7 @@ class RedisDirectValueInserter final
   size_t* const miss_count;
   const DatabaseOverflowPolicy_t overflow_policy;
   std::shared_ptr<std::vector<Key>>* touched_keys;
-  size_t index{0};
+  size_t index;
 };
 
 /**
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <hps/inference_utils.hpp>
+
+namespace HugeCTR {
+
+/**
+ * Compact storage formats for the fp32 embedding vectors that are kept in CPU memory by the
+ * volatile database backends. Values are encoded once upon insertion, and decoded back into fp32
+ * upon every lookup.
+ *
+ * Layouts for a value with `n = value_size / sizeof(float)` elements:
+ *
+ * - `None`: The original `value_size` bytes.
+ * - `FP16`/`BF16`: `n` 16 bit floats.
+ * - `Int8`: A `float` scale, followed by `n` signed bytes, such that `x[i] ~= scale * q[i]`.
+ */
+
+/**
+ * @param codec The codec.
+ * @param value_size Size of the unencoded value in bytes.
+ *
+ * @return Number of bytes required to store the encoded value.
+ */
+uint32_t value_codec_encoded_size(DatabaseValueCodec_t codec, uint32_t value_size);
+
+/**
+ * Encodes a value.
+ *
+ * @param codec The codec.
+ * @param src The unencoded value (`value_size` bytes).
+ * @param value_size Size of the unencoded value in bytes.
+ * @param dst Output buffer (`value_codec_encoded_size(codec, value_size)` bytes).
+ */
+void value_codec_encode(DatabaseValueCodec_t codec, const char* src, uint32_t value_size,
+                        char* dst);
+
+/**
+ * Decodes a value.
+ *
+ * @param codec The codec.
+ * @param src The encoded value (`value_codec_encoded_size(codec, value_size)` bytes).
+ * @param value_size Size of the unencoded value in bytes.
+ * @param dst Output buffer (`value_size` bytes).
+ */
+void value_codec_decode(DatabaseValueCodec_t codec, const char* src, uint32_t value_size,
+                        char* dst);
+
+}  // namespace HugeCTR
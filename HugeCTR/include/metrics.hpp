@@ -41,6 +41,10 @@ using Core23MultiLossMetricMap = std::map<std::string, Core23RawMetricMap>;
 void get_raw_metric_as_host_float_tensor(Core23RawMetricMap metric_map, RawType raw_type,
                                          bool mixed_precision, float* rst, size_t num);
 
+// Samples of the device with `global_device_id` that are not padding in a batch of
+// `current_batch_size` samples, split into chunks of `batch_per_gpu` samples.
+int get_num_valid_samples(int global_device_id, int current_batch_size, int batch_per_gpu);
+
 class Metric {
  public:
   static std::unique_ptr<Metric> Create(const Type type, bool use_mixed_precision,
@@ -57,6 +57,7 @@ void CommonPybind(pybind11::module& m) {
   pybind11::enum_<HugeCTR::Check_t>(m, "Check_t")
       .value("Sum", HugeCTR::Check_t::Sum)
       .value("Non", HugeCTR::Check_t::None)
+      .value("CRC32C", HugeCTR::Check_t::CRC32C)
       .export_values();
   pybind11::enum_<HugeCTR::DataReaderType_t>(m, "DataReaderType_t")
       .value("Norm", HugeCTR::DataReaderType_t::Norm)
@@ -20,6 +20,8 @@
 #include <pybind11/stl.h>
 
 #include <embeddings/embedding_collection.hpp>
+#include <embeddings/shard_planner.hpp>
+#include <sstream>
 
 namespace HugeCTR {
 
@@ -64,6 +66,64 @@ void EmbeddingCollectionPybind(pybind11::module &m) {
            pybind11::arg("shard_strategy"),
            pybind11::arg("compression_strategy") =
                EmbeddingCollectionConfig::CompressionStrategyConfig());
+  pybind11::class_<HugeCTR::EmbeddingTableStats, std::shared_ptr<HugeCTR::EmbeddingTableStats>>(
+      m, "EmbeddingTableStats")
+      .def_readonly("name", &HugeCTR::EmbeddingTableStats::name)
+      .def_readonly("num_samples", &HugeCTR::EmbeddingTableStats::num_samples)
+      .def_readonly("num_keys", &HugeCTR::EmbeddingTableStats::num_keys)
+      .def_readonly("num_unique_keys", &HugeCTR::EmbeddingTableStats::num_unique_keys)
+      .def("avg_hotness", &HugeCTR::EmbeddingTableStats::avg_hotness)
+      .def("expected_unique_keys", &HugeCTR::EmbeddingTableStats::expected_unique_keys,
+           pybind11::arg("num_draws"))
+      .def("__repr__", [](const HugeCTR::EmbeddingTableStats &s) {
+        std::ostringstream os;
+        os << s;
+        return os.str();
+      });
+  pybind11::class_<HugeCTR::EmbeddingTableStatsCollector,
+                   std::shared_ptr<HugeCTR::EmbeddingTableStatsCollector>>(
+      m, "EmbeddingTableStatsCollector")
+      .def(pybind11::init<>())
+      .def(
+          "add",
+          [](HugeCTR::EmbeddingTableStatsCollector &self, const std::string &table_name,
+             pybind11::array_t<int64_t, pybind11::array::c_style | pybind11::array::forcecast>
+                 keys,
+             int64_t num_samples) {
+            self.add(table_name, keys.data(), static_cast<size_t>(keys.size()), num_samples);
+          },
+          pybind11::arg("table_name"), pybind11::arg("keys"), pybind11::arg("num_samples"))
+      .def("stats", &HugeCTR::EmbeddingTableStatsCollector::stats);
+  pybind11::class_<HugeCTR::ShardPlannerParams, std::shared_ptr<HugeCTR::ShardPlannerParams>>(
+      m, "ShardPlannerParams")
+      .def(pybind11::init<>())
+      .def_readwrite("num_gpus", &HugeCTR::ShardPlannerParams::num_gpus)
+      .def_readwrite("global_batch_size", &HugeCTR::ShardPlannerParams::global_batch_size)
+      .def_readwrite("gpu_memory_budget", &HugeCTR::ShardPlannerParams::gpu_memory_budget)
+      .def_readwrite("dp_memory_fraction", &HugeCTR::ShardPlannerParams::dp_memory_fraction)
+      .def_readwrite("emb_type_size", &HugeCTR::ShardPlannerParams::emb_type_size)
+      .def_readwrite("key_type_size", &HugeCTR::ShardPlannerParams::key_type_size)
+      .def_readwrite("default_optimizer", &HugeCTR::ShardPlannerParams::default_optimizer)
+      .def_readwrite("memory_bandwidth", &HugeCTR::ShardPlannerParams::memory_bandwidth)
+      .def_readwrite("network_bandwidth", &HugeCTR::ShardPlannerParams::network_bandwidth)
+      .def_readwrite("allreduce_bandwidth", &HugeCTR::ShardPlannerParams::allreduce_bandwidth)
+      .def_readwrite("min_column_width", &HugeCTR::ShardPlannerParams::min_column_width)
+      .def_readwrite("imbalance_tolerance", &HugeCTR::ShardPlannerParams::imbalance_tolerance)
+      .def_readwrite("max_refinement_steps", &HugeCTR::ShardPlannerParams::max_refinement_steps);
+  pybind11::class_<HugeCTR::ShardPlan, std::shared_ptr<HugeCTR::ShardPlan>>(m, "ShardPlan")
+      .def_readonly("shard_matrix", &HugeCTR::ShardPlan::shard_matrix)
+      .def_readonly("shard_strategy", &HugeCTR::ShardPlan::shard_strategy)
+      .def_readonly("memory_per_gpu", &HugeCTR::ShardPlan::memory_per_gpu)
+      .def_readonly("lookup_time_per_gpu", &HugeCTR::ShardPlan::lookup_time_per_gpu)
+      .def_readonly("comm_time_per_gpu", &HugeCTR::ShardPlan::comm_time_per_gpu)
+      .def("estimated_iteration_time", &HugeCTR::ShardPlan::estimated_iteration_time)
+      .def("__repr__", [](const HugeCTR::ShardPlan &p) {
+        std::ostringstream os;
+        os << p;
+        return os.str();
+      });
+  m.def("plan_embedding_shards", &HugeCTR::plan_embedding_shards, pybind11::arg("config"),
+        pybind11::arg("stats"), pybind11::arg("params"));
 }
 
 }  // namespace python_lib
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <metrics.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace HugeCTR {
+
+namespace metrics {
+
+/**
+ * Host-side counterparts of the metrics above for evaluating large prediction logs. Instead of
+ * keeping every sample, each metric folds the samples into a sketch of fixed size that can be
+ * merged with other sketches of the same kind. This keeps memory independent of the number of
+ * samples and avoids the need for GPUs.
+ */
+struct StreamingMetricParams {
+  // Number of accumulators. `local_reduce(i, ...)` may be called concurrently for distinct `i`.
+  size_t num_workers = 1;
+
+  // Global id of worker 0 of this process, for trimming padded batches (see StreamingMetric).
+  size_t first_global_worker = 0;
+
+  // AUC: predictions are clamped to [pred_min, pred_max] and counted in auc_num_bins equal bins.
+  float pred_min = 0.0f;
+  float pred_max = 1.0f;
+  size_t auc_num_bins = 1000000;
+
+  // HitRate: a sample with a prediction above hit_threshold is a hit if its label is 1.
+  float hit_threshold = 0.8f;
+
+  // NDCG@k of the whole evaluation set ranked by prediction.
+  size_t ndcg_k = 10;
+};
+
+/**
+ * Weights of positive and negative samples per prediction bin. Pairs in different bins are
+ * ranked exactly; pairs in the same bin count as ties (1/2), so the AUC is off by at most
+ * `error_bound()`.
+ */
+class BinnedAUCSketch {
+ public:
+  BinnedAUCSketch(size_t num_bins, float pred_min, float pred_max);
+
+  void add(const float* preds, const float* labels, size_t num_samples);
+  void merge(const BinnedAUCSketch& other);
+  void reset();
+
+  double value() const;
+  double error_bound() const;
+
+  // Bins of positives followed by bins of negatives, e.g. for an MPI reduction.
+  std::vector<double>& weights() { return weights_; }
+
+ private:
+  const float pred_min_;
+  const double bins_per_unit_;
+  const size_t num_bins_;
+  std::vector<double> weights_;
+};
+
+// Mean of the binary cross-entropy of the predictions.
+class LogLossSketch {
+ public:
+  void add(const float* preds, const float* labels, size_t num_samples);
+  void merge(const LogLossSketch& other);
+  void reset();
+
+  double value() const;
+
+  std::vector<double>& weights() { return weights_; }
+
+ private:
+  std::vector<double> weights_ = {0.0, 0.0};  // Sum of the losses, number of samples.
+};
+
+// Same definition as HitRate: hits / predictions above the threshold.
+class HitRateSketch {
+ public:
+  explicit HitRateSketch(float threshold) : threshold_(threshold) {}
+
+  void add(const float* preds, const float* labels, size_t num_samples);
+  void merge(const HitRateSketch& other);
+  void reset();
+
+  double value() const;
+
+  std::vector<double>& weights() { return weights_; }
+
+ private:
+  const float threshold_;
+  std::vector<double> weights_ = {0.0, 0.0};  // Hits, samples above the threshold.
+};
+
+/**
+ * The k samples with the highest predictions and the k highest labels, enough to compute
+ * DCG@k / ideal DCG@k exactly. Ties in the prediction are broken by the lower label first.
+ */
+class TopKSketch {
+ public:
+  explicit TopKSketch(size_t k);
+
+  void add(const float* preds, const float* labels, size_t num_samples);
+  void merge(const TopKSketch& other);
+  void merge(const std::vector<std::pair<float, float>>& top_preds,
+             const std::vector<float>& top_labels);
+  void reset();
+
+  double value() const;
+
+  size_t k() const { return k_; }
+  // (pred, label) min-heap on pred and min-heap of labels, each with at most k entries.
+  const std::vector<std::pair<float, float>>& top_preds() const { return top_preds_; }
+  const std::vector<float>& top_labels() const { return top_labels_; }
+
+ private:
+  void offer(const std::pair<float, float>& sample);
+  void offer_label(float label);
+
+  const size_t k_;
+  std::vector<std::pair<float, float>> top_preds_;
+  std::vector<float> top_labels_;
+};
+
+/**
+ * A `Metric` with one `Sketch` per worker. `local_reduce` folds the Pred and Label tensors of a
+ * batch into the sketch of the worker; the tensors may live on any device and predictions may
+ * be half precision. `finalize_metric` merges the sketches (and those of the other MPI ranks),
+ * returns the metric and starts over.
+ *
+ * Like the GPU metrics, once `set_current_batch_size` was called, the tensors of worker `i` are
+ * taken as the slice of global worker `first_global_worker + i` of a batch that is padded to the
+ * tensor size on every worker, and only the valid samples of that slice are counted.
+ */
+template <typename Sketch>
+class StreamingMetric : public Metric {
+ public:
+  StreamingMetric(const std::string& name, size_t num_workers, const Sketch& prototype,
+                  size_t first_global_worker = 0);
+  ~StreamingMetric() override = default;
+
+  void local_reduce(int worker_id, Core23RawMetricMap raw_metrics) override;
+  void global_reduce(int n_nets) override {}
+  float finalize_metric() override;
+  std::string name() const override { return name_; }
+
+  // The merged sketch of the last `finalize_metric`.
+  const Sketch& result() const { return result_; }
+
+ private:
+  struct Worker {
+    explicit Worker(const Sketch& prototype) : sketch(prototype) {}
+    Sketch sketch;
+    std::vector<float> preds;  // Host copies of non-float or device tensors.
+    std::vector<float> labels;
+  };
+
+  const std::string name_;
+  const size_t first_global_worker_;
+  std::vector<Worker> workers_;
+  Sketch result_;
+};
+
+/**
+ * Creates a streaming AUC, AverageLoss, HitRate or NDCG metric. AverageLoss is the log loss of
+ * the predictions, which matches the training loss of binary classifiers.
+ */
+std::unique_ptr<Metric> create_streaming_metric(Type type, const StreamingMetricParams& params);
+
+}  // namespace metrics
+
+}  // namespace HugeCTR
@@ -19,16 +19,25 @@
 #include <condition_variable>
 #include <core/macro.hpp>
 #include <deque>
+#include <exception>
 #include <functional>
 #include <future>
 #include <memory>
+#include <mutex>
 #include <shared_mutex>
 #include <string>
 #include <thread>
+#include <type_traits>
 #include <vector>
 
 namespace HugeCTR {
 
+enum class ThreadPoolAffinity_t {
+  None,      // Let the OS scheduler decide.
+  Core,      // Pin worker `i` to the `i`-th CPU core that is available to this process.
+  NumaNode,  // Pin worker `i` to the `i % num_nodes`-th NUMA node with CPU cores we may run on.
+};
+
 class ThreadPool final {
  public:
   HCTR_DISALLOW_COPY_AND_MOVE(ThreadPool);
@@ -37,6 +46,15 @@ class ThreadPool final {
 
   ThreadPool(const std::string& name, size_t num_workers);
 
+  ThreadPool(const std::string& name, size_t num_workers, ThreadPoolAffinity_t affinity);
+
+  /**
+   * With `ThreadPoolAffinity_t::NumaNode`, a non-negative `numa_node` pins all workers to the CPU
+   * cores of that NUMA node (instead of distributing them across all nodes).
+   */
+  ThreadPool(const std::string& name, size_t num_workers, ThreadPoolAffinity_t affinity,
+             int numa_node);
+
   virtual ~ThreadPool();
 
   inline const std::string& name() const { return name_; }
@@ -49,6 +67,22 @@ class ThreadPool final {
 
   std::future<void> submit(std::function<void()> task);
 
+  /**
+   * Fork-join execution of `fn(i)` for every `i` in `[0, n)`. The calling thread participates in
+   * the work and returns once all invocations have completed. Unlike `submit`, this neither
+   * allocates task packages nor creates futures. The first exception thrown by `fn` is rethrown.
+   *
+   * @param n Number of iterations.
+   * @param fn Callable with signature `void(size_t)`.
+   */
+  template <typename Function>
+  inline void parallel_for(const size_t n, Function&& fn) {
+    using F = std::remove_reference_t<Function>;
+    parallel_for_(
+        n, [](void* const ctx, const size_t i) { (*static_cast<F*>(ctx))(i); },
+        const_cast<void*>(static_cast<const void*>(&fn)));
+  }
+
   static ThreadPool& get();
 
   template <typename Iterator>
@@ -59,20 +93,64 @@ class ThreadPool final {
   }
 
  private:
+  // Type-erased unit of work. `drop` is invoked instead of `run` if the pool terminates first.
+  struct Task final {
+    void (*run)(void*);
+    void (*drop)(void*);
+    void* arg;
+  };
+
+  // Each worker owns a queue. Idle workers steal from the queues of other workers.
+  struct alignas(64) WorkQueue final {
+    std::mutex guard;
+    std::deque<Task> tasks;
+  };
+
+  // State of a `parallel_for` invocation. Lives on the stack of the calling thread.
+  struct BulkJob final {
+    void (*fn)(void*, size_t);
+    void* ctx;
+    size_t n;
+
+    alignas(64) std::atomic<size_t> next{0};
+    alignas(64) std::atomic<size_t> num_pending_helpers{0};
+
+    std::atomic_flag has_error = ATOMIC_FLAG_INIT;
+    std::exception_ptr error;
+
+    std::mutex guard;
+    std::condition_variable done;  // Triggered by the last helper to finish.
+
+    void run();
+
+    void finish_helper();
+  };
+
   const std::string name_;
+  const ThreadPoolAffinity_t affinity_;
+  const int numa_node_;
   std::vector<std::thread> workers_;
+  std::vector<std::unique_ptr<WorkQueue>> queues_;
 
   mutable std::mutex barrier_;  // Must be obtained to ensure exclusive access.
   mutable std::condition_variable
       submit_sempahore_;  // Triggered on submission. Workers wait for this.
   mutable std::condition_variable idle_semaphore_;  // Trigger
 
-  bool terminate_ = false;  // Used to signal to the workers that termination is imminent.
-  size_t num_idle_workers_ = 0;
-  std::deque<std::packaged_task<void()>>
-      packages_;  // Work packages that have not been processed yet.
+  std::atomic<bool> terminate_{false};  // Signals the workers that termination is imminent.
+  std::atomic<size_t> num_idle_workers_{0};
+  std::atomic<size_t> num_queued_tasks_{0};  // Work packages that have not been processed yet.
+  std::atomic<size_t> next_queue_{0};        // Round-robin placement of external submissions.
+
+  void parallel_for_(size_t n, void (*fn)(void*, size_t), void* ctx);
+
+  void push_(const Task& task);
+
+  bool pop_(size_t queue_index, Task& task);
+
+  void pin_worker_(size_t thread_index) const;
 
   void run_(const size_t thread_index);
 };
 
-}  // namespace HugeCTR
\ No newline at end of file
+}  // namespace HugeCTR
@@ -87,6 +87,33 @@ DataGenerator::DataGenerator(const DataGeneratorParams& data_generator_params)
   }
 }
 
+namespace {
+
+template <Check_t CK_T>
+void generate_norm_dataset(const DataGeneratorParams& params, const std::string& train_data_folder,
+                           const std::string& eval_data_folder, bool use_long_tail, float alpha) {
+  auto generate = [&](auto key) {
+    using T = decltype(key);
+    data_generation_for_test2<T, CK_T>(params.source, train_data_folder + "/train/gen_",
+                                       params.num_files, params.num_samples_per_file,
+                                       params.num_slot, params.slot_size_array, params.label_dim,
+                                       params.dense_dim, params.nnz_array, params.num_threads,
+                                       use_long_tail, alpha);
+    data_generation_for_test2<T, CK_T>(params.eval_source, eval_data_folder + "/val/gen_",
+                                       params.eval_num_files, params.num_samples_per_file,
+                                       params.num_slot, params.slot_size_array, params.label_dim,
+                                       params.dense_dim, params.nnz_array, params.num_threads,
+                                       use_long_tail, alpha);
+  };
+  if (params.i64_input_key) {
+    generate(static_cast<long long>(0));
+  } else {
+    generate(static_cast<unsigned int>(0));
+  }
+}
+
+}  // namespace
+
 void DataGenerator::generate() {
   bool use_long_tail = (data_generator_params_.dist_type == Distribution_t::PowerLaw);
   float alpha = 0.0;
@@ -132,69 +159,25 @@ void DataGenerator::generate() {
                               << ", alpha of power law: " << alpha << std::endl;
       check_make_dir(train_data_folder);
       check_make_dir(eval_data_folder);
-      if (data_generator_params_.check_type == Check_t::Sum) {
-        if (data_generator_params_.i64_input_key) {
-          data_generation_for_test2<long long, Check_t::Sum>(
-              data_generator_params_.source, train_data_folder + "/train/gen_",
-              data_generator_params_.num_files, data_generator_params_.num_samples_per_file,
-              data_generator_params_.num_slot, data_generator_params_.slot_size_array,
-              data_generator_params_.label_dim, data_generator_params_.dense_dim,
-              data_generator_params_.nnz_array, data_generator_params_.num_threads, use_long_tail,
-              alpha);
-          data_generation_for_test2<long long, Check_t::Sum>(
-              data_generator_params_.eval_source, eval_data_folder + "/val/gen_",
-              data_generator_params_.eval_num_files, data_generator_params_.num_samples_per_file,
-              data_generator_params_.num_slot, data_generator_params_.slot_size_array,
-              data_generator_params_.label_dim, data_generator_params_.dense_dim,
-              data_generator_params_.nnz_array, data_generator_params_.num_threads, use_long_tail,
-              alpha);
-        } else {
-          data_generation_for_test2<unsigned int, Check_t::Sum>(
-              data_generator_params_.source, train_data_folder + "/train/gen_",
-              data_generator_params_.num_files, data_generator_params_.num_samples_per_file,
-              data_generator_params_.num_slot, data_generator_params_.slot_size_array,
-              data_generator_params_.label_dim, data_generator_params_.dense_dim,
-              data_generator_params_.nnz_array, data_generator_params_.num_threads, use_long_tail,
-              alpha);
-          data_generation_for_test2<unsigned int, Check_t::Sum>(
-              data_generator_params_.eval_source, eval_data_folder + "/val/gen_",
-              data_generator_params_.eval_num_files, data_generator_params_.num_samples_per_file,
-              data_generator_params_.num_slot, data_generator_params_.slot_size_array,
-              data_generator_params_.label_dim, data_generator_params_.dense_dim,
-              data_generator_params_.nnz_array, data_generator_params_.num_threads, use_long_tail,
-              alpha);
+      switch (data_generator_params_.check_type) {
+        case Check_t::Sum: {
+          generate_norm_dataset<Check_t::Sum>(data_generator_params_, train_data_folder,
+                                              eval_data_folder, use_long_tail, alpha);
+          break;
         }
-      } else {
-        if (data_generator_params_.i64_input_key) {
-          data_generation_for_test2<long long, Check_t::None>(
-              data_generator_params_.source, train_data_folder + "/train/gen_",
-              data_generator_params_.num_files, data_generator_params_.num_samples_per_file,
-              data_generator_params_.num_slot, data_generator_params_.slot_size_array,
-              data_generator_params_.label_dim, data_generator_params_.dense_dim,
-              data_generator_params_.nnz_array, data_generator_params_.num_threads, use_long_tail,
-              alpha);
-          data_generation_for_test2<long long, Check_t::None>(
-              data_generator_params_.eval_source, eval_data_folder + "/val/gen_",
-              data_generator_params_.eval_num_files, data_generator_params_.num_samples_per_file,
-              data_generator_params_.num_slot, data_generator_params_.slot_size_array,
-              data_generator_params_.label_dim, data_generator_params_.dense_dim,
-              data_generator_params_.nnz_array, data_generator_params_.num_threads, use_long_tail,
-              alpha);
-        } else {
-          data_generation_for_test2<unsigned int, Check_t::None>(
-              data_generator_params_.source, train_data_folder + "/train/gen_",
-              data_generator_params_.num_files, data_generator_params_.num_samples_per_file,
-              data_generator_params_.num_slot, data_generator_params_.slot_size_array,
-              data_generator_params_.label_dim, data_generator_params_.dense_dim,
-              data_generator_params_.nnz_array, data_generator_params_.num_threads, use_long_tail,
-              alpha);
-          data_generation_for_test2<unsigned int, Check_t::None>(
-              data_generator_params_.eval_source, eval_data_folder + "/val/gen_",
-              data_generator_params_.eval_num_files, data_generator_params_.num_samples_per_file,
-              data_generator_params_.num_slot, data_generator_params_.slot_size_array,
-              data_generator_params_.label_dim, data_generator_params_.dense_dim,
-              data_generator_params_.nnz_array, data_generator_params_.num_threads, use_long_tail,
-              alpha);
+        case Check_t::CRC32C: {
+          generate_norm_dataset<Check_t::CRC32C>(data_generator_params_, train_data_folder,
+                                                 eval_data_folder, use_long_tail, alpha);
+          break;
+        }
+        case Check_t::None: {
+          generate_norm_dataset<Check_t::None>(data_generator_params_, train_data_folder,
+                                               eval_data_folder, use_long_tail, alpha);
+          break;
+        }
+        default: {
+          assert(!"Error: no such option && should never get here!");
+          break;
         }
       }
       break;
@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <data_readers/buffered_file_source.hpp>
+
+namespace HugeCTR {
+
+namespace {
+
+constexpr size_t IO_ALIGNMENT = 4096;
+
+}  // namespace
+
+BufferedFileSource::BufferedFileSource(long long offset, long long stride,
+                                       const std::string& file_list, bool repeat,
+                                       size_t block_size, size_t num_blocks)
+    : file_list_(file_list),
+      offset_(offset),
+      stride_(stride),
+      repeat_(repeat),
+      block_size_((std::max(block_size, IO_ALIGNMENT) + IO_ALIGNMENT - 1) / IO_ALIGNMENT *
+                  IO_ALIGNMENT),
+      num_blocks_(std::max<size_t>(num_blocks, 1)) {
+  file_name_ = "__empty.bin";
+  HCTR_CHECK_HINT(
+      file_list_.get_num_of_files() >= stride_,
+      "The number of data reader workers should be no greater than the number of files in the "
+      "file list. Please re-configure num_workers within DataReaderParams.");
+
+  for (size_t i = 0; i < num_blocks_ + 1; ++i) {
+    void* ptr = nullptr;
+    HCTR_CHECK_HINT(posix_memalign(&ptr, IO_ALIGNMENT, block_size_) == 0,
+                    "Allocating read buffer failed.");
+    free_.emplace_back(static_cast<char*>(ptr), std::free);
+  }
+  io_thread_ = std::thread(&BufferedFileSource::io_loop, this);
+}
+
+BufferedFileSource::~BufferedFileSource() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  io_thread_.join();
+}
+
+void BufferedFileSource::io_loop() {
+  for (unsigned int file_id = 0;; ++file_id) {
+    std::string file_name = file_list_.get_a_file_with_id(offset_ + file_id * stride_, repeat_);
+
+    int fd = -1;
+    Error_t error = Error_t::Success;
+    if (file_name.empty()) {
+      error = Error_t::EndOfFile;
+    } else {
+      fd = open(file_name.c_str(), O_RDONLY);
+      if (fd < 0) {
+        HCTR_LOG_S(ERROR, WORLD) << "open() failed: " << file_name << ' ' << std::strerror(errno)
+                                 << ' ' << HCTR_LOCATION() << std::endl;
+        error = Error_t::FileCannotOpen;
+      } else {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+      }
+    }
+
+    for (off_t file_offset = 0;;) {
+      Block block;
+      block.file_id = file_id;
+      block.error = error;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [&] { return stop_ || (!free_.empty() && ready_.size() < num_blocks_); });
+        if (stop_) {
+          if (fd >= 0) close(fd);
+          return;
+        }
+        block.data = std::move(free_.back());
+        free_.pop_back();
+      }
+
+      if (error == Error_t::Success) {
+        // fill the block, unless the file ends first
+        while (block.size < block_size_) {
+          ssize_t n = pread(fd, block.data.get() + block.size, block_size_ - block.size,
+                            file_offset + static_cast<off_t>(block.size));
+          if (n < 0 && errno == EINTR) continue;
+          if (n < 0) {
+            HCTR_LOG_S(ERROR, WORLD) << "pread() failed: " << file_name << ' '
+                                     << std::strerror(errno) << std::endl;
+            block.error = Error_t::UnspecificError;
+          }
+          if (n <= 0) {
+            block.last = true;
+            break;
+          }
+          block.size += static_cast<size_t>(n);
+        }
+        file_offset += static_cast<off_t>(block.size);
+      } else {
+        block.last = true;
+      }
+
+      const bool last = block.last;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ready_.push_back(std::move(block));
+      }
+      cv_.notify_all();
+      if (last) break;
+    }
+
+    if (fd >= 0) close(fd);
+    if (error == Error_t::EndOfFile) {
+      return;
+    }
+  }
+}
+
+BufferedFileSource::Block BufferedFileSource::pop_block() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [&] { return !ready_.empty(); });
+  Block block = std::move(ready_.front());
+  ready_.pop_front();
+  return block;
+}
+
+void BufferedFileSource::recycle(Block& block) {
+  if (block.data) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      free_.push_back(std::move(block.data));
+    }
+    cv_.notify_all();
+  }
+  block.size = 0;
+  current_offset_ = 0;
+}
+
+Error_t BufferedFileSource::read_across_blocks(char* ptr, size_t bytes_to_read) {
+  if (!is_open_) {
+    return Error_t::FileCannotOpen;
+  }
+  try {
+    while (bytes_to_read > 0) {
+      size_t available = current_.size - current_offset_;
+      if (available == 0) {
+        if (current_.last) {
+          return current_.error == Error_t::Success ? Error_t::OutOfBound : current_.error;
+        }
+        recycle(current_);
+        current_ = pop_block();
+        continue;
+      }
+      size_t n = std::min(available, bytes_to_read);
+      std::memcpy(ptr, current_.data.get() + current_offset_, n);
+      current_offset_ += n;
+      ptr += n;
+      bytes_to_read -= n;
+    }
+    return Error_t::Success;
+  } catch (const std::runtime_error& rt_err) {
+    HCTR_LOG_S(ERROR, WORLD) << rt_err.what() << std::endl;
+    return Error_t::UnspecificError;
+  }
+}
+
+Error_t BufferedFileSource::next_source(long long expected_next_source_items) noexcept {
+  try {
+    const unsigned int file_id = counter_;
+    file_name_ = file_list_.get_a_file_with_id(offset_ + counter_ * stride_, repeat_);
+    counter_++;  // counter_ should be accum for every source.
+
+    // drop the rest of the previous files; the I/O thread stops after the end of the list
+    is_open_ = false;
+    while (!has_block_ || current_.file_id < file_id) {
+      if (has_block_ && current_.error == Error_t::EndOfFile) break;
+      recycle(current_);
+      current_ = pop_block();
+      has_block_ = true;
+    }
+
+    if (current_.error == Error_t::EndOfFile) {
+      return Error_t::EndOfFile;
+    }
+    if (current_.error == Error_t::FileCannotOpen) {
+      return Error_t::FileCannotOpen;
+    }
+    is_open_ = true;
+    return Error_t::Success;
+  } catch (const std::runtime_error& rt_err) {
+    HCTR_LOG_S(ERROR, WORLD) << rt_err.what() << std::endl;
+    return Error_t::UnspecificError;
+  }
+}
+
+}  // namespace HugeCTR
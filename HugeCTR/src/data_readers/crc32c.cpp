@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <array>
+#include <cstring>
+#include <data_readers/crc32c.hpp>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_acle.h>
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+
+namespace HugeCTR {
+
+namespace {
+
+constexpr uint32_t CRC32C_POLY = 0x82f63b78;  // reflected Castagnoli polynomial
+
+std::array<std::array<uint32_t, 256>, 8> make_crc32c_tables() {
+  std::array<std::array<uint32_t, 256>, 8> tables;
+  for (uint32_t i = 0; i < 256; ++i) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ (CRC32C_POLY & (0u - (crc & 1)));
+    }
+    tables[0][i] = crc;
+  }
+  for (uint32_t i = 0; i < 256; ++i) {
+    for (size_t t = 1; t < 8; ++t) {
+      tables[t][i] = (tables[t - 1][i] >> 8) ^ tables[0][tables[t - 1][i] & 0xff];
+    }
+  }
+  return tables;
+}
+
+// slicing-by-8
+uint32_t crc32c_slicing_by_8(const char* p, size_t size, uint32_t crc) {
+  static const auto tables = make_crc32c_tables();
+  for (; size >= 8; p += 8, size -= 8) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(uint64_t));
+    v ^= crc;
+    crc = tables[7][v & 0xff] ^ tables[6][(v >> 8) & 0xff] ^ tables[5][(v >> 16) & 0xff] ^
+          tables[4][(v >> 24) & 0xff] ^ tables[3][(v >> 32) & 0xff] ^
+          tables[2][(v >> 40) & 0xff] ^ tables[1][(v >> 48) & 0xff] ^ tables[0][v >> 56];
+  }
+  for (; size > 0; ++p, --size) {
+    crc = (crc >> 8) ^ tables[0][(crc ^ static_cast<uint8_t>(*p)) & 0xff];
+  }
+  return crc;
+}
+
+#if defined(__x86_64__)
+
+__attribute__((target("sse4.2"))) uint32_t crc32c_hw(const char* p, size_t size, uint32_t crc) {
+  uint64_t crc64 = crc;
+  for (; size >= 8; p += 8, size -= 8) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(uint64_t));
+    crc64 = _mm_crc32_u64(crc64, v);
+  }
+  crc = static_cast<uint32_t>(crc64);
+  for (; size > 0; ++p, --size) {
+    crc = _mm_crc32_u8(crc, static_cast<uint8_t>(*p));
+  }
+  return crc;
+}
+
+bool has_crc32c_hw() { return __builtin_cpu_supports("sse4.2"); }
+
+#elif defined(__aarch64__)
+
+__attribute__((target("+crc"))) uint32_t crc32c_hw(const char* p, size_t size, uint32_t crc) {
+  for (; size >= 8; p += 8, size -= 8) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(uint64_t));
+    crc = __crc32cd(crc, v);
+  }
+  for (; size > 0; ++p, --size) {
+    crc = __crc32cb(crc, static_cast<uint8_t>(*p));
+  }
+  return crc;
+}
+
+bool has_crc32c_hw() { return getauxval(AT_HWCAP) & HWCAP_CRC32; }
+
+#else
+
+uint32_t crc32c_hw(const char* p, size_t size, uint32_t crc) {
+  return crc32c_slicing_by_8(p, size, crc);
+}
+
+bool has_crc32c_hw() { return false; }
+
+#endif
+
+}  // namespace
+
+uint32_t crc32c(const void* data, size_t size, uint32_t crc) {
+  static const bool use_hw = has_crc32c_hw();
+  const char* p = static_cast<const char*>(data);
+  crc = ~crc;
+  crc = use_hw ? crc32c_hw(p, size, crc) : crc32c_slicing_by_8(p, size, crc);
+  return ~crc;
+}
+
+uint32_t crc32c_sw(const void* data, size_t size, uint32_t crc) {
+  return ~crc32c_slicing_by_8(static_cast<const char*>(data), size, ~crc);
+}
+
+}  // namespace HugeCTR
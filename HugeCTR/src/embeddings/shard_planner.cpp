@@ -0,0 +1,595 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <embeddings/shard_planner.hpp>
+#include <functional>
+#include <limits>
+#include <numeric>
+
+namespace HugeCTR {
+
+double EmbeddingTableStats::expected_unique_keys(double num_draws) const {
+  if (num_keys <= 0 || num_draws <= 0.) {
+    return 0.;
+  }
+  // a key with probability p is drawn at least once with probability 1 - (1 - p)^n
+  double num_unique = 0.;
+  for (auto &[num_keys_in_bin, count] : frequency_histogram) {
+    double p = std::min(count / static_cast<double>(num_keys), 1.);
+    num_unique += static_cast<double>(num_keys_in_bin) * -std::expm1(num_draws * std::log1p(-p));
+  }
+  return num_unique;
+}
+
+std::ostream &operator<<(std::ostream &os, const EmbeddingTableStats &p) {
+  os << p.name << ": num_samples=" << p.num_samples << ", avg_hotness=" << p.avg_hotness()
+     << ", num_unique_keys=" << p.num_unique_keys;
+  return os;
+}
+
+template <typename KeyType>
+void EmbeddingTableStatsCollector::add(const std::string &table_name, const KeyType *keys,
+                                       size_t num_keys, int64_t num_samples) {
+  auto &table = tables_[table_name];
+  table.num_samples += num_samples;
+  table.num_keys += static_cast<int64_t>(num_keys);
+  for (size_t i = 0; i < num_keys; ++i) {
+    ++table.key_counts[static_cast<int64_t>(keys[i])];
+  }
+}
+
+template void EmbeddingTableStatsCollector::add(const std::string &, const int32_t *, size_t,
+                                                int64_t);
+template void EmbeddingTableStatsCollector::add(const std::string &, const uint32_t *, size_t,
+                                                int64_t);
+template void EmbeddingTableStatsCollector::add(const std::string &, const int64_t *, size_t,
+                                                int64_t);
+template void EmbeddingTableStatsCollector::add(const std::string &, const uint64_t *, size_t,
+                                                int64_t);
+
+std::vector<EmbeddingTableStats> EmbeddingTableStatsCollector::stats() const {
+  std::vector<EmbeddingTableStats> stats;
+  for (auto &[name, table] : tables_) {
+    EmbeddingTableStats s;
+    s.name = name;
+    s.num_samples = table.num_samples;
+    s.num_keys = table.num_keys;
+    s.num_unique_keys = static_cast<int64_t>(table.key_counts.size());
+
+    std::vector<int64_t> counts;
+    counts.reserve(table.key_counts.size());
+    for (auto &[key, count] : table.key_counts) {
+      counts.push_back(count);
+    }
+    std::sort(counts.begin(), counts.end(), std::greater<int64_t>());
+
+    // exact bins for rare keys, geometric bins (factor 1.25) for frequent keys
+    for (size_t i = 0; i < counts.size();) {
+      double lower = counts[i] <= 16 ? static_cast<double>(counts[i]) : counts[i] / 1.25;
+      double sum = 0.;
+      size_t j = i;
+      for (; j < counts.size() && static_cast<double>(counts[j]) >= lower; ++j) {
+        sum += static_cast<double>(counts[j]);
+      }
+      s.frequency_histogram.emplace_back(static_cast<int64_t>(j - i), sum / (j - i));
+      i = j;
+    }
+    stats.push_back(std::move(s));
+  }
+  return stats;
+}
+
+double ShardPlan::estimated_iteration_time() const {
+  double t = 0.;
+  for (size_t gpu_id = 0; gpu_id < lookup_time_per_gpu.size(); ++gpu_id) {
+    t = std::max(t, lookup_time_per_gpu[gpu_id] + comm_time_per_gpu[gpu_id]);
+  }
+  return t;
+}
+
+std::ostream &operator<<(std::ostream &os, const ShardPlan &p) {
+  os << "shard plan (estimated iteration time " << p.estimated_iteration_time() * 1e3 << " ms):";
+  for (auto &strategy : p.shard_strategy) {
+    os << "\n  " << get_table_place_strategy(strategy) << ":";
+    for (auto &v : get_table_group_strategy(strategy)) {
+      os << " " << get_table_name(v);
+      if (get_column_wise_sharding_factor(v) > 1) {
+        os << "(x" << get_column_wise_sharding_factor(v) << ")";
+      }
+    }
+  }
+  for (size_t gpu_id = 0; gpu_id < p.shard_matrix.size(); ++gpu_id) {
+    os << "\n  gpu" << gpu_id << ": memory=" << p.memory_per_gpu[gpu_id] / (1 << 20)
+       << " MiB, lookup=" << p.lookup_time_per_gpu[gpu_id] * 1e3
+       << " ms, comm=" << p.comm_time_per_gpu[gpu_id] * 1e3 << " ms, tables=[";
+    for (size_t i = 0; i < p.shard_matrix[gpu_id].size(); ++i) {
+      os << (i ? ", " : "") << p.shard_matrix[gpu_id][i];
+    }
+    os << "]";
+  }
+  return os;
+}
+
+namespace {
+
+// per global batch workload of one table
+struct TableWorkload {
+  std::string name;
+  int ev_size;
+  double num_rows;
+  double param_bytes_per_element;  // weights and optimizer states
+  double num_keys;
+  double num_unique_keys;
+  double num_local_unique_keys;  // distinct keys in the batch of a single GPU
+  double num_pooled_outputs;
+  double num_concat_outputs;
+  bool allow_dp;
+};
+
+struct ShardCost {
+  double memory;
+  double lookup_time;
+  double send_time;
+};
+
+struct TablePlacement {
+  bool dp = false;
+  int row_factor = 1;
+  int col_factor = 1;
+  std::vector<int> gpus;
+
+  int num_shards() const { return row_factor * col_factor; }
+};
+
+class ShardPlanner {
+ public:
+  ShardPlanner(const ShardPlannerParams &params, std::vector<TableWorkload> tables)
+      : params_(params),
+        tables_(std::move(tables)),
+        placements_(tables_.size()),
+        memory_(params.num_gpus, 0.),
+        lookup_time_(params.num_gpus, 0.),
+        send_time_(params.num_gpus, 0.) {}
+
+  void select_data_parallel_tables();
+
+  void select_sharding_factors();
+
+  void place_model_parallel_tables();
+
+  void refine();
+
+  ShardPlan plan() const;
+
+ private:
+  ShardPlannerParams params_;
+  std::vector<TableWorkload> tables_;
+  std::vector<TablePlacement> placements_;
+
+  // accumulated cost per GPU
+  std::vector<double> memory_;
+  std::vector<double> lookup_time_;
+  std::vector<double> send_time_;
+  double allreduce_time_ = 0.;
+
+  ShardCost mp_shard_cost(const TableWorkload &t, int row_factor, int col_factor) const;
+
+  ShardCost dp_cost(const TableWorkload &t) const;
+
+  double mp_shard_time(const TableWorkload &t, int row_factor, int col_factor) const {
+    auto c = mp_shard_cost(t, row_factor, col_factor);
+    return c.lookup_time + c.send_time;
+  }
+
+  // every GPU receives its share of the outputs of all model-parallel shards
+  double recv_time() const {
+    return std::accumulate(send_time_.begin(), send_time_.end(), 0.) / params_.num_gpus;
+  }
+
+  double gpu_time(int gpu_id, double recv_time) const {
+    return lookup_time_[gpu_id] + std::max(send_time_[gpu_id], recv_time) + allreduce_time_;
+  }
+
+  void add_shard(int gpu_id, const ShardCost &c, double sign) {
+    memory_[gpu_id] += sign * c.memory;
+    lookup_time_[gpu_id] += sign * c.lookup_time;
+    send_time_[gpu_id] += sign * c.send_time;
+  }
+
+  int next_col_factor(const TableWorkload &t, int col_factor) const {
+    for (int c = col_factor + 1; c <= t.ev_size / params_.min_column_width; ++c) {
+      if (t.ev_size % c == 0) {
+        return c;
+      }
+    }
+    return -1;
+  }
+};
+
+ShardCost ShardPlanner::mp_shard_cost(const TableWorkload &t, int row_factor,
+                                      int col_factor) const {
+  const double remote = (params_.num_gpus - 1.) / params_.num_gpus;
+  const double ev_bytes = static_cast<double>(t.ev_size / col_factor) * params_.emb_type_size;
+
+  ShardCost c;
+  c.memory = t.num_rows / row_factor * (t.ev_size / col_factor) * t.param_bytes_per_element;
+  // forward gather and backward read-modify-write of every distinct row
+  c.lookup_time = (3. * t.num_unique_keys / row_factor * ev_bytes +
+                   t.num_keys / row_factor * params_.key_type_size) /
+                  params_.memory_bandwidth;
+  // each row-wise shard emits partial sums for all pooled outputs
+  const double output_bytes =
+      (t.num_pooled_outputs + t.num_concat_outputs / row_factor) * ev_bytes;
+  const double key_bytes = t.num_keys / row_factor * params_.key_type_size;
+  // keys in, embedding vectors out (forward), gradients in (backward)
+  c.send_time = remote * (key_bytes + 2. * output_bytes) / params_.network_bandwidth;
+  return c;
+}
+
+ShardCost ShardPlanner::dp_cost(const TableWorkload &t) const {
+  const double ev_bytes = static_cast<double>(t.ev_size) * params_.emb_type_size;
+
+  ShardCost c;
+  c.memory = t.num_rows * t.ev_size * t.param_bytes_per_element;
+  c.lookup_time = (3. * t.num_local_unique_keys * ev_bytes +
+                   t.num_keys / params_.num_gpus * params_.key_type_size) /
+                  params_.memory_bandwidth;
+  // dense allreduce of the wgrad of the whole table
+  c.send_time = 2. * (params_.num_gpus - 1.) / params_.num_gpus * t.num_rows * ev_bytes /
+                params_.allreduce_bandwidth;
+  return c;
+}
+
+void ShardPlanner::select_data_parallel_tables() {
+  // replicate the tables that save the most time per replicated byte
+  std::vector<std::pair<double, size_t>> candidates;
+  for (size_t i = 0; i < tables_.size(); ++i) {
+    const auto &t = tables_[i];
+    if (!t.allow_dp || params_.num_gpus == 1) continue;
+    auto mp = mp_shard_cost(t, 1, 1);
+    auto dp = dp_cost(t);
+    // an mp table occupies its owner for lookup and send, and all GPUs for receive
+    double saving =
+        (mp.lookup_time + 2. * mp.send_time) - params_.num_gpus * (dp.lookup_time + dp.send_time);
+    if (saving > 0.) {
+      candidates.emplace_back(saving / std::max(dp.memory, 1.), i);
+    }
+  }
+  std::sort(candidates.begin(), candidates.end(), std::greater<std::pair<double, size_t>>());
+
+  const double dp_budget = params_.dp_memory_fraction * params_.gpu_memory_budget;
+  double dp_memory = 0.;
+  for (auto &[ratio, i] : candidates) {
+    auto c = dp_cost(tables_[i]);
+    if (dp_memory + c.memory > dp_budget) continue;
+    dp_memory += c.memory;
+
+    auto &placement = placements_[i];
+    placement.dp = true;
+    placement.gpus.resize(params_.num_gpus);
+    std::iota(placement.gpus.begin(), placement.gpus.end(), 0);
+    for (int gpu_id = 0; gpu_id < params_.num_gpus; ++gpu_id) {
+      memory_[gpu_id] += c.memory;
+      lookup_time_[gpu_id] += c.lookup_time;
+    }
+    allreduce_time_ += c.send_time;
+  }
+}
+
+void ShardPlanner::select_sharding_factors() {
+  const double mp_budget = params_.gpu_memory_budget - memory_[0];
+
+  for (bool changed = true; changed;) {
+    changed = false;
+
+    double total_time = 0.;
+    for (size_t i = 0; i < tables_.size(); ++i) {
+      const auto &p = placements_[i];
+      if (p.dp) continue;
+      total_time += p.num_shards() * mp_shard_time(tables_[i], p.row_factor, p.col_factor);
+    }
+    const double ideal_time = total_time / params_.num_gpus;
+
+    for (size_t i = 0; i < tables_.size(); ++i) {
+      auto &t = tables_[i];
+      auto &p = placements_[i];
+      if (p.dp) continue;
+
+      auto c = mp_shard_cost(t, p.row_factor, p.col_factor);
+      bool over_memory = c.memory > mp_budget;
+      bool over_time = c.lookup_time + c.send_time > params_.imbalance_tolerance * ideal_time;
+      if (!over_memory && !over_time) continue;
+
+      // column-wise splits keep the all2all volume, row-wise splits spread the key traffic
+      int best_row = -1, best_col = -1;
+      double best_time = over_memory ? std::numeric_limits<double>::max()
+                                     : mp_shard_time(t, p.row_factor, p.col_factor);
+      auto consider = [&](int row, int col) {
+        if (col < 0 || row * col > params_.num_gpus) return;
+        double time = mp_shard_time(t, row, col);
+        if (time < best_time) {
+          best_time = time;
+          best_row = row;
+          best_col = col;
+        }
+      };
+      consider(p.row_factor + 1, p.col_factor);
+      consider(p.row_factor, next_col_factor(t, p.col_factor));
+      if (best_row < 0) continue;
+
+      p.row_factor = best_row;
+      p.col_factor = best_col;
+      changed = true;
+      break;
+    }
+  }
+}
+
+void ShardPlanner::place_model_parallel_tables() {
+  std::vector<size_t> order;
+  for (size_t i = 0; i < tables_.size(); ++i) {
+    if (!placements_[i].dp) order.push_back(i);
+  }
+  // longest processing time first
+  auto shard_time = [&](size_t i) {
+    return mp_shard_time(tables_[i], placements_[i].row_factor, placements_[i].col_factor);
+  };
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t a, size_t b) { return shard_time(a) > shard_time(b); });
+
+  std::vector<int> gpus(params_.num_gpus);
+  for (size_t i : order) {
+    auto &t = tables_[i];
+    auto &p = placements_[i];
+    for (;;) {
+      auto c = mp_shard_cost(t, p.row_factor, p.col_factor);
+
+      gpus.clear();
+      for (int gpu_id = 0; gpu_id < params_.num_gpus; ++gpu_id) {
+        if (memory_[gpu_id] + c.memory <= params_.gpu_memory_budget) gpus.push_back(gpu_id);
+      }
+      if (static_cast<int>(gpus.size()) >= p.num_shards()) {
+        double recv = recv_time();
+        std::stable_sort(gpus.begin(), gpus.end(),
+                         [&](int a, int b) { return gpu_time(a, recv) < gpu_time(b, recv); });
+        p.gpus.assign(gpus.begin(), gpus.begin() + p.num_shards());
+        std::sort(p.gpus.begin(), p.gpus.end());
+        for (int gpu_id : p.gpus) add_shard(gpu_id, c, 1.);
+        break;
+      }
+
+      HCTR_CHECK_HINT((p.row_factor + 1) * p.col_factor <= params_.num_gpus,
+                      "plan_embedding_shards: table ", t.name,
+                      " does not fit into the memory budget of ", params_.num_gpus, " GPUs.\n");
+      ++p.row_factor;
+    }
+  }
+}
+
+void ShardPlanner::refine() {
+  // Sharding factors are final by now, so is the cost of every shard. Moving shards does not change
+  // the total send volume, hence the receive time is constant as well.
+  const int num_gpus = params_.num_gpus;
+  const double recv = recv_time();
+  std::vector<ShardCost> costs(tables_.size());
+  std::vector<std::vector<size_t>> gpu_tables(num_gpus);  // model-parallel shards on each GPU
+  std::vector<std::vector<char>> has_shard(tables_.size(), std::vector<char>(num_gpus, 0));
+  for (size_t i = 0; i < tables_.size(); ++i) {
+    const auto &p = placements_[i];
+    if (p.dp) continue;
+    costs[i] = mp_shard_cost(tables_[i], p.row_factor, p.col_factor);
+    for (int gpu_id : p.gpus) {
+      gpu_tables[gpu_id].push_back(i);
+      has_shard[i][gpu_id] = 1;
+    }
+  }
+
+  std::vector<double> times(num_gpus);
+  for (int step = 0; step < params_.max_refinement_steps; ++step) {
+    // The three slowest GPUs suffice to know the time of all GPUs except the two a move changes.
+    std::array<int, 3> slowest{-1, -1, -1};
+    for (int gpu_id = 0; gpu_id < num_gpus; ++gpu_id) {
+      times[gpu_id] = gpu_time(gpu_id, recv);
+      for (int k = 0, g = gpu_id; k < 3 && g >= 0; ++k) {
+        if (slowest[k] < 0 || times[g] > times[slowest[k]]) std::swap(g, slowest[k]);
+      }
+    }
+    const int worst_gpu = slowest[0];
+    auto max_other_time = [&](int gpu_id) {
+      for (int g : slowest) {
+        if (g >= 0 && g != worst_gpu && g != gpu_id) return times[g];
+      }
+      return 0.;
+    };
+
+    // best single move of a shard away from the slowest GPU, or swap with a shard of another GPU
+    double best = times[worst_gpu] * (1. - 1e-9);
+    size_t best_table = 0, best_other_table = 0;
+    int best_gpu = -1;
+    bool best_is_swap = false;
+
+    auto evaluate = [&](size_t i, size_t j, int gpu_id, bool swap) {
+      // cost that moves from the slowest GPU to `gpu_id`
+      ShardCost d = costs[i];
+      if (swap) {
+        d.memory -= costs[j].memory;
+        d.lookup_time -= costs[j].lookup_time;
+        d.send_time -= costs[j].send_time;
+      }
+      if (memory_[gpu_id] + d.memory > params_.gpu_memory_budget ||
+          memory_[worst_gpu] - d.memory > params_.gpu_memory_budget) {
+        return;
+      }
+      const double t = std::max(
+          {max_other_time(gpu_id),
+           lookup_time_[worst_gpu] - d.lookup_time +
+               std::max(send_time_[worst_gpu] - d.send_time, recv) + allreduce_time_,
+           lookup_time_[gpu_id] + d.lookup_time +
+               std::max(send_time_[gpu_id] + d.send_time, recv) + allreduce_time_});
+      if (t < best) {
+        best = t;
+        best_table = i;
+        best_other_table = j;
+        best_gpu = gpu_id;
+        best_is_swap = swap;
+      }
+    };
+
+    for (size_t i : gpu_tables[worst_gpu]) {
+      for (int gpu_id = 0; gpu_id < num_gpus; ++gpu_id) {
+        if (has_shard[i][gpu_id]) continue;
+        evaluate(i, i, gpu_id, false);
+        for (size_t j : gpu_tables[gpu_id]) {
+          if (has_shard[j][worst_gpu]) continue;
+          evaluate(i, j, gpu_id, true);
+        }
+      }
+    }
+    if (best_gpu < 0) break;
+
+    auto move = [&](size_t i, int from, int to) {
+      auto &p = placements_[i];
+      add_shard(from, costs[i], -1.);
+      add_shard(to, costs[i], 1.);
+      *std::find(p.gpus.begin(), p.gpus.end(), from) = to;
+      std::sort(p.gpus.begin(), p.gpus.end());
+      auto &from_tables = gpu_tables[from];
+      from_tables.erase(std::find(from_tables.begin(), from_tables.end(), i));
+      gpu_tables[to].push_back(i);
+      has_shard[i][from] = 0;
+      has_shard[i][to] = 1;
+    };
+    move(best_table, worst_gpu, best_gpu);
+    if (best_is_swap) move(best_other_table, best_gpu, worst_gpu);
+  }
+}
+
+ShardPlan ShardPlanner::plan() const {
+  ShardPlan plan;
+  plan.shard_matrix.resize(params_.num_gpus);
+
+  std::vector<TableVariant> dp_tables, mp_tables;
+  for (size_t i = 0; i < tables_.size(); ++i) {
+    const auto &t = tables_[i];
+    const auto &p = placements_[i];
+    for (int gpu_id : p.gpus) {
+      plan.shard_matrix[gpu_id].push_back(t.name);
+    }
+    if (p.dp) {
+      dp_tables.push_back(t.name);
+    } else if (p.col_factor > 1) {
+      mp_tables.push_back(std::make_tuple(t.name, p.col_factor));
+    } else {
+      mp_tables.push_back(t.name);
+    }
+  }
+  if (!dp_tables.empty()) plan.shard_strategy.push_back({"dp", dp_tables});
+  if (!mp_tables.empty()) plan.shard_strategy.push_back({"mp", mp_tables});
+
+  const double recv = recv_time();
+  plan.memory_per_gpu = memory_;
+  plan.lookup_time_per_gpu = lookup_time_;
+  for (int gpu_id = 0; gpu_id < params_.num_gpus; ++gpu_id) {
+    plan.comm_time_per_gpu.push_back(std::max(send_time_[gpu_id], recv) + allreduce_time_);
+  }
+  return plan;
+}
+
+}  // namespace
+
+ShardPlan plan_embedding_shards(const EmbeddingCollectionConfig &config,
+                                const std::vector<EmbeddingTableStats> &stats,
+                                const ShardPlannerParams &params) {
+  HCTR_CHECK_HINT(params.num_gpus > 0, "plan_embedding_shards: num_gpus must be positive.\n");
+  HCTR_CHECK_HINT(params.global_batch_size > 0,
+                  "plan_embedding_shards: global_batch_size must be positive.\n");
+  HCTR_CHECK_HINT(!config.emb_table_config_list_.empty(),
+                  "plan_embedding_shards: call embedding_lookup first.\n");
+
+  std::unordered_map<std::string, const EmbeddingTableStats *> name_to_stats;
+  for (auto &s : stats) {
+    name_to_stats[s.name] = &s;
+  }
+
+  const double batch_size = static_cast<double>(params.global_batch_size);
+  std::vector<TableWorkload> tables;
+  for (auto &table_config : config.emb_table_config_list_) {
+    const auto &table_param = table_config.table_param;
+    auto stats_iter = name_to_stats.find(table_config.name);
+    const EmbeddingTableStats *s = stats_iter != name_to_stats.end() ? stats_iter->second : nullptr;
+    if (!s) {
+      HCTR_LOG_S(WARNING, ROOT) << "plan_embedding_shards: no statistics for table "
+                                << table_config.name << ", assuming hotness 1." << std::endl;
+    }
+
+    TableWorkload t;
+    t.name = table_config.name;
+    t.ev_size = table_param.ev_size;
+
+    Optimizer_t optimizer = table_param.opt_param.optimizer;
+    if (optimizer == Optimizer_t::NOT_INITIALIZED || optimizer == Optimizer_t::DEFAULT) {
+      optimizer = params.default_optimizer;
+    }
+    t.param_bytes_per_element =
+        static_cast<double>((1 + OptParams::num_parameters_per_weight(optimizer)) *
+                            params.emb_type_size);
+
+    const double hotness = s ? s->avg_hotness() : 1.;
+    t.num_rows = table_param.max_vocabulary_size > 0
+                     ? static_cast<double>(table_param.max_vocabulary_size)
+                     : static_cast<double>(s ? s->num_unique_keys : 0);
+    HCTR_CHECK_HINT(t.num_rows > 0, "plan_embedding_shards: table ", t.name,
+                    " is dynamic and has no statistics.\n");
+
+    t.num_keys = 0.;
+    t.num_pooled_outputs = 0.;
+    t.num_concat_outputs = 0.;
+    t.allow_dp = true;
+    for (auto &[name, lookup_param] : config.lookup_configs_) {
+      if (name != t.name) continue;
+      t.num_keys += batch_size * hotness;
+      if (lookup_param.combiner == ::embedding::Combiner::Concat) {
+        t.num_concat_outputs += batch_size * hotness;
+        t.allow_dp &= hotness <= 1. && lookup_param.max_hotness <= 1;
+      } else {
+        t.num_pooled_outputs += batch_size;
+      }
+    }
+
+    auto unique_keys = [&](double num_draws) {
+      double n = s ? s->expected_unique_keys(num_draws) : num_draws;
+      return std::min(n, t.num_rows);
+    };
+    t.num_unique_keys = unique_keys(t.num_keys);
+    t.num_local_unique_keys = unique_keys(t.num_keys / params.num_gpus);
+    tables.push_back(std::move(t));
+  }
+
+  ShardPlanner planner(params, std::move(tables));
+  planner.select_data_parallel_tables();
+  planner.select_sharding_factors();
+  planner.place_model_parallel_tables();
+  planner.refine();
+  ShardPlan plan = planner.plan();
+
+  HCTR_LOG_S(INFO, ROOT) << plan << std::endl;
+  return plan;
+}
+
+}  // namespace HugeCTR
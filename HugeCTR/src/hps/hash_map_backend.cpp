@@ -14,26 +14,177 @@
  * limitations under the License.
  */
 
+#include <numa.h>
+
 #include <algorithm>
 #include <atomic>
 #include <core23/logger.hpp>
 #include <cstring>
+#include <exception>
 #include <execution>
 #include <hps/hash_map_backend.hpp>
 #include <hps/hash_map_backend_detail.hpp>
 #include <hps/hier_parameter_server_base.hpp>
+#include <mutex>
 #include <random>
+#include <unordered_map>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 // TODO: Remove me!
 #pragma GCC diagnostic error "-Wconversion"
 
 namespace HugeCTR {
 
+namespace {
+
+// Worker pools of the NUMA nodes, shared by all hash map backends in this process.
+ThreadPool& numa_node_workers(const int node, const size_t num_cpus) {
+  static std::mutex guard;
+  static std::unordered_map<int, std::unique_ptr<ThreadPool>> pools;
+
+  const std::lock_guard lock(guard);
+  std::unique_ptr<ThreadPool>& pool{pools[node]};
+  if (!pool) {
+    pool = std::make_unique<ThreadPool>("hm node " + std::to_string(node), num_cpus,
+                                        ThreadPoolAffinity_t::NumaNode, node);
+  }
+  return *pool;
+}
+
+}  // namespace
+
 template <typename Key>
-HashMapBackend<Key>::HashMapBackend(const HashMapBackendParams& params) : Base(params) {
+HashMapBackend<Key>::HashMapBackend(const HashMapBackendParams& params)
+    : Base(params),
+      numa_placement_{params.numa_placement},
+      access_clock_{std::time(nullptr)} {
+  if (numa_placement_ != DatabaseNumaPlacement_t::Default && numa_available() < 0) {
+    HCTR_LOG_S(WARNING, WORLD) << get_name() << ": NUMA placement '" << numa_placement_
+                               << "' requested, but NUMA is not available on this system."
+                               << std::endl;
+    numa_placement_ = DatabaseNumaPlacement_t::Default;
+  }
+
+  if (numa_placement_ == DatabaseNumaPlacement_t::Local) {
+    // Only nodes with CPU cores can host workers.
+    bitmask* const cpus{numa_allocate_cpumask()};
+    for (int node{0}; node <= numa_max_node(); ++node) {
+      if (numa_node_to_cpus(node, cpus) == 0) {
+        const unsigned int num_cpus{numa_bitmask_weight(cpus)};
+        if (num_cpus > 0) {
+          numa_nodes_.emplace_back(node);
+          numa_workers_.emplace_back(&numa_node_workers(node, num_cpus));
+        }
+      }
+    }
+    numa_free_cpumask(cpus);
+    HCTR_CHECK_HINT(!numa_nodes_.empty(), "Unable to determine NUMA nodes with CPU cores!");
+
+    HCTR_LOG_S(INFO, WORLD) << get_name() << ": Partitions are distributed across "
+                            << numa_nodes_.size() << " NUMA nodes." << std::endl;
+  }
+
+  if (params.access_tracking == DatabaseAccessTracking_t::Deferred &&
+      params.overflow_policy != DatabaseOverflowPolicy_t::EvictRandom) {
+    access_thread_ = std::thread(&HashMapBackend::run_access_thread_, this);
+  }
+
   HCTR_LOG_C(DEBUG, WORLD, "Created blank database backend in local memory!\n");
 }
 
+template <typename Key>
+HashMapBackend<Key>::~HashMapBackend() {
+  if (access_thread_.joinable()) {
+    {
+      const std::lock_guard lock(access_thread_guard_);
+      access_thread_terminate_ = true;
+    }
+    access_thread_semaphore_.notify_all();
+    access_thread_.join();
+  }
+}
+
+template <typename Key>
+HashMapAccessStats HashMapBackend<Key>::access_stats() const {
+  HashMapAccessStats stats;
+  stats.num_applied = num_access_applied_;
+  stats.num_dropped = num_access_dropped_;
+  stats.num_drains = num_access_drains_;
+  return stats;
+}
+
+template <typename Key>
+void HashMapBackend<Key>::run_access_thread_() {
+  Logger::set_thread_name("hm access");
+
+  std::unique_lock lock(access_thread_guard_);
+  while (!access_thread_semaphore_.wait_for(lock, access_drain_interval,
+                                            [this]() { return access_thread_terminate_; })) {
+    access_clock_.store(std::time(nullptr), std::memory_order_relaxed);
+
+    // Keep the eviction metadata current, even if nothing is inserted for a while.
+    const std::shared_lock read_lock(read_write_guard_);
+    for (auto& table : tables_) {
+      for (Partition& part : table.second) {
+        apply_access_log_(part);
+      }
+    }
+  }
+}
+
+template <typename Key>
+int HashMapBackend<Key>::numa_node_of_part_(const size_t part_index) const {
+  switch (numa_placement_) {
+    case DatabaseNumaPlacement_t::Default:
+      break;
+    case DatabaseNumaPlacement_t::Local:
+      return numa_nodes_[part_index % numa_nodes_.size()];
+    case DatabaseNumaPlacement_t::Interleaved:
+      return CharAllocator::interleave;
+  }
+  return CharAllocator::any_node;
+}
+
+template <typename Key>
+template <typename Function>
+void HashMapBackend<Key>::for_each_part_(const size_t num_partitions, const Function& fn) const {
+  if (numa_workers_.empty()) {
+    ThreadPool::get().parallel_for(num_partitions, fn);
+    return;
+  }
+
+  // Let the workers of each NUMA node process the partitions that reside on that node.
+  const size_t num_nodes{numa_workers_.size()};
+  std::vector<std::future<void>> tasks;
+  tasks.reserve(num_nodes);
+  for (size_t node_index{0}; node_index < num_nodes && node_index < num_partitions; ++node_index) {
+    const size_t num_node_parts{(num_partitions - node_index + num_nodes - 1) / num_nodes};
+    ThreadPool& workers{*numa_workers_[node_index]};
+    tasks.emplace_back(workers.submit([&fn, &workers, node_index, num_nodes, num_node_parts]() {
+      workers.parallel_for(num_node_parts,
+                           [&](const size_t i) { fn(node_index + i * num_nodes); });
+    }));
+  }
+
+  // Tasks reference the stack of this function. So they must have all completed before we leave,
+  // even if one of them fails.
+  std::exception_ptr error;
+  for (auto& task : tasks) {
+    try {
+      task.get();
+    } catch (...) {
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
 template <typename Key>
 size_t HashMapBackend<Key>::size(const std::string& table_name) const {
   const std::shared_lock lock(read_write_guard_);
@@ -94,7 +245,7 @@ size_t HashMapBackend<Key>::contains(const std::string& table_name, const size_t
     std::atomic<size_t> joint_hit_count{0};
     std::atomic<size_t> joint_skip_count{0};
 
-    HCTR_HPS_DB_PARALLEL_FOR_EACH_PART_({
+    HCTR_HPS_HASH_MAP_PARALLEL_FOR_EACH_PART_({
       const Partition& part{parts[part_index]};
 
       size_t hit_count{0};
@@ -142,7 +293,7 @@ size_t HashMapBackend<Key>::insert(const std::string& table_name, const size_t n
 
     parts.reserve(this->params_.num_partitions);
     while (parts.size() < this->params_.num_partitions) {
-      parts.emplace_back(value_size, this->params_);
+      parts.emplace_back(value_size, this->params_, numa_node_of_part_(parts.size()));
     }
   }
 
@@ -159,6 +310,7 @@ size_t HashMapBackend<Key>::insert(const std::string& table_name, const size_t n
     const size_t part_index{num_partitions == 1 ? 0 : HCTR_HPS_KEY_TO_PART_INDEX_(*keys)};
     Partition& part{parts[part_index]};
     HCTR_CHECK(part.value_size == value_size);
+    apply_access_log_(part);
 
     // Step through batch-by-batch.
     for (const Key* k{keys}; k != keys_end;) {
@@ -180,9 +332,10 @@ size_t HashMapBackend<Key>::insert(const std::string& table_name, const size_t n
   } else {
     std::atomic<size_t> joint_num_inserts{0};
 
-    HCTR_HPS_DB_PARALLEL_FOR_EACH_PART_({
+    HCTR_HPS_HASH_MAP_PARALLEL_FOR_EACH_PART_({
       Partition& part{parts[part_index]};
       HCTR_CHECK(part.value_size == value_size);
+      apply_access_log_(part);
 
       size_t num_inserts{0};
 
@@ -216,6 +369,114 @@ size_t HashMapBackend<Key>::insert(const std::string& table_name, const size_t n
   return num_inserts;
 }
 
+/**
+ * Copies a value of `N` bytes. For the common embedding widths, the compiler fully unrolls the
+ * loop into unaligned vector moves of the widest available instruction set.
+ */
+template <size_t N>
+inline void copy_value_n(const char* const __restrict src, char* const __restrict dst) {
+#if defined(__AVX512F__)
+  static_assert(N % sizeof(__m512i) == 0);
+  for (size_t i{0}; i < N; i += sizeof(__m512i)) {
+    _mm512_storeu_si512(&dst[i], _mm512_loadu_si512(&src[i]));
+  }
+#elif defined(__AVX__)
+  static_assert(N % sizeof(__m256i) == 0);
+  for (size_t i{0}; i < N; i += sizeof(__m256i)) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(&dst[i]),
+                        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&src[i])));
+  }
+#elif defined(__SSE2__)
+  static_assert(N % sizeof(__m128i) == 0);
+  for (size_t i{0}; i < N; i += sizeof(__m128i)) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&dst[i]),
+                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[i])));
+  }
+#else
+  std::memcpy(dst, src, N);
+#endif
+}
+
+inline void copy_value(const char* const src, const uint32_t value_size, char* const dst) {
+  switch (value_size) {
+    case 16 * sizeof(float):
+      copy_value_n<16 * sizeof(float)>(src, dst);
+      break;
+    case 32 * sizeof(float):
+      copy_value_n<32 * sizeof(float)>(src, dst);
+      break;
+    case 64 * sizeof(float):
+      copy_value_n<64 * sizeof(float)>(src, dst);
+      break;
+    case 128 * sizeof(float):
+      copy_value_n<128 * sizeof(float)>(src, dst);
+      break;
+    default:
+      std::copy_n(src, value_size, dst);
+      break;
+  }
+}
+
+/**
+ * Resolves a group of keys in three passes, so that the cache misses of different keys overlap
+ * instead of being serialized:
+ *
+ * 1. Hash all keys and prefetch the control bytes and slots where their probe sequences begin.
+ * 2. Probe the hash map and prefetch the value of each hit.
+ * 3. Update the payload metadata via `on_hit` and copy (or decode) the values to their outputs.
+ */
+template <typename Key>
+template <typename HitOp>
+size_t HashMapBackend<Key>::fetch_group_(Partition& part, const Key* const* const group,
+                                         const size_t group_size, const Key* const keys,
+                                         char* const values, const size_t value_stride,
+                                         const DatabaseMissCallback& on_miss,
+                                         const HitOp& on_hit) const {
+  HCTR_CHECK(group_size <= fetch_group_size);
+  auto& entries{part.entries};
+  const uint32_t value_size{part.value_size};
+  const DatabaseValueCodec_t value_codec{part.value_codec};
+
+  size_t hashes[fetch_group_size];
+  for (size_t i{0}; i < group_size; ++i) {
+    hashes[i] = entries.hash(*group[i]);
+    entries.prefetch_hash(hashes[i]);
+  }
+
+  Payload* payloads[fetch_group_size];
+  for (size_t i{0}; i < group_size; ++i) {
+    const auto& it{entries.find(*group[i], hashes[i])};
+    if (it != entries.end()) {
+      payloads[i] = &it->second;
+      const char* const value{payloads[i]->value};
+      for (size_t j{0}; j < part.encoded_value_size; j += 64) {
+        __builtin_prefetch(&value[j], 0, 3);
+      }
+    } else {
+      payloads[i] = nullptr;
+    }
+  }
+
+  size_t miss_count{0};
+  for (size_t i{0}; i < group_size; ++i) {
+    const Key* const k{group[i]};
+    const size_t k_index{static_cast<size_t>(k - keys)};
+    if (payloads[i]) {
+      on_hit(*payloads[i], k);
+      if (value_codec == DatabaseValueCodec_t::None) {
+        copy_value(payloads[i]->value, value_size, &values[k_index * value_stride]);
+      } else {
+        value_codec_decode(value_codec, payloads[i]->value, value_size,
+                           &values[k_index * value_stride]);
+      }
+    } else {
+      on_miss(k_index);
+      ++miss_count;
+    }
+  }
+  return miss_count;
+}
+
 template <typename Key>
 size_t HashMapBackend<Key>::fetch(const std::string& table_name, const size_t num_keys,
                                   const Key* const keys, char* const values,
@@ -235,6 +496,8 @@ size_t HashMapBackend<Key>::fetch(const std::string& table_name, const size_t nu
   const size_t num_partitions{parts.size()};
   const size_t max_batch_size{this->params_.max_batch_size};
   const DatabaseOverflowPolicy_t overflow_policy{this->params_.overflow_policy};
+  const DatabaseAccessTracking_t access_tracking{this->params_.access_tracking};
+  const size_t access_sample_rate{std::max<size_t>(this->params_.access_sample_rate, 1)};
 
   size_t miss_count{0};
   size_t skip_count{0};
@@ -247,13 +510,14 @@ size_t HashMapBackend<Key>::fetch(const std::string& table_name, const size_t nu
     HCTR_CHECK(part.value_size <= value_stride);
 
     // Step through input batch-by-batch.
+    std::vector<Key> access_buffer;
     std::chrono::nanoseconds elapsed;
     for (const Key* k{keys}; k != keys_end;) {
       HCTR_HPS_DB_CHECK_TIME_BUDGET_(SEQUENTIAL_DIRECT, on_miss);
 
       const size_t prev_miss_count{miss_count};
       const size_t batch_size{std::min<size_t>(keys_end - k, max_batch_size)};
-      HCTR_HPS_HASH_MAP_FETCH_(SEQUENTIAL_DIRECT);
+      HCTR_HPS_HASH_MAP_FETCH_GROUPED_(SEQUENTIAL_DIRECT);
 
       HCTR_LOG_C(TRACE, WORLD, get_name(), " backend; Partition ", table_name, '/', part_index,
                  ", batch ", (k - keys - 1) / max_batch_size, ": ",
@@ -264,13 +528,14 @@ size_t HashMapBackend<Key>::fetch(const std::string& table_name, const size_t nu
     std::atomic<size_t> joint_miss_count{0};
     std::atomic<size_t> joint_skip_count{0};
 
-    HCTR_HPS_DB_PARALLEL_FOR_EACH_PART_({
+    HCTR_HPS_HASH_MAP_PARALLEL_FOR_EACH_PART_({
       Partition& part{parts[part_index]};
       HCTR_CHECK(part.value_size <= value_stride);
 
       size_t miss_count{0};
 
       // Step through input batch-by-batch.
+      std::vector<Key> access_buffer;
       std::chrono::nanoseconds elapsed;
       size_t num_batches{0};
       for (const Key* k{keys}; k != keys_end; ++num_batches) {
@@ -278,7 +543,7 @@ size_t HashMapBackend<Key>::fetch(const std::string& table_name, const size_t nu
 
         const size_t prev_miss_count{miss_count};
         size_t batch_size{0};
-        HCTR_HPS_HASH_MAP_FETCH_(PARALLEL_DIRECT);
+        HCTR_HPS_HASH_MAP_FETCH_GROUPED_(PARALLEL_DIRECT);
 
         HCTR_LOG_C(TRACE, WORLD, get_name(), " backend; Partition ", table_name, '/', part_index,
                    ", batch ", num_batches, ": ", batch_size - miss_count + prev_miss_count, " / ",
@@ -320,6 +585,8 @@ size_t HashMapBackend<Key>::fetch(const std::string& table_name, const size_t nu
   const size_t num_partitions{parts.size()};
   const size_t max_batch_size{this->params_.max_batch_size};
   const DatabaseOverflowPolicy_t overflow_policy{this->params_.overflow_policy};
+  const DatabaseAccessTracking_t access_tracking{this->params_.access_tracking};
+  const size_t access_sample_rate{std::max<size_t>(this->params_.access_sample_rate, 1)};
 
   size_t miss_count{0};
   size_t skip_count{0};
@@ -332,13 +599,14 @@ size_t HashMapBackend<Key>::fetch(const std::string& table_name, const size_t nu
     HCTR_CHECK(part.value_size <= value_stride);
 
     // Step through input batch-by-batch.
+    std::vector<Key> access_buffer;
     std::chrono::nanoseconds elapsed;
     for (const size_t* i{indices}; i != indices_end;) {
       HCTR_HPS_DB_CHECK_TIME_BUDGET_(SEQUENTIAL_INDIRECT, on_miss);
 
       const size_t prev_miss_count{miss_count};
       const size_t batch_size{std::min<size_t>(indices_end - i, max_batch_size)};
-      HCTR_HPS_HASH_MAP_FETCH_(SEQUENTIAL_INDIRECT);
+      HCTR_HPS_HASH_MAP_FETCH_GROUPED_(SEQUENTIAL_INDIRECT);
 
       HCTR_LOG_C(TRACE, WORLD, get_name(), " backend; Partition ", table_name, '/', part_index,
                  ", batch ", (i - indices - 1) / max_batch_size, ": ",
@@ -349,13 +617,14 @@ size_t HashMapBackend<Key>::fetch(const std::string& table_name, const size_t nu
     std::atomic<size_t> joint_miss_count{0};
     std::atomic<size_t> joint_skip_count{0};
 
-    HCTR_HPS_DB_PARALLEL_FOR_EACH_PART_({
+    HCTR_HPS_HASH_MAP_PARALLEL_FOR_EACH_PART_({
       Partition& part{parts[part_index]};
       HCTR_CHECK(part.value_size <= value_stride);
 
       size_t miss_count{0};
 
       // Step through input batch-by-batch.
+      std::vector<Key> access_buffer;
       std::chrono::nanoseconds elapsed;
       size_t num_batches{0};
       for (const size_t* i{indices}; i != indices_end; ++num_batches) {
@@ -363,7 +632,7 @@ size_t HashMapBackend<Key>::fetch(const std::string& table_name, const size_t nu
 
         const size_t prev_miss_count{miss_count};
         size_t batch_size{0};
-        HCTR_HPS_HASH_MAP_FETCH_(PARALLEL_INDIRECT);
+        HCTR_HPS_HASH_MAP_FETCH_GROUPED_(PARALLEL_INDIRECT);
 
         HCTR_LOG_C(TRACE, WORLD, get_name(), " backend; Partition ", table_name, '/', part_index,
                    ", batch ", num_batches, ": ", batch_size - miss_count + prev_miss_count, " / ",
@@ -444,7 +713,7 @@ size_t HashMapBackend<Key>::evict(const std::string& table_name, const size_t nu
   } else {
     std::atomic<size_t> joint_num_deletions{0};
 
-    HCTR_HPS_DB_PARALLEL_FOR_EACH_PART_({
+    HCTR_HPS_HASH_MAP_PARALLEL_FOR_EACH_PART_({
       Partition& part{parts[part_index]};
 
       size_t num_deletions{0};
@@ -502,13 +771,15 @@ size_t HashMapBackend<Key>::dump_bin(const std::string& table_name, std::ofstrea
   const uint32_t value_size{parts.empty() ? 0 : parts.front().value_size};
   file.write(reinterpret_cast<const char*>(&value_size), sizeof(uint32_t));
 
-  // Store values.
+  // Store values. Encoded values are expanded again, so that dumps do not depend on the codec.
   size_t num_entries{0};
+  std::vector<char> value(value_size);
 
   for (const Partition& part : parts) {
     for (const Entry& entry : part.entries) {
       file.write(reinterpret_cast<const char*>(&entry.first), sizeof(Key));
-      file.write(entry.second.value, value_size);
+      value_codec_decode(part.value_codec, entry.second.value, value_size, value.data());
+      file.write(value.data(), value_size);
     }
     num_entries += part.entries.size();
   }
@@ -545,11 +816,15 @@ size_t HashMapBackend<Key>::dump_sst(const std::string& table_name, rocksdb::Sst
 
   // Iterate over pairs and insert.
   rocksdb::Slice k_view{nullptr, sizeof(Key)};
-  rocksdb::Slice v_view{nullptr, parts.empty() ? 0 : parts.front().value_size};
+  const uint32_t value_size{parts.empty() ? 0 : parts.front().value_size};
+  const DatabaseValueCodec_t value_codec{parts.empty() ? DatabaseValueCodec_t::None
+                                                      : parts.front().value_codec};
+  std::vector<char> value(value_size);
+  rocksdb::Slice v_view{value.data(), value_size};
 
   for (const Entry* const entry : entries) {
     k_view.data_ = reinterpret_cast<const char*>(&entry->first);
-    v_view.data_ = entry->second.value;
+    value_codec_decode(value_codec, entry->second.value, value_size, value.data());
     HCTR_ROCKSDB_CHECK(file.Put(k_view, v_view));
   }
 
@@ -562,6 +837,9 @@ size_t HashMapBackend<Key>::resolve_overflow_(const std::string& table_name,
                                               const size_t part_index, Partition& part) {
   const size_t max_batch_size{this->params_.max_batch_size};
 
+  // Make sure the eviction metadata reflects all accesses recorded so far.
+  apply_access_log_(part);
+
   size_t num_deletions{0};
 
   switch (this->params_.overflow_policy) {
@@ -687,6 +965,123 @@ size_t HashMapBackend<Key>::resolve_overflow_(const std::string& table_name,
   return num_deletions;
 }
 
+namespace {
+
+// Index of the access log that the calling thread appends to. Consecutive threads get distinct
+// logs, so fetches running in parallel do not touch the same cache lines.
+size_t access_log_slot() {
+  static std::atomic<size_t> next_slot{0};
+  thread_local const size_t slot{next_slot.fetch_add(1, std::memory_order_relaxed)};
+  return slot;
+}
+
+}  // namespace
+
+template <typename Key>
+void HashMapBackend<Key>::record_accesses_(Partition& part, const std::vector<Key>& keys,
+                                           const size_t num_hits) const {
+  if (keys.empty() || !part.access_logs) {
+    return;
+  }
+  const time_t now{access_clock_.load(std::memory_order_relaxed)};
+  const size_t sample_rate{std::max<size_t>(this->params_.access_sample_rate, 1)};
+
+  // Claim the log of this thread. If it is taken, we move on to the next free one.
+  std::vector<AccessLog>& logs{part.access_logs->logs};
+  const size_t num_logs{logs.size()};
+  const size_t capacity{std::max<size_t>(this->params_.access_log_capacity / num_logs, 1)};
+  const size_t slot{access_log_slot()};
+  size_t num_records{0};
+  bool drain{false};
+  for (size_t i{0}; i < num_logs; ++i) {
+    AccessLog& log{logs[(slot + i) % num_logs]};
+    if (log.busy.test_and_set(std::memory_order_acquire)) {
+      continue;
+    }
+
+    // If the log is saturated, we drop the excess records (i.e., the log is sampled more coarsely).
+    num_records =
+        std::min(keys.size(), capacity > log.records.size() ? capacity - log.records.size() : 0);
+
+    // The k-th sampled key represents itself and the hits skipped until the next sample. Only the
+    // last one of a batch may stand for fewer than `sample_rate` hits.
+    for (size_t k{0}; k < num_records; ++k) {
+      log.records.push_back({keys[k], now, std::min(sample_rate, num_hits - k * sample_rate)});
+    }
+    drain = log.records.size() >= capacity / 2;
+
+    log.busy.clear(std::memory_order_release);
+    break;
+  }
+
+  if (num_records < keys.size()) {
+    if (num_access_dropped_.fetch_add(keys.size() - num_records, std::memory_order_relaxed) == 0) {
+      HCTR_LOG_S(WARNING, WORLD) << get_name() << ": Access log full, dropping records. Consider "
+                                 << "raising the access log capacity or the sample rate."
+                                 << std::endl;
+    }
+  }
+
+  // Fold the logs in before they overflow. Under read-only load, nothing else would.
+  if (drain) {
+    apply_access_log_(part);
+  }
+}
+
+template <typename Key>
+size_t HashMapBackend<Key>::apply_access_log_(Partition& part) const {
+  if (!part.access_logs) {
+    return 0;
+  }
+
+  // Invoked under the shared or the exclusive lock. Only the holder of `draining` may alter the
+  // payload metadata; concurrent fetches neither read nor write it.
+  AccessLogs& logs{*part.access_logs};
+  if (logs.draining.test_and_set(std::memory_order_acquire)) {
+    return 0;
+  }
+
+  size_t num_records{0};
+  for (AccessLog& log : logs.logs) {
+    // A log that is being appended to is left for the next drain.
+    if (log.busy.test_and_set(std::memory_order_acquire)) {
+      continue;
+    }
+
+    switch (this->params_.overflow_policy) {
+      case DatabaseOverflowPolicy_t::EvictRandom:
+        break;
+
+      case DatabaseOverflowPolicy_t::EvictLeastUsed: {
+        for (const AccessRecord& record : log.records) {
+          const auto& it{part.entries.find(record.key)};
+          if (it != part.entries.end()) {
+            it->second.access_count += record.weight;
+          }
+        }
+      } break;
+
+      case DatabaseOverflowPolicy_t::EvictOldest: {
+        for (const AccessRecord& record : log.records) {
+          const auto& it{part.entries.find(record.key)};
+          if (it != part.entries.end()) {
+            it->second.last_access = std::max(it->second.last_access, record.time);
+          }
+        }
+      } break;
+    }
+
+    num_records += log.records.size();
+    log.records.clear();
+    log.busy.clear(std::memory_order_release);
+  }
+
+  logs.draining.clear(std::memory_order_release);
+  num_access_applied_.fetch_add(num_records, std::memory_order_relaxed);
+  num_access_drains_.fetch_add(1, std::memory_order_relaxed);
+  return num_records;
+}
+
 template class HashMapBackend<unsigned int>;
 template class HashMapBackend<long long>;
 
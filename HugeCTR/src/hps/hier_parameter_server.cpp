@@ -101,6 +101,12 @@ HierParameterServer<TypeHashKey>::HierParameterServer(const parameter_server_con
                    "Wrong input: The size of parameter server parameters are not correct.");
   }
 
+  if (!ps_config_.key_trace_path.empty()) {
+    key_trace_ = std::make_unique<KeyTraceWriter>(
+        ps_config_.key_trace_path, static_cast<uint32_t>(sizeof(TypeHashKey)),
+        ps_config_.key_trace_max_size);
+  }
+
   // Connect to volatile database.
   {
     const auto& conf = inference_params_array[0].volatile_db;
@@ -118,6 +124,11 @@ HierParameterServer<TypeHashKey>::HierParameterServer(const parameter_server_con
             conf.overflow_policy,
             conf.overflow_resolution_target,
             conf.allocation_rate,
+            conf.access_tracking,
+            conf.access_sample_rate,
+            conf.access_log_capacity,
+            conf.value_codec,
+            conf.numa_placement,
         };
         volatile_db_ = std::make_unique<HashMapBackend<TypeHashKey>>(params);
       } break;
@@ -125,6 +136,10 @@ HierParameterServer<TypeHashKey>::HierParameterServer(const parameter_server_con
       case DatabaseType_t::MultiProcessHashMap: {
         HCTR_LOG_S(INFO, WORLD) << "Creating Multi-Process HashMap CPU database backend..."
                                 << std::endl;
+        // Access logs live in process memory and cannot be drained by other processes.
+        HCTR_CHECK_HINT(conf.access_tracking != DatabaseAccessTracking_t::Deferred,
+                        "Deferred access tracking is not supported by the multi-process hash map "
+                        "backend!");
         MultiProcessHashMapBackendParams params{
             conf.max_batch_size,
             conf.num_partitions,
@@ -136,6 +151,7 @@ HierParameterServer<TypeHashKey>::HierParameterServer(const parameter_server_con
             conf.shared_memory_name,
             std::chrono::milliseconds{100},  // heart_beat_frequency
             conf.shared_memory_auto_remove,
+            conf.value_codec,
         };
         volatile_db_ = std::make_unique<MultiProcessHashMapBackend<TypeHashKey>>(params);
       } break;
@@ -158,6 +174,12 @@ HierParameterServer<TypeHashKey>::HierParameterServer(const parameter_server_con
             conf.tls_client_certificate,
             conf.tls_client_key,
             conf.tls_server_name_identification,
+            conf.num_slots_per_partition,
+            conf.num_refresh_workers,
+            std::chrono::milliseconds{conf.refresh_window_ms},
+            conf.max_pending_refreshes,
+            {conf.near_cache_capacity, NearCacheParams{}.num_shards,
+             std::chrono::milliseconds{conf.near_cache_ttl_ms}},
         };
         volatile_db_ = std::make_unique<RedisClusterBackend<TypeHashKey>>(params);
       } break;
@@ -400,6 +422,31 @@ void HierParameterServer<TypeHashKey>::update_database_per_model(
             inference_params.update_source.failure_backoff_ms,
             inference_params.update_source.max_commit_interval);
       }
+#ifdef HCTR_USE_REDIS
+      // Near cache invalidation. Shared databases are updated by only one consumer in the group.
+      // However, each process needs to see all updates to keep its near cache coherent.
+      if (volatile_db_ && !inference_params.volatile_db.update_filters.empty() &&
+          inference_params.volatile_db.type == DatabaseType_t::RedisCluster &&
+          inference_params.volatile_db.near_cache_capacity > 0) {
+        std::ostringstream consumer_group;
+        consumer_group << kafka_group_prefix << "volatile.near_cache." << host_name << '.'
+                       << getpid();
+
+        std::vector<std::string> tag_filters;
+        std::transform(inference_params.volatile_db.update_filters.begin(),
+                       inference_params.volatile_db.update_filters.end(),
+                       std::back_inserter(tag_filters), kafka_prepare_filter);
+
+        volatile_db_near_cache_source_ = std::make_unique<KafkaMessageSource<TypeHashKey>>(
+            inference_params.update_source.brokers, consumer_group.str(), tag_filters,
+            inference_params.update_source.metadata_refresh_interval_ms,
+            inference_params.update_source.receive_buffer_size,
+            inference_params.update_source.poll_timeout_ms,
+            inference_params.update_source.max_batch_size,
+            inference_params.update_source.failure_backoff_ms,
+            inference_params.update_source.max_commit_interval);
+      }
+#endif  // HCTR_USE_REDIS
       // Persistent database updates.
       if (persistent_db_ && !inference_params.persistent_db.update_filters.empty()) {
         std::ostringstream consumer_group;
@@ -444,6 +491,20 @@ void HierParameterServer<TypeHashKey>::update_database_per_model(
     });
   }
 
+#ifdef HCTR_USE_REDIS
+  if (volatile_db_near_cache_source_) {
+    auto* const db{static_cast<RedisClusterBackend<TypeHashKey>*>(volatile_db_.get())};
+    volatile_db_near_cache_source_->engage([db](const std::string& tag, const size_t num_pairs,
+                                                const TypeHashKey* keys, const char* values,
+                                                const size_t value_size) {
+      HCTR_LOG_C(TRACE, WORLD, "Volatile DB near cache update for tag: '", tag,
+                 "', num_pairs: ", num_pairs, ", value_size: ", value_size, " bytes\n");
+      db->update_near_cache(tag, num_pairs, keys, values, static_cast<uint32_t>(value_size),
+                            value_size);
+    });
+  }
+#endif  // HCTR_USE_REDIS
+
   if (persistent_db_source_) {
     persistent_db_source_->engage([&](const std::string& tag, const size_t num_pairs,
                                       const TypeHashKey* keys, const char* values,
@@ -759,6 +820,10 @@ void HierParameterServer<TypeHashKey>::lookup(const void* const h_keys, const si
   const std::string& tag_name = make_tag_name(model_name, embedding_table_name);
   const float default_vec_value = ps_config_.default_emb_vec_value_[*model_id][table_id];
 
+  if (key_trace_) {
+    key_trace_->write(tag_name, h_keys, length);
+  }
+
 #ifdef ENABLE_INFERENCE
   HCTR_LOG_S(TRACE, WORLD) << "Looking up " << length << " embeddings (each with " << embedding_size
                            << " values)..." << std::endl;
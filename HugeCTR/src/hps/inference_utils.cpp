@@ -36,15 +36,25 @@ bool VolatileDatabaseParams::operator==(const VolatileDatabaseParams& p) const {
          // Backend specific.
          address == p.address && user_name == p.user_name && password == p.password &&
          num_partitions == p.num_partitions && allocation_rate == p.allocation_rate &&
+         value_codec == p.value_codec && numa_placement == p.numa_placement &&
          shared_memory_size == p.shared_memory_size && shared_memory_name == p.shared_memory_name &&
          shared_memory_auto_remove == p.shared_memory_auto_remove &&
-         num_node_connections == p.num_node_connections && max_batch_size == p.max_batch_size &&
+         num_node_connections == p.num_node_connections &&
+         num_slots_per_partition == p.num_slots_per_partition &&
+         num_refresh_workers == p.num_refresh_workers &&
+         refresh_window_ms == p.refresh_window_ms &&
+         max_pending_refreshes == p.max_pending_refreshes &&
+         near_cache_capacity == p.near_cache_capacity &&
+         near_cache_ttl_ms == p.near_cache_ttl_ms &&
+         max_batch_size == p.max_batch_size &&
          enable_tls == p.enable_tls && tls_ca_certificate == p.tls_ca_certificate &&
          tls_client_certificate == p.tls_client_certificate && tls_client_key == p.tls_client_key &&
          tls_server_name_identification == p.tls_server_name_identification &&
          // Overflow handling related.
          overflow_margin == p.overflow_margin && overflow_policy == p.overflow_policy &&
          overflow_resolution_target == p.overflow_resolution_target &&
+         access_tracking == p.access_tracking && access_sample_rate == p.access_sample_rate &&
+         access_log_capacity == p.access_log_capacity &&
          // Caching behavior related.
          initialize_after_startup == p.initialize_after_startup &&
          initial_cache_rate == p.initial_cache_rate &&
@@ -450,6 +460,9 @@ void parameter_server_config::init(const std::string& hps_json_config_file) {
 
     params.allocation_rate =
         get_value_from_json_soft(volatile_db, "allocation_rate", params.allocation_rate);
+    params.value_codec = get_hps_value_codec(volatile_db, "value_codec", params.value_codec);
+    params.numa_placement =
+        get_hps_numa_placement(volatile_db, "numa_placement", params.numa_placement);
 
     params.shared_memory_size =
         get_value_from_json_soft(volatile_db, "shared_memory_size", params.shared_memory_size);
@@ -460,6 +473,18 @@ void parameter_server_config::init(const std::string& hps_json_config_file) {
 
     params.num_node_connections =
         get_value_from_json_soft(volatile_db, "num_node_connections", params.num_node_connections);
+    params.num_slots_per_partition = get_value_from_json_soft(
+        volatile_db, "num_slots_per_partition", params.num_slots_per_partition);
+    params.num_refresh_workers =
+        get_value_from_json_soft(volatile_db, "num_refresh_workers", params.num_refresh_workers);
+    params.refresh_window_ms =
+        get_value_from_json_soft(volatile_db, "refresh_window_ms", params.refresh_window_ms);
+    params.max_pending_refreshes = get_value_from_json_soft(volatile_db, "max_pending_refreshes",
+                                                            params.max_pending_refreshes);
+    params.near_cache_capacity =
+        get_value_from_json_soft(volatile_db, "near_cache_capacity", params.near_cache_capacity);
+    params.near_cache_ttl_ms =
+        get_value_from_json_soft(volatile_db, "near_cache_ttl_ms", params.near_cache_ttl_ms);
 
     params.max_batch_size =
         get_value_from_json_soft(volatile_db, "max_batch_size", params.max_batch_size);
@@ -481,6 +506,12 @@ void parameter_server_config::init(const std::string& hps_json_config_file) {
         get_hps_overflow_policy(volatile_db, "overflow_policy", params.overflow_policy);
     params.overflow_resolution_target = get_value_from_json_soft(
         volatile_db, "overflow_resolution_target", params.overflow_resolution_target);
+    params.access_tracking =
+        get_hps_access_tracking(volatile_db, "access_tracking", params.access_tracking);
+    params.access_sample_rate =
+        get_value_from_json_soft(volatile_db, "access_sample_rate", params.access_sample_rate);
+    params.access_log_capacity =
+        get_value_from_json_soft(volatile_db, "access_log_capacity", params.access_log_capacity);
 
     // Caching behavior related.
     params.initial_cache_rate =
@@ -503,6 +534,11 @@ void parameter_server_config::init(const std::string& hps_json_config_file) {
   this->persistent_db = persistent_db_params;
   this->update_source = update_source_params;
 
+  //****Key trace parameters.
+  this->key_trace_path = get_value_from_json_soft(hps_config, "key_trace_path", key_trace_path);
+  this->key_trace_max_size =
+      get_value_from_json_soft(hps_config, "key_trace_max_size", key_trace_max_size);
+
   // Search for all model configuration
   const nlohmann::json& models = get_json(hps_config, "models");
   HCTR_CHECK_HINT(models.size() > 0,
@@ -992,4 +1028,103 @@ DatabaseOverflowPolicy_t get_hps_overflow_policy(const nlohmann::json& json, con
   return default_value;
 }
 
+DatabaseAccessTracking_t get_hps_access_tracking(const nlohmann::json& json, const std::string& key,
+                                                 const DatabaseAccessTracking_t default_value) {
+  if (json.find(key) == json.end()) {
+    return default_value;
+  }
+  std::string tmp = get_value_from_json<std::string>(json, key);
+  DatabaseAccessTracking_t enum_value;
+  std::unordered_set<const char*> names;
+
+  enum_value = DatabaseAccessTracking_t::Immediate;
+  names = {hctr_enum_to_c_str(enum_value), "direct"};
+  for (const char* name : names)
+    if (tmp == name) {
+      return enum_value;
+    }
+
+  enum_value = DatabaseAccessTracking_t::Deferred;
+  names = {hctr_enum_to_c_str(enum_value), "lazy", "sampled"};
+  for (const char* name : names)
+    if (tmp == name) {
+      return enum_value;
+    }
+
+  return default_value;
+}
+
+DatabaseValueCodec_t get_hps_value_codec(const nlohmann::json& json, const std::string& key,
+                                         const DatabaseValueCodec_t default_value) {
+  if (json.find(key) == json.end()) {
+    return default_value;
+  }
+  std::string tmp = get_value_from_json<std::string>(json, key);
+  DatabaseValueCodec_t enum_value;
+  std::unordered_set<const char*> names;
+
+  enum_value = DatabaseValueCodec_t::None;
+  names = {hctr_enum_to_c_str(enum_value), "fp32", "raw"};
+  for (const char* name : names)
+    if (tmp == name) {
+      return enum_value;
+    }
+
+  enum_value = DatabaseValueCodec_t::FP16;
+  names = {hctr_enum_to_c_str(enum_value), "half", "float16"};
+  for (const char* name : names)
+    if (tmp == name) {
+      return enum_value;
+    }
+
+  enum_value = DatabaseValueCodec_t::BF16;
+  names = {hctr_enum_to_c_str(enum_value), "bfloat16"};
+  for (const char* name : names)
+    if (tmp == name) {
+      return enum_value;
+    }
+
+  enum_value = DatabaseValueCodec_t::Int8;
+  names = {hctr_enum_to_c_str(enum_value), "int8_scaled"};
+  for (const char* name : names)
+    if (tmp == name) {
+      return enum_value;
+    }
+
+  return default_value;
+}
+
+DatabaseNumaPlacement_t get_hps_numa_placement(const nlohmann::json& json, const std::string& key,
+                                               const DatabaseNumaPlacement_t default_value) {
+  if (json.find(key) == json.end()) {
+    return default_value;
+  }
+  std::string tmp = get_value_from_json<std::string>(json, key);
+  DatabaseNumaPlacement_t enum_value;
+  std::unordered_set<const char*> names;
+
+  enum_value = DatabaseNumaPlacement_t::Default;
+  names = {hctr_enum_to_c_str(enum_value), "none", "os"};
+  for (const char* name : names)
+    if (tmp == name) {
+      return enum_value;
+    }
+
+  enum_value = DatabaseNumaPlacement_t::Local;
+  names = {hctr_enum_to_c_str(enum_value), "node_local", "numa_local"};
+  for (const char* name : names)
+    if (tmp == name) {
+      return enum_value;
+    }
+
+  enum_value = DatabaseNumaPlacement_t::Interleaved;
+  names = {hctr_enum_to_c_str(enum_value), "interleave"};
+  for (const char* name : names)
+    if (tmp == name) {
+      return enum_value;
+    }
+
+  return default_value;
+}
+
 }  // namespace HugeCTR
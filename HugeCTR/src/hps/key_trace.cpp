@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <core23/logger.hpp>
+#include <cstring>
+#include <hps/key_trace.hpp>
+
+namespace HugeCTR {
+
+KeyTraceWriter::KeyTraceWriter(const std::string& path, const uint32_t key_size,
+                               const size_t max_size)
+    : path_{path},
+      key_size_{key_size},
+      max_size_{max_size},
+      begin_{std::chrono::steady_clock::now()},
+      file_{path, std::ios::binary | std::ios::trunc} {
+  HCTR_CHECK(key_size == sizeof(uint32_t) || key_size == sizeof(uint64_t));
+  HCTR_CHECK_HINT(file_.is_open(), "Unable to open key trace file '", path, "'.");
+
+  // Write header.
+  file_.write(KEY_TRACE_MAGIC, sizeof(KEY_TRACE_MAGIC));
+  file_.write(reinterpret_cast<const char*>(&key_size_), sizeof(uint32_t));
+  size_ = sizeof(KEY_TRACE_MAGIC) + sizeof(uint32_t);
+  if (!file_.good()) {
+    HCTR_LOG_C(ERROR, WORLD, "Writing to key trace '", path_,
+               "' failed. Lookups will not be recorded.\n");
+    failed_ = true;
+  }
+
+  thread_ = std::thread(&KeyTraceWriter::run_, this);
+
+  HCTR_LOG_C(INFO, WORLD, "Recording lookup keys to '", path_, "' (max. ", max_size_,
+             " bytes).\n");
+}
+
+KeyTraceWriter::~KeyTraceWriter() {
+  {
+    const std::lock_guard lock(guard_);
+    terminate_ = true;
+  }
+  semaphore_.notify_one();
+  thread_.join();
+
+  file_.close();
+  HCTR_LOG_C(INFO, WORLD, "Key trace '", path_, "': ", num_records_.load(), " lookups recorded, ",
+             num_dropped_.load(), " dropped, ", size_, " bytes.\n");
+}
+
+void KeyTraceWriter::write(const std::string& tag, const void* const keys, const size_t num_keys) {
+  if (failed_.load(std::memory_order_relaxed)) {
+    num_dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  const uint64_t time{static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                           begin_)
+          .count())};
+  const uint32_t tag_size{static_cast<uint32_t>(tag.size())};
+  const uint64_t num_keys_64{num_keys};
+  const size_t record_size{sizeof(uint32_t) + tag.size() + 2 * sizeof(uint64_t) +
+                           num_keys * key_size_};
+
+  bool accepted{false};
+  bool flush{false};
+  {
+    const std::lock_guard lock(guard_);
+    if (size_ + record_size > max_size_) {
+      if (!size_limit_reached_) {
+        size_limit_reached_ = true;
+        HCTR_LOG_C(WARNING, WORLD, "Key trace '", path_,
+                   "' reached its size limit. Further lookups are not recorded.\n");
+      }
+    } else if (pending_.size() + record_size > max_pending_size) {
+      if (!buffer_overflowed_) {
+        buffer_overflowed_ = true;
+        HCTR_LOG_C(WARNING, WORLD, "Key trace '", path_,
+                   "' cannot keep up with the lookups. Dropping records.\n");
+      }
+    } else {
+      // Encode record.
+      const size_t offset{pending_.size()};
+      pending_.resize(offset + record_size);
+      char* dst{&pending_[offset]};
+      std::memcpy(dst, &tag_size, sizeof(uint32_t));
+      dst += sizeof(uint32_t);
+      std::memcpy(dst, tag.data(), tag.size());
+      dst += tag.size();
+      std::memcpy(dst, &time, sizeof(uint64_t));
+      dst += sizeof(uint64_t);
+      std::memcpy(dst, &num_keys_64, sizeof(uint64_t));
+      dst += sizeof(uint64_t);
+      std::memcpy(dst, keys, num_keys * key_size_);
+
+      size_ += record_size;
+      ++num_pending_;
+      accepted = true;
+      flush = pending_.size() >= flush_size;
+    }
+  }
+
+  if (!accepted) {
+    num_dropped_.fetch_add(1, std::memory_order_relaxed);
+  } else if (flush) {
+    semaphore_.notify_one();
+  }
+}
+
+void KeyTraceWriter::run_() {
+  Logger::set_thread_name("key trace");
+
+  std::vector<char> buffer;
+  std::unique_lock lock(guard_);
+  while (true) {
+    semaphore_.wait_for(lock, flush_interval,
+                        [this]() { return terminate_ || pending_.size() >= flush_size; });
+
+    // Take the pending records, and write them without blocking `write`.
+    buffer.clear();
+    buffer.swap(pending_);
+    const size_t num_records{num_pending_};
+    num_pending_ = 0;
+    const bool terminate{terminate_};
+    lock.unlock();
+
+    if (num_records) {
+      if (!failed_) {
+        file_.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        if (file_.good()) {
+          num_records_ += num_records;
+        } else {
+          HCTR_LOG_C(ERROR, WORLD, "Writing to key trace '", path_,
+                     "' failed. Further lookups are not recorded.\n");
+          failed_ = true;
+        }
+      }
+      if (failed_) {
+        num_dropped_ += num_records;
+      }
+    }
+    if (terminate) {
+      break;
+    }
+
+    lock.lock();
+  }
+}
+
+KeyTraceReader::KeyTraceReader(const std::string& path) : file_{path, std::ios::binary} {
+  HCTR_CHECK_HINT(file_.is_open(), "Unable to open key trace file '", path, "'.");
+
+  // Parse header.
+  char magic[sizeof(KEY_TRACE_MAGIC)];
+  file_.read(magic, sizeof(magic));
+  HCTR_CHECK(file_);
+  HCTR_CHECK_HINT(std::equal(magic, magic + sizeof(magic), KEY_TRACE_MAGIC),
+                  "'", path, "' is not a key trace.");
+
+  file_.read(reinterpret_cast<char*>(&key_size_), sizeof(uint32_t));
+  HCTR_CHECK(file_);
+  HCTR_CHECK(key_size_ == sizeof(uint32_t) || key_size_ == sizeof(uint64_t));
+}
+
+bool KeyTraceReader::next(std::string& tag, uint64_t& time, std::vector<int64_t>& keys) {
+  uint32_t tag_size;
+  if (!file_.read(reinterpret_cast<char*>(&tag_size), sizeof(uint32_t))) {
+    return false;
+  }
+  tag.resize(tag_size);
+  file_.read(tag.data(), tag_size);
+  file_.read(reinterpret_cast<char*>(&time), sizeof(uint64_t));
+
+  uint64_t num_keys;
+  file_.read(reinterpret_cast<char*>(&num_keys), sizeof(uint64_t));
+  HCTR_CHECK_HINT(file_.good(), "Key trace is truncated.");
+
+  buffer_.resize(num_keys * key_size_);
+  file_.read(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+  HCTR_CHECK_HINT(file_.good(), "Key trace is truncated.");
+
+  keys.resize(num_keys);
+  if (key_size_ == sizeof(uint32_t)) {
+    const uint32_t* const src{reinterpret_cast<const uint32_t*>(buffer_.data())};
+    std::copy_n(src, num_keys, keys.begin());
+  } else {
+    std::memcpy(keys.data(), buffer_.data(), buffer_.size());
+  }
+  return true;
+}
+
+}  // namespace HugeCTR
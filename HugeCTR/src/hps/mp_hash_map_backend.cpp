@@ -588,13 +588,15 @@ size_t MultiProcessHashMapBackend<Key>::dump_bin(const std::string& table_name,
   const uint32_t value_size{parts.empty() ? 0 : parts.front().value_size};
   file.write(reinterpret_cast<const char*>(&value_size), sizeof(uint32_t));
 
-  // Store values.
+  // Store values. Encoded values are expanded again, so that dumps do not depend on the codec.
   size_t num_entries{0};
+  std::vector<char> value(value_size);
 
   for (const Partition& part : parts) {
     for (const Entry& entry : part.entries) {
       file.write(reinterpret_cast<const char*>(&entry.first), sizeof(Key));
-      file.write(entry.second.value.get(), value_size);
+      value_codec_decode(part.value_codec, entry.second.value.get(), value_size, value.data());
+      file.write(value.data(), value_size);
     }
     num_entries += part.entries.size();
   }
@@ -632,11 +634,15 @@ size_t MultiProcessHashMapBackend<Key>::dump_sst(const std::string& table_name,
 
   // Iterate over pairs and insert.
   rocksdb::Slice k_view{nullptr, sizeof(Key)};
-  rocksdb::Slice v_view{nullptr, parts.empty() ? 0 : parts.front().value_size};
+  const uint32_t value_size{parts.empty() ? 0 : parts.front().value_size};
+  const DatabaseValueCodec_t value_codec{parts.empty() ? DatabaseValueCodec_t::None
+                                                      : parts.front().value_codec};
+  std::vector<char> value(value_size);
+  rocksdb::Slice v_view{value.data(), value_size};
 
   for (const Entry* const entry : entries) {
     k_view.data_ = reinterpret_cast<const char*>(&entry->first);
-    v_view.data_ = entry->second.value.get();
+    value_codec_decode(value_codec, entry->second.value.get(), value_size, value.data());
     HCTR_ROCKSDB_CHECK(file.Put(k_view, v_view));
   }
 
@@ -0,0 +1,368 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <core23/logger.hpp>
+#include <hps/database_backend_detail.hpp>
+#include <hps/near_cache.hpp>
+
+// TODO: Remove me!
+#pragma GCC diagnostic error "-Wconversion"
+
+namespace HugeCTR {
+
+FrequencySketch::FrequencySketch(const size_t capacity) {
+  size_t num_words{1};
+  while (num_words < capacity) {
+    num_words <<= 1;
+  }
+  table_.resize(num_words, 0);
+  mask_ = num_words - 1;
+  sample_size_ = std::max<size_t>(capacity * 10, 16);
+}
+
+void FrequencySketch::increment(const uint64_t hash) {
+  bool added{false};
+  for (uint64_t row{0}; row < 4; ++row) {
+    const uint64_t h{rrxmrrxmsx_0(hash + row * 0x9e3779b97f4a7c15ULL)};
+    uint64_t& word{table_[h & mask_]};
+    const uint64_t shift{(h >> 60) << 2};  // One of 16 counters in the word.
+    if (((word >> shift) & 0xf) != 0xf) {
+      word += 1ULL << shift;
+      added = true;
+    }
+  }
+  if (added && ++num_samples_ >= sample_size_) {
+    reset_();
+  }
+}
+
+uint32_t FrequencySketch::estimate(const uint64_t hash) const {
+  uint64_t count{0xf};
+  for (uint64_t row{0}; row < 4; ++row) {
+    const uint64_t h{rrxmrrxmsx_0(hash + row * 0x9e3779b97f4a7c15ULL)};
+    const uint64_t shift{(h >> 60) << 2};
+    count = std::min(count, (table_[h & mask_] >> shift) & 0xf);
+  }
+  return static_cast<uint32_t>(count);
+}
+
+void FrequencySketch::reset_() {
+  // Halve all counters (aging).
+  for (uint64_t& word : table_) {
+    word = (word >> 1) & 0x7777777777777777ULL;
+  }
+  num_samples_ /= 2;
+}
+
+template <typename Key>
+NearCache<Key>::Shard::Shard(const size_t capacity, const size_t value_stride)
+    : keys(capacity),
+      stamps(capacity, 0),
+      referenced(capacity, false),
+      values(capacity * value_stride),
+      sketch{capacity} {
+  index.reserve(capacity);
+}
+
+template <typename Key>
+NearCache<Key>::NearCache(const NearCacheParams& params) : params_{params} {
+  HCTR_CHECK(params.num_shards > 0);
+}
+
+template <typename Key>
+typename NearCache<Key>::Table* NearCache<Key>::get_table_(const std::string& table_name) const {
+  const std::shared_lock lock(tables_guard_);
+  const auto it{tables_.find(table_name)};
+  return it != tables_.end() ? it->second.get() : nullptr;
+}
+
+template <typename Key>
+typename NearCache<Key>::Table* NearCache<Key>::get_or_create_table_(const std::string& table_name,
+                                                                     const size_t value_stride) {
+  Table* table{get_table_(table_name)};
+  if (table) {
+    return table;
+  }
+
+  const std::unique_lock lock(tables_guard_);
+  std::unique_ptr<Table>& slot{tables_[table_name]};
+  if (!slot) {
+    const size_t capacity{params_.capacity / value_stride};
+    const size_t num_shards{std::max<size_t>(std::min(params_.num_shards, capacity), 1)};
+    const size_t shard_capacity{std::max<size_t>(capacity / num_shards, 1)};
+
+    slot = std::make_unique<Table>(value_stride);
+    slot->shards.reserve(num_shards);
+    for (size_t i{0}; i < num_shards; ++i) {
+      slot->shards.emplace_back(std::make_unique<Shard>(shard_capacity, value_stride));
+    }
+
+    HCTR_LOG_C(DEBUG, WORLD, "Near cache; Table ", table_name, ": ", num_shards, " x ",
+               shard_capacity, " values (", num_shards * shard_capacity * value_stride,
+               " bytes).\n");
+  }
+  return slot.get();
+}
+
+template <typename Key>
+size_t NearCache<Key>::fetch(const std::string& table_name, const size_t num_indices,
+                             const size_t* const indices, const Key* const keys,
+                             char* const values, const size_t value_stride,
+                             std::vector<size_t>& missing, uint64_t& generation) {
+  missing.clear();
+
+  Table* const table{get_or_create_table_(table_name, value_stride)};
+  generation = table->generation;
+  if (table->value_stride != value_stride) {
+    for (size_t i{0}; i < num_indices; ++i) {
+      missing.emplace_back(indices ? indices[i] : i);
+    }
+    num_misses_ += num_indices;
+    return 0;
+  }
+
+  const int64_t now{Clock::now().time_since_epoch().count()};
+  const int64_t ttl{std::chrono::duration_cast<Clock::duration>(params_.ttl).count()};
+
+  size_t num_hits{0};
+  size_t num_expired{0};
+  int64_t total_age{0};
+  int64_t max_age{0};
+
+  for (size_t i{0}; i < num_indices; ++i) {
+    const size_t idx{indices ? indices[i] : i};
+    const Key& key{keys[idx]};
+    const uint64_t hash{rrxmrrxmsx_0(key)};
+    Shard& shard{*table->shards[hash % table->shards.size()]};
+
+    const std::lock_guard lock(shard.guard);
+    shard.sketch.increment(hash);
+
+    const auto it{shard.index.find(key)};
+    if (it == shard.index.end()) {
+      missing.emplace_back(idx);
+      continue;
+    }
+
+    const uint32_t slot{it->second};
+    const int64_t age{now - shard.stamps[slot]};
+    if (ttl && age > ttl) {
+      missing.emplace_back(idx);
+      ++num_expired;
+      continue;
+    }
+
+    std::copy_n(&shard.values[slot * value_stride], value_stride, &values[idx * value_stride]);
+    shard.referenced[slot] = true;
+
+    ++num_hits;
+    total_age += age;
+    max_age = std::max(max_age, age);
+  }
+
+  num_hits_ += num_hits;
+  num_misses_ += missing.size();
+  num_expired_ += num_expired;
+  total_age_ += total_age;
+  for (int64_t prev_max_age{max_age_}; max_age > prev_max_age;) {
+    if (max_age_.compare_exchange_weak(prev_max_age, max_age)) {
+      break;
+    }
+  }
+
+  return num_hits;
+}
+
+template <typename Key>
+void NearCache<Key>::insert(const std::string& table_name, const size_t num_indices,
+                            const size_t* const indices, const Key* const keys,
+                            const char* const values, const size_t value_stride,
+                            const uint64_t generation) {
+  if (!num_indices) {
+    return;
+  }
+
+  Table* const table{get_or_create_table_(table_name, value_stride)};
+  if (table->value_stride != value_stride) {
+    return;
+  }
+
+  const int64_t now{Clock::now().time_since_epoch().count()};
+
+  size_t num_admitted{0};
+  size_t num_rejected{0};
+
+  for (size_t i{0}; i < num_indices; ++i) {
+    const size_t idx{indices[i]};
+    const Key& key{keys[idx]};
+    const uint64_t hash{rrxmrrxmsx_0(key)};
+    Shard& shard{*table->shards[hash % table->shards.size()]};
+
+    const std::lock_guard lock(shard.guard);
+    if (table->generation != generation) {
+      // Values might have been changed while they were fetched. Checking while holding the lock
+      // ensures that a concurrent `invalidate` either is detected here, or removes the value.
+      num_rejected += num_indices - i;
+      break;
+    }
+
+    uint32_t slot;
+    const auto it{shard.index.find(key)};
+    if (it != shard.index.end()) {
+      // Refresh existing entry.
+      slot = it->second;
+    } else if (shard.index.size() < shard.keys.size()) {
+      slot = static_cast<uint32_t>(shard.index.size());
+      shard.index.emplace(key, slot);
+    } else {
+      // Find a victim (CLOCK). Recently referenced entries get a second chance.
+      while (shard.referenced[shard.hand]) {
+        shard.referenced[shard.hand] = false;
+        shard.hand = (shard.hand + 1) % shard.keys.size();
+      }
+      slot = static_cast<uint32_t>(shard.hand);
+
+      // TinyLFU admission.
+      const Key& victim{shard.keys[slot]};
+      if (shard.sketch.estimate(hash) <= shard.sketch.estimate(rrxmrrxmsx_0(victim))) {
+        ++num_rejected;
+        continue;
+      }
+      shard.index.erase(victim);
+      shard.index.emplace(key, slot);
+      shard.hand = (shard.hand + 1) % shard.keys.size();
+    }
+
+    shard.keys[slot] = key;
+    shard.stamps[slot] = now;
+    shard.referenced[slot] = false;
+    std::copy_n(&values[idx * value_stride], value_stride, &shard.values[slot * value_stride]);
+    ++num_admitted;
+  }
+
+  num_admitted_ += num_admitted;
+  num_rejected_ += num_rejected;
+}
+
+template <typename Key>
+void NearCache<Key>::update(const std::string& table_name, const size_t num_pairs,
+                            const Key* const keys, const char* const values,
+                            const uint32_t value_size, const size_t value_stride) {
+  Table* const table{get_table_(table_name)};
+  if (!table) {
+    return;
+  }
+  if (table->value_stride != value_size) {
+    invalidate(table_name, num_pairs, keys);
+    return;
+  }
+  ++table->generation;
+
+  const int64_t now{Clock::now().time_since_epoch().count()};
+
+  for (size_t idx{0}; idx < num_pairs; ++idx) {
+    const Key& key{keys[idx]};
+    const uint64_t hash{rrxmrrxmsx_0(key)};
+    Shard& shard{*table->shards[hash % table->shards.size()]};
+
+    const std::lock_guard lock(shard.guard);
+    const auto it{shard.index.find(key)};
+    if (it != shard.index.end()) {
+      const uint32_t slot{it->second};
+      shard.stamps[slot] = now;
+      std::copy_n(&values[idx * value_stride], value_size, &shard.values[slot * value_size]);
+    }
+  }
+}
+
+template <typename Key>
+void NearCache<Key>::invalidate(const std::string& table_name, const size_t num_keys,
+                                const Key* const keys) {
+  Table* const table{get_table_(table_name)};
+  if (!table) {
+    return;
+  }
+  ++table->generation;
+
+  size_t num_invalidated{0};
+  for (const Key* k{keys}; k != &keys[num_keys]; ++k) {
+    const uint64_t hash{rrxmrrxmsx_0(*k)};
+    Shard& shard{*table->shards[hash % table->shards.size()]};
+
+    const std::lock_guard lock(shard.guard);
+    const auto it{shard.index.find(*k)};
+    if (it == shard.index.end()) {
+      continue;
+    }
+
+    // Move the last occupied slot into the gap to keep the occupied slots contiguous.
+    const uint32_t slot{it->second};
+    const uint32_t last{static_cast<uint32_t>(shard.index.size() - 1)};
+    shard.index.erase(it);
+    if (slot != last) {
+      const Key& moved_key{shard.keys[last]};
+      shard.index[moved_key] = slot;
+      shard.keys[slot] = moved_key;
+      shard.stamps[slot] = shard.stamps[last];
+      shard.referenced[slot] = shard.referenced[last];
+      std::copy_n(&shard.values[last * table->value_stride], table->value_stride,
+                  &shard.values[slot * table->value_stride]);
+    }
+    ++num_invalidated;
+  }
+
+  num_invalidated_ += num_invalidated;
+}
+
+template <typename Key>
+void NearCache<Key>::invalidate(const std::string& table_name) {
+  Table* const table{get_table_(table_name)};
+  if (!table) {
+    return;
+  }
+  ++table->generation;
+
+  for (const auto& shard : table->shards) {
+    const std::lock_guard lock(shard->guard);
+    num_invalidated_ += shard->index.size();
+    shard->index.clear();
+    shard->hand = 0;
+  }
+}
+
+template <typename Key>
+NearCacheStats NearCache<Key>::stats() const {
+  NearCacheStats stats;
+  stats.num_hits = num_hits_;
+  stats.num_misses = num_misses_;
+  stats.num_expired = num_expired_;
+  stats.num_admitted = num_admitted_;
+  stats.num_rejected = num_rejected_;
+  stats.num_invalidated = num_invalidated_;
+  if (stats.num_hits) {
+    stats.avg_age = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::duration{total_age_ / static_cast<int64_t>(stats.num_hits)});
+  }
+  stats.max_age =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::duration{max_age_.load()});
+  return stats;
+}
+
+template class NearCache<unsigned int>;
+template class NearCache<long long>;
+
+}  // namespace HugeCTR
@@ -21,7 +21,9 @@
 #include <hps/redis_backend.hpp>
 #include <hps/redis_backend_detail.hpp>
 #include <iostream>
+#include <numeric>
 #include <random>
+#include <thread>
 #include <thread_pool.hpp>
 #include <unordered_set>
 
@@ -32,25 +34,50 @@ namespace HugeCTR {
 
 #ifdef HCTR_USE_REDIS
 
-inline std::string make_hkey(const std::string& table_name, const size_t part, const char suffix) {
-  std::ostringstream os;
-  // These curly brackets (`{` and `}`) are not a design choice. Instead, this will trigger Redis to
-  // align node allocations for 'v' and 't'.
-  os << "hps_et{" << table_name << "/p" << part << '}' << suffix;
-  return os.str();
-}
+/**
+ * Throughout this file, `part_index` refers to a storage partition (i.e., a slot of a partition).
+ * See `RedisClusterBackend::make_hkey_`.
+ */
 
 #ifdef HCTR_DEFINE_REDIS_VALUE_HKEY_
 #error HCTR_DEFINE_REDIS_VALUE_HKEY_ should not be defined!
 #endif
 #define HCTR_DEFINE_REDIS_VALUE_HKEY_() \
-  const std::string& hkey_v { make_hkey(table_name, part_index, 'v') }
+  const std::string& hkey_v { make_hkey_(table_name, part_index, 'v') }
 
 #ifdef HCTR_DEFINE_REDIS_META_HKEY_
 #error HCTR_DEFINE_REDIS_META_HKEY_ should not be defined!
 #endif
 #define HCTR_DEFINE_REDIS_META_HKEY_() \
-  const std::string& hkey_m { make_hkey(table_name, part_index, 't') }
+  const std::string& hkey_m { make_hkey_(table_name, part_index, 't') }
+
+#ifdef HCTR_HPS_REDIS_PARALLEL_FOR_EACH_SLOT_
+#error HCTR_HPS_REDIS_PARALLEL_FOR_EACH_SLOT_ should not be defined!
+#endif
+#define HCTR_HPS_REDIS_PARALLEL_FOR_EACH_SLOT_(...)                                \
+  do {                                                                             \
+    ThreadPool::get().parallel_for(num_slots_,                                     \
+                                   [&](const size_t part_index) { __VA_ARGS__; }); \
+  } while (0)
+
+/**
+ * Like `HCTR_HPS_REDIS_PARALLEL_FOR_EACH_SLOT_`, but only visits storage partitions that received
+ * keys from `group_by_slot_`. Their positions are `[i, indices_end)`.
+ */
+#ifdef HCTR_HPS_REDIS_PARALLEL_FOR_EACH_SLOT_GROUP_
+#error HCTR_HPS_REDIS_PARALLEL_FOR_EACH_SLOT_GROUP_ should not be defined!
+#endif
+#define HCTR_HPS_REDIS_PARALLEL_FOR_EACH_SLOT_GROUP_(...)                                     \
+  HCTR_HPS_REDIS_PARALLEL_FOR_EACH_SLOT_({                                                    \
+    static_assert(std::is_same_v<std::decay_t<decltype(slot_offsets)>, std::vector<size_t>>); \
+    static_assert(std::is_same_v<std::decay_t<decltype(slot_indices)>, std::vector<size_t>>); \
+                                                                                              \
+    const size_t* i{&slot_indices[slot_offsets[part_index]]};                                 \
+    const size_t* const indices_end{&slot_indices[slot_offsets[part_index + 1]]};             \
+    if (i != indices_end) {                                                                   \
+      __VA_ARGS__;                                                                            \
+    }                                                                                         \
+  })
 
 #define HCTR_RETHROW_REDIS_ERRORS_(...)                             \
   do {                                                              \
@@ -73,9 +100,27 @@ inline std::string make_hkey(const std::string& table_name, const size_t part, c
 
 template <typename Key>
 RedisClusterBackend<Key>::RedisClusterBackend(const RedisClusterBackendParams& params)
-    : Base(params) {
+    : Base(params),
+      num_slots_{params.num_partitions * params.num_slots_per_partition},
+      slot_overflow_margin_{params.overflow_margin / params.num_slots_per_partition +
+                            (params.overflow_margin % params.num_slots_per_partition != 0)},
+      slot_overflow_resolution_margin_{this->overflow_resolution_margin_ /
+                                       params.num_slots_per_partition},
+      background_worker_{"redis bg worker", params.num_refresh_workers} {
   HCTR_CHECK(params.num_node_connections > 0);
   HCTR_CHECK(params.num_partitions >= params.num_node_connections);
+  HCTR_CHECK(params.num_slots_per_partition > 0);
+  HCTR_CHECK(params.num_refresh_workers > 0);
+  HCTR_CHECK(params.max_pending_refreshes > 0);
+
+  refresh_queues_.reserve(params.num_refresh_workers);
+  for (size_t i{0}; i < params.num_refresh_workers; ++i) {
+    refresh_queues_.emplace_back(std::make_unique<RefreshQueue>());
+  }
+
+  if (params.near_cache.capacity > 0) {
+    near_cache_ = std::make_unique<NearCache<Key>>(params.near_cache);
+  }
 
   // Put together cluster configuration.
   sw::redis::ConnectionOptions options;
@@ -118,20 +163,113 @@ RedisClusterBackend<Key>::RedisClusterBackend(const RedisClusterBackendParams& p
   HCTR_LOG_C(INFO, WORLD, get_name(), ": Connecting via ", options.host, ':', options.port,
              "...\n");
   redis_ = std::make_unique<sw::redis::RedisCluster>(options, pool_options);
+
+  refresh_timer_ = std::thread(&RedisClusterBackend::run_refresh_timer_, this);
 }
 
 template <typename Key>
 RedisClusterBackend<Key>::~RedisClusterBackend() {
+  // Stop the timer, and flush the queues that are still waiting for their refresh window.
+  {
+    const std::lock_guard lock(refresh_timer_guard_);
+    refresh_timer_terminate_ = true;
+  }
+  refresh_timer_semaphore_.notify_all();
+  refresh_timer_.join();
+  for (; !refresh_deadlines_.empty(); refresh_deadlines_.pop()) {
+    const size_t queue_index{refresh_deadlines_.top().second};
+    background_worker_.submit([this, queue_index]() { flush_refresh_queue_(queue_index); });
+  }
+
   HCTR_LOG_C(INFO, WORLD, get_name(), ": Awaiting background worker to conclude...\n");
   background_worker_.await_idle();
 
+  const RedisRefreshStats& stats{refresh_stats()};
+  HCTR_LOG_C(INFO, WORLD, get_name(), ": Metadata refreshes: ", stats.num_queued, " queued, ",
+             stats.num_coalesced, " coalesced, ", stats.num_dropped, " dropped, ",
+             stats.num_flushed, " applied; max. queue depth = ", stats.max_queue_depth,
+             ", avg. lag = ", stats.avg_lag.count(), " ns, max. lag = ", stats.max_lag.count(),
+             " ns.\n");
+
+  if (near_cache_) {
+    const NearCacheStats& stats{near_cache_stats()};
+    HCTR_LOG_C(INFO, WORLD, get_name(), ": Near cache: ", stats.num_hits, " hits, ",
+               stats.num_misses, " misses (", stats.num_expired, " expired); hit rate = ",
+               stats.hit_rate(), ", ", stats.num_admitted, " admitted, ", stats.num_rejected,
+               " rejected, ", stats.num_invalidated, " invalidated; avg. age = ",
+               stats.avg_age.count(), " ns, max. age = ", stats.max_age.count(), " ns.\n");
+  }
+
   HCTR_LOG_C(INFO, WORLD, get_name(), ": Disconnecting...\n");
   redis_.reset();
 }
 
+template <typename Key>
+std::string RedisClusterBackend<Key>::make_hkey_(const std::string& table_name,
+                                                 const size_t part_index, const char suffix) const {
+  const size_t num_partitions{this->params_.num_partitions};
+
+  std::ostringstream os;
+  // These curly brackets (`{` and `}`) are not a design choice. Instead, this will trigger Redis to
+  // align node allocations for 'v' and 't'.
+  os << "hps_et{" << table_name << "/p" << part_index % num_partitions;
+  if (this->params_.num_slots_per_partition > 1) {
+    // Different hash tags map to different cluster slots.
+    os << '.' << part_index / num_partitions;
+  }
+  os << '}' << suffix;
+  return os.str();
+}
+
+template <typename Key>
+size_t RedisClusterBackend<Key>::slot_of_(const Key& key) const {
+  // Since `num_partitions` divides `num_slots_`, this is consistent with
+  // `HCTR_HPS_KEY_TO_PART_INDEX_`; i.e., `slot_of_(key) % num_partitions` is the partition.
+  return rrxmrrxmsx_0(key) % num_slots_;
+}
+
+template <typename Key>
+void RedisClusterBackend<Key>::group_by_slot_(const size_t num_keys, const Key* const keys,
+                                              std::vector<size_t>& slot_offsets,
+                                              std::vector<size_t>& slot_indices) const {
+  std::vector<size_t> slots(num_keys);
+  slot_offsets.assign(num_slots_ + 1, 0);
+  for (size_t idx{0}; idx < num_keys; ++idx) {
+    slots[idx] = slot_of_(keys[idx]);
+    ++slot_offsets[slots[idx] + 1];
+  }
+  std::partial_sum(slot_offsets.begin(), slot_offsets.end(), slot_offsets.begin());
+
+  std::vector<size_t> cursors(slot_offsets.begin(), slot_offsets.end() - 1);
+  slot_indices.resize(num_keys);
+  for (size_t idx{0}; idx < num_keys; ++idx) {
+    slot_indices[cursors[slots[idx]]++] = idx;
+  }
+}
+
+template <typename Key>
+void RedisClusterBackend<Key>::group_by_slot_(const size_t num_indices,
+                                              const size_t* const indices, const Key* const keys,
+                                              std::vector<size_t>& slot_offsets,
+                                              std::vector<size_t>& slot_indices) const {
+  std::vector<size_t> slots(num_indices);
+  slot_offsets.assign(num_slots_ + 1, 0);
+  for (size_t idx{0}; idx < num_indices; ++idx) {
+    slots[idx] = slot_of_(keys[indices[idx]]);
+    ++slot_offsets[slots[idx] + 1];
+  }
+  std::partial_sum(slot_offsets.begin(), slot_offsets.end(), slot_offsets.begin());
+
+  std::vector<size_t> cursors(slot_offsets.begin(), slot_offsets.end() - 1);
+  slot_indices.resize(num_indices);
+  for (size_t idx{0}; idx < num_indices; ++idx) {
+    slot_indices[cursors[slots[idx]]++] = indices[idx];
+  }
+}
+
 template <typename Key>
 size_t RedisClusterBackend<Key>::size(const std::string& table_name) const {
-  if (this->params_.num_partitions == 1) {
+  if (num_slots_ == 1) {
     constexpr size_t part_index{0};
     HCTR_DEFINE_REDIS_VALUE_HKEY_();
 
@@ -139,8 +277,7 @@ size_t RedisClusterBackend<Key>::size(const std::string& table_name) const {
   } else {
     std::atomic<size_t> joint_num_entries{0};
 
-    const size_t num_partitions{this->params_.num_partitions};
-    HCTR_HPS_DB_PARALLEL_FOR_EACH_PART_({
+    HCTR_HPS_REDIS_PARALLEL_FOR_EACH_SLOT_({
       HCTR_RETHROW_REDIS_ERRORS_({
         HCTR_DEFINE_REDIS_VALUE_HKEY_();
 
@@ -160,15 +297,14 @@ size_t RedisClusterBackend<Key>::contains(const std::string& table_name, const s
 
   const Key* const keys_end{&keys[num_keys]};
   const size_t max_batch_size{this->params_.max_batch_size};
-  const size_t num_partitions{this->params_.num_partitions};
 
   size_t hit_count{0};
   size_t skip_count{0};
 
   if (num_keys == 0) {
     // Do nothing ;-).
-  } else if (num_keys == 1 || num_partitions == 1) {
-    const size_t part_index{num_partitions == 1 ? 0 : HCTR_HPS_KEY_TO_PART_INDEX_(*keys)};
+  } else if (num_keys == 1 || num_slots_ == 1) {
+    const size_t part_index{num_slots_ == 1 ? 0 : slot_of_(*keys)};
 
     HCTR_RETHROW_REDIS_ERRORS_({
       HCTR_DEFINE_REDIS_VALUE_HKEY_();
@@ -189,24 +325,37 @@ size_t RedisClusterBackend<Key>::contains(const std::string& table_name, const s
       }
     });
   } else {
+    std::vector<size_t> slot_offsets;
+    std::vector<size_t> slot_indices;
+    group_by_slot_(num_keys, keys, slot_offsets, slot_indices);
+
     std::atomic<size_t> joint_hit_count{0};
     std::atomic<size_t> joint_skip_count{0};
 
-    HCTR_HPS_DB_PARALLEL_FOR_EACH_PART_({
+    HCTR_HPS_REDIS_PARALLEL_FOR_EACH_SLOT_GROUP_({
       HCTR_DEFINE_REDIS_VALUE_HKEY_();
 
       size_t hit_count{0};
+      size_t skip_count{0};
 
       HCTR_RETHROW_REDIS_ERRORS_({
         // Step through keys batch-by-batch.
         std::chrono::nanoseconds elapsed;
         size_t num_batches{0};
-        for (const Key* k{keys}; k != keys_end; ++num_batches) {
-          HCTR_HPS_DB_CHECK_TIME_BUDGET_(PARALLEL_DIRECT, nullptr);
+        for (; i != indices_end; ++num_batches) {
+          if (time_budget != std::chrono::nanoseconds::zero()) {
+            elapsed = std::chrono::high_resolution_clock::now() - begin;
+            if (elapsed >= time_budget) {
+              HCTR_LOG_C(WARNING, WORLD, get_name(), " backend; Table ", table_name,
+                         ": Timeout = ", elapsed.count(), " ns!\n");
+              skip_count += static_cast<size_t>(indices_end - i);
+              break;
+            }
+          }
 
           const size_t hit_count_prev{hit_count};
-          size_t batch_size{0};
-          HCTR_HPS_REDIS_CONTAINS_(PARALLEL_DIRECT);
+          const size_t batch_size{std::min<size_t>(indices_end - i, max_batch_size)};
+          HCTR_HPS_REDIS_CONTAINS_(SEQUENTIAL_INDIRECT);
 
           HCTR_LOG_C(TRACE, WORLD, get_name(), " backend; Partition ", table_name, '/', part_index,
                      ", batch ", num_batches, ": ", hit_count - hit_count_prev, " / ", batch_size,
@@ -215,6 +364,7 @@ size_t RedisClusterBackend<Key>::contains(const std::string& table_name, const s
       });
 
       joint_hit_count += hit_count;
+      joint_skip_count += skip_count;
     });
 
     hit_count += joint_hit_count;
@@ -234,14 +384,13 @@ size_t RedisClusterBackend<Key>::insert(const std::string& table_name, const siz
 
   const Key* const keys_end{&keys[num_pairs]};
   const size_t max_batch_size{this->params_.max_batch_size};
-  const size_t num_partitions{this->params_.num_partitions};
 
   size_t num_inserts{0};
 
   if (num_pairs == 0) {
     // Do nothing ;-).
-  } else if (num_pairs == 1 || num_partitions == 1) {
-    const size_t part_index{num_partitions == 1 ? 0 : HCTR_HPS_KEY_TO_PART_INDEX_(*keys)};
+  } else if (num_pairs == 1 || num_slots_ == 1) {
+    const size_t part_index{num_slots_ == 1 ? 0 : slot_of_(*keys)};
 
     HCTR_RETHROW_REDIS_ERRORS_({
       HCTR_DEFINE_REDIS_VALUE_HKEY_();
@@ -266,15 +415,19 @@ size_t RedisClusterBackend<Key>::insert(const std::string& table_name, const siz
                    batch_size - num_inserts + prev_num_inserts, " = ", batch_size, " entries.\n");
 
         // Handle overflow situations.
-        if (part_size > this->params_.overflow_margin) {
+        if (part_size > slot_overflow_margin_) {
           resolve_overflow_(table_name, part_index, part_size);
         }
       }
     });
   } else {
+    std::vector<size_t> slot_offsets;
+    std::vector<size_t> slot_indices;
+    group_by_slot_(num_pairs, keys, slot_offsets, slot_indices);
+
     std::atomic<size_t> joint_num_inserts{0};
 
-    HCTR_HPS_DB_PARALLEL_FOR_EACH_PART_({
+    HCTR_HPS_REDIS_PARALLEL_FOR_EACH_SLOT_GROUP_({
       HCTR_DEFINE_REDIS_VALUE_HKEY_();
       HCTR_DEFINE_REDIS_META_HKEY_();
 
@@ -283,25 +436,25 @@ size_t RedisClusterBackend<Key>::insert(const std::string& table_name, const siz
       HCTR_RETHROW_REDIS_ERRORS_({
         std::vector<std::pair<sw::redis::StringView, sw::redis::StringView>> kv_views;
         std::vector<std::pair<sw::redis::StringView, sw::redis::StringView>> km_views;
-        kv_views.reserve(std::min(num_pairs / num_partitions, max_batch_size));
-        km_views.reserve(std::min(num_pairs / num_partitions, max_batch_size));
+        kv_views.reserve(std::min<size_t>(indices_end - i, max_batch_size));
+        km_views.reserve(std::min<size_t>(indices_end - i, max_batch_size));
 
         size_t num_batches{0};
-        for (const Key* k{keys}; k != keys_end; ++num_batches) {
+        for (; i != indices_end; ++num_batches) {
           const size_t prev_num_inserts{num_inserts};
-          size_t batch_size{0};
+          const size_t batch_size{std::min<size_t>(indices_end - i, max_batch_size)};
           size_t part_size;
-          if (!HCTR_HPS_REDIS_INSERT_(PARALLEL_DIRECT)) {
+          if (!HCTR_HPS_REDIS_INSERT_(SEQUENTIAL_INDIRECT)) {
             break;
           }
 
           HCTR_LOG_C(TRACE, WORLD, get_name(), " backend; Partition ", table_name, '/', part_index,
                      ", batch ", num_batches, ": Inserted ", num_inserts - prev_num_inserts,
-                     " + updated ", kv_views.size() - num_inserts + prev_num_inserts, " = ",
-                     kv_views.size(), " entries.\n");
+                     " + updated ", batch_size - num_inserts + prev_num_inserts, " = ",
+                     batch_size, " entries.\n");
 
           // Handle overflow situations.
-          if (part_size > this->params_.overflow_margin) {
+          if (part_size > slot_overflow_margin_) {
             resolve_overflow_(table_name, part_index, part_size);
           }
         }
@@ -313,6 +466,10 @@ size_t RedisClusterBackend<Key>::insert(const std::string& table_name, const siz
     num_inserts += joint_num_inserts;
   }
 
+  if (near_cache_) {
+    near_cache_->update(table_name, num_pairs, keys, values, value_size, value_stride);
+  }
+
   HCTR_LOG_C(TRACE, WORLD, get_name(), " backend; Table ", table_name, ": Inserted ", num_inserts,
              " + updated ", num_pairs - num_inserts, " = ", num_pairs, " entries.\n");
   return num_inserts;
@@ -324,19 +481,23 @@ size_t RedisClusterBackend<Key>::fetch(const std::string& table_name, const size
                                        const size_t value_stride,
                                        const DatabaseMissCallback& on_miss,
                                        const std::chrono::nanoseconds& time_budget) {
+  if (near_cache_) {
+    return fetch_cached_(table_name, num_keys, nullptr, keys, values, value_stride, on_miss,
+                         time_budget);
+  }
+
   const auto begin{std::chrono::high_resolution_clock::now()};
 
   const Key* const keys_end{&keys[num_keys]};
   const size_t max_batch_size{this->params_.max_batch_size};
-  const size_t num_partitions{this->params_.num_partitions};
 
   size_t miss_count{0};
   size_t skip_count{0};
 
   if (num_keys == 0) {
     // Do nothing ;-).
-  } else if (num_keys == 1 || num_partitions == 1) {
-    const size_t part_index{num_partitions == 1 ? 0 : HCTR_HPS_KEY_TO_PART_INDEX_(*keys)};
+  } else if (num_keys == 1 || num_slots_ == 1) {
+    const size_t part_index{num_slots_ == 1 ? 0 : slot_of_(*keys)};
 
     HCTR_RETHROW_REDIS_ERRORS_({
       HCTR_DEFINE_REDIS_VALUE_HKEY_();
@@ -369,49 +530,12 @@ size_t RedisClusterBackend<Key>::fetch(const std::string& table_name, const size
       }
     });
   } else {
-    std::atomic<size_t> joint_miss_count{0};
-    std::atomic<size_t> joint_skip_count{0};
-
-    HCTR_HPS_DB_PARALLEL_FOR_EACH_PART_({
-      size_t miss_count{0};
-
-      HCTR_RETHROW_REDIS_ERRORS_({
-        HCTR_DEFINE_REDIS_VALUE_HKEY_();
-
-        std::shared_ptr<std::vector<Key>> touched_keys;
-        HCTR_HPS_REDIS_FETCH_DEFINE_V_VIEWS();
-        std::vector<sw::redis::StringView> k_views;
-        k_views.reserve(std::min(num_keys / num_partitions, max_batch_size));
-
-        // Step through input batch-by-batch.
-        std::chrono::nanoseconds elapsed;
-        size_t num_batches{0};
-        for (const Key* k{keys}; k != keys_end; ++num_batches) {
-          HCTR_HPS_DB_CHECK_TIME_BUDGET_(PARALLEL_DIRECT, on_miss);
-
-          const size_t prev_miss_count{miss_count};
-          size_t batch_size{0};
-          if (!HCTR_HPS_REDIS_FETCH_(PARALLEL_DIRECT)) {
-            break;
-          }
-
-          HCTR_LOG_C(TRACE, WORLD, get_name(), " backend; Partition ", table_name, '/', part_index,
-                     ", batch ", num_batches, ": ", batch_size - miss_count + prev_miss_count,
-                     " / ", batch_size, " hits. Time: ", elapsed.count(), " / ",
-                     time_budget.count(), " ns.\n");
-        }
-
-        // Refresh metadata if required.
-        if (touched_keys && !touched_keys->empty()) {
-          queue_metadata_refresh_(table_name, part_index, std::move(touched_keys));
-        }
-      });
+    std::vector<size_t> slot_offsets;
+    std::vector<size_t> slot_indices;
+    group_by_slot_(num_keys, keys, slot_offsets, slot_indices);
 
-      joint_miss_count += miss_count;
-    });
-
-    miss_count += joint_miss_count;
-    skip_count += joint_skip_count;
+    miss_count += fetch_slots_(table_name, slot_offsets, slot_indices, keys, values, value_stride,
+                               on_miss, begin, time_budget, skip_count);
   }
 
   const size_t hit_count{num_keys - skip_count - miss_count};
@@ -426,19 +550,33 @@ size_t RedisClusterBackend<Key>::fetch(const std::string& table_name, const size
                                        char* const values, const size_t value_stride,
                                        const DatabaseMissCallback& on_miss,
                                        const std::chrono::nanoseconds& time_budget) {
+  if (near_cache_) {
+    return fetch_cached_(table_name, num_indices, indices, keys, values, value_stride, on_miss,
+                         time_budget);
+  }
+  return fetch_remote_(table_name, num_indices, indices, keys, values, value_stride, on_miss,
+                       time_budget);
+}
+
+template <typename Key>
+size_t RedisClusterBackend<Key>::fetch_remote_(const std::string& table_name,
+                                               const size_t num_indices,
+                                               const size_t* const indices, const Key* const keys,
+                                               char* const values, const size_t value_stride,
+                                               const DatabaseMissCallback& on_miss,
+                                               const std::chrono::nanoseconds& time_budget) {
   const auto begin{std::chrono::high_resolution_clock::now()};
 
   const size_t* const indices_end{&indices[num_indices]};
   const size_t max_batch_size{this->params_.max_batch_size};
-  const size_t num_partitions{this->params_.num_partitions};
 
   size_t miss_count{0};
   size_t skip_count{0};
 
   if (num_indices == 0) {
     // Do nothing ;-).
-  } else if (num_indices == 1 || num_partitions == 1) {
-    const size_t part_index{num_partitions == 1 ? 0 : HCTR_HPS_KEY_TO_PART_INDEX_(keys[*indices])};
+  } else if (num_indices == 1 || num_slots_ == 1) {
+    const size_t part_index{num_slots_ == 1 ? 0 : slot_of_(keys[*indices])};
 
     HCTR_RETHROW_REDIS_ERRORS_({
       HCTR_DEFINE_REDIS_VALUE_HKEY_();
@@ -471,56 +609,124 @@ size_t RedisClusterBackend<Key>::fetch(const std::string& table_name, const size
       }
     });
   } else {
-    std::atomic<size_t> joint_miss_count{0};
-    std::atomic<size_t> joint_skip_count{0};
+    std::vector<size_t> slot_offsets;
+    std::vector<size_t> slot_indices;
+    group_by_slot_(num_indices, indices, keys, slot_offsets, slot_indices);
 
-    HCTR_HPS_DB_PARALLEL_FOR_EACH_PART_({
-      size_t miss_count{0};
+    miss_count += fetch_slots_(table_name, slot_offsets, slot_indices, keys, values, value_stride,
+                               on_miss, begin, time_budget, skip_count);
+  }
 
-      HCTR_RETHROW_REDIS_ERRORS_({
-        HCTR_DEFINE_REDIS_VALUE_HKEY_();
+  const size_t hit_count{num_indices - skip_count - miss_count};
+  HCTR_LOG_C(TRACE, WORLD, get_name(), " backend; Table ", table_name, ": ", hit_count, " / ",
+             num_indices - skip_count, " hits; skipped ", skip_count, " keys.\n");
+  return hit_count;
+}
 
-        std::shared_ptr<std::vector<Key>> touched_keys;
-        HCTR_HPS_REDIS_FETCH_DEFINE_V_VIEWS();
-        std::vector<sw::redis::StringView> k_views;
-        k_views.reserve(std::min(num_indices / num_partitions, max_batch_size));
+template <typename Key>
+size_t RedisClusterBackend<Key>::fetch_cached_(const std::string& table_name,
+                                               const size_t num_indices,
+                                               const size_t* const indices, const Key* const keys,
+                                               char* const values, const size_t value_stride,
+                                               const DatabaseMissCallback& on_miss,
+                                               const std::chrono::nanoseconds& time_budget) {
+  std::vector<size_t> missing;
+  uint64_t generation;
+  const size_t hit_count{near_cache_->fetch(table_name, num_indices, indices, keys, values,
+                                            value_stride, missing, generation)};
+  if (missing.empty()) {
+    return hit_count;
+  }
 
-        // Step through input batch-by-batch.
-        std::chrono::nanoseconds elapsed;
-        size_t num_batches{0};
-        for (const size_t* i{indices}; i != indices_end; ++num_batches) {
-          HCTR_HPS_DB_CHECK_TIME_BUDGET_(PARALLEL_INDIRECT, on_miss);
+  // Fetch the rest from Redis. Remember which positions could not be served. Each position is
+  // reported at most once, so that concurrent callbacks never touch the same flag.
+  const size_t num_positions{
+      indices ? *std::max_element(missing.begin(), missing.end()) + 1 : num_indices};
+  std::vector<char> remote_misses(num_positions);
+  const DatabaseMissCallback record_miss{[&](const size_t index) {
+    remote_misses[index] = 1;
+    on_miss(index);
+  }};
+  const size_t remote_hit_count{fetch_remote_(table_name, missing.size(), missing.data(), keys,
+                                              values, value_stride, record_miss, time_budget)};
+
+  // Offer the values that were found to the near cache.
+  if (remote_hit_count) {
+    missing.erase(std::remove_if(missing.begin(), missing.end(),
+                                 [&](const size_t index) { return remote_misses[index]; }),
+                  missing.end());
+    near_cache_->insert(table_name, missing.size(), missing.data(), keys, values, value_stride,
+                        generation);
+  }
 
-          // Assemble query.
-          const size_t prev_miss_count{miss_count};
-          size_t batch_size{0};
-          if (!HCTR_HPS_REDIS_FETCH_(PARALLEL_INDIRECT)) {
-            break;
-          }
+  return hit_count + remote_hit_count;
+}
 
-          HCTR_LOG_C(TRACE, WORLD, get_name(), " backend; Partition ", table_name, '/', part_index,
-                     ", batch ", num_batches, ": ", batch_size - miss_count + prev_miss_count,
-                     " / ", batch_size, " hits. Time: ", elapsed.count(), " / ",
-                     time_budget.count(), " ns.\n");
+template <typename Key>
+size_t RedisClusterBackend<Key>::fetch_slots_(
+    const std::string& table_name, const std::vector<size_t>& slot_offsets,
+    const std::vector<size_t>& slot_indices, const Key* const keys, char* const values,
+    const size_t value_stride, const DatabaseMissCallback& on_miss,
+    const std::chrono::high_resolution_clock::time_point& begin,
+    const std::chrono::nanoseconds& time_budget, size_t& skip_count) {
+  const size_t max_batch_size{this->params_.max_batch_size};
+
+  std::atomic<size_t> joint_miss_count{0};
+  std::atomic<size_t> joint_skip_count{0};
+
+  // Each storage partition is served by exactly one cluster node. Hence, processing them
+  // concurrently keeps requests to all nodes in flight at the same time.
+  HCTR_HPS_REDIS_PARALLEL_FOR_EACH_SLOT_GROUP_({
+    size_t miss_count{0};
+    size_t skip_count{0};
+
+    HCTR_RETHROW_REDIS_ERRORS_({
+      HCTR_DEFINE_REDIS_VALUE_HKEY_();
+
+      std::chrono::nanoseconds elapsed;
+      HCTR_HPS_DB_CHECK_TIME_BUDGET_(SEQUENTIAL_INDIRECT, on_miss);
+      if (!skip_count) {
+        std::vector<sw::redis::StringView> k_views;
+        k_views.reserve(static_cast<size_t>(indices_end - i));
+        for (; i != indices_end; ++i) {
+          k_views.emplace_back(reinterpret_cast<const char*>(&keys[*i]), sizeof(Key));
+        }
+
+        // Send all batches in a single round-trip.
+        sw::redis::Pipeline pipe{redis_->pipeline(hkey_v, false)};
+        for (size_t batch_begin{0}; batch_begin < k_views.size(); batch_begin += max_batch_size) {
+          const size_t batch_end{std::min(batch_begin + max_batch_size, k_views.size())};
+          pipe.hmget(hkey_v, k_views.begin() + static_cast<std::ptrdiff_t>(batch_begin),
+                     k_views.begin() + static_cast<std::ptrdiff_t>(batch_end));
         }
+        sw::redis::QueuedReplies replies{pipe.exec()};
+
+        // Scatter values into the caller's buffer.
+        std::shared_ptr<std::vector<Key>> touched_keys;
+        for (size_t idx{0}; idx < replies.size(); ++idx) {
+          replies.get(idx, RedisDirectValueInserter<Key>(
+                               keys, k_views, values, value_stride, on_miss, miss_count,
+                               this->params_.overflow_policy, touched_keys, idx * max_batch_size));
+        }
+
+        HCTR_LOG_C(TRACE, WORLD, get_name(), " backend; Partition ", table_name, '/', part_index,
+                   ": ", k_views.size() - miss_count, " / ", k_views.size(), " hits in ",
+                   replies.size(), " batches. Time: ", elapsed.count(), " / ",
+                   time_budget.count(), " ns.\n");
 
         // Refresh metadata if required.
         if (touched_keys && !touched_keys->empty()) {
           queue_metadata_refresh_(table_name, part_index, std::move(touched_keys));
         }
-      });
-
-      joint_miss_count += miss_count;
+      }
     });
 
-    miss_count += joint_miss_count;
-    skip_count += joint_skip_count;
-  }
+    joint_miss_count += miss_count;
+    joint_skip_count += skip_count;
+  });
 
-  const size_t hit_count{num_indices - skip_count - miss_count};
-  HCTR_LOG_C(TRACE, WORLD, get_name(), " backend; Table ", table_name, ": ", hit_count, " / ",
-             num_indices - skip_count, " hits; skipped ", skip_count, " keys.\n");
-  return hit_count;
+  skip_count += joint_skip_count;
+  return joint_miss_count;
 }
 
 template <typename Key>
@@ -542,13 +748,12 @@ size_t RedisClusterBackend<Key>::evict(const std::string& table_name) {
 
   size_t num_deletions{0};
 
-  if (this->params_.num_partitions == 1) {
+  if (num_slots_ == 1) {
     num_deletions += evict_part(0);
   } else {
     std::atomic<size_t> joint_num_deletions{0};
 
-    const size_t num_partitions{this->params_.num_partitions};
-    HCTR_HPS_DB_PARALLEL_FOR_EACH_PART_({
+    HCTR_HPS_REDIS_PARALLEL_FOR_EACH_SLOT_({
       const size_t num_deletions{evict_part(part_index)};
 
       HCTR_LOG_C(TRACE, WORLD, get_name(), " backend; Partition ", table_name, '/', part_index,
@@ -560,6 +765,10 @@ size_t RedisClusterBackend<Key>::evict(const std::string& table_name) {
     num_deletions += joint_num_deletions;
   }
 
+  if (near_cache_) {
+    near_cache_->invalidate(table_name);
+  }
+
   HCTR_LOG_C(TRACE, WORLD, get_name(), " backend; Table ", table_name, ": Erased ", num_deletions,
              " entries.\n");
   return num_deletions;
@@ -570,14 +779,13 @@ size_t RedisClusterBackend<Key>::evict(const std::string& table_name, const size
                                        const Key* const keys) {
   const Key* const keys_end{&keys[num_keys]};
   const size_t max_batch_size{this->params_.max_batch_size};
-  const size_t num_partitions{this->params_.num_partitions};
 
   size_t num_deletions{0};
 
   if (num_keys == 0) {
     // Do nothing ;-).
-  } else if (num_keys == 1 || num_partitions == 1) {
-    const size_t part_index{num_partitions == 1 ? 0 : HCTR_HPS_KEY_TO_PART_INDEX_(*keys)};
+  } else if (num_keys == 1 || num_slots_ == 1) {
+    const size_t part_index{num_slots_ == 1 ? 0 : slot_of_(*keys)};
 
     HCTR_RETHROW_REDIS_ERRORS_({
       HCTR_DEFINE_REDIS_VALUE_HKEY_();
@@ -599,9 +807,13 @@ size_t RedisClusterBackend<Key>::evict(const std::string& table_name, const size
       }
     });
   } else {
+    std::vector<size_t> slot_offsets;
+    std::vector<size_t> slot_indices;
+    group_by_slot_(num_keys, keys, slot_offsets, slot_indices);
+
     std::atomic<size_t> joint_num_deletions{0};
 
-    HCTR_HPS_DB_PARALLEL_FOR_EACH_PART_({
+    HCTR_HPS_REDIS_PARALLEL_FOR_EACH_SLOT_GROUP_({
       size_t num_deletions{0};
 
       HCTR_RETHROW_REDIS_ERRORS_({
@@ -609,13 +821,13 @@ size_t RedisClusterBackend<Key>::evict(const std::string& table_name, const size
         HCTR_DEFINE_REDIS_META_HKEY_();
 
         std::vector<sw::redis::StringView> k_views;
-        k_views.reserve(std::min(num_keys / num_partitions, max_batch_size));
+        k_views.reserve(std::min<size_t>(indices_end - i, max_batch_size));
 
         size_t num_batches{0};
-        for (const Key* k{keys}; k != keys_end; ++num_batches) {
+        for (; i != indices_end; ++num_batches) {
           const size_t prev_num_deletions{num_deletions};
-          size_t batch_size{0};
-          if (!HCTR_HPS_REDIS_EVICT_(PARALLEL_DIRECT)) {
+          const size_t batch_size{std::min<size_t>(indices_end - i, max_batch_size)};
+          if (!HCTR_HPS_REDIS_EVICT_(SEQUENTIAL_INDIRECT)) {
             break;
           }
 
@@ -631,6 +843,10 @@ size_t RedisClusterBackend<Key>::evict(const std::string& table_name, const size
     num_deletions += joint_num_deletions;
   }
 
+  if (near_cache_) {
+    near_cache_->invalidate(table_name, num_keys, keys);
+  }
+
   HCTR_LOG_C(TRACE, WORLD, get_name(), " backend; Table ", table_name, ": Erased ", num_deletions,
              " / ", num_keys, " entries.\n");
   return num_deletions;
@@ -673,7 +889,7 @@ std::vector<std::string> RedisClusterBackend<Key>::find_tables(const std::string
 template <typename Key>
 std::vector<Key> RedisClusterBackend<Key>::keys(const std::string& table_name) const {
   std::vector<Key> keys;
-  for (size_t part_index{0}; part_index < this->params_.num_partitions; ++part_index) {
+  for (size_t part_index{0}; part_index < num_slots_; ++part_index) {
     HCTR_DEFINE_REDIS_VALUE_HKEY_();
     redis_->hkeys(hkey_v, RedisKeyVectorInserter(keys));
   }
@@ -682,7 +898,7 @@ std::vector<Key> RedisClusterBackend<Key>::keys(const std::string& table_name) c
 
 template <typename Key>
 uint32_t RedisClusterBackend<Key>::value_size_for(const std::string& table_name) const {
-  for (size_t part_index{0}; part_index < this->params_.num_partitions; ++part_index) {
+  for (size_t part_index{0}; part_index < num_slots_; ++part_index) {
     HCTR_DEFINE_REDIS_VALUE_HKEY_();
 
     // Find a valid key (if existing).
@@ -710,7 +926,6 @@ uint32_t RedisClusterBackend<Key>::value_size_for(const std::string& table_name)
 template <typename Key>
 size_t RedisClusterBackend<Key>::dump_bin(const std::string& table_name, std::ofstream& file) {
   const size_t max_batch_size{this->params_.max_batch_size};
-  const size_t num_partitions{this->params_.num_partitions};
 
   std::mutex mutex;
 
@@ -743,15 +958,63 @@ size_t RedisClusterBackend<Key>::dump_bin(const std::string& table_name, std::of
     });
   };
 
-  if (num_partitions == 1) {
+  if (num_slots_ == 1) {
     write_part(0);
   } else {
-    HCTR_HPS_DB_PARALLEL_FOR_EACH_PART_({ write_part(part_index); });
+    HCTR_HPS_REDIS_PARALLEL_FOR_EACH_SLOT_({ write_part(part_index); });
   }
 
   return num_entries;
 }
 
+template <typename Key>
+RedisRefreshStats RedisClusterBackend<Key>::refresh_stats() const {
+  RedisRefreshStats stats;
+  size_t num_flushes{0};
+  int64_t total_lag{0};
+
+  for (const auto& queue : refresh_queues_) {
+    {
+      const std::lock_guard lock(queue->guard);
+      stats.queue_depth += queue->num_pending;
+    }
+    stats.max_queue_depth = std::max(stats.max_queue_depth, queue->max_depth.load());
+    stats.num_queued += queue->num_queued;
+    stats.num_coalesced += queue->num_coalesced;
+    stats.num_dropped += queue->num_dropped;
+    stats.num_flushed += queue->num_flushed;
+    num_flushes += queue->num_flushes;
+    total_lag += queue->total_lag;
+    stats.max_lag = std::max(stats.max_lag, std::chrono::nanoseconds{queue->max_lag.load()});
+  }
+  if (num_flushes) {
+    stats.avg_lag = std::chrono::nanoseconds{total_lag / static_cast<int64_t>(num_flushes)};
+  }
+
+  return stats;
+}
+
+template <typename Key>
+NearCacheStats RedisClusterBackend<Key>::near_cache_stats() const {
+  return near_cache_ ? near_cache_->stats() : NearCacheStats{};
+}
+
+template <typename Key>
+void RedisClusterBackend<Key>::update_near_cache(const std::string& table_name,
+                                                 const size_t num_pairs, const Key* const keys,
+                                                 const char* const values,
+                                                 const uint32_t value_size,
+                                                 const size_t value_stride) {
+  if (!near_cache_) {
+    return;
+  }
+  if (values) {
+    near_cache_->update(table_name, num_pairs, keys, values, value_size, value_stride);
+  } else {
+    near_cache_->invalidate(table_name, num_pairs, keys);
+  }
+}
+
 #ifdef HCTR_USE_ROCKS_DB
 template <typename Key>
 size_t RedisClusterBackend<Key>::dump_sst(const std::string& table_name,
@@ -762,8 +1025,7 @@ size_t RedisClusterBackend<Key>::dump_sst(const std::string& table_name,
 
   // Step through key views batch-by-batch.
   const uint32_t value_size{value_size_for(table_name)};
-  const size_t max_batch_size{this->params_.max_batch_size *
-                              std::min<size_t>(this->params_.num_partitions, 2)};
+  const size_t max_batch_size{this->params_.max_batch_size * std::min<size_t>(num_slots_, 2)};
   HCTR_CHECK(max_batch_size > 0);
   std::vector<char> values(max_batch_size * value_size);
 
@@ -791,7 +1053,7 @@ template <typename Key>
 void RedisClusterBackend<Key>::resolve_overflow_(const std::string& table_name,
                                                  const size_t part_index, size_t part_size) {
   HCTR_LOG_C(TRACE, WORLD, get_name(), " backend; Partition ", table_name, '/', part_index,
-             " is overflowing (size = ", part_size, " > ", this->params_.overflow_margin,
+             " is overflowing (size = ", part_size, " > ", slot_overflow_margin_,
              "). Attempting to resolve...\n");
 
   const size_t max_batch_size{this->params_.max_batch_size};
@@ -817,7 +1079,7 @@ void RedisClusterBackend<Key>::resolve_overflow_(const std::string& table_name,
       redis_->hkeys(hkey_m, RedisKeyVectorInserter(keys));
 
       part_size = keys.size();
-      if (part_size <= this->overflow_resolution_margin_) {
+      if (part_size <= slot_overflow_resolution_margin_) {
         HCTR_LOG_C(TRACE, WORLD, get_name(), " backend; Partition ", table_name, '/', part_index,
                    ": Overflow was already resolved by another process.\n");
         return;
@@ -847,7 +1109,7 @@ void RedisClusterBackend<Key>::resolve_overflow_(const std::string& table_name,
           k_views.emplace_back(reinterpret_cast<const char*>(&*k_it), sizeof(Key));
         }
         delete_batch(k_views);
-        if (part_size <= this->overflow_resolution_margin_) {
+        if (part_size <= slot_overflow_resolution_margin_) {
           break;
         }
       }
@@ -860,7 +1122,7 @@ void RedisClusterBackend<Key>::resolve_overflow_(const std::string& table_name,
       redis_->hgetall(hkey_m, RedisKeyAccumulatorVectorInserter<Key>(keys_metas));
 
       part_size = keys_metas.size();
-      if (part_size <= this->overflow_resolution_margin_) {
+      if (part_size <= slot_overflow_resolution_margin_) {
         HCTR_LOG_C(TRACE, WORLD, get_name(), " backend; Partition ", table_name, '/', part_index,
                    ": Overflow was already resolved by another process.\n");
         return;
@@ -891,7 +1153,7 @@ void RedisClusterBackend<Key>::resolve_overflow_(const std::string& table_name,
             k_views.emplace_back(reinterpret_cast<const char*>(&km_it->first), sizeof(Key));
           }
           delete_batch(k_views);
-          if (part_size <= this->overflow_resolution_margin_) {
+          if (part_size <= slot_overflow_resolution_margin_) {
             break;
           }
         }
@@ -920,7 +1182,7 @@ void RedisClusterBackend<Key>::resolve_overflow_(const std::string& table_name,
       redis_->hgetall(hkey_m, RedisKeyTimeVectorInserter<Key>(keys_metas));
 
       part_size = keys_metas.size();
-      if (part_size <= this->overflow_resolution_margin_) {
+      if (part_size <= slot_overflow_resolution_margin_) {
         HCTR_LOG_C(TRACE, WORLD, get_name(), " backend; Partition ", table_name, '/', part_index,
                    ": Overflow was already resolved by another process.\n");
         return;
@@ -949,7 +1211,7 @@ void RedisClusterBackend<Key>::resolve_overflow_(const std::string& table_name,
           k_views.emplace_back(reinterpret_cast<const char*>(&km_it->first), sizeof(Key));
         }
         delete_batch(k_views);
-        if (part_size <= this->overflow_resolution_margin_) {
+        if (part_size <= slot_overflow_resolution_margin_) {
           break;
         }
       }
@@ -961,24 +1223,24 @@ void RedisClusterBackend<Key>::resolve_overflow_(const std::string& table_name,
 }
 
 template <typename Key>
-void RedisClusterBackend<Key>::refresh_metadata_lfu_inc_(const std::string& table_name,
-                                                         const size_t part_index,
-                                                         const std::vector<Key>& keys,
-                                                         const long long amount) {
+void RedisClusterBackend<Key>::refresh_metadata_lfu_inc_(
+    const std::string& table_name, const size_t part_index,
+    const std::vector<std::pair<Key, long long>>& keys_amounts) {
   HCTR_LOG_C(TRACE, WORLD, get_name(), " backend; Partition ", table_name, '/', part_index,
-             ": Refreshing LFU metadata of ", keys.size(), " entries (incrementing by ", amount,
-             ").\n");
+             ": Refreshing LFU metadata of ", keys_amounts.size(), " entries.\n");
 
   HCTR_PRINT_REDIS_ERRORS_({
     HCTR_DEFINE_REDIS_META_HKEY_();
 
     // Step through input batch-by-batch.
-    for (auto k_it{keys.begin()}; k_it != keys.end();) {
-      const size_t batch_size{std::min<size_t>(keys.end() - k_it, this->params_.max_batch_size)};
+    for (auto ka_it{keys_amounts.begin()}; ka_it != keys_amounts.end();) {
+      const size_t batch_size{
+          std::min<size_t>(keys_amounts.end() - ka_it, this->params_.max_batch_size)};
 
       sw::redis::Pipeline pipe{redis_->pipeline(hkey_m, false)};
-      for (const auto batch_end{k_it + batch_size}; k_it != batch_end; ++k_it) {
-        pipe.hincrby(hkey_m, {reinterpret_cast<const char*>(&*k_it), sizeof(Key)}, amount);
+      for (const auto batch_end{ka_it + batch_size}; ka_it != batch_end; ++ka_it) {
+        pipe.hincrby(hkey_m, {reinterpret_cast<const char*>(&ka_it->first), sizeof(Key)},
+                     ka_it->second);
       }
       pipe.exec();
     }
@@ -1022,9 +1284,10 @@ template <typename Key>
 void RedisClusterBackend<Key>::refresh_metadata_lru_(const std::string& table_name,
                                                      const size_t part_index,
                                                      const std::vector<Key>& keys,
-                                                     const time_t time) {
+                                                     const std::vector<time_t>& times) {
+  HCTR_CHECK(keys.size() == times.size());
   HCTR_LOG_C(TRACE, WORLD, get_name(), " backend; Partition ", table_name, '/', part_index,
-             ": Refreshing LRU metadata of ", keys.size(), " entries (assigning to ", time, ").\n");
+             ": Refreshing LRU metadata of ", keys.size(), " entries.\n");
 
   HCTR_PRINT_REDIS_ERRORS_({
     HCTR_DEFINE_REDIS_META_HKEY_();
@@ -1033,15 +1296,16 @@ void RedisClusterBackend<Key>::refresh_metadata_lru_(const std::string& table_na
     km_views.reserve(std::min(keys.size(), this->params_.max_batch_size));
 
     // Step through input batch-by-batch.
+    auto t_it{times.begin()};
     for (auto k_it{keys.begin()}; k_it != keys.end();) {
       const size_t batch_size{std::min<size_t>(keys.end() - k_it, this->params_.max_batch_size)};
 
       km_views.clear();
-      for (const auto batch_end{k_it + batch_size}; k_it != batch_end; ++k_it) {
+      for (const auto batch_end{k_it + batch_size}; k_it != batch_end; ++k_it, ++t_it) {
         km_views.emplace_back(
             std::piecewise_construct,
             std::forward_as_tuple(reinterpret_cast<const char*>(&*k_it), sizeof(Key)),
-            std::forward_as_tuple(reinterpret_cast<const char*>(&time), sizeof(time_t)));
+            std::forward_as_tuple(reinterpret_cast<const char*>(&*t_it), sizeof(time_t)));
       }
       redis_->hset(hkey_m, km_views.begin(), km_views.end());
     }
@@ -1052,22 +1316,167 @@ template <typename Key>
 void RedisClusterBackend<Key>::queue_metadata_refresh_(const std::string& table_name,
                                                        const size_t part_index,
                                                        std::shared_ptr<std::vector<Key>>&& keys) {
+  // LFU counter increment or LRU timestamp.
+  long long value;
   switch (this->params_.overflow_policy) {
-    case DatabaseOverflowPolicy_t::EvictRandom: {
-    } break;
+    case DatabaseOverflowPolicy_t::EvictRandom:
+      return;
+    case DatabaseOverflowPolicy_t::EvictLeastUsed:
+      value = 1;
+      break;
+    case DatabaseOverflowPolicy_t::EvictOldest:
+      value = static_cast<long long>(std::time(nullptr));
+      break;
+    default:
+      HCTR_OWN_THROW(Error_t::WrongInput, "Unsupported overflow policy!");
+  }
 
-    case DatabaseOverflowPolicy_t::EvictLeastUsed: {
-      background_worker_.submit([this, table_name, part_index, keys]() {
-        refresh_metadata_lfu_inc_(table_name, part_index, *keys, 1);
-      });
-    } break;
+  const size_t queue_index{part_index % refresh_queues_.size()};
+  RefreshQueue& queue{*refresh_queues_[queue_index]};
+  const size_t max_pending{this->params_.max_pending_refreshes};
 
-    case DatabaseOverflowPolicy_t::EvictOldest: {
-      const time_t now{std::time(nullptr)};
-      background_worker_.submit([this, table_name, part_index, keys, now]() {
-        refresh_metadata_lru_(table_name, part_index, *keys, now);
-      });
-    } break;
+  std::chrono::steady_clock::time_point deadline;
+  bool schedule{false};
+  {
+    const std::lock_guard lock(queue.guard);
+
+    std::unordered_map<Key, long long>& pending{queue.pending[{table_name, part_index}]};
+    size_t num_queued{0};
+    size_t num_coalesced{0};
+    size_t num_dropped{0};
+    for (const Key& key : *keys) {
+      const auto res{pending.try_emplace(key, 0)};
+      if (res.second) {
+        if (queue.num_pending >= max_pending) {
+          // Queue is full. Only refreshes of keys that are already pending can be accepted.
+          pending.erase(res.first);
+          ++num_dropped;
+          continue;
+        }
+        ++queue.num_pending;
+      } else {
+        ++num_coalesced;
+      }
+      ++num_queued;
+
+      if (this->params_.overflow_policy == DatabaseOverflowPolicy_t::EvictLeastUsed) {
+        res.first->second += value;
+      } else {
+        res.first->second = value;
+      }
+    }
+    if (pending.empty()) {
+      queue.pending.erase({table_name, part_index});
+    }
+
+    queue.num_queued += num_queued;
+    queue.num_coalesced += num_coalesced;
+    queue.num_dropped += num_dropped;
+    if (queue.num_pending > queue.max_depth) {
+      queue.max_depth = queue.num_pending;
+    }
+
+    if (!queue.scheduled && queue.num_pending) {
+      queue.scheduled = true;
+      queue.first_queued = std::chrono::steady_clock::now();
+      deadline = queue.first_queued + this->params_.refresh_window;
+      schedule = true;
+    }
+  }
+
+  // Let refreshes accumulate for a while to coalesce repeated accesses of hot keys.
+  if (schedule) {
+    {
+      const std::lock_guard lock(refresh_timer_guard_);
+      refresh_deadlines_.emplace(deadline, queue_index);
+    }
+    refresh_timer_semaphore_.notify_one();
+  }
+}
+
+template <typename Key>
+void RedisClusterBackend<Key>::flush_refresh_queue_(const size_t queue_index) {
+  RefreshQueue& queue{*refresh_queues_[queue_index]};
+
+  std::chrono::steady_clock::time_point first_queued;
+  decltype(queue.pending) pending;
+  size_t num_pending;
+  {
+    const std::lock_guard lock(queue.guard);
+    first_queued = queue.first_queued;
+    pending.swap(queue.pending);
+    num_pending = queue.num_pending;
+    queue.num_pending = 0;
+    queue.scheduled = false;
+  }
+
+  for (const auto& [table_part, keys_values] : pending) {
+    const std::string& table_name{table_part.first};
+    const size_t part_index{table_part.second};
+
+    switch (this->params_.overflow_policy) {
+      case DatabaseOverflowPolicy_t::EvictRandom:
+        break;
+
+      case DatabaseOverflowPolicy_t::EvictLeastUsed: {
+        const std::vector<std::pair<Key, long long>> keys_amounts(keys_values.begin(),
+                                                                 keys_values.end());
+        refresh_metadata_lfu_inc_(table_name, part_index, keys_amounts);
+      } break;
+
+      case DatabaseOverflowPolicy_t::EvictOldest: {
+        // Each key keeps the time of its own last access.
+        std::vector<Key> keys;
+        std::vector<time_t> times;
+        keys.reserve(keys_values.size());
+        times.reserve(keys_values.size());
+        for (const auto& kv : keys_values) {
+          keys.emplace_back(kv.first);
+          times.emplace_back(static_cast<time_t>(kv.second));
+        }
+        refresh_metadata_lru_(table_name, part_index, keys, times);
+      } break;
+    }
+  }
+
+  // Update statistics.
+  const int64_t lag{std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - first_queued)
+                        .count()};
+  queue.num_flushed += num_pending;
+  ++queue.num_flushes;
+  queue.total_lag += lag;
+  for (int64_t max_lag{queue.max_lag}; lag > max_lag;) {
+    if (queue.max_lag.compare_exchange_weak(max_lag, lag)) {
+      break;
+    }
+  }
+
+  HCTR_LOG_C(TRACE, WORLD, get_name(), " backend; Refresh queue ", queue_index, ": Applied ",
+             num_pending, " refreshes. Lag: ", lag, " ns.\n");
+}
+
+template <typename Key>
+void RedisClusterBackend<Key>::run_refresh_timer_() {
+  Logger::set_thread_name("redis refresh timer");
+
+  std::unique_lock lock(refresh_timer_guard_);
+  while (!refresh_timer_terminate_) {
+    if (refresh_deadlines_.empty()) {
+      refresh_timer_semaphore_.wait(lock);
+      continue;
+    }
+
+    const auto [deadline, queue_index]{refresh_deadlines_.top()};
+    if (std::chrono::steady_clock::now() < deadline) {
+      refresh_timer_semaphore_.wait_until(lock, deadline);
+      continue;
+    }
+    refresh_deadlines_.pop();
+
+    lock.unlock();
+    background_worker_.submit([this, queue_index]() { flush_refresh_queue_(queue_index); });
+    lock.lock();
   }
 }
 
@@ -0,0 +1,291 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <core23/logger.hpp>
+#include <cstring>
+#include <hps/value_codec.hpp>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// TODO: Remove me!
+#pragma GCC diagnostic error "-Wconversion"
+
+namespace HugeCTR {
+
+inline uint32_t float_to_bits(const float f) {
+  uint32_t u;
+  std::memcpy(&u, &f, sizeof(float));
+  return u;
+}
+
+inline float bits_to_float(const uint32_t u) {
+  float f;
+  std::memcpy(&f, &u, sizeof(float));
+  return f;
+}
+
+inline float load_float(const char* const src, const size_t i) {
+  float f;
+  std::memcpy(&f, &src[i * sizeof(float)], sizeof(float));
+  return f;
+}
+
+inline void store_float(char* const dst, const size_t i, const float f) {
+  std::memcpy(&dst[i * sizeof(float)], &f, sizeof(float));
+}
+
+inline uint16_t load_u16(const char* const src, const size_t i) {
+  uint16_t h;
+  std::memcpy(&h, &src[i * sizeof(uint16_t)], sizeof(uint16_t));
+  return h;
+}
+
+inline void store_u16(char* const dst, const size_t i, const uint16_t h) {
+  std::memcpy(&dst[i * sizeof(uint16_t)], &h, sizeof(uint16_t));
+}
+
+/**
+ * IEEE binary32 -> binary16 with round-to-nearest-even. Overflows become infinity, and NaNs stay
+ * NaNs.
+ */
+inline uint16_t float_to_half(const float f) {
+  uint32_t u{float_to_bits(f)};
+  const uint32_t sign{(u >> 16) & 0x8000};
+  u &= 0x7fffffff;
+
+  uint32_t h;
+  if (u >= (127 + 16) << 23) {
+    // Inf, NaN or too large.
+    h = u > 0x7f800000 ? 0x7e00 : 0x7c00;
+  } else if (u < (127 - 14) << 23) {
+    // Subnormal or zero. Let the FPU do the rounding.
+    constexpr uint32_t denorm_magic{((127 - 15) + (23 - 10) + 1) << 23};
+    h = float_to_bits(bits_to_float(u) + bits_to_float(denorm_magic)) - denorm_magic;
+  } else {
+    // Normal. Rebias exponent, and round mantissa.
+    const uint32_t mant_odd{(u >> 13) & 1};
+    u += (static_cast<uint32_t>(15 - 127) << 23) + 0xfff + mant_odd;
+    h = u >> 13;
+  }
+  return static_cast<uint16_t>(h | sign);
+}
+
+inline float half_to_float(const uint16_t h) {
+  const uint32_t sign{static_cast<uint32_t>(h & 0x8000) << 16};
+  uint32_t exp{(h >> 10) & 0x1fU};
+  uint32_t mant{h & 0x3ffU};
+
+  if (exp == 0x1f) {
+    // Inf or NaN.
+    return bits_to_float(sign | 0x7f800000 | (mant << 13));
+  } else if (exp == 0) {
+    if (mant == 0) {
+      return bits_to_float(sign);
+    }
+    // Subnormal. Normalize mantissa.
+    exp = 127 - 15 + 1;
+    while (!(mant & 0x400)) {
+      mant <<= 1;
+      --exp;
+    }
+    mant &= 0x3ff;
+    return bits_to_float(sign | (exp << 23) | (mant << 13));
+  }
+  return bits_to_float(sign | ((exp + 127 - 15) << 23) | (mant << 13));
+}
+
+/**
+ * IEEE binary32 -> bfloat16 with round-to-nearest-even.
+ */
+inline uint16_t float_to_bfloat16(const float f) {
+  const uint32_t u{float_to_bits(f)};
+  if ((u & 0x7fffffff) > 0x7f800000) {
+    // Keep NaNs quiet.
+    return static_cast<uint16_t>((u >> 16) | 0x40);
+  }
+  return static_cast<uint16_t>((u + 0x7fff + ((u >> 16) & 1)) >> 16);
+}
+
+inline float bfloat16_to_float(const uint16_t h) {
+  return bits_to_float(static_cast<uint32_t>(h) << 16);
+}
+
+static void encode_fp16(const char* const src, const size_t n, char* const dst) {
+  size_t i{0};
+#if defined(__F16C__) && defined(__AVX__)
+  for (; i + 8 <= n; i += 8) {
+    const __m256 v{_mm256_loadu_ps(reinterpret_cast<const float*>(&src[i * sizeof(float)]))};
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&dst[i * sizeof(uint16_t)]),
+                     _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+  }
+#endif
+  for (; i < n; ++i) {
+    store_u16(dst, i, float_to_half(load_float(src, i)));
+  }
+}
+
+static void decode_fp16(const char* const src, const size_t n, char* const dst) {
+  size_t i{0};
+#if defined(__F16C__) && defined(__AVX__)
+  for (; i + 8 <= n; i += 8) {
+    const __m128i h{_mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[i * sizeof(uint16_t)]))};
+    _mm256_storeu_ps(reinterpret_cast<float*>(&dst[i * sizeof(float)]), _mm256_cvtph_ps(h));
+  }
+#endif
+  for (; i < n; ++i) {
+    store_float(dst, i, half_to_float(load_u16(src, i)));
+  }
+}
+
+static void encode_bf16(const char* const src, const size_t n, char* const dst) {
+  for (size_t i{0}; i < n; ++i) {
+    store_u16(dst, i, float_to_bfloat16(load_float(src, i)));
+  }
+}
+
+static void decode_bf16(const char* const src, const size_t n, char* const dst) {
+  size_t i{0};
+#if defined(__AVX2__)
+  for (; i + 8 <= n; i += 8) {
+    const __m128i h{_mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[i * sizeof(uint16_t)]))};
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(&dst[i * sizeof(float)]),
+                        _mm256_slli_epi32(_mm256_cvtepu16_epi32(h), 16));
+  }
+#elif defined(__SSE2__)
+  const __m128i zero{_mm_setzero_si128()};
+  for (; i + 8 <= n; i += 8) {
+    const __m128i h{_mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[i * sizeof(uint16_t)]))};
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&dst[i * sizeof(float)]),
+                     _mm_unpacklo_epi16(zero, h));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&dst[(i + 4) * sizeof(float)]),
+                     _mm_unpackhi_epi16(zero, h));
+  }
+#endif
+  for (; i < n; ++i) {
+    store_float(dst, i, bfloat16_to_float(load_u16(src, i)));
+  }
+}
+
+static void encode_int8(const char* const src, const size_t n, char* const dst) {
+  float max_abs{0};
+  for (size_t i{0}; i < n; ++i) {
+    max_abs = std::max(max_abs, std::abs(load_float(src, i)));
+  }
+
+  const float scale{max_abs / 127.f};
+  const float inv_scale{max_abs > 0 ? 127.f / max_abs : 0.f};
+  std::memcpy(dst, &scale, sizeof(float));
+
+  int8_t* const q{reinterpret_cast<int8_t*>(&dst[sizeof(float)])};
+  for (size_t i{0}; i < n; ++i) {
+    const float x{std::nearbyint(load_float(src, i) * inv_scale)};
+    q[i] = static_cast<int8_t>(std::min(std::max(x, -127.f), 127.f));
+  }
+}
+
+static void decode_int8(const char* const src, const size_t n, char* const dst) {
+  float scale;
+  std::memcpy(&scale, src, sizeof(float));
+  const int8_t* const q{reinterpret_cast<const int8_t*>(&src[sizeof(float)])};
+
+  size_t i{0};
+#if defined(__AVX2__)
+  const __m256 vscale{_mm256_set1_ps(scale)};
+  for (; i + 8 <= n; i += 8) {
+    const __m256i v{_mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&q[i])))};
+    _mm256_storeu_ps(reinterpret_cast<float*>(&dst[i * sizeof(float)]),
+                     _mm256_mul_ps(_mm256_cvtepi32_ps(v), vscale));
+  }
+#elif defined(__SSE4_1__)
+  const __m128 vscale{_mm_set1_ps(scale)};
+  for (; i + 4 <= n; i += 4) {
+    int32_t q4;
+    std::memcpy(&q4, &q[i], sizeof(int32_t));
+    const __m128i v{_mm_cvtepi8_epi32(_mm_cvtsi32_si128(q4))};
+    _mm_storeu_ps(reinterpret_cast<float*>(&dst[i * sizeof(float)]),
+                  _mm_mul_ps(_mm_cvtepi32_ps(v), vscale));
+  }
+#endif
+  for (; i < n; ++i) {
+    store_float(dst, i, static_cast<float>(q[i]) * scale);
+  }
+}
+
+uint32_t value_codec_encoded_size(const DatabaseValueCodec_t codec, const uint32_t value_size) {
+  if (codec != DatabaseValueCodec_t::None) {
+    HCTR_CHECK_HINT(value_size % sizeof(float) == 0,
+                    "Value codec '", hctr_enum_to_c_str(codec),
+                    "' requires fp32 values, but value_size = ", value_size, ".");
+  }
+  const uint32_t n{value_size / static_cast<uint32_t>(sizeof(float))};
+
+  switch (codec) {
+    case DatabaseValueCodec_t::None:
+      return value_size;
+    case DatabaseValueCodec_t::FP16:
+    case DatabaseValueCodec_t::BF16:
+      return n * static_cast<uint32_t>(sizeof(uint16_t));
+    case DatabaseValueCodec_t::Int8:
+      return static_cast<uint32_t>(sizeof(float)) + n;
+  }
+  HCTR_DIE("Unsupported value codec!");
+  return 0;
+}
+
+void value_codec_encode(const DatabaseValueCodec_t codec, const char* const src,
+                        const uint32_t value_size, char* const dst) {
+  const size_t n{value_size / sizeof(float)};
+
+  switch (codec) {
+    case DatabaseValueCodec_t::None:
+      std::copy_n(src, value_size, dst);
+      break;
+    case DatabaseValueCodec_t::FP16:
+      encode_fp16(src, n, dst);
+      break;
+    case DatabaseValueCodec_t::BF16:
+      encode_bf16(src, n, dst);
+      break;
+    case DatabaseValueCodec_t::Int8:
+      encode_int8(src, n, dst);
+      break;
+  }
+}
+
+void value_codec_decode(const DatabaseValueCodec_t codec, const char* const src,
+                        const uint32_t value_size, char* const dst) {
+  const size_t n{value_size / sizeof(float)};
+
+  switch (codec) {
+    case DatabaseValueCodec_t::None:
+      std::copy_n(src, value_size, dst);
+      break;
+    case DatabaseValueCodec_t::FP16:
+      decode_fp16(src, n, dst);
+      break;
+    case DatabaseValueCodec_t::BF16:
+      decode_bf16(src, n, dst);
+      break;
+    case DatabaseValueCodec_t::Int8:
+      decode_int8(src, n, dst);
+      break;
+  }
+}
+
+}  // namespace HugeCTR
@@ -0,0 +1,387 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cuda_fp16.h>
+
+#include <algorithm>
+#include <cmath>
+#include <core23/data_type.hpp>
+#include <core23/device.hpp>
+#include <core23/low_level_primitives.hpp>
+#include <functional>
+#include <streaming_metrics.hpp>
+
+namespace HugeCTR {
+
+namespace metrics {
+
+BinnedAUCSketch::BinnedAUCSketch(size_t num_bins, float pred_min, float pred_max)
+    : pred_min_(pred_min),
+      bins_per_unit_(num_bins / static_cast<double>(pred_max - pred_min)),
+      num_bins_(num_bins),
+      weights_(2 * num_bins, 0.0) {
+  HCTR_CHECK_HINT(num_bins > 0 && pred_max > pred_min, "Illegal AUC bins!");
+}
+
+void BinnedAUCSketch::add(const float* preds, const float* labels, size_t num_samples) {
+  double* positives = weights_.data();
+  double* negatives = weights_.data() + num_bins_;
+  const size_t last_bin = num_bins_ - 1;
+  for (size_t i = 0; i < num_samples; ++i) {
+    const double offset = (preds[i] - pred_min_) * bins_per_unit_;
+    const size_t bin = offset > 0.0 ? static_cast<size_t>(std::min<double>(offset, last_bin)) : 0;
+    positives[bin] += labels[i];
+    negatives[bin] += 1.0f - labels[i];
+  }
+}
+
+void BinnedAUCSketch::merge(const BinnedAUCSketch& other) {
+  HCTR_CHECK_HINT(other.weights_.size() == weights_.size(), "Cannot merge different AUC bins!");
+  std::transform(weights_.begin(), weights_.end(), other.weights_.begin(), weights_.begin(),
+                 std::plus<double>());
+}
+
+void BinnedAUCSketch::reset() { std::fill(weights_.begin(), weights_.end(), 0.0); }
+
+// Area under the ROC curve, walking the bins from the highest predictions down.
+double BinnedAUCSketch::value() const {
+  const double* positives = weights_.data();
+  const double* negatives = weights_.data() + num_bins_;
+  double num_positives = 0.0;
+  double area = 0.0;
+  double num_negatives = 0.0;
+  for (size_t bin = num_bins_; bin-- > 0;) {
+    area += negatives[bin] * (num_positives + 0.5 * positives[bin]);
+    num_positives += positives[bin];
+    num_negatives += negatives[bin];
+  }
+  return (num_positives > 0.0 && num_negatives > 0.0) ? area / (num_positives * num_negatives)
+                                                      : 0.0;
+}
+
+double BinnedAUCSketch::error_bound() const {
+  const double* positives = weights_.data();
+  const double* negatives = weights_.data() + num_bins_;
+  double num_positives = 0.0;
+  double num_negatives = 0.0;
+  double tied = 0.0;
+  for (size_t bin = 0; bin < num_bins_; ++bin) {
+    tied += positives[bin] * negatives[bin];
+    num_positives += positives[bin];
+    num_negatives += negatives[bin];
+  }
+  return (num_positives > 0.0 && num_negatives > 0.0)
+             ? 0.5 * tied / (num_positives * num_negatives)
+             : 0.0;
+}
+
+void LogLossSketch::add(const float* preds, const float* labels, size_t num_samples) {
+  constexpr float eps = 1e-7f;
+  double loss = 0.0;
+  for (size_t i = 0; i < num_samples; ++i) {
+    const float pred = std::min(std::max(preds[i], eps), 1.0f - eps);
+    loss -= labels[i] * std::log(pred) + (1.0f - labels[i]) * std::log(1.0f - pred);
+  }
+  weights_[0] += loss;
+  weights_[1] += num_samples;
+}
+
+void LogLossSketch::merge(const LogLossSketch& other) {
+  weights_[0] += other.weights_[0];
+  weights_[1] += other.weights_[1];
+}
+
+void LogLossSketch::reset() { std::fill(weights_.begin(), weights_.end(), 0.0); }
+
+double LogLossSketch::value() const { return weights_[1] > 0.0 ? weights_[0] / weights_[1] : 0.0; }
+
+void HitRateSketch::add(const float* preds, const float* labels, size_t num_samples) {
+  size_t hits = 0;
+  size_t checked = 0;
+  for (size_t i = 0; i < num_samples; ++i) {
+    const bool above = preds[i] > threshold_;
+    checked += above;
+    hits += above && labels[i] == 1.0f;
+  }
+  weights_[0] += hits;
+  weights_[1] += checked;
+}
+
+void HitRateSketch::merge(const HitRateSketch& other) {
+  weights_[0] += other.weights_[0];
+  weights_[1] += other.weights_[1];
+}
+
+void HitRateSketch::reset() { std::fill(weights_.begin(), weights_.end(), 0.0); }
+
+double HitRateSketch::value() const { return weights_[1] > 0.0 ? weights_[0] / weights_[1] : 0.0; }
+
+namespace {
+
+// Orders the ranking from the best sample to the worst, so that heaps built with it keep the
+// worst of the current top k at the front.
+bool ranks_before(const std::pair<float, float>& lhs, const std::pair<float, float>& rhs) {
+  return lhs.first > rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+}
+
+double discounted_gain(const std::vector<float>& ranked_labels) {
+  double dcg = 0.0;
+  for (size_t i = 0; i < ranked_labels.size(); ++i) {
+    dcg += ranked_labels[i] / std::log2(i + 2.0);
+  }
+  return dcg;
+}
+
+}  // namespace
+
+TopKSketch::TopKSketch(size_t k) : k_(k) { HCTR_CHECK_HINT(k > 0, "NDCG@k needs k > 0!"); }
+
+void TopKSketch::offer(const std::pair<float, float>& sample) {
+  if (top_preds_.size() == k_) {
+    if (!ranks_before(sample, top_preds_.front())) {
+      return;
+    }
+    std::pop_heap(top_preds_.begin(), top_preds_.end(), ranks_before);
+    top_preds_.pop_back();
+  }
+  top_preds_.push_back(sample);
+  std::push_heap(top_preds_.begin(), top_preds_.end(), ranks_before);
+}
+
+void TopKSketch::offer_label(float label) {
+  if (top_labels_.size() == k_) {
+    if (!(label > top_labels_.front())) {
+      return;
+    }
+    std::pop_heap(top_labels_.begin(), top_labels_.end(), std::greater<float>());
+    top_labels_.pop_back();
+  }
+  top_labels_.push_back(label);
+  std::push_heap(top_labels_.begin(), top_labels_.end(), std::greater<float>());
+}
+
+void TopKSketch::add(const float* preds, const float* labels, size_t num_samples) {
+  for (size_t i = 0; i < num_samples; ++i) {
+    offer({preds[i], labels[i]});
+    offer_label(labels[i]);
+  }
+}
+
+void TopKSketch::merge(const TopKSketch& other) { merge(other.top_preds_, other.top_labels_); }
+
+void TopKSketch::merge(const std::vector<std::pair<float, float>>& top_preds,
+                       const std::vector<float>& top_labels) {
+  for (const auto& sample : top_preds) {
+    offer(sample);
+  }
+  for (const float label : top_labels) {
+    offer_label(label);
+  }
+}
+
+void TopKSketch::reset() {
+  top_preds_.clear();
+  top_labels_.clear();
+}
+
+double TopKSketch::value() const {
+  auto ranked = top_preds_;
+  std::sort(ranked.begin(), ranked.end(), ranks_before);
+  std::vector<float> labels(ranked.size());
+  std::transform(ranked.begin(), ranked.end(), labels.begin(),
+                 [](const auto& sample) { return sample.second; });
+  std::vector<float> ideal_labels = top_labels_;
+  std::sort(ideal_labels.begin(), ideal_labels.end(), std::greater<float>());
+
+  const double ideal_dcg = discounted_gain(ideal_labels);
+  return ideal_dcg > 0.0 ? discounted_gain(labels) / ideal_dcg : 0.0;
+}
+
+namespace {
+
+#ifdef ENABLE_MPI
+bool mpi_ready() {
+  int initialized = 0;
+  int num_processes = 1;
+  HCTR_MPI_THROW(MPI_Initialized(&initialized));
+  if (initialized) {
+    HCTR_MPI_THROW(MPI_Comm_size(MPI_COMM_WORLD, &num_processes));
+  }
+  return num_processes > 1;
+}
+#endif
+
+// Sketches made of sums add up across ranks.
+template <typename Sketch>
+void all_reduce(Sketch& sketch) {
+#ifdef ENABLE_MPI
+  if (mpi_ready()) {
+    std::vector<double>& weights = sketch.weights();
+    HCTR_MPI_THROW(MPI_Allreduce(MPI_IN_PLACE, weights.data(), weights.size(), MPI_DOUBLE, MPI_SUM,
+                                 MPI_COMM_WORLD));
+  }
+#endif
+}
+
+// Top k sketches are gathered as [num_preds, num_labels, (pred, label) * k, label * k].
+void all_reduce(TopKSketch& sketch) {
+#ifdef ENABLE_MPI
+  if (mpi_ready()) {
+    const size_t k = sketch.k();
+    const size_t stride = 2 + 3 * k;
+    std::vector<float> local(stride, 0.0f);
+    local[0] = sketch.top_preds().size();
+    local[1] = sketch.top_labels().size();
+    for (size_t i = 0; i < sketch.top_preds().size(); ++i) {
+      local[2 + 2 * i] = sketch.top_preds()[i].first;
+      local[3 + 2 * i] = sketch.top_preds()[i].second;
+    }
+    std::copy(sketch.top_labels().begin(), sketch.top_labels().end(), local.begin() + 2 + 2 * k);
+
+    int num_processes = 1;
+    HCTR_MPI_THROW(MPI_Comm_size(MPI_COMM_WORLD, &num_processes));
+    std::vector<float> all(stride * num_processes);
+    HCTR_MPI_THROW(MPI_Allgather(local.data(), stride, MPI_FLOAT, all.data(), stride, MPI_FLOAT,
+                                 MPI_COMM_WORLD));
+
+    // Every rank rebuilds the same sketch from all ranks, including itself.
+    sketch.reset();
+    for (int rank = 0; rank < num_processes; ++rank) {
+      const float* remote = all.data() + rank * stride;
+      std::vector<std::pair<float, float>> top_preds(static_cast<size_t>(remote[0]));
+      for (size_t i = 0; i < top_preds.size(); ++i) {
+        top_preds[i] = {remote[2 + 2 * i], remote[3 + 2 * i]};
+      }
+      const float* labels = remote + 2 + 2 * k;
+      sketch.merge(top_preds, std::vector<float>(labels, labels + static_cast<size_t>(remote[1])));
+    }
+  }
+#endif
+}
+
+}  // namespace
+
+template <typename Sketch>
+StreamingMetric<Sketch>::StreamingMetric(const std::string& name, size_t num_workers,
+                                         const Sketch& prototype, size_t first_global_worker)
+    : Metric(), name_(name), first_global_worker_(first_global_worker), result_(prototype) {
+  HCTR_CHECK_HINT(num_workers > 0, "A streaming metric needs at least one worker!");
+  workers_.reserve(num_workers);
+  for (size_t i = 0; i < num_workers; ++i) {
+    workers_.emplace_back(prototype);
+  }
+}
+
+template <typename Sketch>
+void StreamingMetric<Sketch>::local_reduce(int worker_id, Core23RawMetricMap raw_metrics) {
+  HCTR_CHECK_HINT(worker_id >= 0 && static_cast<size_t>(worker_id) < workers_.size(),
+                  "Invalid streaming metric worker!");
+  Worker& worker = workers_[worker_id];
+  const core23::Tensor& pred_tensor = raw_metrics[RawType::Pred];
+  const core23::Tensor& label_tensor = raw_metrics[RawType::Label];
+  int64_t num_samples = pred_tensor.num_elements();
+  HCTR_CHECK_HINT(label_tensor.num_elements() == num_samples,
+                  "Streaming metrics need one label per prediction!");
+  if (current_batch_size_ > 0) {
+    num_samples = get_num_valid_samples(static_cast<int>(first_global_worker_) + worker_id,
+                                        current_batch_size_, static_cast<int>(num_samples));
+  }
+  if (num_samples == 0) {
+    return;
+  }
+
+  // Reads a tensor as floats, copying it to the host and converting it if needed.
+  const core23::Device host(core23::DeviceType::CPU);
+  auto host_floats = [&](const core23::Tensor& tensor,
+                         std::vector<float>& staging) -> const float* {
+    const bool on_host = tensor.device().type() == core23::DeviceType::CPU;
+    if (tensor.data_type().match<float>()) {
+      if (on_host) {
+        return tensor.data<float>();
+      }
+      staging.resize(num_samples);
+      core23::copy_sync(staging.data(), tensor.data(), num_samples * sizeof(float), host,
+                        tensor.device());
+      return staging.data();
+    }
+    HCTR_CHECK_HINT(tensor.data_type().match<__half>(),
+                    "Streaming metrics support float and half tensors only!");
+    std::vector<__half> halves;
+    const __half* src = tensor.data<__half>();
+    if (!on_host) {
+      halves.resize(num_samples);
+      core23::copy_sync(halves.data(), src, num_samples * sizeof(__half), host, tensor.device());
+      src = halves.data();
+    }
+    staging.resize(num_samples);
+    std::transform(src, src + num_samples, staging.begin(),
+                   [](const __half value) { return __half2float(value); });
+    return staging.data();
+  };
+
+  const float* preds = host_floats(pred_tensor, worker.preds);
+  const float* labels = host_floats(label_tensor, worker.labels);
+  worker.sketch.add(preds, labels, num_samples);
+}
+
+template <typename Sketch>
+float StreamingMetric<Sketch>::finalize_metric() {
+  result_.reset();
+  for (auto& worker : workers_) {
+    result_.merge(worker.sketch);
+    worker.sketch.reset();
+  }
+  all_reduce(result_);
+  return result_.value();
+}
+
+template class StreamingMetric<BinnedAUCSketch>;
+template class StreamingMetric<LogLossSketch>;
+template class StreamingMetric<HitRateSketch>;
+template class StreamingMetric<TopKSketch>;
+
+std::unique_ptr<Metric> create_streaming_metric(Type type, const StreamingMetricParams& params) {
+  std::unique_ptr<Metric> ret;
+  switch (type) {
+    case Type::AUC:
+      ret.reset(new StreamingMetric<BinnedAUCSketch>(
+          "AUC", params.num_workers,
+          BinnedAUCSketch(params.auc_num_bins, params.pred_min, params.pred_max),
+          params.first_global_worker));
+      break;
+    case Type::AverageLoss:
+      ret.reset(new StreamingMetric<LogLossSketch>("AverageLoss", params.num_workers,
+                                                   LogLossSketch(), params.first_global_worker));
+      break;
+    case Type::HitRate:
+      ret.reset(new StreamingMetric<HitRateSketch>("HitRate", params.num_workers,
+                                                   HitRateSketch(params.hit_threshold),
+                                                   params.first_global_worker));
+      break;
+    case Type::NDCG:
+      ret.reset(new StreamingMetric<TopKSketch>("NDCG@" + std::to_string(params.ndcg_k),
+                                                params.num_workers, TopKSketch(params.ndcg_k),
+                                                params.first_global_worker));
+      break;
+    default:
+      HCTR_OWN_THROW(Error_t::WrongInput, "This metric has no streaming implementation.");
+  }
+  return ret;
+}
+
+}  // namespace metrics
+
+}  // namespace HugeCTR
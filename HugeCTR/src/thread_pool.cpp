@@ -14,16 +14,73 @@
  * limitations under the License.
  */
 
+#include <numa.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <cerrno>
 #include <core23/logger.hpp>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <thread_pool.hpp>
 
 namespace HugeCTR {
 
+namespace {
+
+// Allows workers to identify themselves (used to keep work local and to help while waiting).
+thread_local const ThreadPool* tls_pool{nullptr};
+thread_local size_t tls_worker_index{0};
+
+ThreadPoolAffinity_t get_default_affinity() {
+  const char* affinity_str = getenv("HCTR_DEFAULT_AFFINITY");
+  if (affinity_str) {
+    const std::string affinity{affinity_str};
+    if (affinity == "core") {
+      return ThreadPoolAffinity_t::Core;
+    } else if (affinity == "numa_node") {
+      return ThreadPoolAffinity_t::NumaNode;
+    }
+  }
+  return ThreadPoolAffinity_t::None;
+}
+
+}  // namespace
+
+void ThreadPool::BulkJob::run() {
+  for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < n;) {
+    try {
+      fn(ctx, i);
+    } catch (...) {
+      if (!has_error.test_and_set()) {
+        error = std::current_exception();
+      }
+    }
+  }
+}
+
+void ThreadPool::BulkJob::finish_helper() {
+  // The job lives on the stack of the caller, which may return as soon as it observes the last
+  // helper to finish. Decrementing under the lock ensures that we are done with `done` by then.
+  std::lock_guard<std::mutex> lock(guard);
+  if (num_pending_helpers.fetch_sub(1, std::memory_order_release) == 1) {
+    done.notify_one();
+  }
+}
+
 ThreadPool::ThreadPool(const std::string& name) : ThreadPool(name, 0) {}
 
-ThreadPool::ThreadPool(const std::string& name, size_t num_workers) : name_(name) {
+ThreadPool::ThreadPool(const std::string& name, size_t num_workers)
+    : ThreadPool(name, num_workers, ThreadPoolAffinity_t::None) {}
+
+ThreadPool::ThreadPool(const std::string& name, size_t num_workers,
+                       const ThreadPoolAffinity_t affinity)
+    : ThreadPool(name, num_workers, affinity, -1) {}
+
+ThreadPool::ThreadPool(const std::string& name, size_t num_workers,
+                       const ThreadPoolAffinity_t affinity, const int numa_node)
+    : name_(name), affinity_(affinity), numa_node_(numa_node) {
   // Determine eventual number of threads.
   if (num_workers == 0) {
     const char* num_workers_str = getenv("HCTR_DEFAULT_CONCURRENCY");
@@ -34,7 +91,10 @@ ThreadPool::ThreadPool(const std::string& name, size_t num_workers) : name_(name
     }
   }
 
-  // Create worker threads.
+  // Create work queues, and worker threads.
+  for (size_t i = 0; i < num_workers; i++) {
+    queues_.emplace_back(std::make_unique<WorkQueue>());
+  }
   for (size_t i = 0; i < num_workers; i++) {
     workers_.emplace_back(&ThreadPool::run_, this, i);
   }
@@ -55,12 +115,19 @@ ThreadPool::~ThreadPool() {
   for (auto& worker : workers_) {
     worker.join();
   }
+
+  // Release work packages that were never executed.
+  for (auto& queue : queues_) {
+    for (const Task& task : queue->tasks) {
+      task.drop(task.arg);
+    }
+  }
 }
 
 bool ThreadPool::idle() const {
   // Momentarily request exclusive access, and read out the idle status.
   std::lock_guard<std::mutex> lock(barrier_);
-  return num_idle_workers_ == workers_.size() && packages_.empty();
+  return num_idle_workers_ == workers_.size() && num_queued_tasks_ == 0;
 }
 
 void ThreadPool::await_idle() const {
@@ -68,7 +135,7 @@ void ThreadPool::await_idle() const {
   std::unique_lock<std::mutex> lock(barrier_);
 
   // Are we idle already? If not wait for a worker to exit.
-  while (num_idle_workers_ != workers_.size() || !packages_.empty()) {
+  while (num_idle_workers_ != workers_.size() || num_queued_tasks_ != 0) {
     if (terminate_) {
       HCTR_OWN_THROW(Error_t::IllegalCall, "Attempted to await an already terminated ThreadPool!");
     }
@@ -77,21 +144,21 @@ void ThreadPool::await_idle() const {
 }
 
 std::future<void> ThreadPool::submit(std::function<void()> task) {
-  std::packaged_task<void()> package(std::move(task));
-  std::future<void> result = package.get_future();
+  auto package{std::make_unique<std::packaged_task<void()>>(std::move(task))};
+  std::future<void> result = package->get_future();
 
-  // Momentarily request exclusive access, to submit the task.
+  // Momentarily request exclusive access, to check the pool state.
   {
     std::lock_guard<std::mutex> lock(barrier_);
     if (terminate_) {
       HCTR_OWN_THROW(Error_t::IllegalCall,
                      "Attempted to submit work to an already terminated ThreadPool!");
     }
-    packages_.emplace_back(std::move(package));
   }
 
-  // Wake up a worker.
-  submit_sempahore_.notify_one();
+  using Package = std::packaged_task<void()>;
+  push_({[](void* const arg) { std::unique_ptr<Package>(static_cast<Package*>(arg))->operator()(); },
+         [](void* const arg) { delete static_cast<Package*>(arg); }, package.release()});
 
   return result;
 }
@@ -100,16 +167,190 @@ ThreadPool& ThreadPool::get() {
   // Lazy init of default thread-pool on first call to this function..
   static std::unique_ptr<ThreadPool> default_pool;
   static std::once_flag semaphore;
-  std::call_once(semaphore, []() { default_pool = std::make_unique<ThreadPool>("default"); });
+  std::call_once(semaphore, []() {
+    default_pool = std::make_unique<ThreadPool>("default", 0, get_default_affinity());
+  });
   return *default_pool.get();
 }
 
+void ThreadPool::parallel_for_(const size_t n, void (*const fn)(void*, size_t), void* const ctx) {
+  if (n == 0) {
+    return;
+  }
+
+  BulkJob job;
+  job.fn = fn;
+  job.ctx = ctx;
+  job.n = n;
+
+  // Recruit helpers. The calling thread takes care of one share of the work itself.
+  const size_t num_helpers{std::min(n - 1, workers_.size())};
+  if (num_helpers) {
+    job.num_pending_helpers.store(num_helpers, std::memory_order_relaxed);
+
+    const Task helper{[](void* const arg) {
+                        BulkJob& job{*static_cast<BulkJob*>(arg)};
+                        job.run();
+                        job.finish_helper();
+                      },
+                      [](void* const arg) { static_cast<BulkJob*>(arg)->finish_helper(); }, &job};
+    for (size_t i = 0; i < num_helpers; i++) {
+      push_(helper);
+    }
+  }
+
+  // Take our share of the iterations from the shared counter.
+  job.run();
+
+  // `job` lives on our stack. Hence, we must wait until all helpers are done with it. If we are a
+  // worker of this pool, we lend a hand to avoid starving nested invocations. Once the queues are
+  // empty, every helper has been picked up by some thread and we can sleep until the last one is
+  // done.
+  if (tls_pool == this) {
+    Task task;
+    while (job.num_pending_helpers.load(std::memory_order_acquire) != 0 &&
+           pop_(tls_worker_index, task)) {
+      task.run(task.arg);
+    }
+  }
+  {
+    std::unique_lock<std::mutex> lock(job.guard);
+    job.done.wait(lock, [&job]() {
+      return job.num_pending_helpers.load(std::memory_order_acquire) == 0;
+    });
+  }
+
+  if (job.error) {
+    std::rethrow_exception(job.error);
+  }
+}
+
+void ThreadPool::push_(const Task& task) {
+  HCTR_CHECK_HINT(!queues_.empty(), "Attempted to submit work to a ThreadPool without workers!");
+
+  // Workers keep their own work local. Other threads distribute it round-robin.
+  const size_t queue_index{tls_pool == this
+                               ? tls_worker_index
+                               : next_queue_.fetch_add(1, std::memory_order_relaxed) %
+                                     queues_.size()};
+  {
+    WorkQueue& queue{*queues_[queue_index]};
+    std::lock_guard<std::mutex> lock(queue.guard);
+    queue.tasks.emplace_back(task);
+    ++num_queued_tasks_;
+  }
+
+  // Wake up a worker (only required if some of them are sleeping).
+  if (num_idle_workers_ != 0) {
+    std::lock_guard<std::mutex> lock(barrier_);
+    submit_sempahore_.notify_one();
+  }
+}
+
+bool ThreadPool::pop_(const size_t queue_index, Task& task) {
+  if (num_queued_tasks_ == 0) {
+    return false;
+  }
+
+  // Try own queue first, then attempt to steal from the other workers.
+  const size_t num_queues{queues_.size()};
+  for (size_t i = 0; i < num_queues; i++) {
+    WorkQueue& queue{*queues_[(queue_index + i) % num_queues]};
+    std::lock_guard<std::mutex> lock(queue.guard);
+    if (!queue.tasks.empty()) {
+      task = queue.tasks.front();
+      queue.tasks.pop_front();
+      --num_queued_tasks_;
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::pin_worker_(const size_t thread_index) const {
+  switch (affinity_) {
+    case ThreadPoolAffinity_t::None:
+      break;
+
+    case ThreadPoolAffinity_t::Core: {
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      HCTR_CHECK(sched_getaffinity(0, sizeof(cpus), &cpus) == 0);
+
+      std::vector<int> available_cpus;
+      for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &cpus)) {
+          available_cpus.emplace_back(cpu);
+        }
+      }
+      if (available_cpus.empty()) {
+        break;
+      }
+
+      const int cpu{available_cpus[thread_index % available_cpus.size()]};
+      CPU_ZERO(&cpus);
+      CPU_SET(cpu, &cpus);
+      HCTR_CHECK(pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0);
+      HCTR_LOG_S(DEBUG, WORLD) << "ThreadPool " << name_ << ": Pinned worker #" << thread_index
+                               << " to CPU " << cpu << '.' << std::endl;
+    } break;
+
+    case ThreadPoolAffinity_t::NumaNode: {
+      if (numa_available() < 0) {
+        break;
+      }
+
+      int node{numa_node_};
+      if (node < 0) {
+        // Distribute the workers across the nodes that we may run on and that have CPU cores.
+        std::vector<int> nodes;
+        bitmask* const run_nodes{numa_get_run_node_mask()};
+        bitmask* const cpus{numa_allocate_cpumask()};
+        for (int n = 0; n <= numa_max_node(); n++) {
+          if (numa_bitmask_isbitset(run_nodes, n) && numa_node_to_cpus(n, cpus) == 0 &&
+              numa_bitmask_weight(cpus) > 0) {
+            nodes.emplace_back(n);
+          }
+        }
+        numa_free_cpumask(cpus);
+        numa_bitmask_free(run_nodes);
+        if (nodes.empty()) {
+          break;
+        }
+        node = nodes[thread_index % nodes.size()];
+      }
+
+      if (numa_run_on_node(node) != 0) {
+        HCTR_LOG_S(WARNING, WORLD) << "ThreadPool " << name_ << ": Unable to pin worker #"
+                                   << thread_index << " to NUMA node " << node << " ("
+                                   << std::strerror(errno) << ")." << std::endl;
+        break;
+      }
+      numa_set_preferred(node);
+      HCTR_LOG_S(DEBUG, WORLD) << "ThreadPool " << name_ << ": Pinned worker #" << thread_index
+                               << " to NUMA node " << node << '.' << std::endl;
+    } break;
+  }
+}
+
 void ThreadPool::run_(const size_t thread_index) {
   if (name_ != "") {
     Logger::set_thread_name(name_ + " #" + std::to_string(thread_index));
   }
+  pin_worker_(thread_index);
+
+  tls_pool = this;
+  tls_worker_index = thread_index;
+
   while (true) {
-    thread_local std::packaged_task<void()> package;
+    Task task;
+
+    // Execute work packages while there are any. Once termination was requested, the remaining
+    // packages are left to the destructor, which releases them.
+    if (!terminate_.load(std::memory_order_relaxed) && pop_(thread_index, task)) {
+      task.run(task.arg);
+      continue;
+    }
 
     // Acquire exclusive access.
     {
@@ -120,29 +361,21 @@ void ThreadPool::run_(const size_t thread_index) {
         return;
       }
 
-      // If no work package queued.
-      while (packages_.empty()) {
-        // Enter idle state (notify threads that wait for the threadpool to go idle).
-        num_idle_workers_ += 1;
-        idle_semaphore_.notify_all();
+      // Enter idle state (notify threads that wait for the threadpool to go idle).
+      num_idle_workers_ += 1;
+      idle_semaphore_.notify_all();
 
-        // Wait for a task.
-        submit_sempahore_.wait(barrier_lock);
-        num_idle_workers_ -= 1;
+      // Wait for a task.
+      submit_sempahore_.wait(barrier_lock,
+                             [&]() { return terminate_ || num_queued_tasks_ != 0; });
+      num_idle_workers_ -= 1;
 
-        // If woken up by terminate request.
-        if (terminate_) {
-          return;
-        }
+      // If woken up by terminate request.
+      if (terminate_) {
+        return;
       }
-
-      package = std::move(packages_.front());
-      packages_.pop_front();
     }
-
-    // Execute work package.
-    package();
   }
 }
 
-}  // namespace HugeCTR
\ No newline at end of file
+}  // namespace HugeCTR
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cuda_runtime.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <core23/details/host_launch_helpers.hpp>
+#include <core23/details/philox.hpp>
+#include <core23/device.hpp>
+#include <core23/low_level_primitives.hpp>
+#include <limits>
+#include <vector>
+
+using namespace HugeCTR::core23;
+
+namespace {
+
+const Device cpu(DeviceType::CPU, 0);
+const Device gpu(DeviceType::GPU, 0);
+constexpr unsigned long long seed{1234};
+
+// Several host chunks and a tail that ends inside a counter.
+constexpr int64_t num_elements{3 * kHostChunkSize + 5};
+
+template <typename Type>
+std::vector<Type> generate_on_gpu(const bool normal, const int64_t n, CURANDGenerator generator,
+                                  CUDAStream stream) {
+  Type* d_data;
+  EXPECT_EQ(cudaMalloc(&d_data, n * sizeof(Type)), cudaSuccess);
+  if (normal) {
+    normal_async<Type>(d_data, n, 1, 2, gpu, generator, stream);
+  } else {
+    uniform_async<Type>(d_data, n, -3, 5, gpu, generator, stream);
+  }
+  std::vector<Type> data(n);
+  EXPECT_EQ(cudaMemcpyAsync(data.data(), d_data, n * sizeof(Type), cudaMemcpyDeviceToHost,
+                            stream()),
+            cudaSuccess);
+  EXPECT_EQ(cudaStreamSynchronize(stream()), cudaSuccess);
+  EXPECT_EQ(cudaFree(d_data), cudaSuccess);
+  return data;
+}
+
+template <typename Type>
+std::vector<Type> generate_on_cpu(const bool normal, const int64_t n, CURANDGenerator generator,
+                                  CUDAStream stream) {
+  std::vector<Type> data(n);
+  if (normal) {
+    normal_async<Type>(data.data(), n, 1, 2, cpu, generator, stream);
+  } else {
+    uniform_async<Type>(data.data(), n, -3, 5, cpu, generator, stream);
+  }
+  EXPECT_EQ(cudaStreamSynchronize(stream()), cudaSuccess);
+  return data;
+}
+
+// Same values up to the rounding of log, sin and cos in the normal distribution.
+template <typename Type>
+void check_cpu_matches_gpu() {
+  const Type tolerance{std::is_same<Type, float>::value ? Type(1e-5) : Type(1e-12)};
+  CUDAStream stream(cudaStreamDefault, 0);
+  for (const bool normal : {false, true}) {
+    const std::vector<Type> expected{generate_on_gpu<Type>(
+        normal, num_elements, CURANDGenerator(gpu, seed, CURAND_RNG_PSEUDO_PHILOX4_32_10),
+        stream)};
+    const std::vector<Type> actual{
+        generate_on_cpu<Type>(normal, num_elements, CURANDGenerator(cpu, seed), stream)};
+    for (int64_t i{0}; i < num_elements; ++i) {
+      ASSERT_NEAR(actual[i], expected[i], tolerance * std::max<Type>(1, std::abs(expected[i])))
+          << (normal ? "normal" : "uniform") << ", i = " << i;
+    }
+  }
+}
+
+// Element by element on the calling thread, like a pool with a single worker.
+template <typename Type>
+std::vector<Type> serial_uniform(const int64_t n) {
+  constexpr int64_t kValues = kPhiloxValuesPerCounter<Type>;
+  const PhiloxUniform<Type> dist{-3, 5};
+  std::vector<Type> data(n);
+  for (int64_t i{0}; i < n; i += kValues) {
+    uint32_t words[4];
+    Type values[kValues];
+    philox4x32_10(seed, i / kValues, words);
+    dist(words, values);
+    std::copy(values, values + std::min(kValues, n - i), data.begin() + i);
+  }
+  return data;
+}
+
+template <typename Type>
+void check_thread_independence() {
+  CUDAStream stream(cudaStreamDefault, 0);
+  const std::vector<Type> expected{serial_uniform<Type>(num_elements)};
+  const std::vector<Type> actual{
+      generate_on_cpu<Type>(false, num_elements, CURANDGenerator(cpu, seed), stream)};
+  // Same values, except that the compiler may contract the scaling differently.
+  const Type tolerance{8 * std::numeric_limits<Type>::epsilon()};
+  for (int64_t i{0}; i < num_elements; ++i) {
+    ASSERT_NEAR(actual[i], expected[i], tolerance) << "i = " << i;
+  }
+
+  // Two requests that split the elements at a counter boundary, off the chunk boundaries.
+  CURANDGenerator generator(cpu, seed);
+  const int64_t n0{kHostChunkSize + 4};
+  const std::vector<Type> head{generate_on_cpu<Type>(false, n0, generator, stream)};
+  const std::vector<Type> tail{
+      generate_on_cpu<Type>(false, num_elements - n0, generator, stream)};
+  ASSERT_TRUE(std::equal(head.begin(), head.end(), actual.begin()));
+  ASSERT_TRUE(std::equal(tail.begin(), tail.end(), actual.begin() + n0));
+}
+
+}  // namespace
+
+TEST(low_level_primitives, philox_cpu_matches_gpu) {
+  check_cpu_matches_gpu<float>();
+  check_cpu_matches_gpu<double>();
+}
+
+// CPU results do not depend on how the elements are split among the ThreadPool workers.
+TEST(low_level_primitives, philox_cpu_thread_independence) {
+  check_thread_independence<float>();
+  check_thread_independence<double>();
+}
+
+// Empty requests are no-ops, also for generators that are not Philox.
+TEST(low_level_primitives, empty_random_requests) {
+  CUDAStream stream(cudaStreamDefault, 0);
+  float* d_data;
+  ASSERT_EQ(cudaMalloc(&d_data, sizeof(float)), cudaSuccess);
+  CURANDGenerator generator(gpu, seed);
+  uniform_async<float>(d_data, 0, 0, 1, gpu, generator, stream);
+  normal_async<float>(d_data, 0, 0, 1, gpu, generator, stream);
+  EXPECT_EQ(cudaStreamSynchronize(stream()), cudaSuccess);
+  EXPECT_EQ(cudaFree(d_data), cudaSuccess);
+
+  // No counters are consumed either.
+  CURANDGenerator cpu_generator(cpu, seed);
+  std::vector<float> data(1);
+  uniform_async<float>(data.data(), 0, -3, 5, cpu, cpu_generator, stream);
+  EXPECT_EQ(generate_on_cpu<float>(false, 8, cpu_generator, stream),
+            generate_on_cpu<float>(false, 8, CURANDGenerator(cpu, seed), stream));
+}
+
+// CPU fills and conversions on a stream run after the work queued before them.
+TEST(low_level_primitives, cpu_fill_and_convert_on_stream) {
+  CUDAStream stream(cudaStreamDefault, 0);
+  const int64_t n{2 * kHostChunkSize + 3};
+  float* h_src;
+  ASSERT_EQ(cudaMallocHost(&h_src, n * sizeof(float)), cudaSuccess);
+  float* d_src;
+  ASSERT_EQ(cudaMalloc(&d_src, n * sizeof(float)), cudaSuccess);
+
+  fill_async<float>(d_src, n, 2.5f, gpu, stream);
+  copy_async(h_src, d_src, n * sizeof(float), cpu, gpu, stream);
+  std::vector<double> dst(n);
+  convert_async<double, float>(dst.data(), h_src, n, cpu, cpu, stream);
+  EXPECT_TRUE(std::all_of(dst.begin(), dst.end(), [](double v) { return v == 2.5; }));
+
+  fill_async<float>(h_src, n, -1.f, cpu, stream);
+  EXPECT_TRUE(std::all_of(h_src, h_src + n, [](float v) { return v == -1.f; }));
+
+  EXPECT_EQ(cudaFree(d_src), cudaSuccess);
+  EXPECT_EQ(cudaFreeHost(h_src), cudaSuccess);
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <nv_cpu_cache.hpp>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using Key = long long;
+constexpr Key empty_key{std::numeric_limits<Key>::max()};
+using Cache = gpu_cache::cpu_cache<Key, uint64_t, empty_key, SET_ASSOCIATIVITY, SLAB_SIZE>;
+
+constexpr size_t emb_size{4};
+constexpr size_t num_sets{4};
+constexpr size_t set_capacity{SET_ASSOCIATIVITY * SLAB_SIZE};
+
+float value_of(const Key key, const size_t i) { return static_cast<float>(key * 10 + i); }
+
+// Exact LRU per slabset, which is what the cache implements when every query holds a single key.
+class ReferenceLRU final {
+ public:
+  // Returns true on a hit. Misses insert the key, and evict the least recently used key of its set
+  // if needed.
+  bool access(const Key key) {
+    std::list<Key>& lru{sets_[set_of(key)]};
+    const auto it{positions_.find(key)};
+    if (it != positions_.end()) {
+      lru.splice(lru.begin(), lru, it->second);
+      return true;
+    }
+
+    if (lru.size() == set_capacity) {
+      positions_.erase(lru.back());
+      lru.pop_back();
+      ++num_evictions;
+    }
+    lru.emplace_front(key);
+    positions_.emplace(key, lru.begin());
+    return false;
+  }
+
+  std::vector<Key> keys() const {
+    std::vector<Key> keys;
+    for (const auto& kv : positions_) {
+      keys.emplace_back(kv.first);
+    }
+    std::sort(keys.begin(), keys.end());
+    return keys;
+  }
+
+  size_t num_evictions{0};
+
+ private:
+  static size_t set_of(const Key key) { return MurmurHash3_32<Key>::hash(key) % num_sets; }
+
+  std::vector<std::list<Key>> sets_{num_sets};
+  std::unordered_map<Key, std::list<Key>::iterator> positions_;
+};
+
+std::vector<Key> dump(Cache& cache) {
+  std::vector<Key> keys(num_sets * set_capacity);
+  size_t num_keys;
+  cache.Dump(keys.data(), &num_keys, 0, num_sets, 0);
+  keys.resize(num_keys);
+  std::sort(keys.begin(), keys.end());
+  return keys;
+}
+
+}  // namespace
+
+// Replays a skewed trace one key at a time, and compares every hit, miss and eviction with the
+// reference LRU.
+TEST(cpu_cache, matches_reference_lru) {
+  Cache cache(num_sets, emb_size);
+  ReferenceLRU reference;
+
+  std::mt19937 gen(42);
+  // Mean key = number of slots. The hot head hits, and the long tail keeps evicting.
+  std::geometric_distribution<Key> dist(1.0 / (num_sets * set_capacity));
+
+  std::vector<float> values(emb_size);
+  size_t num_hits{0};
+  for (size_t step{0}; step < 20000; ++step) {
+    const Key key{dist(gen)};
+
+    uint64_t missing_index;
+    Key missing_key;
+    size_t num_missing;
+    cache.Query(&key, 1, values.data(), &missing_index, &missing_key, &num_missing, 0);
+
+    const bool hit{reference.access(key)};
+    ASSERT_EQ(num_missing, hit ? 0 : 1) << "step " << step << ", key " << key;
+    if (hit) {
+      ++num_hits;
+      for (size_t i{0}; i < emb_size; ++i) {
+        ASSERT_EQ(values[i], value_of(key, i)) << "step " << step << ", key " << key;
+      }
+    } else {
+      ASSERT_EQ(missing_index, 0);
+      ASSERT_EQ(missing_key, key);
+      for (size_t i{0}; i < emb_size; ++i) {
+        values[i] = value_of(key, i);
+      }
+      cache.Replace(&key, 1, values.data(), 0);
+    }
+  }
+
+  // The trace must exercise both paths for the comparison to mean anything.
+  EXPECT_GT(num_hits, 1000);
+  EXPECT_GT(reference.num_evictions, 1000);
+  EXPECT_EQ(dump(cache), reference.keys());
+}
+
+// Missing keys of a batch are reported in input order, and updates only touch resident keys.
+TEST(cpu_cache, batch_query_and_update) {
+  Cache cache(num_sets, emb_size);
+
+  std::vector<Key> keys(3 * 4096 + 7);
+  for (size_t i{0}; i < keys.size(); ++i) {
+    keys[i] = static_cast<Key>(i * 7919 % 100003);
+  }
+  std::vector<float> values(keys.size() * emb_size);
+  std::vector<uint64_t> missing_index(keys.size());
+  std::vector<Key> missing_keys(keys.size());
+  size_t num_missing;
+
+  // Nothing is cached yet. Multiple chunks must be stitched together in order.
+  cache.Query(keys.data(), keys.size(), values.data(), missing_index.data(), missing_keys.data(),
+              &num_missing, 0);
+  ASSERT_EQ(num_missing, keys.size());
+  for (size_t i{0}; i < keys.size(); ++i) {
+    ASSERT_EQ(missing_index[i], i);
+    ASSERT_EQ(missing_keys[i], keys[i]);
+  }
+
+  // Insert a few keys, and overwrite them as well as some keys that are not cached.
+  const std::vector<Key> resident{1, 2, 3, 4, 5};
+  std::vector<float> resident_values(resident.size() * emb_size);
+  for (size_t i{0}; i < resident.size(); ++i) {
+    for (size_t j{0}; j < emb_size; ++j) {
+      resident_values[i * emb_size + j] = value_of(resident[i], j);
+    }
+  }
+  cache.Replace(resident.data(), resident.size(), resident_values.data(), 0);
+
+  const std::vector<Key> updated{2, 4, 6};
+  const std::vector<float> updated_values(updated.size() * emb_size, -1.f);
+  cache.Update(updated.data(), updated.size(), updated_values.data(), 0);
+  EXPECT_EQ(dump(cache), resident);
+
+  const std::vector<Key> query{6, 1, 2, 7, 4};
+  cache.Query(query.data(), query.size(), values.data(), missing_index.data(),
+              missing_keys.data(), &num_missing, 0);
+  ASSERT_EQ(num_missing, 2);
+  EXPECT_EQ(missing_index[0], 0);
+  EXPECT_EQ(missing_keys[0], 6);
+  EXPECT_EQ(missing_index[1], 3);
+  EXPECT_EQ(missing_keys[1], 7);
+  EXPECT_EQ(values[1 * emb_size], value_of(1, 0));
+  EXPECT_EQ(values[2 * emb_size], -1.f);
+  EXPECT_EQ(values[4 * emb_size], -1.f);
+}
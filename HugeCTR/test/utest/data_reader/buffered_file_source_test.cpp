@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <data_readers/buffered_file_source.hpp>
+#include <data_readers/file_source.hpp>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace HugeCTR;
+
+namespace {
+
+constexpr size_t block_size{4096};
+
+// Sizes around the block size, so that files end on, before and after block boundaries.
+const std::vector<size_t> file_sizes{1,     4095, 4096, 4097,  0,
+                                     12411, 8192, 3,    50000, 2 * 4096 - 1};
+
+class BufferedFileSourceTest : public testing::Test {
+ protected:
+  std::vector<std::string> file_names_;
+  std::string file_list_name_;
+
+  void SetUp() override {
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> dist(0, 255);
+    for (size_t i = 0; i < file_sizes.size(); ++i) {
+      file_names_.push_back(testing::TempDir() + "buffered_file_source_" + std::to_string(i) +
+                            ".data");
+      std::vector<char> data(file_sizes[i]);
+      for (auto& c : data) {
+        c = static_cast<char>(dist(gen));
+      }
+      std::ofstream out_stream(file_names_.back(), std::ofstream::binary);
+      out_stream.write(data.data(), data.size());
+    }
+    file_list_name_ = write_file_list(file_names_);
+  }
+
+  void TearDown() override {
+    for (const auto& file_name : file_names_) {
+      std::remove(file_name.c_str());
+    }
+    std::remove(file_list_name_.c_str());
+  }
+
+  static std::string write_file_list(const std::vector<std::string>& file_names) {
+    const std::string file_list_name{testing::TempDir() + "buffered_file_source_list.txt"};
+    std::ofstream out_stream(file_list_name);
+    out_stream << file_names.size() << '\n';
+    for (const auto& file_name : file_names) {
+      out_stream << file_name << '\n';
+    }
+    return file_list_name;
+  }
+};
+
+// Reads `num_files` files through both sources in random pieces, and expects the same bytes and
+// status codes. With `max_reads_per_file`, files are abandoned before their end.
+void compare_sources(Source& expected, Source& actual, const size_t num_files,
+                     const size_t max_reads_per_file, const unsigned seed) {
+  std::mt19937 gen(seed);
+  // Mostly small reads, like the fields of a sample, and a few that span several blocks. No empty
+  // reads: FileSource checks those against the `gcount` of the previous read.
+  std::uniform_int_distribution<size_t> small_size(1, 64);
+  std::uniform_int_distribution<size_t> large_size(1, 3 * block_size);
+  std::bernoulli_distribution use_large(0.1);
+
+  for (size_t i = 0; i < num_files; ++i) {
+    const Error_t expected_error = expected.next_source(0);
+    ASSERT_EQ(actual.next_source(0), expected_error) << "file " << i;
+    ASSERT_EQ(actual.is_open(), expected.is_open()) << "file " << i;
+    if (expected_error != Error_t::Success) {
+      continue;
+    }
+
+    for (size_t num_reads = 0; num_reads < max_reads_per_file; ++num_reads) {
+      const size_t n = use_large(gen) ? large_size(gen) : small_size(gen);
+      std::vector<char> x(n), y(n);
+      const Error_t error = expected.read(x.data(), n);
+      ASSERT_EQ(actual.read(y.data(), n), error) << "file " << i << ", read " << num_reads;
+      if (error != Error_t::Success) {
+        break;
+      }
+      ASSERT_EQ(y, x) << "file " << i << ", read " << num_reads;
+    }
+  }
+}
+
+}  // namespace
+
+TEST_F(BufferedFileSourceTest, matches_file_source) {
+  for (const size_t num_blocks : {1, 2, 4}) {
+    FileSource expected(0, 1, file_list_name_, false);
+    BufferedFileSource actual(0, 1, file_list_name_, false, block_size, num_blocks);
+    compare_sources(expected, actual, file_sizes.size() + 1, SIZE_MAX, num_blocks);
+
+    // The end of the list is sticky.
+    EXPECT_EQ(actual.next_source(0), Error_t::EndOfFile);
+    EXPECT_FALSE(actual.is_open());
+    std::vector<char> x(1);
+    EXPECT_EQ(actual.read(x.data(), 1), Error_t::FileCannotOpen);
+  }
+}
+
+// Every second file, for both workers. The rest of abandoned files is skipped.
+TEST_F(BufferedFileSourceTest, strided_and_abandoned_files) {
+  for (const long long offset : {0, 1}) {
+    FileSource expected(offset, 2, file_list_name_, false);
+    BufferedFileSource actual(offset, 2, file_list_name_, false, block_size, 2);
+    compare_sources(expected, actual, file_sizes.size() / 2 + 1, 3, offset);
+  }
+}
+
+// With `repeat`, the files are served over and over. Destruction stops the endless readahead.
+TEST_F(BufferedFileSourceTest, repeat) {
+  FileSource expected(0, 1, file_list_name_, true);
+  BufferedFileSource actual(0, 1, file_list_name_, true, block_size, 2);
+  compare_sources(expected, actual, 3 * file_sizes.size(), SIZE_MAX, 3);
+}
+
+// Files that cannot be opened are reported, and the source moves on to the next file.
+TEST_F(BufferedFileSourceTest, missing_file) {
+  std::vector<std::string> file_names{file_names_[1], testing::TempDir() + "does_not_exist.data",
+                                      file_names_[5]};
+  const std::string file_list_name{write_file_list(file_names)};
+
+  FileSource expected(0, 1, file_list_name, false);
+  BufferedFileSource actual(0, 1, file_list_name, false, block_size, 2);
+  compare_sources(expected, actual, file_names.size() + 1, SIZE_MAX, 4);
+}
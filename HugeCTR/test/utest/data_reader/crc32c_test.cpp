@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <data_generator.hpp>
+#include <data_readers/check_crc32c.hpp>
+#include <data_readers/crc32c.hpp>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace HugeCTR;
+
+namespace {
+
+// Serves a byte buffer, like a file with nothing after it.
+class MemorySource : public Source {
+  std::vector<char> data_;
+  size_t offset_{0};
+
+ public:
+  MemorySource(std::vector<char> data) : data_(std::move(data)) {}
+
+  Error_t read(char* ptr, size_t bytes_to_read) override {
+    if (bytes_to_read > data_.size() - offset_) {
+      return Error_t::OutOfBound;
+    }
+    std::memcpy(ptr, data_.data() + offset_, bytes_to_read);
+    offset_ += bytes_to_read;
+    return Error_t::Success;
+  }
+
+  Error_t next_source(long long) noexcept override {
+    offset_ = 0;
+    return Error_t::Success;
+  }
+
+  bool is_open() noexcept override { return true; }
+};
+
+std::vector<char> random_bytes(const size_t n, const unsigned seed) {
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<int> dist(0, 255);
+  std::vector<char> x(n);
+  for (auto& c : x) {
+    c = static_cast<char>(dist(gen));
+  }
+  return x;
+}
+
+// Writes `blocks` with `DataWriter<Check_t::CRC32C>`, and returns the file content.
+std::vector<char> write_blocks(const std::vector<std::vector<char>>& blocks) {
+  const std::string file_name{testing::TempDir() + "crc32c_test.data"};
+  {
+    std::ofstream out_stream(file_name, std::ofstream::binary);
+    DataWriter<Check_t::CRC32C> data_writer(out_stream);
+    for (const auto& block : blocks) {
+      // Append in two pieces. The checksum must cover the whole block.
+      const int half = static_cast<int>(block.size() / 2);
+      data_writer.append(block.data(), half);
+      data_writer.append(block.data() + half, static_cast<int>(block.size()) - half);
+      data_writer.write();
+    }
+  }
+  std::ifstream in_stream(file_name, std::ifstream::binary);
+  std::vector<char> data{std::istreambuf_iterator<char>(in_stream),
+                         std::istreambuf_iterator<char>()};
+  std::remove(file_name.c_str());
+  return data;
+}
+
+}  // namespace
+
+TEST(crc32c, known_answer) {
+  const std::string check{"123456789"};
+  EXPECT_EQ(crc32c(check.data(), check.size()), 0xe3069283);
+  EXPECT_EQ(crc32c_sw(check.data(), check.size()), 0xe3069283);
+
+  EXPECT_EQ(crc32c(nullptr, 0), 0);
+  EXPECT_EQ(crc32c_sw(nullptr, 0), 0);
+
+  // 32 bytes of zeros, see RFC 3720, B.4.
+  const std::vector<char> zeros(32, 0);
+  EXPECT_EQ(crc32c(zeros.data(), zeros.size()), 0x8a9136aa);
+  EXPECT_EQ(crc32c_sw(zeros.data(), zeros.size()), 0x8a9136aa);
+}
+
+// The dispatched implementation (hardware if the CPU has it) and slicing-by-8 agree on every
+// length and alignment, also when the checksum is computed in pieces.
+TEST(crc32c, hardware_matches_slicing_by_8) {
+  const std::vector<char> data{random_bytes(1024 + 7, 1)};
+  for (size_t offset = 0; offset < 8; ++offset) {
+    for (size_t size = 0; size + offset <= data.size(); size += size < 64 ? 1 : 61) {
+      const char* p = data.data() + offset;
+      const uint32_t expected = crc32c_sw(p, size);
+      ASSERT_EQ(crc32c(p, size), expected) << "offset " << offset << ", size " << size;
+
+      const size_t split = size / 3;
+      EXPECT_EQ(crc32c(p + split, size - split, crc32c(p, split)), expected);
+      EXPECT_EQ(crc32c_sw(p + split, size - split, crc32c_sw(p, split)), expected);
+    }
+  }
+}
+
+TEST(crc32c, writer_checker_round_trip) {
+  const std::vector<std::vector<char>> blocks{random_bytes(sizeof(DataSetHeader), 2),
+                                              random_bytes(1, 3), random_bytes(17, 4),
+                                              random_bytes(4096 + 3, 5)};
+  const std::vector<char> data{write_blocks(blocks)};
+
+  // Every block is read back in pieces. Only the read that completes a block checks it.
+  {
+    MemorySource src(data);
+    CheckCRC32C checker(src);
+    for (const auto& block : blocks) {
+      std::vector<char> y(block.size());
+      const size_t first = block.size() / 2;
+      EXPECT_EQ(checker.read(y.data(), first), Error_t::Success);
+      EXPECT_EQ(checker.read(y.data() + first, block.size() - first), Error_t::Success);
+      EXPECT_EQ(y, block);
+    }
+  }
+
+  // A flipped bit in the third block fails that block only.
+  {
+    std::vector<char> corrupt{data};
+    const size_t pos = 3 * sizeof(int) + blocks[0].size() + blocks[1].size() +
+                       2 * sizeof(uint32_t) + blocks[2].size() / 2;
+    corrupt[pos] ^= 0x10;
+    MemorySource src(corrupt);
+    CheckCRC32C checker(src);
+    for (size_t i = 0; i < blocks.size(); ++i) {
+      std::vector<char> y(blocks[i].size());
+      EXPECT_EQ(checker.read(y.data(), y.size()), i == 2 ? Error_t::DataCheckError
+                                                         : Error_t::Success)
+          << "block " << i;
+    }
+  }
+
+  // Reading past the end of a block, and impossible block lengths break the file.
+  {
+    MemorySource src(data);
+    CheckCRC32C checker(src);
+    std::vector<char> y(blocks[0].size() + 1);
+    EXPECT_EQ(checker.read(y.data(), y.size()), Error_t::BrokenFile);
+  }
+  for (const int length : {0, -1, (1 << 30) + 1}) {
+    std::vector<char> corrupt{data};
+    std::memcpy(corrupt.data(), &length, sizeof(int));
+    MemorySource src(corrupt);
+    CheckCRC32C checker(src);
+    char c;
+    EXPECT_EQ(checker.read(&c, 1), Error_t::BrokenFile) << "length " << length;
+  }
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <embeddings/shard_planner.hpp>
+#include <map>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace HugeCTR;
+
+namespace {
+
+struct SyntheticTable {
+  std::string name;
+  int64_t vocabulary_size;
+  int ev_size;
+  int hotness;
+};
+
+// Vocabulary sizes and hotness span several orders of magnitude, like the Criteo tables.
+std::vector<SyntheticTable> make_tables(const size_t num_tables, const unsigned seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<double> log_vocabulary(2., 6.5);
+  std::vector<SyntheticTable> tables;
+  for (size_t i = 0; i < num_tables; ++i) {
+    const int64_t vocabulary_size =
+        static_cast<int64_t>(std::pow(10., log_vocabulary(gen)));
+    const int hotness = i % 7 == 0 ? 20 : i % 3 == 0 ? 5 : 1;
+    tables.push_back({"t" + std::to_string(i), vocabulary_size, i % 4 == 0 ? 128 : 64, hotness});
+  }
+  return tables;
+}
+
+EmbeddingCollectionConfig make_config(const std::vector<SyntheticTable> &tables) {
+  EmbeddingCollectionConfig config(false, ::embedding::CommunicationStrategy::Uniform);
+  for (const auto &t : tables) {
+    EmbeddingTableConfig table_config(t.name, t.vocabulary_size, t.ev_size, std::nullopt,
+                                      std::nullopt);
+    config.embedding_lookup(table_config, "key_" + t.name, "emb_" + t.name, "sum");
+  }
+  return config;
+}
+
+// Zipf distributed keys (exponent 1.05), as typically observed in recommender training data.
+std::vector<EmbeddingTableStats> make_stats(const std::vector<SyntheticTable> &tables,
+                                            const int64_t num_samples, const unsigned seed) {
+  std::mt19937 gen(seed);
+  EmbeddingTableStatsCollector collector;
+  for (const auto &t : tables) {
+    const int64_t num_keys = std::min<int64_t>(t.vocabulary_size, 1 << 16);
+    std::vector<double> weights(num_keys);
+    for (int64_t k = 0; k < num_keys; ++k) {
+      weights[k] = 1. / std::pow(static_cast<double>(k + 1), 1.05);
+    }
+    std::discrete_distribution<int64_t> dist(weights.begin(), weights.end());
+
+    std::vector<int64_t> keys(num_samples * t.hotness);
+    std::generate(keys.begin(), keys.end(), [&]() { return dist(gen); });
+    collector.add(t.name, keys.data(), keys.size(), num_samples);
+  }
+  return collector.stats();
+}
+
+ShardPlannerParams make_params(const int num_gpus) {
+  ShardPlannerParams params;
+  params.num_gpus = num_gpus;
+  params.global_batch_size = 8192 * num_gpus;
+  params.gpu_memory_budget = 32e9;
+  return params;
+}
+
+// Checks that every table is placed, and every GPU stays within its memory budget.
+void check_plan(const ShardPlan &plan, const std::vector<SyntheticTable> &tables,
+                const ShardPlannerParams &params) {
+  ASSERT_EQ(plan.shard_matrix.size(), static_cast<size_t>(params.num_gpus));
+
+  std::map<std::string, int> num_shards;
+  for (const auto &gpu_tables : plan.shard_matrix) {
+    for (const auto &name : gpu_tables) {
+      ++num_shards[name];
+    }
+  }
+  std::map<std::string, int> col_factors;
+  for (const auto &strategy : plan.shard_strategy) {
+    for (const auto &v : get_table_group_strategy(strategy)) {
+      const std::string name = get_table_name(v);
+      EXPECT_EQ(col_factors.count(name), 0) << name << " is listed twice.";
+      col_factors[name] =
+          get_table_place_strategy(strategy) == "dp" ? 1 : get_column_wise_sharding_factor(v);
+      if (get_table_place_strategy(strategy) == "dp") {
+        EXPECT_EQ(num_shards[name], params.num_gpus) << name;
+      } else {
+        // row-wise times column-wise shards, each on a different GPU
+        EXPECT_EQ(num_shards[name] % col_factors[name], 0) << name;
+      }
+    }
+  }
+  for (const auto &t : tables) {
+    EXPECT_GT(num_shards[t.name], 0) << t.name << " is not placed.";
+    EXPECT_EQ(col_factors.count(t.name), 1) << t.name << " has no strategy.";
+  }
+
+  for (double memory : plan.memory_per_gpu) {
+    EXPECT_LE(memory, params.gpu_memory_budget);
+  }
+}
+
+}  // namespace
+
+TEST(shard_planner, stats_collector) {
+  EmbeddingTableStatsCollector collector;
+  const std::vector<int64_t> keys{1, 1, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4};
+  collector.add("t", keys.data(), keys.size(), 6);
+
+  const auto stats = collector.stats();
+  ASSERT_EQ(stats.size(), 1);
+  const auto &s = stats[0];
+  EXPECT_EQ(s.num_samples, 6);
+  EXPECT_EQ(s.num_keys, 12);
+  EXPECT_EQ(s.num_unique_keys, 4);
+  EXPECT_DOUBLE_EQ(s.avg_hotness(), 2.);
+
+  const std::vector<std::pair<int64_t, double>> histogram{{1, 5.}, {2, 3.}, {1, 1.}};
+  EXPECT_EQ(s.frequency_histogram, histogram);
+
+  EXPECT_EQ(s.expected_unique_keys(0.), 0.);
+  // a single draw always yields one distinct key
+  EXPECT_NEAR(s.expected_unique_keys(1.), 1., 1e-12);
+  EXPECT_NEAR(s.expected_unique_keys(1e6), 4., 1e-9);
+}
+
+// On skewed tables, the slowest GPU must not be much slower than the average GPU.
+TEST(shard_planner, balances_skewed_tables) {
+  const auto tables = make_tables(26, 1);
+  const auto stats = make_stats(tables, 4096, 2);
+  for (int num_gpus : {2, 4, 8}) {
+    const auto params = make_params(num_gpus);
+    const ShardPlan plan = plan_embedding_shards(make_config(tables), stats, params);
+    check_plan(plan, tables, params);
+
+    double total_time = 0.;
+    for (int gpu_id = 0; gpu_id < num_gpus; ++gpu_id) {
+      total_time += plan.lookup_time_per_gpu[gpu_id] + plan.comm_time_per_gpu[gpu_id];
+    }
+    const double avg_time = total_time / num_gpus;
+    EXPECT_LE(plan.estimated_iteration_time(), params.imbalance_tolerance * avg_time)
+        << num_gpus << " GPUs";
+  }
+}
+
+// Refinement must remain fast for many tables on many GPUs.
+TEST(shard_planner, many_tables) {
+  const auto tables = make_tables(500, 3);
+  const auto stats = make_stats(tables, 256, 4);
+  const auto params = make_params(64);
+  const ShardPlan plan = plan_embedding_shards(make_config(tables), stats, params);
+  check_plan(plan, tables, params);
+}
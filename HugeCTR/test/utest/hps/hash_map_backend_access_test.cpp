@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <hps/hash_map_backend.hpp>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+using namespace HugeCTR;
+
+namespace {
+
+using Key = long long;
+
+const std::string table_name{"tab"};
+constexpr size_t emb_size{4};
+
+HashMapBackendParams deferred_params(const DatabaseOverflowPolicy_t policy,
+                                     const size_t log_capacity_per_thread) {
+  HashMapBackendParams params;
+  params.num_partitions = 1;
+  params.overflow_policy = policy;
+  params.access_tracking = DatabaseAccessTracking_t::Deferred;
+  params.access_log_capacity =
+      log_capacity_per_thread * std::max(std::thread::hardware_concurrency(), 1U);
+  return params;
+}
+
+void insert_range(HashMapBackend<Key>& db, const Key begin, const Key end) {
+  std::vector<Key> keys(end - begin);
+  std::iota(keys.begin(), keys.end(), begin);
+  const std::vector<float> values(keys.size() * emb_size, 1.0f);
+  db.insert(table_name, keys.size(), keys.data(), reinterpret_cast<const char*>(values.data()),
+            emb_size * sizeof(float), emb_size * sizeof(float));
+}
+
+size_t fetch_keys(HashMapBackend<Key>& db, const std::vector<Key>& keys) {
+  std::vector<float> values(keys.size() * emb_size);
+  return db.fetch(table_name, keys.size(), keys.data(), reinterpret_cast<char*>(values.data()),
+                  emb_size * sizeof(float), [](size_t) {}, std::chrono::nanoseconds::zero());
+}
+
+}  // namespace
+
+// Records are folded in by fetches alone, and hot keys survive the next overflow resolution.
+TEST(hash_map_backend, deferred_lfu_read_only_drain) {
+  HashMapBackendParams params{deferred_params(DatabaseOverflowPolicy_t::EvictLeastUsed, 64)};
+  params.overflow_margin = 100;
+  params.overflow_resolution_target = 0.5;
+  params.max_batch_size = 10;  // Evict in small steps, so that the hot keys are not swept along.
+  HashMapBackend<Key> db(params);
+
+  insert_range(db, 0, 100);
+  const std::vector<Key> hot_keys{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  for (size_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(fetch_keys(db, hot_keys), hot_keys.size());
+  }
+  const HashMapAccessStats stats{db.access_stats()};
+  EXPECT_GE(stats.num_applied, 32);
+  EXPECT_EQ(stats.num_dropped, 0);
+
+  insert_range(db, 100, 150);
+  EXPECT_LE(db.size(table_name), 100);
+  EXPECT_EQ(db.contains(table_name, hot_keys.size(), hot_keys.data(),
+                        std::chrono::nanoseconds::zero()),
+            hot_keys.size());
+}
+
+// Records that do not fit into the log are dropped and counted.
+TEST(hash_map_backend, deferred_dropped_records) {
+  HashMapBackend<Key> db(deferred_params(DatabaseOverflowPolicy_t::EvictLeastUsed, 4));
+
+  insert_range(db, 0, 10);
+  std::vector<Key> keys(10);
+  std::iota(keys.begin(), keys.end(), 0);
+  EXPECT_EQ(fetch_keys(db, keys), keys.size());
+
+  const HashMapAccessStats stats{db.access_stats()};
+  EXPECT_EQ(stats.num_dropped, 6);
+  EXPECT_EQ(stats.num_applied, 4);
+}
+
+// With every n-th hit sampled, a batch yields ceil(hits / n) records.
+TEST(hash_map_backend, deferred_sample_rate) {
+  HashMapBackendParams params{deferred_params(DatabaseOverflowPolicy_t::EvictOldest, 1024)};
+  params.access_sample_rate = 4;
+  HashMapBackend<Key> db(params);
+
+  insert_range(db, 0, 10);
+  std::vector<Key> keys(10);
+  std::iota(keys.begin(), keys.end(), 0);
+  EXPECT_EQ(fetch_keys(db, keys), keys.size());
+
+  // Nothing is folded in yet. The next insert drains the log.
+  EXPECT_EQ(db.access_stats().num_applied, 0);
+  insert_range(db, 10, 11);
+  EXPECT_EQ(db.access_stats().num_applied, 3);
+}
+
+// Logs below the drain threshold are folded in periodically.
+TEST(hash_map_backend, deferred_periodic_drain) {
+  HashMapBackend<Key> db(deferred_params(DatabaseOverflowPolicy_t::EvictLeastUsed, 1024));
+
+  insert_range(db, 0, 10);
+  const std::vector<Key> keys{1, 2, 3};
+  EXPECT_EQ(fetch_keys(db, keys), keys.size());
+  EXPECT_EQ(db.access_stats().num_applied, 0);
+
+  const auto deadline{std::chrono::steady_clock::now() + std::chrono::seconds(5)};
+  while (db.access_stats().num_applied < keys.size() &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  EXPECT_EQ(db.access_stats().num_applied, keys.size());
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <hps/value_codec.hpp>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace HugeCTR;
+
+namespace {
+
+// Lengths that cover the vectorized loops as well as their scalar tails.
+const std::vector<size_t> test_lengths{1, 3, 4, 7, 8, 9, 16, 17, 128, 131};
+
+std::vector<float> round_trip(const DatabaseValueCodec_t codec, const std::vector<float>& x) {
+  const uint32_t value_size{static_cast<uint32_t>(x.size() * sizeof(float))};
+  std::vector<char> encoded(value_codec_encoded_size(codec, value_size));
+  value_codec_encode(codec, reinterpret_cast<const char*>(x.data()), value_size, encoded.data());
+
+  std::vector<float> y(x.size());
+  value_codec_decode(codec, encoded.data(), value_size, reinterpret_cast<char*>(y.data()));
+  return y;
+}
+
+std::vector<float> random_values(const size_t n, const float range, const unsigned seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<float> dist(-range, range);
+  std::vector<float> x(n);
+  std::generate(x.begin(), x.end(), [&]() { return dist(gen); });
+  return x;
+}
+
+// Relative round-trip error of codecs that keep a float exponent (`mantissa_bits` explicit bits).
+void check_relative_error(const DatabaseValueCodec_t codec, const int mantissa_bits) {
+  const float bound{std::ldexp(1.f, -(mantissa_bits + 1))};
+  for (const size_t n : test_lengths) {
+    const std::vector<float> x{random_values(n, 8.f, static_cast<unsigned>(n))};
+    const std::vector<float> y{round_trip(codec, x)};
+    for (size_t i{0}; i < n; ++i) {
+      EXPECT_LE(std::abs(y[i] - x[i]), bound * std::abs(x[i])) << "n = " << n << ", i = " << i;
+    }
+  }
+}
+
+}  // namespace
+
+TEST(value_codec, encoded_size) {
+  EXPECT_EQ(value_codec_encoded_size(DatabaseValueCodec_t::None, 40), 40);
+  EXPECT_EQ(value_codec_encoded_size(DatabaseValueCodec_t::FP16, 40), 20);
+  EXPECT_EQ(value_codec_encoded_size(DatabaseValueCodec_t::BF16, 40), 20);
+  EXPECT_EQ(value_codec_encoded_size(DatabaseValueCodec_t::Int8, 40), sizeof(float) + 10);
+}
+
+TEST(value_codec, none_round_trip) {
+  for (const size_t n : test_lengths) {
+    const std::vector<float> x{random_values(n, 1000.f, static_cast<unsigned>(n))};
+    const std::vector<float> y{round_trip(DatabaseValueCodec_t::None, x)};
+    EXPECT_EQ(std::memcmp(x.data(), y.data(), n * sizeof(float)), 0) << "n = " << n;
+  }
+}
+
+TEST(value_codec, fp16_round_trip) {
+  check_relative_error(DatabaseValueCodec_t::FP16, 10);
+
+  // Special values, subnormals and overflow (9 values, so that both code paths see them).
+  const float inf{std::numeric_limits<float>::infinity()};
+  const std::vector<float> x{0.f, -0.f, inf, -inf, std::nanf(""), 1e-6f, -3e-7f, 1e5f, 65504.f};
+  const std::vector<float> y{round_trip(DatabaseValueCodec_t::FP16, x)};
+  EXPECT_EQ(y[0], 0.f);
+  EXPECT_TRUE(std::signbit(y[1]));
+  EXPECT_EQ(y[2], inf);
+  EXPECT_EQ(y[3], -inf);
+  EXPECT_TRUE(std::isnan(y[4]));
+  // Subnormal halfs are spaced 2^-24 apart.
+  EXPECT_LE(std::abs(y[5] - x[5]), std::ldexp(1.f, -25));
+  EXPECT_LE(std::abs(y[6] - x[6]), std::ldexp(1.f, -25));
+  EXPECT_EQ(y[7], inf);
+  EXPECT_EQ(y[8], 65504.f);
+}
+
+TEST(value_codec, bf16_round_trip) {
+  check_relative_error(DatabaseValueCodec_t::BF16, 7);
+
+  const float inf{std::numeric_limits<float>::infinity()};
+  const std::vector<float> x{0.f, -0.f, inf, -inf, std::nanf(""), 1e30f, -1e-30f, 1.f, -2.f};
+  const std::vector<float> y{round_trip(DatabaseValueCodec_t::BF16, x)};
+  EXPECT_EQ(y[0], 0.f);
+  EXPECT_TRUE(std::signbit(y[1]));
+  EXPECT_EQ(y[2], inf);
+  EXPECT_EQ(y[3], -inf);
+  EXPECT_TRUE(std::isnan(y[4]));
+  EXPECT_LE(std::abs(y[5] - x[5]), std::ldexp(1.f, -8) * x[5]);
+  EXPECT_LE(std::abs(y[6] - x[6]), std::ldexp(1.f, -8) * -x[6]);
+  EXPECT_EQ(y[7], 1.f);
+  EXPECT_EQ(y[8], -2.f);
+}
+
+TEST(value_codec, int8_round_trip) {
+  // Quantization step is `max_abs / 127`. Rounding to nearest keeps us within half a step.
+  for (const size_t n : test_lengths) {
+    const std::vector<float> x{random_values(n, 3.f, static_cast<unsigned>(n))};
+    const std::vector<float> y{round_trip(DatabaseValueCodec_t::Int8, x)};
+
+    float max_abs{0};
+    for (const float v : x) {
+      max_abs = std::max(max_abs, std::abs(v));
+    }
+    const float bound{max_abs / 254.f * (1.f + 1e-5f)};
+    for (size_t i{0}; i < n; ++i) {
+      EXPECT_LE(std::abs(y[i] - x[i]), bound) << "n = " << n << ", i = " << i;
+    }
+  }
+
+  // All-zero vectors must not produce NaNs.
+  const std::vector<float> zeros(9, 0.f);
+  EXPECT_EQ(round_trip(DatabaseValueCodec_t::Int8, zeros), zeros);
+
+  // The extremes are represented exactly.
+  const std::vector<float> x{-2.f, 0.f, 2.f, 1.f};
+  const std::vector<float> y{round_trip(DatabaseValueCodec_t::Int8, x)};
+  EXPECT_FLOAT_EQ(y[0], -2.f);
+  EXPECT_EQ(y[1], 0.f);
+  EXPECT_FLOAT_EQ(y[2], 2.f);
+}
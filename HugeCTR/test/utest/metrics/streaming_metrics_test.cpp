@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <core23/tensor.hpp>
+#include <functional>
+#include <random>
+#include <streaming_metrics.hpp>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace HugeCTR;
+using namespace HugeCTR::metrics;
+
+namespace {
+
+struct Samples {
+  std::vector<float> preds;
+  std::vector<float> labels;
+};
+
+// Predictions in [0, 1], every second one rounded to 1/200 so that there are exact ties. Labels
+// are drawn with the probability given by the prediction, up to `max_label` for graded relevance.
+Samples make_samples(const size_t n, const int max_label, const unsigned seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<float> uniform(0.f, 1.f);
+  Samples s;
+  for (size_t i = 0; i < n; ++i) {
+    float pred = uniform(gen);
+    if (i % 2 == 0) {
+      pred = std::round(pred * 200.f) / 200.f;
+    }
+    int label = 0;
+    for (int j = 0; j < max_label; ++j) {
+      label += uniform(gen) < pred;
+    }
+    s.preds.push_back(pred);
+    s.labels.push_back(static_cast<float>(label));
+  }
+  return s;
+}
+
+// Fraction of (positive, negative) pairs ranked correctly, ties counting 1/2.
+double exact_auc(const Samples& s) {
+  std::vector<float> positives, negatives;
+  for (size_t i = 0; i < s.preds.size(); ++i) {
+    (s.labels[i] > 0.f ? positives : negatives).push_back(s.preds[i]);
+  }
+  std::sort(negatives.begin(), negatives.end());
+  double area = 0.0;
+  for (const float pred : positives) {
+    const auto lower = std::lower_bound(negatives.begin(), negatives.end(), pred);
+    const auto upper = std::upper_bound(lower, negatives.end(), pred);
+    area += (lower - negatives.begin()) + 0.5 * (upper - lower);
+  }
+  return area / (static_cast<double>(positives.size()) * negatives.size());
+}
+
+// DCG@k of the whole set sorted by prediction, ties ranking the lower label first.
+double exact_ndcg(const Samples& s, const size_t k) {
+  std::vector<std::pair<float, float>> ranked;
+  for (size_t i = 0; i < s.preds.size(); ++i) {
+    ranked.emplace_back(s.preds[i], s.labels[i]);
+  }
+  std::sort(ranked.begin(), ranked.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.first > rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+  });
+  std::vector<float> ideal{s.labels};
+  std::sort(ideal.begin(), ideal.end(), std::greater<float>());
+
+  double dcg = 0.0;
+  double ideal_dcg = 0.0;
+  for (size_t i = 0; i < std::min(k, ranked.size()); ++i) {
+    dcg += ranked[i].second / std::log2(i + 2.0);
+    ideal_dcg += ideal[i] / std::log2(i + 2.0);
+  }
+  return dcg / ideal_dcg;
+}
+
+core23::Tensor host_tensor(float* data, const size_t n) {
+  return core23::Tensor::bind(data, core23::Shape({static_cast<int64_t>(n)}),
+                              core23::ScalarType::Float,
+                              core23::Device(core23::DeviceType::CPU));
+}
+
+// Splits the samples into `num_workers` batches of `batch_per_worker` samples each and feeds
+// every worker from its own thread. Samples past the end are padding with the given values.
+float run_workers(Metric& metric, const Samples& s, const size_t num_workers,
+                  const size_t batch_per_worker, const float pad_pred, const float pad_label) {
+  const size_t padded_size = num_workers * batch_per_worker;
+  Samples padded{s};
+  padded.preds.resize(padded_size, pad_pred);
+  padded.labels.resize(padded_size, pad_label);
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < num_workers; ++i) {
+    threads.emplace_back([&, i]() {
+      const size_t offset = i * batch_per_worker;
+      Core23RawMetricMap raw_metrics{
+          {RawType::Pred, host_tensor(padded.preds.data() + offset, batch_per_worker)},
+          {RawType::Label, host_tensor(padded.labels.data() + offset, batch_per_worker)}};
+      metric.local_reduce(static_cast<int>(i), raw_metrics);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return metric.finalize_metric();
+}
+
+}  // namespace
+
+// The binned AUC is off from the exact AUC by no more than its own error bound.
+TEST(streaming_metrics, auc_within_error_bound) {
+  const Samples s{make_samples(20000, 1, 1)};
+  const double expected = exact_auc(s);
+  for (const size_t num_bins : {1000, 37, 10}) {
+    BinnedAUCSketch sketch(num_bins, 0.f, 1.f);
+    sketch.add(s.preds.data(), s.labels.data(), s.preds.size());
+    EXPECT_LE(std::abs(sketch.value() - expected), sketch.error_bound()) << num_bins << " bins";
+    EXPECT_LT(sketch.error_bound(), 1.0 / num_bins) << num_bins << " bins";
+  }
+
+  // Predictions outside of the range are clamped into the first and last bin.
+  Samples clamped{s};
+  clamped.preds[0] = -5.f;
+  clamped.preds[1] = 7.f;
+  BinnedAUCSketch sketch(1000, 0.f, 1.f);
+  sketch.add(clamped.preds.data(), clamped.labels.data(), clamped.preds.size());
+  EXPECT_LE(std::abs(sketch.value() - exact_auc(clamped)), sketch.error_bound());
+}
+
+TEST(streaming_metrics, ndcg_matches_full_sort) {
+  const Samples s{make_samples(5000, 3, 2)};
+  for (const size_t k : {1, 10, 100, 5000, 6000}) {
+    TopKSketch sketch(k);
+    sketch.add(s.preds.data(), s.labels.data(), s.preds.size());
+    EXPECT_DOUBLE_EQ(sketch.value(), exact_ndcg(s, k)) << "k = " << k;
+  }
+}
+
+// Sketches of concurrent workers merge into the sketch of all samples, also after a reset.
+TEST(streaming_metrics, merge_across_workers) {
+  constexpr size_t num_workers = 4;
+  constexpr size_t batch_per_worker = 2500;
+  StreamingMetricParams params;
+  params.num_workers = num_workers;
+  params.auc_num_bins = 1000;
+  params.ndcg_k = 16;
+  const auto auc = create_streaming_metric(Type::AUC, params);
+  const auto ndcg = create_streaming_metric(Type::NDCG, params);
+  EXPECT_EQ(ndcg->name(), "NDCG@16");
+
+  for (const unsigned seed : {3, 4}) {
+    const Samples s{make_samples(num_workers * batch_per_worker, 1, seed)};
+
+    BinnedAUCSketch auc_sketch(params.auc_num_bins, params.pred_min, params.pred_max);
+    auc_sketch.add(s.preds.data(), s.labels.data(), s.preds.size());
+    EXPECT_NEAR(run_workers(*auc, s, num_workers, batch_per_worker, 0.f, 0.f), auc_sketch.value(),
+                1e-6);
+
+    TopKSketch ndcg_sketch(params.ndcg_k);
+    ndcg_sketch.add(s.preds.data(), s.labels.data(), s.preds.size());
+    EXPECT_EQ(run_workers(*ndcg, s, num_workers, batch_per_worker, 0.f, 0.f),
+              static_cast<float>(ndcg_sketch.value()));
+  }
+}
+
+// With a current batch size, the padding at the end of the batch is not counted, like in the
+// GPU metrics. This process holds the global workers 4 to 7 of 8.
+TEST(streaming_metrics, padded_batch) {
+  constexpr size_t num_workers = 4;
+  constexpr size_t batch_per_worker = 64;
+  StreamingMetricParams params;
+  params.num_workers = num_workers;
+  params.first_global_worker = 4;
+  params.auc_num_bins = 1000;
+  params.ndcg_k = 8;
+
+  const Samples s{make_samples(3 * batch_per_worker + 5, 1, 5)};
+  const int current_batch_size = static_cast<int>(4 * batch_per_worker + s.preds.size());
+
+  // Padding that would rank first with the worst label.
+  const auto auc = create_streaming_metric(Type::AUC, params);
+  auc->set_current_batch_size(current_batch_size);
+  BinnedAUCSketch auc_sketch(params.auc_num_bins, params.pred_min, params.pred_max);
+  auc_sketch.add(s.preds.data(), s.labels.data(), s.preds.size());
+  EXPECT_NEAR(run_workers(*auc, s, num_workers, batch_per_worker, 1.f, 0.f), auc_sketch.value(),
+              1e-6);
+
+  const auto ndcg = create_streaming_metric(Type::NDCG, params);
+  ndcg->set_current_batch_size(current_batch_size);
+  TopKSketch ndcg_sketch(params.ndcg_k);
+  ndcg_sketch.add(s.preds.data(), s.labels.data(), s.preds.size());
+  EXPECT_EQ(run_workers(*ndcg, s, num_workers, batch_per_worker, 1.f, 0.f),
+            static_cast<float>(ndcg_sketch.value()));
+
+  // Batches that end before this process leave its sketches empty.
+  const auto loss = create_streaming_metric(Type::AverageLoss, params);
+  loss->set_current_batch_size(static_cast<int>(4 * batch_per_worker));
+  EXPECT_EQ(run_workers(*loss, s, num_workers, batch_per_worker, 0.5f, 0.f), 0.f);
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <thread_pool.hpp>
+#include <vector>
+
+using namespace HugeCTR;
+
+// Every iteration runs exactly once, even if there are fewer iterations than workers.
+TEST(thread_pool, parallel_for_fewer_iterations_than_workers) {
+  ThreadPool pool("test", 8);
+
+  for (const size_t n : {0, 1, 3, 8, 100}) {
+    std::vector<std::atomic<size_t>> counts(n);
+    pool.parallel_for(n, [&](const size_t i) { counts[i].fetch_add(1); });
+    for (size_t i = 0; i < n; ++i) {
+      EXPECT_EQ(counts[i].load(), 1) << "n = " << n << ", i = " << i;
+    }
+  }
+  pool.await_idle();
+}
+
+// Workers that invoke `parallel_for` themselves must not starve, even if all of them do.
+TEST(thread_pool, parallel_for_nested) {
+  ThreadPool pool("test", 2);
+
+  constexpr size_t num_outer{8};
+  constexpr size_t num_inner{16};
+  std::atomic<size_t> count{0};
+  pool.parallel_for(num_outer, [&](size_t) {
+    pool.parallel_for(num_inner, [&](size_t) { count.fetch_add(1); });
+  });
+  EXPECT_EQ(count.load(), num_outer * num_inner);
+
+  // Same for `parallel_for` invocations from within submitted tasks.
+  count = 0;
+  std::vector<std::future<void>> results;
+  for (size_t i = 0; i < num_outer; ++i) {
+    results.emplace_back(
+        pool.submit([&]() { pool.parallel_for(num_inner, [&](size_t) { count.fetch_add(1); }); }));
+  }
+  ThreadPool::await(results.begin(), results.end());
+  EXPECT_EQ(count.load(), num_outer * num_inner);
+}
+
+// The exception is rethrown to the caller once all other iterations have completed.
+TEST(thread_pool, parallel_for_exception) {
+  ThreadPool pool("test", 4);
+
+  constexpr size_t n{64};
+  std::atomic<size_t> count{0};
+  EXPECT_THROW(pool.parallel_for(n,
+                                 [&](const size_t i) {
+                                   count.fetch_add(1);
+                                   if (i == 13) {
+                                     throw std::runtime_error("iteration 13");
+                                   }
+                                 }),
+               std::runtime_error);
+  EXPECT_EQ(count.load(), n);
+
+  // The pool remains usable.
+  count = 0;
+  pool.parallel_for(n, [&](size_t) { count.fetch_add(1); });
+  EXPECT_EQ(count.load(), n);
+
+  // Exceptions of submitted tasks surface through their future.
+  std::future<void> result{pool.submit([]() { throw std::runtime_error("task"); })};
+  EXPECT_THROW(result.get(), std::runtime_error);
+}
+
+// Tasks still queued when the pool is destroyed are released without running. Their futures report
+// a broken promise.
+TEST(thread_pool, destroy_with_queued_tasks) {
+  constexpr size_t num_tasks{32};
+  std::vector<std::future<void>> results;
+  std::promise<void> release;
+  std::atomic<size_t> num_run{0};
+  std::thread releaser;
+  {
+    ThreadPool pool("test", 1);
+
+    // Block the only worker, so that everything submitted afterwards stays queued.
+    std::promise<void> started;
+    results.emplace_back(pool.submit([&]() {
+      started.set_value();
+      release.get_future().wait();
+    }));
+    started.get_future().wait();
+    for (size_t i = 0; i < num_tasks; ++i) {
+      results.emplace_back(pool.submit([&]() { num_run.fetch_add(1); }));
+    }
+
+    releaser = std::thread([&]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      release.set_value();
+    });
+  }
+  releaser.join();
+
+  size_t num_dropped{0};
+  for (auto& result : results) {
+    ASSERT_EQ(result.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    try {
+      result.get();
+    } catch (const std::future_error& e) {
+      EXPECT_EQ(e.code(), std::future_errc::broken_promise);
+      ++num_dropped;
+    }
+  }
+  EXPECT_EQ(num_dropped, num_tasks);
+  EXPECT_EQ(num_run.load(), 0);
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <nv_gpu_cache.hpp>
+#include <vector>
+
+namespace gpu_cache {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// CPU Cache
+// Host memory counterpart of gpu_cache. Uses the same slabset layout, hashing and LRU replacement,
+// and produces the same outputs. All buffers passed to the API are host buffers, and all calls are
+// synchronous (the stream is ignored).
+template <typename key_type, typename ref_counter_type, key_type empty_key, int set_associativity,
+          int warp_size, typename set_hasher = MurmurHash3_32<key_type>,
+          typename slab_hasher = Mod_Hash<key_type, size_t>>
+class cpu_cache : public gpu_cache_api<key_type> {
+ public:
+  // Ctor
+  cpu_cache(const size_t capacity_in_set, const size_t embedding_vec_size);
+
+  // Dtor
+  ~cpu_cache();
+
+  // Query API, i.e. A single read from the cache
+  // Missing keys are reported in the order of their position in h_keys
+  void Query(const key_type* h_keys, const size_t len, float* h_values, uint64_t* h_missing_index,
+             key_type* h_missing_keys, size_t* h_missing_len, cudaStream_t stream,
+             const size_t task_per_warp_tile = TASK_PER_WARP_TILE_MACRO) override;
+
+  // Replace API, i.e. Follow the Query API to update the content of the cache to Most Recent
+  void Replace(const key_type* h_keys, const size_t len, const float* h_values, cudaStream_t stream,
+               const size_t task_per_warp_tile = TASK_PER_WARP_TILE_MACRO) override;
+
+  // Update API, i.e. update the embeddings which exist in the cache
+  void Update(const key_type* h_keys, const size_t len, const float* h_values, cudaStream_t stream,
+              const size_t task_per_warp_tile = TASK_PER_WARP_TILE_MACRO) override;
+
+  // Dump API, i.e. dump some slabsets' keys from the cache
+  void Dump(key_type* h_keys, size_t* h_dump_counter, const size_t start_set_index,
+            const size_t end_set_index, cudaStream_t stream) override;
+
+  void Record(cudaStream_t stream) override {}
+
+ public:
+  using slabset = slab_set<set_associativity, key_type, warp_size>;
+
+ private:
+  // Number of keys processed by one OpenMP task
+  static const size_t CHUNK_SIZE_ = 4096;
+
+  // Search a single key in its slabset, return the slot or num_slot_ if missing
+  size_t find_(const key_type key, const size_t set, size_t slab) const;
+
+  // Lock a slabset for modification
+  void lock_set_(const size_t set);
+
+  void unlock_set_(const size_t set);
+
+  // Cache data
+  std::unique_ptr<slabset[]> keys_;
+  std::unique_ptr<float[]> vals_;
+  std::unique_ptr<std::atomic<ref_counter_type>[]> slot_counter_;
+
+  // Global counter
+  std::atomic<ref_counter_type> global_counter_{0};
+
+  // Cache capacity
+  size_t capacity_in_set_;
+  size_t num_slot_;
+
+  // Embedding vector size
+  size_t embedding_vec_size_;
+
+  // Version of each slab set (seqlock). Odd while a writer modifies the set. Readers don't lock,
+  // but retry if the version changed while they were reading.
+  std::unique_ptr<std::atomic<uint32_t>[]> set_version_;
+};
+
+}  // namespace gpu_cache
@@ -0,0 +1,427 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <nv_cpu_cache.hpp>
+#include <type_traits>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace gpu_cache {
+
+inline void cpu_relax() {
+#if defined(__SSE2__)
+  _mm_pause();
+#endif
+}
+
+// Compare the keys of a slab with the target key
+// Bit i of the result is set if slab[i] == key
+template <int warp_size, typename key_type>
+inline uint32_t slab_match(const key_type* slab, const key_type key,
+                           std::integral_constant<size_t, 4>) {
+  uint32_t mask = 0;
+  int i = 0;
+#if defined(__AVX512F__)
+  const __m512i k = _mm512_set1_epi32(static_cast<int32_t>(key));
+  for (; i + 16 <= warp_size; i += 16) {
+    const __m512i s = _mm512_loadu_si512(reinterpret_cast<const void*>(slab + i));
+    mask |= static_cast<uint32_t>(_mm512_cmpeq_epi32_mask(s, k)) << i;
+  }
+#elif defined(__AVX2__)
+  const __m256i k = _mm256_set1_epi32(static_cast<int32_t>(key));
+  for (; i + 8 <= warp_size; i += 8) {
+    const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(slab + i));
+    const __m256i eq = _mm256_cmpeq_epi32(s, k);
+    mask |= static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(eq))) << i;
+  }
+#endif
+  for (; i < warp_size; i++) {
+    mask |= static_cast<uint32_t>(slab[i] == key) << i;
+  }
+  return mask;
+}
+
+template <int warp_size, typename key_type>
+inline uint32_t slab_match(const key_type* slab, const key_type key,
+                           std::integral_constant<size_t, 8>) {
+  uint32_t mask = 0;
+  int i = 0;
+#if defined(__AVX512F__)
+  const __m512i k = _mm512_set1_epi64(static_cast<int64_t>(key));
+  for (; i + 8 <= warp_size; i += 8) {
+    const __m512i s = _mm512_loadu_si512(reinterpret_cast<const void*>(slab + i));
+    mask |= static_cast<uint32_t>(_mm512_cmpeq_epi64_mask(s, k)) << i;
+  }
+#elif defined(__AVX2__)
+  const __m256i k = _mm256_set1_epi64x(static_cast<int64_t>(key));
+  for (; i + 4 <= warp_size; i += 4) {
+    const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(slab + i));
+    const __m256i eq = _mm256_cmpeq_epi64(s, k);
+    mask |= static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(eq))) << i;
+  }
+#endif
+  for (; i < warp_size; i++) {
+    mask |= static_cast<uint32_t>(slab[i] == key) << i;
+  }
+  return mask;
+}
+
+template <int warp_size, typename key_type>
+inline uint32_t slab_match(const key_type* slab, const key_type key) {
+  return slab_match<warp_size>(slab, key, std::integral_constant<size_t, sizeof(key_type)>());
+}
+
+inline int first_lane(const uint32_t mask) { return __builtin_ctz(mask); }
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define CPU_CACHE_TEMPLATE_                                                   \
+  template <typename key_type, typename ref_counter_type, key_type empty_key, \
+            int set_associativity, int warp_size, typename set_hasher, typename slab_hasher>
+#define CPU_CACHE_                                                                           \
+  cpu_cache<key_type, ref_counter_type, empty_key, set_associativity, warp_size, set_hasher, \
+            slab_hasher>
+
+CPU_CACHE_TEMPLATE_
+CPU_CACHE_::cpu_cache(const size_t capacity_in_set, const size_t embedding_vec_size)
+    : capacity_in_set_(capacity_in_set), num_slot_(0), embedding_vec_size_(embedding_vec_size) {
+  // Check parameter
+  if (capacity_in_set_ == 0) {
+    printf("Error: Invalid value for capacity_in_set.\n");
+    return;
+  }
+  if (embedding_vec_size_ == 0) {
+    printf("Error: Invalid value for embedding_vec_size.\n");
+    return;
+  }
+  if (set_associativity <= 0) {
+    printf("Error: Invalid value for set_associativity.\n");
+    return;
+  }
+  if (warp_size != 1 && warp_size != 2 && warp_size != 4 && warp_size != 8 && warp_size != 16 &&
+      warp_size != 32) {
+    printf("Error: Invalid value for warp_size.\n");
+    return;
+  }
+
+  // Calculate # of slot
+  num_slot_ = capacity_in_set_ * set_associativity * warp_size;
+
+  // Allocate host memory for cache
+  keys_.reset(new slabset[capacity_in_set_]);
+  vals_.reset(new float[embedding_vec_size_ * num_slot_]);
+  slot_counter_.reset(new std::atomic<ref_counter_type>[num_slot_]);
+  set_version_.reset(new std::atomic<uint32_t>[capacity_in_set_]);
+
+  // Initialize the cache, set all entry to unused <K,V>
+  key_type* const keys = reinterpret_cast<key_type*>(keys_.get());
+  std::fill(keys, keys + num_slot_, empty_key);
+  std::fill(vals_.get(), vals_.get() + embedding_vec_size_ * num_slot_, 0.f);
+  for (size_t i = 0; i < num_slot_; i++) {
+    slot_counter_[i].store(0, std::memory_order_relaxed);
+  }
+  for (size_t i = 0; i < capacity_in_set_; i++) {
+    set_version_[i].store(0, std::memory_order_relaxed);
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+CPU_CACHE_TEMPLATE_
+CPU_CACHE_::~cpu_cache() {}
+
+CPU_CACHE_TEMPLATE_
+void CPU_CACHE_::lock_set_(const size_t set) {
+  std::atomic<uint32_t>& version = set_version_[set];
+  while (true) {
+    uint32_t cur = version.load(std::memory_order_relaxed);
+    if (!(cur & 1) &&
+        version.compare_exchange_weak(cur, cur + 1, std::memory_order_acquire,
+                                      std::memory_order_relaxed)) {
+      return;
+    }
+    cpu_relax();
+  }
+}
+
+CPU_CACHE_TEMPLATE_
+void CPU_CACHE_::unlock_set_(const size_t set) {
+  set_version_[set].fetch_add(1, std::memory_order_release);
+}
+
+CPU_CACHE_TEMPLATE_
+size_t CPU_CACHE_::find_(const key_type key, const size_t set, size_t slab) const {
+  for (int counter = 0; counter < set_associativity; counter++) {
+    const key_type* const slab_keys = keys_[set].set_[slab].slab_;
+
+    // If found, return the slot
+    const uint32_t found_mask = slab_match<warp_size>(slab_keys, key);
+    if (found_mask) {
+      return (set * set_associativity + slab) * warp_size + first_lane(found_mask);
+    }
+
+    // Slots are filled in probing order. An empty slot terminates the search
+    if (slab_match<warp_size>(slab_keys, empty_key)) {
+      break;
+    }
+
+    slab = (slab + 1) % set_associativity;
+  }
+  return num_slot_;
+}
+
+CPU_CACHE_TEMPLATE_
+void CPU_CACHE_::Query(const key_type* h_keys, const size_t len, float* h_values,
+                       uint64_t* h_missing_index, key_type* h_missing_keys, size_t* h_missing_len,
+                       cudaStream_t stream, const size_t task_per_warp_tile) {
+  // Check if it is a valid query
+  *h_missing_len = 0;
+  if (len == 0) {
+    return;
+  }
+
+  // Update the global counter as user perform a new(most recent) read operation to the cache
+  const ref_counter_type now = global_counter_.fetch_add(1, std::memory_order_relaxed) + 1;
+
+  // Each chunk first collects its missing keys in its own section of the output buffers
+  const size_t num_chunks = (len - 1) / CHUNK_SIZE_ + 1;
+  std::vector<size_t> chunk_missing_len(num_chunks);
+
+#pragma omp parallel for schedule(dynamic) if (num_chunks > 1)
+  for (size_t chunk = 0; chunk < num_chunks; chunk++) {
+    const size_t chunk_begin = chunk * CHUNK_SIZE_;
+    const size_t chunk_end = std::min(chunk_begin + CHUNK_SIZE_, len);
+    size_t missing_len = 0;
+
+    for (size_t idx = chunk_begin; idx < chunk_end; idx++) {
+      const key_type key = h_keys[idx];
+      const size_t set = set_hasher::hash(key) % capacity_in_set_;
+      const size_t slab = slab_hasher::hash(key) % set_associativity;
+      float* const dst = h_values + idx * embedding_vec_size_;
+
+      // Optimistic read. Retry if a writer modified the slabset in the meantime
+      size_t slot;
+      while (true) {
+        const uint32_t version = set_version_[set].load(std::memory_order_acquire);
+        if (version & 1) {
+          cpu_relax();
+          continue;
+        }
+
+        slot = find_(key, set, slab);
+        if (slot != num_slot_) {
+          std::memcpy(dst, vals_.get() + slot * embedding_vec_size_,
+                      sizeof(float) * embedding_vec_size_);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (set_version_[set].load(std::memory_order_relaxed) == version) {
+          break;
+        }
+      }
+
+      if (slot != num_slot_) {
+        // Touch and refresh the hitting slot
+        slot_counter_[slot].store(now, std::memory_order_relaxed);
+      } else {
+        h_missing_index[chunk_begin + missing_len] = idx;
+        h_missing_keys[chunk_begin + missing_len] = key;
+        missing_len++;
+      }
+    }
+
+    chunk_missing_len[chunk] = missing_len;
+  }
+
+  // Compact the missing keys, so that they are in order of their position in h_keys
+  size_t missing_len = chunk_missing_len[0];
+  for (size_t chunk = 1; chunk < num_chunks; chunk++) {
+    const size_t chunk_begin = chunk * CHUNK_SIZE_;
+    std::memmove(h_missing_index + missing_len, h_missing_index + chunk_begin,
+                 sizeof(uint64_t) * chunk_missing_len[chunk]);
+    std::memmove(h_missing_keys + missing_len, h_missing_keys + chunk_begin,
+                 sizeof(key_type) * chunk_missing_len[chunk]);
+    missing_len += chunk_missing_len[chunk];
+  }
+  *h_missing_len = missing_len;
+}
+
+CPU_CACHE_TEMPLATE_
+void CPU_CACHE_::Replace(const key_type* h_keys, const size_t len, const float* h_values,
+                         cudaStream_t stream, const size_t task_per_warp_tile) {
+  // Check if it is a valid replacement
+  if (len == 0) {
+    return;
+  }
+
+  const ref_counter_type now = global_counter_.load(std::memory_order_relaxed);
+  const size_t num_chunks = (len - 1) / CHUNK_SIZE_ + 1;
+
+#pragma omp parallel for schedule(dynamic) if (num_chunks > 1)
+  for (size_t chunk = 0; chunk < num_chunks; chunk++) {
+    const size_t chunk_end = std::min((chunk + 1) * CHUNK_SIZE_, len);
+
+    for (size_t idx = chunk * CHUNK_SIZE_; idx < chunk_end; idx++) {
+      const key_type key = h_keys[idx];
+      const size_t set = set_hasher::hash(key) % capacity_in_set_;
+      size_t slab = slab_hasher::hash(key) % set_associativity;
+
+      // Variables to keep the LR slot during the probing
+      ref_counter_type min_slot_counter_val = std::numeric_limits<ref_counter_type>::max();
+      size_t min_slot = num_slot_;
+      // Slot to write the value to (none if the key is already stored)
+      size_t target_slot = num_slot_;
+
+      lock_set_(set);
+
+      int counter = 0;
+      for (; counter < set_associativity; counter++) {
+        key_type* const slab_keys = keys_[set].set_[slab].slab_;
+        const size_t slab_offset = (set * set_associativity + slab) * warp_size;
+
+        // If found target key, the insertion/replace is no longer needed. Refresh the slot
+        const uint32_t found_mask = slab_match<warp_size>(slab_keys, key);
+        if (found_mask) {
+          slot_counter_[slab_offset + first_lane(found_mask)].store(now,
+                                                                    std::memory_order_relaxed);
+          break;
+        }
+
+        // If found empty key, do insertion
+        const uint32_t empty_mask = slab_match<warp_size>(slab_keys, empty_key);
+        if (empty_mask) {
+          const int lane = first_lane(empty_mask);
+          slab_keys[lane] = key;
+          target_slot = slab_offset + lane;
+          break;
+        }
+
+        // Refresh LR info, continue probing
+        for (int lane = 0; lane < warp_size; lane++) {
+          const ref_counter_type slot_counter_val =
+              slot_counter_[slab_offset + lane].load(std::memory_order_relaxed);
+          if (slot_counter_val < min_slot_counter_val) {
+            min_slot_counter_val = slot_counter_val;
+            min_slot = slab_offset + lane;
+          }
+        }
+
+        slab = (slab + 1) % set_associativity;
+      }
+
+      // All the slabs inside the slabset are occupied by other keys. Replace the LR slot
+      if (counter == set_associativity) {
+        const size_t lr_slab = (min_slot / warp_size) % set_associativity;
+        keys_[set].set_[lr_slab].slab_[min_slot % warp_size] = key;
+        target_slot = min_slot;
+      }
+
+      if (target_slot != num_slot_) {
+        slot_counter_[target_slot].store(now, std::memory_order_relaxed);
+        std::memcpy(vals_.get() + target_slot * embedding_vec_size_,
+                    h_values + idx * embedding_vec_size_, sizeof(float) * embedding_vec_size_);
+      }
+
+      unlock_set_(set);
+    }
+  }
+}
+
+CPU_CACHE_TEMPLATE_
+void CPU_CACHE_::Update(const key_type* h_keys, const size_t len, const float* h_values,
+                        cudaStream_t stream, const size_t task_per_warp_tile) {
+  // Check if it is a valid update request
+  if (len == 0) {
+    return;
+  }
+
+  // Update the value of input keys that are existed in the cache
+  // Will not change the locality information
+  const size_t num_chunks = (len - 1) / CHUNK_SIZE_ + 1;
+
+#pragma omp parallel for schedule(dynamic) if (num_chunks > 1)
+  for (size_t chunk = 0; chunk < num_chunks; chunk++) {
+    const size_t chunk_end = std::min((chunk + 1) * CHUNK_SIZE_, len);
+
+    for (size_t idx = chunk * CHUNK_SIZE_; idx < chunk_end; idx++) {
+      const key_type key = h_keys[idx];
+      const size_t set = set_hasher::hash(key) % capacity_in_set_;
+      const size_t slab = slab_hasher::hash(key) % set_associativity;
+
+      lock_set_(set);
+      const size_t slot = find_(key, set, slab);
+      if (slot != num_slot_) {
+        std::memcpy(vals_.get() + slot * embedding_vec_size_,
+                    h_values + idx * embedding_vec_size_, sizeof(float) * embedding_vec_size_);
+      }
+      unlock_set_(set);
+    }
+  }
+}
+
+CPU_CACHE_TEMPLATE_
+void CPU_CACHE_::Dump(key_type* h_keys, size_t* h_dump_counter, const size_t start_set_index,
+                      const size_t end_set_index, cudaStream_t stream) {
+  // Check if it is a valid dump request
+  if (start_set_index >= capacity_in_set_) {
+    printf("Error: Invalid value for start_set_index. Nothing dumped.\n");
+    return;
+  }
+  if (end_set_index <= start_set_index || end_set_index > capacity_in_set_) {
+    printf("Error: Invalid value for end_set_index. Nothing dumped.\n");
+    return;
+  }
+
+  size_t dump_counter = 0;
+  slabset set_keys;
+
+  for (size_t set = start_set_index; set < end_set_index; set++) {
+    // Optimistic read of the slabset
+    while (true) {
+      const uint32_t version = set_version_[set].load(std::memory_order_acquire);
+      if (version & 1) {
+        cpu_relax();
+        continue;
+      }
+      std::memcpy(&set_keys, &keys_[set], sizeof(slabset));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (set_version_[set].load(std::memory_order_relaxed) == version) {
+        break;
+      }
+    }
+
+    // Store the (non-empty) keys to output buffer
+    for (int slab = 0; slab < set_associativity; slab++) {
+      for (int lane = 0; lane < warp_size; lane++) {
+        const key_type key = set_keys.set_[slab].slab_[lane];
+        if (key != empty_key) {
+          h_keys[dump_counter++] = key;
+        }
+      }
+    }
+  }
+
+  *h_dump_counter = dump_counter;
+}
+
+template class cpu_cache<unsigned int, uint64_t, std::numeric_limits<unsigned int>::max(),
+                         SET_ASSOCIATIVITY, SLAB_SIZE>;
+template class cpu_cache<long long, uint64_t, std::numeric_limits<long long>::max(),
+                         SET_ASSOCIATIVITY, SLAB_SIZE>;
+}  // namespace gpu_cache
@@ -7,7 +7,9 @@
 
 #include "context.hpp"
 
+#include <fcntl.h>
 #include <malloc.h>
+#include <sys/eventfd.h>
 
 #include <algorithm>
 #include <thread>
@@ -36,6 +38,9 @@ int rdma_context::Init() {
     LOG(ERROR) << "InitMemory() failed";
     return -1;
   }
+  if (FLAGS_use_srq) {
+    std::thread(&rdma_context::AsyncEventHandler, this).detach();
+  }
   return 0;
 }
 
@@ -145,39 +150,170 @@ int rdma_context::InitMemory() {
     struct rdma_io_engine *io_engine = new rdma_io_engine();
     io_engine->context = (void *)this;
     io_engines_.push_back(io_engine);
+    if (InitEngine(io_engine)) {
+      return -1;
+    }
+  }
 
-    // Allocate each IO engine's CQ and MP.
-    for (int j=0; j<FLAGS_cq_num; ++j) {
-      // Completion queues.
-      struct ibv_cq *cq;
-      cq = ibv_create_cq(ctx_, FLAGS_cq_depth, nullptr, nullptr, 0);
-      if (!cq) {
-        PLOG(ERROR) << "ibv_create_cq() failed";
-        return -1;        
-      }
-      io_engine->cqs.push_back(cq);
+  // The QoS engine only carries latency-critical tasks, over one endpoint per host.
+  if (FLAGS_qos_engine) {
+    qos_io_engine_ = new rdma_io_engine();
+    qos_io_engine_->context = (void *)this;
+    if (InitEngine(qos_io_engine_)) {
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+
+int rdma_context::InitEngine(rdma_io_engine *io_engine) {
+  // Completion channel, for pollers that sleep when idle.
+  if (FLAGS_idle_poll_us > 0) {
+    io_engine->channel = ibv_create_comp_channel(ctx_);
+    if (!io_engine->channel) {
+      PLOG(ERROR) << "ibv_create_comp_channel() failed";
+      return -1;
+    }
+    int flags = fcntl(io_engine->channel->fd, F_GETFL);
+    if (fcntl(io_engine->channel->fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+      PLOG(ERROR) << "Failed to make the completion channel non-blocking";
+      return -1;
+    }
+    io_engine->wake_fd = eventfd(0, EFD_NONBLOCK);
+    if (io_engine->wake_fd < 0) {
+      PLOG(ERROR) << "eventfd() failed";
+      return -1;
     }
+  }
 
-    // Memory pools.
-    struct rdma_region *region;
-    region = new rdma_region(pd_, FLAGS_sbuf_size, FLAGS_buf_num, FLAGS_memalign, 0);
-    if (region->Mallocate()) {
-      LOG(ERROR) << "Send Region Memory allocation failed";
-      return -1;      
+  if (FLAGS_stage_stats) {
+    io_engine->stages = new stage_stats();
+  }
+
+  // Allocate each IO engine's CQ and MP.
+  bool hw_ts = FLAGS_hw_ts && FLAGS_stage_stats;
+  for (int j=0; j<FLAGS_cq_num; ++j) {
+    // Completion queues, extended ones to get the NIC's completion timestamps.
+    struct ibv_cq *cq;
+    if (hw_ts) {
+      struct ibv_cq_init_attr_ex cq_attr;
+      memset(&cq_attr, 0, sizeof(cq_attr));
+      cq_attr.cqe = FLAGS_cq_depth;
+      cq_attr.channel = io_engine->channel;
+      cq_attr.wc_flags = IBV_WC_EX_WITH_BYTE_LEN | IBV_WC_EX_WITH_QP_NUM |
+                         IBV_WC_EX_WITH_COMPLETION_TIMESTAMP_WALLCLOCK;
+      struct ibv_cq_ex *cq_ex = ibv_create_cq_ex(ctx_, &cq_attr);
+      if (cq_ex) {
+        io_engine->cqs_ex.push_back(cq_ex);
+        io_engine->cqs.push_back(ibv_cq_ex_to_cq(cq_ex));
+        continue;
+      }
+      if (j > 0) {
+        PLOG(ERROR) << "ibv_create_cq_ex() failed";
+        return -1;
+      }
+      PLOG(WARNING) << "No completion timestamps, stage_stats falls back to software timestamps";
+      hw_ts = false;
     }
-    io_engine->send_region = region;
-    region = new rdma_region(pd_, FLAGS_rbuf_size, FLAGS_buf_num, FLAGS_memalign, 0);
-    if (region->Mallocate()) {
-      LOG(ERROR) << "Recv Region Memory allocation failed";
-      return -1;      
+    cq = ibv_create_cq(ctx_, FLAGS_cq_depth, nullptr, io_engine->channel, 0);
+    if (!cq) {
+      PLOG(ERROR) << "ibv_create_cq() failed";
+      return -1;        
     }
-    io_engine->recv_region = region;    
+    io_engine->cqs.push_back(cq);
+  }
+
+  // Memory pools.
+  struct rdma_region *region;
+  region = new rdma_region(pd_, FLAGS_sbuf_size, FLAGS_buf_num, FLAGS_memalign, 0);
+  if (region->Mallocate()) {
+    LOG(ERROR) << "Send Region Memory allocation failed";
+    return -1;      
+  }
+  io_engine->send_region = region;
+  region = new rdma_region(pd_, FLAGS_rbuf_size, FLAGS_buf_num, FLAGS_memalign, 0);
+  if (region->Mallocate()) {
+    LOG(ERROR) << "Recv Region Memory allocation failed";
+    return -1;      
+  }
+  io_engine->recv_region = region;    
+
+  if (FLAGS_use_srq && InitSrq(io_engine)) {
+    return -1;
   }
 
   return 0;
 }
 
 
+// One SRQ per engine. It starts with srq_depth receives, the rest of the recv region is kept
+// spare for RefillSrq().
+int rdma_context::InitSrq(rdma_io_engine *engine) {
+  struct ibv_srq_init_attr srq_init_attr;
+  memset(&srq_init_attr, 0, sizeof(srq_init_attr));
+  srq_init_attr.attr.max_wr = FLAGS_buf_num;
+  srq_init_attr.attr.max_sge = kMaxSge;
+
+  engine->srq = ibv_create_srq(pd_, &srq_init_attr);
+  if (!engine->srq) {
+    PLOG(ERROR) << "ibv_create_srq() failed";
+    return -1;
+  }
+  if (engine->PostSrqBuffers(FLAGS_srq_depth) != FLAGS_srq_depth) {
+    LOG(ERROR) << "Failed to post " << FLAGS_srq_depth << " receives to the SRQ";
+    return -1;
+  }
+
+  return engine->ArmSrq();
+}
+
+
+void rdma_context::AsyncEventHandler() {
+  struct ibv_async_event event;
+
+  while (!ibv_get_async_event(ctx_, &event)) {
+    if (event.event_type == IBV_EVENT_SRQ_LIMIT_REACHED) {
+      for (auto engine : io_engines_) {
+        if (engine->srq == event.element.srq) {
+          engine->srq_low.store(true, std::memory_order_relaxed);
+        }
+      }
+      if (qos_io_engine_ && qos_io_engine_->srq == event.element.srq) {
+        qos_io_engine_->srq_low.store(true, std::memory_order_relaxed);
+      }
+    }
+    else {
+      LOG(INFO) << "Async event: " << ibv_event_type_str(event.event_type);
+    }
+    ibv_ack_async_event(&event);
+  }
+
+  PLOG(ERROR) << "ibv_get_async_event() failed";
+}
+
+
+void rdma_context::ReportFootprint() {
+  int i = 0;
+  size_t total_posted = 0, total_pinned = 0;
+
+  for (auto engine : io_engines_) {
+    // Without an SRQ each endpoint keeps recv_batch receives posted.
+    size_t posted = engine->srq ? engine->srq_posted.load() : engine->GetEpNum() * FLAGS_recv_batch;
+    size_t pinned = (size_t)FLAGS_buf_num * FLAGS_rbuf_size;
+    LOG(INFO) << "Engine " << i++ << ": " << engine->GetEpNum() << " endpoints, " << posted
+              << (engine->srq ? " receives posted to the SRQ, " : " receives posted per QP, ")
+              << pinned / 1024 << " KiB registered for receives";
+    total_posted += posted;
+    total_pinned += pinned;
+  }
+  LOG(INFO) << "Receive footprint with " << GetHostNum() << " hosts: " << total_posted
+            << " receives posted, " << total_posted * FLAGS_rbuf_size / 1024 << " KiB in use, "
+            << total_pinned / 1024 << " KiB registered";
+}
+
+
 int rdma_context::Listen() {
   struct addrinfo *res, *t;
   struct addrinfo hints;
@@ -275,7 +411,7 @@ int rdma_context::AcceptHandler(int connfd) {
   union ibv_gid gid;
   std::vector<rdma_buffer *> buffers;
   rdma_host *new_host;  
-  int host_id, engine_id = -1, engine_cqid = -1;
+  int host_id, engine_id = -1, engine_cqid = -1, number_of_qos_qp;
   rdma_endpoint *ep;
 
   int rbuf_id = -1;
@@ -295,6 +431,7 @@ int rdma_context::AcceptHandler(int connfd) {
     goto out;
   }
   number_of_qp = (info->info.host.number_of_qp);
+  number_of_qos_qp = (info->info.host.number_of_qos_qp);
   if (number_of_qp <= 0) {
     LOG(ERROR) << "The number of qp should be positive";
     goto out;
@@ -336,6 +473,11 @@ int rdma_context::AcceptHandler(int connfd) {
       engine_id = 0;
     }
     struct rdma_io_engine *engine = io_engines_[engine_id];
+    // The remote's QoS endpoints are served by our QoS engine, if we have one.
+    bool is_qos = i >= number_of_qp - number_of_qos_qp;
+    if (is_qos && qos_io_engine_) {
+      engine = qos_io_engine_;
+    }
 
     ++engine_cqid;
     if (engine_cqid == engine->cqs.size()) {
@@ -345,6 +487,7 @@ int rdma_context::AcceptHandler(int connfd) {
     // Get a new rdma_endpoint ep.
     struct ibv_qp_init_attr qp_init_attr = MakeQpInitAttr(
       engine->cqs[engine_cqid], engine->cqs[engine_cqid], FLAGS_send_wq_depth, FLAGS_recv_wq_depth, IBV_QPT_RC);
+    qp_init_attr.srq = engine->srq;
     auto qp = ibv_create_qp(pd_, &qp_init_attr);
     if (!qp) {
       PLOG(ERROR) << "ibv_create_qp() failed";
@@ -356,6 +499,10 @@ int rdma_context::AcceptHandler(int connfd) {
     ep->SetHost(new_host);
     ep->SetEngine(engine);
     new_host->eps.push_back(ep);
+    if (is_qos) {
+      ep->is_qos = true;
+      new_host->qos_ep = ep;
+    }
 
     n = read(connfd, conn_buf, sizeof(connect_info));
     if (n != sizeof(connect_info)) {
@@ -380,8 +527,8 @@ int rdma_context::AcceptHandler(int connfd) {
       goto out;
     }
 
-    // Post The first batch
-    for (int j=0; j<FLAGS_recv_batch; ++j) {
+    // Post The first batch (receives come from the SRQ otherwise)
+    for (int j=0; !engine->srq && j<FLAGS_recv_batch; ++j) {
       struct rdma_request *req = new rdma_request();
       
       struct ibv_sge sg;
@@ -425,6 +572,7 @@ int rdma_context::AcceptHandler(int connfd) {
   }
 
   new_host->initialized = true;
+  ReportFootprint();
 
   close(connfd);
   free(conn_buf);
@@ -496,8 +644,10 @@ int rdma_context::Connect(const char *server, int port, int connid) {
   int number_of_qp, n = 0, rbuf_id = -1;
 
   std::vector<rdma_buffer *> buffers;
+  std::vector<rdma_io_engine *> ep_engines;  // The engine of each endpoint
   memset(info, 0, sizeof(connect_info));
-  info->info.host.number_of_qp = (num_per_host_ * io_engines_.size());
+  info->info.host.number_of_qp = (num_per_host_ * io_engines_.size()) + (qos_io_engine_ ? 1 : 0);
+  info->info.host.number_of_qos_qp = qos_io_engine_ ? 1 : 0;
   memcpy(&info->info.host.gid, &local_gid_, sizeof(union ibv_gid));
   if (write(sockfd, conn_buf, sizeof(connect_info)) != sizeof(connect_info)) {
     LOG(ERROR) << "Couldn't send local address";
@@ -533,76 +683,88 @@ int rdma_context::Connect(const char *server, int port, int connid) {
   host_id = hosts_.size();
   hosts_.push_back(new_host);
   hosts_lock_.unlock();
+  new_host->SetCredit(FLAGS_credit_window);
 
   for (int i=0; i<num_per_host_; ++i) {
+    ep_engines.insert(ep_engines.end(), io_engines_.begin(), io_engines_.end());
+  }
+  if (qos_io_engine_) {
+    ep_engines.push_back(qos_io_engine_);
+  }
+
+  for (size_t i=0; i<ep_engines.size(); ++i) {
     // Set the IO engine of the endpoint.
-    for (auto engine : io_engines_) {
-      ++engine_cqid;
-      if (engine_cqid == engine->cqs.size()) {
-        engine_cqid = 0;
-      }
+    struct rdma_io_engine *engine = ep_engines[i];
+    ++engine_cqid;
+    if (engine_cqid == engine->cqs.size()) {
+      engine_cqid = 0;
+    }
 
-      // Get a new rdma_endpoint ep.
-      struct ibv_qp_init_attr qp_init_attr = MakeQpInitAttr(
-        engine->cqs[engine_cqid], engine->cqs[engine_cqid], FLAGS_send_wq_depth, FLAGS_recv_wq_depth, IBV_QPT_RC);
-  
-      auto qp = ibv_create_qp(pd_, &qp_init_attr);
-      if (!qp) {
-        PLOG(ERROR) << "ibv_create_qp() failed";
-        delete qp;
-        return -1;
-      }
+    // Get a new rdma_endpoint ep.
+    struct ibv_qp_init_attr qp_init_attr = MakeQpInitAttr(
+      engine->cqs[engine_cqid], engine->cqs[engine_cqid], FLAGS_send_wq_depth, FLAGS_recv_wq_depth, IBV_QPT_RC);
+    qp_init_attr.srq = engine->srq;
 
-      ep = new rdma_endpoint(host_id, qp);
-      ep->SetMaster(this);
-      ep->SetHost(new_host);
-      ep->SetEngine(engine);
-      ep->SetSl(7);
+    auto qp = ibv_create_qp(pd_, &qp_init_attr);
+    if (!qp) {
+      PLOG(ERROR) << "ibv_create_qp() failed";
+      delete qp;
+      return -1;
+    }
 
-      GetEndpointInfo(ep, info);
-      if (write(sockfd, conn_buf, sizeof(connect_info)) != sizeof(connect_info)) {
-        LOG(ERROR) << "Couldn't send " << i << " endpoint's info";
-        goto out;
-      }
-      n = read(sockfd, conn_buf, sizeof(connect_info));
-      if (n != sizeof(connect_info)) {
-        PLOG(ERROR) << "Client Read";
-        LOG(ERROR) << "Read only " << n << "/" << sizeof(connect_info)
-                   << " bytes";
-        goto out;
-      }
-      if ((info->type) != kChannelInfoKey) {
-        LOG(ERROR) << "Exchange Data Failed. Type Received is " << (info->type)
-                   << ", expected " << kChannelInfoKey;
-        goto out;
-      }
-      SetEndpointInfo(ep, info);
-      if (ep->Activate(remote_gid)) {
-        LOG(ERROR) << "Activate " << i << " endpoint failed";
-        goto out;
-      }
+    ep = new rdma_endpoint(host_id, qp);
+    ep->SetMaster(this);
+    ep->SetHost(new_host);
+    ep->SetEngine(engine);
+    ep->SetSl(7);
+    if (engine == qos_io_engine_) {
+      ep->is_qos = true;
+      new_host->qos_ep = ep;
+    }
 
-      // Post The first batch
-      for (int j=0; j<FLAGS_recv_batch; ++j) {
-        struct rdma_request *req = new rdma_request();
-        struct ibv_sge sg;
-        auto buf = engine->PickNextBuffer(1);
-        sg.addr = (uint64_t)buf;
-        sg.lkey = buf->local_K_;
-        sg.length = buf->size_;
-        req->sglist.push_back(sg);
-        req->sge_num = 1;
-
-        if (ep->PostRecv(req)) {
-          LOG(ERROR) << "The " << j << " -th ep failed to post first batch";
-          goto out;
-        }
-      }
+    GetEndpointInfo(ep, info);
+    if (write(sockfd, conn_buf, sizeof(connect_info)) != sizeof(connect_info)) {
+      LOG(ERROR) << "Couldn't send " << i << " endpoint's info";
+      goto out;
+    }
+    n = read(sockfd, conn_buf, sizeof(connect_info));
+    if (n != sizeof(connect_info)) {
+      PLOG(ERROR) << "Client Read";
+      LOG(ERROR) << "Read only " << n << "/" << sizeof(connect_info)
+                 << " bytes";
+      goto out;
+    }
+    if ((info->type) != kChannelInfoKey) {
+      LOG(ERROR) << "Exchange Data Failed. Type Received is " << (info->type)
+                 << ", expected " << kChannelInfoKey;
+      goto out;
+    }
+    SetEndpointInfo(ep, info);
+    if (ep->Activate(remote_gid)) {
+      LOG(ERROR) << "Activate " << i << " endpoint failed";
+      goto out;
+    }
 
-      ep->SetActivated(true);
-      ep->SetServer(GidToIP(remote_gid));
-      engine->PutEndpoint(ep);
+    // Post The first batch (receives come from the SRQ otherwise)
+    for (int j=0; !engine->srq && j<FLAGS_recv_batch; ++j) {
+      struct rdma_request *req = new rdma_request();
+      struct ibv_sge sg;
+      auto buf = engine->PickNextBuffer(1);
+      sg.addr = (uint64_t)buf;
+      sg.lkey = buf->local_K_;
+      sg.length = buf->size_;
+      req->sglist.push_back(sg);
+      req->sge_num = 1;
+
+      if (ep->PostRecv(req)) {
+        LOG(ERROR) << "The " << j << " -th ep failed to post first batch";
+        goto out;
+      }
     }
+
+    ep->SetActivated(true);
+    ep->SetServer(GidToIP(remote_gid));
+    engine->PutEndpoint(ep);
   }
 
 
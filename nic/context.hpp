@@ -31,7 +31,6 @@ class rdma_context {
   uint16_t lid_;
   uint8_t sl_;
   int port_;  // tcp port for server
-  uint64_t completion_timestamp_mask_;
 
   // Memory Management
 
@@ -40,14 +39,11 @@ class rdma_context {
   std::mutex rmem_lock_;
   // For each remote host, we have a single mempool for it
 
-  // For hardware timestamp
-  std::vector<uint64_t> nic_process_time_;
-
   std::vector<rdma_host *> hosts_;
   std::mutex hosts_lock_;
 
   std::vector<rdma_io_engine *> io_engines_;
-  struct rdma_io_engine *qos_io_engine_;
+  struct rdma_io_engine *qos_io_engine_ = nullptr;
 
   int num_of_hosts_ = 0;  // How many hosts to set up connections
   int num_per_host_ = 0;  // How many connections each host will set
@@ -72,14 +68,18 @@ class rdma_context {
   int InitCuda();
 #endif
   int InitMemory();
+  int InitEngine(rdma_io_engine *io_engine);
+  int InitSrq(rdma_io_engine *engine);
   int InitTransport();
-  int InitQoSEp();
 
   int ConnectionSetup(const char *server, int port);
   int AcceptHandler(int connfd);
 
   int PollCompletion();
 
+  // Dispatches SRQ limit events to the engines.
+  void AsyncEventHandler();
+
 
   std::string GidToIP(
       const union ibv_gid &gid);  // Translate local gid to a IP string.
@@ -103,6 +103,9 @@ class rdma_context {
   // Connection Setup: Client side
   int Connect(const char *server, int port, int connid);
 
+  // Log the receive resources of each engine.
+  void ReportFootprint();
+
   // Assitant function: Find the EP of the given IP
   rdma_host *FindHost(std::string &ip) {
     // TODO
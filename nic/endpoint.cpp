@@ -98,6 +98,7 @@ int rdma_endpoint::PostRecv(rdma_request *req) {
 
   if (auto ret = ibv_post_recv(qp_, &wr, &bad_wr)) {
     fprintf(stderr, "PostRecv: Failed in ibv_post_recv().\n");
+    delete status;
     return -1;
   }
 
@@ -24,6 +24,7 @@ class rdma_request {
   enum ibv_wr_opcode opcode;  // Opcode of this request
   int sge_num;                // sge_num of this request
   std::vector<struct ibv_sge> sglist;
+  uint64_t posted = 0;        // Now64Ns() at ibv_post_send, with --stage_stats
 };
 
 class rdma_endpoint {
@@ -3,6 +3,7 @@
 #include <mutex>
 #include <queue>
 #include <thread>
+#include <unistd.h>
 
 #include "engine.hpp"
 
@@ -11,15 +12,27 @@
 
 // Put a task into the engine's task pool.
 void rdma_io_engine::PutTask(send_task *task) {
-  tasks_.push(task);
+  tasks_[task->priority].push(task);
+
+  // Pairs with rdma_poller::Sleep(), which sets sleeping before it polls the tasks a last time.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (sleeping.load()) {
+    uint64_t one = 1;
+    if (write(wake_fd, &one, sizeof(one)) < 0) {
+      PLOG(ERROR) << "Failed to wake up the poller";
+    }
+  }
 }
 
 
+// Strict priority: bulk tasks only go out when no critical one is waiting.
 send_task *rdma_io_engine::GetTask() {
   struct send_task *ret;
   
-  if (tasks_.try_pop(ret)) {
-    return ret;
+  for (auto &tasks : tasks_) {
+    if (tasks.try_pop(ret)) {
+      return ret;
+    }
   }
 
   return nullptr;
@@ -28,6 +41,9 @@ send_task *rdma_io_engine::GetTask() {
 
 void rdma_io_engine::PutEndpoint(rdma_endpoint *ep) {
   endpoints_.push_back(ep);
+
+  std::lock_guard<std::mutex> lock(qpn_eps_mutex_);
+  qpn_eps_[ep->GetQpn()] = ep;
 }
 
 
@@ -85,6 +101,180 @@ rdma_endpoint *rdma_io_engine::PickEp(std::string dest) {
 
 
 
+// Post a consumed receive buffer again, to the endpoint or to the SRQ.
+int rdma_io_engine::Repost(rdma_endpoint *ep, rdma_request *req) {
+  if (!srq) {
+    if (ep->PostRecv(req)) {
+      ReleaseRequest(req);
+      return -1;
+    }
+    return 0;
+  }
+
+  if (srq_posted.fetch_sub(1, std::memory_order_relaxed) > FLAGS_srq_depth) {
+    // The burst that made RefillSrq() post the spare buffers is over, keep them spare again.
+    ReleaseRequest(req);
+    return 0;
+  }
+  if (PostSrqRecv(req)) {
+    // srq_posted already excludes the consumed receive. The buffers go back to the recv region,
+    // where the next RefillSrq() picks them up.
+    ReleaseRequest(req);
+    return -1;
+  }
+  return 0;
+}
+
+
+// Return the buffers of an unposted receive request to the recv region.
+void rdma_io_engine::ReleaseRequest(rdma_request *req) {
+  for (int j=0; j<req->sge_num; ++j) {
+    ReleaseBuffer(1, (struct rdma_buffer *)req->sglist[j].addr);
+  }
+  delete req;
+}
+
+
+rdma_endpoint *rdma_io_engine::RecvEndpoint(const struct ibv_wc &wc, rdma_transmit_status *status) {
+  if (status->ep) {
+    return status->ep;
+  }
+
+  std::lock_guard<std::mutex> lock(qpn_eps_mutex_);
+  auto it = qpn_eps_.find(wc.qp_num);
+  if (it == qpn_eps_.end()) {
+    LOG(ERROR) << "Failed to find the endpoint of qp " << wc.qp_num;
+    return nullptr;
+  }
+  return it->second;
+}
+
+
+int rdma_io_engine::PostSrqRecv(rdma_request *req) {
+  struct ibv_sge sg[kMaxSge];
+  struct ibv_recv_wr wr;
+  struct ibv_recv_wr *bad_wr;
+
+  for (int j = 0; j < req->sge_num; j++) {
+    sg[j].addr = ((struct rdma_buffer *)req->sglist[j].addr)->addr_;
+    sg[j].lkey = req->sglist[j].lkey;
+    sg[j].length = req->sglist[j].length;
+  }
+
+  // The endpoint is only known on completion, see RecvEndpoint().
+  struct rdma_transmit_status *status = new rdma_transmit_status();
+  status->ep = nullptr;
+  status->req = req;
+
+  memset(&wr, 0, sizeof(struct ibv_recv_wr));
+  wr.num_sge = req->sge_num;
+  wr.sg_list = sg;
+  wr.next = nullptr;
+  wr.wr_id = (uint64_t)status;
+
+  if (ibv_post_srq_recv(srq, &wr, &bad_wr)) {
+    PLOG(ERROR) << "ibv_post_srq_recv() failed";
+    delete status;
+    return -1;
+  }
+  srq_posted.fetch_add(1, std::memory_order_relaxed);
+
+  return 0;
+}
+
+
+// Post up to n buffers of the recv region to the SRQ. Returns how many were posted.
+int rdma_io_engine::PostSrqBuffers(int n) {
+  int posted = 0;
+  for (; posted<n; ++posted) {
+    auto buf = PickNextBuffer(1);
+    if (buf == nullptr) {
+      break;
+    }
+    struct rdma_request *req = new rdma_request();
+    struct ibv_sge sg;
+    sg.addr = (uint64_t)buf;
+    sg.lkey = buf->local_K_;
+    sg.length = buf->size_;
+    req->sglist.push_back(sg);
+    req->sge_num = 1;
+
+    if (PostSrqRecv(req)) {
+      ReleaseBuffer(1, buf);
+      delete req;
+      break;
+    }
+  }
+
+  return posted;
+}
+
+
+// Arm the SRQ limit event, it fires once when fewer than srq_limit receives are posted.
+int rdma_io_engine::ArmSrq() {
+  struct ibv_srq_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.srq_limit = FLAGS_srq_limit;
+  if (ibv_modify_srq(srq, &attr, IBV_SRQ_LIMIT)) {
+    PLOG(ERROR) << "ibv_modify_srq() failed";
+    return -1;
+  }
+
+  return 0;
+}
+
+
+// Called by the engine thread after the SRQ limit was reached.
+int rdma_io_engine::RefillSrq() {
+  srq_low.store(false, std::memory_order_relaxed);
+  int n = PostSrqBuffers(RemainingBufferNum(1));
+  if (ArmSrq()) {
+    return -1;
+  }
+
+  return n;
+}
+
+
 rdma_io_engine::rdma_io_engine() {
   
-}
\ No newline at end of file
+}
+
+int rdma_io_engine::PollCq(int cq, int n, struct ibv_wc *wc, uint64_t *ts) {
+  if (cqs_ex.empty()) {
+    int ret = ibv_poll_cq(cqs[cq], n, wc);
+    for (int i=0; i<ret; ++i) {
+      ts[i] = 0;
+    }
+    return ret;
+  }
+
+  struct ibv_cq_ex *cq_ex = cqs_ex[cq];
+  struct ibv_poll_cq_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  int ret = ibv_start_poll(cq_ex, &attr);
+  if (ret == ENOENT) {
+    return 0;
+  }
+  if (ret) {
+    return -1;
+  }
+
+  int polled = 0;
+  do {
+    struct ibv_wc &w = wc[polled];
+    memset(&w, 0, sizeof(w));
+    w.wr_id = cq_ex->wr_id;
+    w.status = cq_ex->status;
+    if (w.status == IBV_WC_SUCCESS) {
+      w.opcode = ibv_wc_read_opcode(cq_ex);
+      w.byte_len = ibv_wc_read_byte_len(cq_ex);
+      w.qp_num = ibv_wc_read_qp_num(cq_ex);
+    }
+    ts[polled] = ibv_wc_read_completion_wallclock_ns(cq_ex);
+    ++polled;
+  } while (polled < n && ibv_next_poll(cq_ex) == 0);
+  ibv_end_poll(cq_ex);
+
+  return polled;
+}
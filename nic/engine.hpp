@@ -1,8 +1,26 @@
 #ifndef ENGINE_HPP
 #define ENGINE_HPP
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
 #include "endpoint.hpp"
 #include "memory.hpp"
+#include "stage-stats.hpp"
+
+
+// Latency-critical tasks (inference lookups) are sent before bulk ones (updates).
+enum task_priority {
+  kPriorityCritical = 0,
+  kPriorityBulk = 1,
+  kNumPriorities = 2,
+};
 
+/*
+ * Writes bytes [offset, offset + len) of the payload described by `source` into a registered send
+ * buffer. A payload may span several buffers, so it can be called more than once per task.
+ */
+typedef void (*payload_writer)(const char *source, int offset, char *buf, int len);
 
 struct send_task {
   int length;
@@ -10,9 +28,14 @@ struct send_task {
   uint64_t context;
   char *source;
   char *dest;
+  int priority;
+  payload_writer writer;  // nullptr: source holds the payload as is.
+  uint64_t enqueued = 0;  // Now64Ns() at Send(), with --stage_stats
 
-  send_task(void (*cb_)(uint64_t, char *, int), uint64_t ctx_, int length_, char *source_, char *dest_) 
-      : length(length_), source(source_), dest(dest_), callback(cb_), context(ctx_) {}
+  send_task(void (*cb_)(uint64_t, char *, int), uint64_t ctx_, int length_, char *source_, char *dest_,
+            int priority_ = kPriorityBulk, payload_writer writer_ = nullptr) 
+      : length(length_), source(source_), dest(dest_), callback(cb_), context(ctx_),
+        priority(priority_), writer(writer_) {}
 };
 
 /*
@@ -33,8 +56,26 @@ class rdma_io_engine {
   int GetEpNum();
   rdma_endpoint *PickEp(std::string dest);
 
+  // Receive side
+  int Repost(rdma_endpoint *ep, rdma_request *req);
+  void ReleaseRequest(rdma_request *req);
+  rdma_endpoint *RecvEndpoint(const struct ibv_wc &wc, rdma_transmit_status *status);
+  int PostSrqBuffers(int n);
+  int RefillSrq();
+  int ArmSrq();
+
   // Transportation
   std::vector<ibv_cq *> cqs;
+  // With --hw_ts, the extended CQs behind cqs, which carry the NIC's completion timestamps.
+  std::vector<ibv_cq_ex *> cqs_ex;
+  /*
+   * Polls up to n completions of the CQ at index cq. ts[i] is when the NIC completed wc[i] in
+   * Now64Ns() time with --hw_ts, 0 otherwise.
+   */
+  int PollCq(int cq, int n, struct ibv_wc *wc, uint64_t *ts);
+
+  // Per stage latencies (--stage_stats), recorded and dumped by the poller thread.
+  stage_stats *stages = nullptr;
 
   // Memory
   int pd_num;
@@ -46,6 +87,17 @@ class rdma_io_engine {
   // Credit
   int credit;
 
+  // Completion events (--idle_poll_us): the CQs report to channel, PutTask() writes wake_fd
+  // while the poller of the engine is sleeping.
+  struct ibv_comp_channel *channel = nullptr;
+  int wake_fd = -1;
+  std::atomic<bool> sleeping{false};
+
+  // Shared receive queue (--use_srq): all endpoints of the engine take their receives from it.
+  struct ibv_srq *srq = nullptr;
+  std::atomic<int> srq_posted{0};    // Receives currently posted to srq.
+  std::atomic<bool> srq_low{false};  // Set by IBV_EVENT_SRQ_LIMIT_REACHED.
+
   // Global information
   void *context;
 
@@ -55,13 +107,19 @@ class rdma_io_engine {
   // Task pools relevant, eradicate the competitions.
   // std::mutex tasks_mutex_;
   // std::queue<send_task *> tasks_;
-  tbb::concurrent_queue<send_task *> tasks_;
+  tbb::concurrent_queue<send_task *> tasks_[kNumPriorities];
   // semaphore tasks_semaphore_;
 
   // Endpoint pools relevant.
   std::vector<rdma_endpoint *> endpoints_;
   int endpoint_index_ = 0;
 
+  // Receive completions on the SRQ only carry the qp_num.
+  std::unordered_map<uint32_t, rdma_endpoint *> qpn_eps_;
+  std::mutex qpn_eps_mutex_;
+
+  int PostSrqRecv(rdma_request *req);
+
 };
 
 
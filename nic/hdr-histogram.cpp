@@ -0,0 +1,109 @@
+#include "hdr-histogram.hpp"
+
+#include <math.h>
+
+#include <algorithm>
+
+
+hdr_histogram::hdr_histogram(uint64_t highest_trackable, int significant_digits)
+    : highest_trackable_(std::max<uint64_t>(highest_trackable, 2)) {
+  significant_digits = std::min(std::max(significant_digits, 1), 5);
+  // Twice the resolution, since the lower half of each bucket overlaps the previous one.
+  sub_bucket_bits_ = (int)ceil(log2(2 * pow(10, significant_digits)));
+  sub_bucket_count_ = 1llu << sub_bucket_bits_;
+  counts_.resize(Index(highest_trackable_) + 1);
+}
+
+
+/*
+ * Values below sub_bucket_count_ are counted one by one. Above, a value whose highest bit is
+ * `sub_bucket_bits_ - 1 + shift` keeps its top sub_bucket_bits_ bits, and each shift adds half
+ * a sub-bucket range of slots.
+ */
+size_t hdr_histogram::Index(uint64_t value) const {
+  if (value < sub_bucket_count_) {
+    return value;
+  }
+  int shift = 63 - __builtin_clzll(value) - (sub_bucket_bits_ - 1);
+  return shift * (sub_bucket_count_ / 2) + (value >> shift);
+}
+
+
+uint64_t hdr_histogram::LowestEquivalent(size_t index) const {
+  if (index < sub_bucket_count_) {
+    return index;
+  }
+  uint64_t half = sub_bucket_count_ / 2;
+  int shift = index / half - 1;
+  return (index - shift * half) << shift;
+}
+
+
+uint64_t hdr_histogram::HighestEquivalent(size_t index) const {
+  if (index < sub_bucket_count_) {
+    return index;
+  }
+  uint64_t half = sub_bucket_count_ / 2;
+  int shift = index / half - 1;
+  return LowestEquivalent(index) + (1llu << shift) - 1;
+}
+
+
+void hdr_histogram::Record(uint64_t value, uint64_t count) {
+  value = std::min(value, highest_trackable_);
+  counts_[Index(value)] += count;
+  total_ += count;
+  min_ = std::min(min_, value);
+  max_ = std::max(max_, value);
+}
+
+
+void hdr_histogram::Merge(const hdr_histogram &other) {
+  for (size_t i=0; i<counts_.size() && i<other.counts_.size(); ++i) {
+    counts_[i] += other.counts_[i];
+  }
+  total_ += other.total_;
+  min_ = std::min(min_, other.min_);
+  max_ = std::max(max_, other.max_);
+}
+
+
+void hdr_histogram::Reset() {
+  std::fill(counts_.begin(), counts_.end(), 0);
+  total_ = 0;
+  min_ = UINT64_MAX;
+  max_ = 0;
+}
+
+
+uint64_t hdr_histogram::ValueAtPercentile(double percentile) const {
+  if (total_ == 0) {
+    return 0;
+  }
+  uint64_t target = (uint64_t)ceil(std::min(std::max(percentile, 0.0), 100.0) / 100 * total_);
+  target = std::max<uint64_t>(target, 1);
+
+  uint64_t seen = 0;
+  for (size_t i=0; i<counts_.size(); ++i) {
+    seen += counts_[i];
+    if (seen >= target) {
+      return std::min(HighestEquivalent(i), max_);
+    }
+  }
+  return max_;
+}
+
+
+double hdr_histogram::Mean() const {
+  if (total_ == 0) {
+    return 0;
+  }
+  double sum = 0;
+  for (size_t i=0; i<counts_.size(); ++i) {
+    if (counts_[i]) {
+      // The middle of the bucket.
+      sum += counts_[i] * ((LowestEquivalent(i) + HighestEquivalent(i)) / 2.0);
+    }
+  }
+  return sum / total_;
+}
@@ -0,0 +1,49 @@
+#ifndef HDR_HISTOGRAM_HPP
+#define HDR_HISTOGRAM_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+
+/*
+ * A High Dynamic Range histogram of latencies (in ns), in the spirit of HdrHistogram.
+ *
+ * Values are counted in log-linear buckets: every power of two is split into sub-buckets fine
+ * enough to keep `significant_digits` decimal digits, so the memory is fixed (about 200KB for
+ * 3 digits up to a minute) whatever the number of samples. Recording is not thread safe;
+ * keep one histogram per thread and Merge() them at the end.
+ */
+class hdr_histogram {
+ public:
+  hdr_histogram(uint64_t highest_trackable = 60000000000llu, int significant_digits = 3);
+
+  // Values above highest_trackable are clamped to it.
+  void Record(uint64_t value, uint64_t count = 1);
+  // Both histograms must have been created with the same parameters.
+  void Merge(const hdr_histogram &other);
+  void Reset();
+
+  // The highest value equivalent to the one at `percentile` (0-100).
+  uint64_t ValueAtPercentile(double percentile) const;
+  uint64_t Count() const { return total_; }
+  uint64_t Min() const { return total_ ? min_ : 0; }
+  uint64_t Max() const { return max_; }
+  double Mean() const;
+
+ private:
+  int sub_bucket_bits_;
+  uint64_t sub_bucket_count_;
+  uint64_t highest_trackable_;
+  std::vector<uint64_t> counts_;
+  uint64_t total_ = 0;
+  uint64_t min_ = UINT64_MAX;
+  uint64_t max_ = 0;
+
+  size_t Index(uint64_t value) const;
+  uint64_t HighestEquivalent(size_t index) const;
+  uint64_t LowestEquivalent(size_t index) const;
+};
+
+#endif
@@ -50,13 +50,30 @@ DEFINE_bool(memalign, true, "memalign instead of malloc");
 
 DEFINE_int32(send_wq_depth, 1024, "Send Work Queue depth");
 DEFINE_int32(recv_wq_depth, 1024, "Recv Work Queue depth");
+DEFINE_bool(use_srq, false, "All qps of an IO engine share one receive queue");
+DEFINE_int32(srq_depth, 256, "The number of receives an IO engine keeps posted to its SRQ");
+DEFINE_int32(srq_limit, 64,
+             "SRQ watermark below which the spare receive buffers (buf_num - srq_depth) are posted");
+DEFINE_int32(idle_poll_us, 0,
+             "Idle time after which an IO engine waits for completion events instead of polling, 0 "
+             "to always poll");
+DEFINE_int32(engines_per_poller, 1, "The number of IO engines sharing one polling thread");
+DEFINE_int32(poller_report_s, 0, "Interval of the per-engine CPU/wakeup report, 0 to disable");
+DEFINE_int32(credit_window, 64,
+             "Requests a GPU node may have outstanding per memory node, 0 to disable flow control");
+DEFINE_int32(qos_reserved_credits, 8, "Credits of the window that only latency-critical tasks may use");
+DEFINE_bool(stage_stats, false,
+            "Record per engine latency histograms of each stage of a request, dumped every "
+            "poller_report_s");
+DEFINE_bool(qos_engine, false,
+            "Send latency-critical tasks through a dedicated QoS engine and endpoint per host");
 DEFINE_int32(cq_depth, 65536, "CQ depth");
 
 DEFINE_int32(buf_num, 1, "The number of buffers one QP owns");
 DEFINE_int32(mr_num, 1, "The number of MR one thread contains.");
 DEFINE_bool(use_cuda, false, "Whether use cuda or not");
 DEFINE_int32(gpu_id, 0, "Cuda device id");
-DEFINE_bool(hw_ts, false, "Hardware timestamp enable?");
+DEFINE_bool(hw_ts, false, "Use the NIC's completion timestamps for stage_stats if it has them");
 
 DEFINE_bool(run_infinitely, false, "Will run infinitely");
 DEFINE_int32(iters, 200000, "Iterations one QP will send");
@@ -242,5 +259,28 @@ bool ParametersCheck() {
   
   // TODO
 
+  if (FLAGS_credit_window > 0 && FLAGS_qos_reserved_credits >= FLAGS_credit_window) {
+    LOG(ERROR) << "qos_reserved_credits should be less than credit_window";
+    return false;
+  }
+  if (FLAGS_engines_per_poller <= 0) {
+    LOG(ERROR) << "engines_per_poller should be positive";
+    return false;
+  }
+  if (FLAGS_stage_stats && FLAGS_poller_report_s <= 0) {
+    LOG(ERROR) << "stage_stats needs a positive poller_report_s to be dumped";
+    return false;
+  }
+  if (FLAGS_use_srq) {
+    if (FLAGS_srq_depth <= 0 || FLAGS_srq_depth > FLAGS_buf_num) {
+      LOG(ERROR) << "srq_depth should be positive and at most buf_num";
+      return false;
+    }
+    if (FLAGS_srq_limit < 0 || FLAGS_srq_limit >= FLAGS_srq_depth) {
+      LOG(ERROR) << "srq_limit should be less than srq_depth";
+      return false;
+    }
+  }
+
   return true;
 }
\ No newline at end of file
@@ -69,6 +69,16 @@ DECLARE_bool(memalign);
 
 DECLARE_int32(send_wq_depth);
 DECLARE_int32(recv_wq_depth);
+DECLARE_bool(use_srq);
+DECLARE_int32(srq_depth);
+DECLARE_int32(srq_limit);
+DECLARE_int32(idle_poll_us);
+DECLARE_int32(engines_per_poller);
+DECLARE_int32(poller_report_s);
+DECLARE_int32(credit_window);
+DECLARE_int32(qos_reserved_credits);
+DECLARE_bool(qos_engine);
+DECLARE_bool(stage_stats);
 DECLARE_int32(cq_depth);
 DECLARE_int32(buf_size);
 DECLARE_int32(buf_num);
@@ -116,6 +126,17 @@ constexpr int kMaxSge = 16;
 constexpr int kMaxInline = 512;
 constexpr int kMaxConnRetry = 10;
 
+/*
+ * Header in front of every packet between the GPU node and the memory node:
+ *  +------------+------------+----------+-----------+-------------+
+ *  |  Callback  |  Context   |  Length  |  Credits  |  Timestamp  |
+ *  |    (8B)    |    (8B)    |   (4B)   |   (4B)    |    (8B)     |
+ *  +------------+------------+----------+-----------+-------------+
+ * Credits is set on responses only: the send window the memory node gives back (--credit_window).
+ * Timestamp is when the GPU node posted the request (--stage_stats), echoed by the response.
+ */
+constexpr int kPacketHeaderSize = 32;
+
 class connect_info {
  public:
   int type;
@@ -124,6 +145,7 @@ class connect_info {
       union ibv_gid gid;
       int number_of_qp;
       int number_of_mem;
+      int number_of_qos_qp;  // The last number_of_qos_qp QPs go to the QoS engine.
     } host;
     struct {
       uint64_t remote_addr;
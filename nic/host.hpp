@@ -1,6 +1,7 @@
 #ifndef HOST_HPP
 #define HOST_HPP
 
+#include <atomic>
 #include <vector>
 #include <string>
 #include <mutex>
@@ -15,7 +16,7 @@ class rdma_host {
 
  public:
   std::vector<rdma_endpoint *> eps;
-  struct rdma_endpoint *qos_ep;
+  struct rdma_endpoint *qos_ep = nullptr;
   std::string address;
   bool initialized;
 
@@ -23,8 +24,8 @@ class rdma_host {
   int current_ep_index_;
   std::mutex ep_index_mutex_;
 
-  int credit_ = 20;
-  std::mutex credit_mutex_;
+  // Send window towards this host, shared by all engines.
+  std::atomic<int> credit_{20};
 
 
  public:
@@ -48,22 +49,26 @@ class rdma_host {
     return ret;
   }
 
-  bool ApplyCredit() {
-    credit_mutex_.lock();
-    if (credit_ <= 0) {
-      credit_mutex_.unlock();
-      return false;
+  // Take a credit if more than `reserve` are left.
+  bool ApplyCredit(int reserve = 0) {
+    int c = credit_.load(std::memory_order_relaxed);
+    while (c > reserve) {
+      if (credit_.compare_exchange_weak(c, c - 1, std::memory_order_acquire,
+                                        std::memory_order_relaxed)) {
+        return true;
+      }
     }
-    --credit_;
-    credit_mutex_.unlock();
 
-    return true;
+    return false;
+  }
+
+  // Credits piggy-backed on a response.
+  void ReturnCredit(int c) {
+    credit_.fetch_add(c, std::memory_order_release);
   }
 
   void SetCredit(int c) {
-    credit_mutex_.lock();
-    credit_ = c;
-    credit_mutex_.unlock();
+    credit_.store(c);
   }
 };
 
@@ -1,10 +1,12 @@
+#include <algorithm>
+
 #include "rdma-memorynode.hpp"
 
 /* DEBUGGING USED */
-void Test(char *input, int input_len, char *output, int *output_len) {
-  char *str = "HELLOWORLD";
-  memcpy(output, str, 11);
-  *output_len = 11;
+void Test(char *input, int input_len, char *output, int *output_len, int capacity) {
+  const char *str = "HELLOWORLD";
+  *output_len = std::min(11, capacity);
+  memcpy(output, str, *output_len);
 
   printf("Received: %s\n", input);
   fflush(stdout);
@@ -0,0 +1,166 @@
+#include "poller.hpp"
+
+#include <sys/epoll.h>
+#include <time.h>
+
+#include <sstream>
+
+
+static uint64_t ThreadCpuNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1000000000llu + ts.tv_nsec;
+}
+
+
+int rdma_poller::Poll(bool after_wake) {
+  int total = 0;
+
+  for (size_t i=0; i<engines_.size(); ++i) {
+    uint64_t start = Now64Ns();
+    int work = step_(engines_[i]);
+    stats_[i].step_ns += Now64Ns() - start;
+    stats_[i].work += work;
+    if (after_wake) {
+      stats_[i].work_after_wake += work;
+    }
+    total += work;
+  }
+
+  return total;
+}
+
+
+int rdma_poller::InitEvents() {
+  epfd_ = epoll_create1(0);
+  if (epfd_ < 0) {
+    PLOG(ERROR) << "epoll_create1() failed";
+    return -1;
+  }
+
+  for (auto engine : engines_) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = engine->channel;
+    if (epoll_ctl(epfd_, EPOLL_CTL_ADD, engine->channel->fd, &ev)) {
+      PLOG(ERROR) << "epoll_ctl() failed for a completion channel";
+      return -1;
+    }
+    ev.data.ptr = nullptr;
+    if (epoll_ctl(epfd_, EPOLL_CTL_ADD, engine->wake_fd, &ev)) {
+      PLOG(ERROR) << "epoll_ctl() failed for a wake up fd";
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+
+// Returns the number of events that woke us up, or -1 if work arrived before going to sleep.
+int rdma_poller::Sleep(int timeout_ms) {
+  for (auto engine : engines_) {
+    engine->sleeping.store(true);
+    for (auto cq : engine->cqs) {
+      if (ibv_req_notify_cq(cq, 0)) {
+        LOG(ERROR) << "ibv_req_notify_cq() failed";
+        exit(-1);
+      }
+    }
+  }
+
+  // Completions that came in before the CQs were armed do not generate an event.
+  if (Poll(false) == 0) {
+    struct epoll_event evs[16];
+    int n = epoll_wait(epfd_, evs, 16, timeout_ms);
+    for (int i=0; i<n; ++i) {
+      struct ibv_comp_channel *channel = (struct ibv_comp_channel *)evs[i].data.ptr;
+      if (channel) {
+        struct ibv_cq *cq;
+        void *cq_context;
+        while (!ibv_get_cq_event(channel, &cq, &cq_context)) {
+          ibv_ack_cq_events(cq, 1);
+        }
+      }
+    }
+    for (auto engine : engines_) {
+      uint64_t count;
+      while (read(engine->wake_fd, &count, sizeof(count)) > 0) {
+      }
+    }
+    for (auto engine : engines_) {
+      engine->sleeping.store(false);
+    }
+    return n < 0 ? 0 : n;
+  }
+
+  for (auto engine : engines_) {
+    engine->sleeping.store(false);
+  }
+  return -1;
+}
+
+
+void rdma_poller::Report(uint64_t now, uint64_t *last_report, uint64_t *last_cpu) {
+  uint64_t cpu = ThreadCpuNs();
+  double elapsed = now - *last_report;
+  std::ostringstream oss;
+
+  oss << "Poller " << id_ << ": cpu " << 100.0 * (cpu - *last_cpu) / elapsed << "%, "
+      << wakeups_ << " wakeups, wake latency "
+      << (wakeups_ ? wake_latency_ns_ / wakeups_ / 1000.0 : 0.0) << " us";
+  for (size_t i=0; i<engines_.size(); ++i) {
+    oss << "; engine " << id_ * FLAGS_engines_per_poller + i << ": cpu " << 100.0 * stats_[i].step_ns / elapsed
+        << "%, " << stats_[i].work << " ops, " << stats_[i].work_after_wake << " after a wakeup";
+    stats_[i] = engine_stats();
+  }
+  LOG(INFO) << oss.str();
+  for (size_t i=0; i<engines_.size(); ++i) {
+    if (engines_[i]->stages) {
+      LOG(INFO) << "Engine " << id_ * FLAGS_engines_per_poller + i << " stages: "
+                << engines_[i]->stages->Dump();
+    }
+  }
+
+  wakeups_ = 0;
+  wake_latency_ns_ = 0;
+  *last_report = now;
+  *last_cpu = cpu;
+}
+
+
+void rdma_poller::Run() {
+  const uint64_t idle_ns = (uint64_t)FLAGS_idle_poll_us * 1000;
+  const uint64_t report_ns = (uint64_t)FLAGS_poller_report_s * 1000000000;
+  // Wake up now and then to report even if there is no traffic.
+  const int timeout_ms = FLAGS_poller_report_s > 0 ? FLAGS_poller_report_s * 1000 : -1;
+  bool adaptive = FLAGS_idle_poll_us > 0;
+
+  stats_.resize(engines_.size());
+  if (adaptive && InitEvents()) {
+    LOG(ERROR) << "Poller " << id_ << " falls back to busy polling";
+    adaptive = false;
+  }
+
+  uint64_t last_work = Now64Ns(), last_report = last_work, last_cpu = ThreadCpuNs();
+  uint64_t woken = 0;  // Set after a wake up until the work that caused it shows up.
+  while (1) {
+    uint64_t now = Now64Ns();
+    if (Poll(woken != 0)) {
+      if (woken) {
+        ++wakeups_;
+        wake_latency_ns_ += Now64Ns() - woken;
+        woken = 0;
+      }
+      last_work = now;
+    }
+    else if (adaptive && now - last_work >= idle_ns && Sleep(timeout_ms) > 0) {
+      woken = last_work = Now64Ns();
+    }
+
+    if (report_ns && now - last_report >= report_ns) {
+      Report(now, &last_report, &last_cpu);
+    }
+  }
+}
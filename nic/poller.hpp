@@ -0,0 +1,49 @@
+#ifndef POLLER_HPP
+#define POLLER_HPP
+#include <functional>
+#include <vector>
+
+#include "engine.hpp"
+
+
+/*
+ * Drives the data channel of one or more IO engines (--engines_per_poller) from one thread.
+ *
+ * It busy-polls while there is work. After --idle_poll_us without any, it arms the CQs of its
+ * engines (ibv_req_notify_cq) and sleeps in epoll until a completion event or a new send task
+ * (see rdma_io_engine::PutTask) wakes it up. With --idle_poll_us=0 it never sleeps.
+ */
+class rdma_poller {
+ public:
+  // One iteration of an engine's data channel, returns how much work it did.
+  using step_fn = std::function<int(rdma_io_engine *)>;
+
+  rdma_poller(int id, std::vector<rdma_io_engine *> engines, step_fn step)
+      : id_(id), engines_(std::move(engines)), step_(std::move(step)) {}
+
+  // Never returns.
+  void Run();
+
+ private:
+  struct engine_stats {
+    uint64_t step_ns = 0;         // Time spent in step_, i.e. the CPU the engine used.
+    uint64_t work = 0;
+    uint64_t work_after_wake = 0;  // Work found by the first iteration after a wake up.
+  };
+
+  int id_;
+  std::vector<rdma_io_engine *> engines_;
+  step_fn step_;
+
+  int epfd_ = -1;
+  std::vector<engine_stats> stats_;
+  uint64_t wakeups_ = 0;
+  uint64_t wake_latency_ns_ = 0;  // From epoll_wait() returning to the first work done.
+
+  int Poll(bool after_wake);
+  int InitEvents();
+  int Sleep(int timeout_ms);
+  void Report(uint64_t now, uint64_t *last_report, uint64_t *last_cpu);
+};
+
+#endif
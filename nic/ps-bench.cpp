@@ -0,0 +1,185 @@
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <algorithm>
+#include <ctime>
+#include "rdma-gpunode.hpp"
+#include "ps-protocol.hpp"
+
+/*
+ * End-to-end embedding lookup benchmark against ps-test memory nodes started with
+ * --sparse_models. Each IO thread keeps --outstanding batches in flight on its engine and
+ * reports keys/s and per batch latency. Batches are spread over the memory nodes with
+ * client_engine::Lookup().
+ *
+ * With --bulk_io_thread, that many more threads issue the same lookups as bulk traffic on the
+ * same engines, and the latency of both classes is reported separately, e.g. to check the tail
+ * of the critical lookups with --qos_engine and --credit_window.
+ */
+
+DEFINE_string(key_file, "", "sparse model key file to draw keys from (random keys if empty)");
+DEFINE_int64(key_range, 1000000, "keys are drawn from [0, key_range) without key_file");
+DEFINE_int32(table_id, 0, "table to look up");
+DEFINE_int32(batch_size, 1024, "keys per lookup");
+DEFINE_int32(num_batches, 100000, "lookups per IO thread");
+DEFINE_int32(outstanding, 8, "lookups in flight per IO thread");
+DEFINE_int32(emb_vec_size, 16, "embedding vector size (floats) of the table");
+DEFINE_int32(bulk_io_thread, 0, "extra IO threads issuing bulk priority lookups");
+
+client_session session;
+
+std::atomic<uint64_t> total_hits(0);
+std::atomic<uint64_t> total_errors(0);
+
+struct batch_slot {
+  std::atomic<bool> busy{false};
+  uint64_t start;
+  double *latency;  // Where the callback stores the latency of the current batch.
+  std::vector<int64_t> keys;
+  std::vector<float> output;
+};
+
+static uint64_t NowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000llu + ts.tv_nsec;
+}
+
+void LookupDone(uint64_t ctx, int result) {
+  batch_slot *slot = reinterpret_cast<batch_slot *>(ctx);
+  *slot->latency = (double)(NowNs() - slot->start);
+
+  if (result < 0) {
+    total_errors++;
+  } else {
+    total_hits += result;
+  }
+  slot->busy.store(false, std::memory_order_release);
+}
+
+void thread_task(int thread_num, int priority, const std::vector<int64_t> *key_pool,
+                 std::vector<double> *latencies) {
+  auto engine = session.GetEngine(thread_num);
+  std::mt19937_64 rng(thread_num);
+  std::vector<batch_slot> slots(FLAGS_outstanding);
+  for (auto &slot : slots) {
+    slot.keys.resize(FLAGS_batch_size);
+    slot.output.resize((size_t)FLAGS_batch_size * FLAGS_emb_vec_size);
+  }
+
+  for (int i = 0; i < FLAGS_num_batches; i++) {
+    batch_slot &slot = slots[i % FLAGS_outstanding];
+    while (slot.busy.load(std::memory_order_acquire)) {
+    }
+
+    for (auto &key : slot.keys) {
+      key = key_pool->empty() ? (int64_t)(rng() % FLAGS_key_range)
+                              : (*key_pool)[rng() % key_pool->size()];
+    }
+    slot.latency = &(*latencies)[i];
+    slot.busy.store(true, std::memory_order_relaxed);
+    slot.start = NowNs();
+
+    if (engine.Lookup(FLAGS_table_id, slot.keys.data(), FLAGS_batch_size,
+                      reinterpret_cast<char *>(slot.output.data()),
+                      FLAGS_emb_vec_size * sizeof(float), LookupDone,
+                      reinterpret_cast<uint64_t>(&slot), priority)) {
+      std::cout << "Lookup does not fit into the buffers" << std::endl;
+      exit(1);
+    }
+  }
+
+  for (auto &slot : slots) {
+    while (slot.busy.load(std::memory_order_acquire)) {
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  std::vector<std::string> hosts;
+  std::istringstream iss(FLAGS_mem_nodes);
+  std::string node;
+  while (std::getline(iss, node, ',')) {
+    hosts.push_back(node);
+  }
+  if (hosts.empty() || FLAGS_batch_size <= 0 || FLAGS_outstanding <= 0 ||
+      FLAGS_num_batches <= 0 || FLAGS_emb_vec_size <= 0 || FLAGS_bulk_io_thread < 0) {
+    std::cout << "Need --mem_nodes, positive --batch_size/--outstanding/--num_batches/"
+              << "--emb_vec_size and non-negative --bulk_io_thread" << std::endl;
+    return 1;
+  }
+
+  std::vector<int64_t> key_pool;
+  if (!FLAGS_key_file.empty()) {
+    std::ifstream ifs(FLAGS_key_file, std::ios::binary | std::ios::ate);
+    key_pool.resize((size_t)ifs.tellg() / sizeof(int64_t));
+    ifs.seekg(0);
+    ifs.read(reinterpret_cast<char *>(key_pool.data()), key_pool.size() * sizeof(int64_t));
+    if (!ifs || key_pool.empty()) {
+      std::cout << "Cannot read keys from " << FLAGS_key_file << std::endl;
+      return 1;
+    }
+  }
+
+  session.SetHosts(hosts);
+  if (session.Init(argc, argv)) {
+    std::cout << "session init fail" << std::endl;
+    return 1;
+  }
+  session.Start();
+
+  const int thread_count = FLAGS_io_thread + FLAGS_bulk_io_thread;
+  std::vector<std::vector<double>> latencies(thread_count,
+                                             std::vector<double>(FLAGS_num_batches));
+  std::vector<std::thread> threads;
+
+  const uint64_t start = NowNs();
+  for (int i = 0; i < thread_count; i++) {
+    int priority = i < FLAGS_io_thread ? kPriorityCritical : kPriorityBulk;
+    threads.emplace_back(thread_task, i, priority, &key_pool, &latencies[i]);
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+  const double elapsed = (double)(NowNs() - start) / 1e9;
+
+  auto report = [](const char *name, std::vector<double> all) {
+    if (all.empty()) {
+      return;
+    }
+    std::sort(all.begin(), all.end());
+    double sum = 0;
+    for (double l : all) {
+      sum += l;
+    }
+    auto percentile = [&all](int p) { return all[std::min(all.size() - 1, all.size() * p / 100)]; };
+    std::cout << name << " batch latency (us): avg " << sum / all.size() / 1e3 << ", p50 "
+              << percentile(50) / 1e3 << ", p90 " << percentile(90) / 1e3 << ", p99 "
+              << percentile(99) / 1e3 << ", max " << all.back() / 1e3 << std::endl;
+  };
+
+  std::vector<double> critical, bulk;
+  for (int i = 0; i < thread_count; i++) {
+    auto &all = i < FLAGS_io_thread ? critical : bulk;
+    all.insert(all.end(), latencies[i].begin(), latencies[i].end());
+  }
+
+  const double total_batches = (double)thread_count * FLAGS_num_batches;
+  const double total_keys = total_batches * FLAGS_batch_size;
+  std::cout << "batches: " << total_batches << ", batch_size: " << FLAGS_batch_size
+            << ", outstanding: " << FLAGS_outstanding << ", elapsed: " << elapsed << " s"
+            << std::endl;
+  std::cout << "throughput: " << total_keys / elapsed << " keys/s, " << total_batches / elapsed
+            << " batches/s" << std::endl;
+  std::cout << "hit ratio: " << (double)total_hits.load() / total_keys
+            << ", errors: " << total_errors.load() << std::endl;
+  report("critical", critical);
+  report("bulk", bulk);
+  return 0;
+}
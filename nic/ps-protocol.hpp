@@ -0,0 +1,80 @@
+#ifndef PS_PROTOCOL_HPP
+#define PS_PROTOCOL_HPP
+
+#include <stdint.h>
+#include <string.h>
+
+
+/*
+ * Embedding lookups between the GPU node and the memory node. Both messages are the payload of a
+ * session packet (see rdma-gpunode.hpp), so they follow its kPacketHeaderSize bytes header.
+ *
+ * Request:
+ *  +---------+------------+------------+------------+----------------------+
+ *  |  Magic  |  Table ID  |  Num keys  |  Reserved  |  Keys                |
+ *  |  (4B)   |    (4B)    |    (4B)    |    (4B)    |  (Num keys * 8B)     |
+ *  +---------+------------+------------+------------+----------------------+
+ *
+ * Response:
+ *  +---------+------------+------------+------------+------------+-----------------------------+
+ *  |  Magic  |   Status   |  Num keys  |  Vec size  |  Num hits  |  Vectors                    |
+ *  |  (4B)   |    (4B)    |    (4B)    |    (4B)    |    (4B)    |  (Num keys * Vec size)      |
+ *  +---------+------------+------------+------------+------------+-----------------------------+
+ *
+ * Vec size is in bytes. Vectors are densely packed in the order of the keys; keys that are not in
+ * the table get a vector of zeros. Messages without the magic are handled as before (Data).
+ */
+
+constexpr uint32_t kLookupMagic = 0x4c424d45;  // "EMBL"
+
+enum lookup_status : uint32_t {
+  kLookupOk = 0,
+  kLookupBadRequest = 1,
+  kLookupUnknownTable = 2,
+  kLookupTooLarge = 3,  // The response would not fit into a send buffer.
+};
+
+struct lookup_request_header {
+  uint32_t magic;
+  uint32_t table_id;
+  uint32_t num_keys;
+  uint32_t reserved;
+};
+
+struct lookup_response_header {
+  uint32_t magic;
+  uint32_t status;
+  uint32_t num_keys;
+  uint32_t vec_size;
+  uint32_t num_hits;
+};
+
+static_assert(sizeof(lookup_request_header) == 16, "Unexpected padding.");
+static_assert(sizeof(lookup_response_header) == 20, "Unexpected padding.");
+
+
+inline int LookupRequestSize(uint32_t num_keys) {
+  return sizeof(lookup_request_header) + num_keys * sizeof(int64_t);
+}
+
+inline int LookupResponseSize(uint32_t num_keys, uint32_t vec_size) {
+  return sizeof(lookup_response_header) + num_keys * vec_size;
+}
+
+inline bool IsLookupMessage(const char *msg, int length) {
+  uint32_t magic;
+  if (length < (int)sizeof(uint32_t)) return false;
+  memcpy(&magic, msg, sizeof(uint32_t));
+  return magic == kLookupMagic;
+}
+
+// Returns the length of the request.
+inline int WriteLookupRequest(char *msg, uint32_t table_id, const int64_t *keys,
+                              uint32_t num_keys) {
+  struct lookup_request_header header = {kLookupMagic, table_id, num_keys, 0};
+  memcpy(msg, &header, sizeof(header));
+  memcpy(msg + sizeof(header), keys, num_keys * sizeof(int64_t));
+  return LookupRequestSize(num_keys);
+}
+
+#endif
@@ -0,0 +1,113 @@
+#include "ps-service.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include <glog/logging.h>
+
+
+/* Keys and vectors are inserted in batches of this many pairs. */
+constexpr size_t kLoadBatch = 64 * 1024;
+
+
+int embedding_service::LoadSparseModel(uint32_t table_id, const std::string &path,
+                                       int emb_vec_size) {
+  const std::string key_file = path + "/key";
+  const std::string vec_file = path + "/emb_vector";
+  const uint32_t vec_size = emb_vec_size * sizeof(float);
+
+  std::ifstream keys_in(key_file, std::ios::binary | std::ios::ate);
+  std::ifstream vecs_in(vec_file, std::ios::binary | std::ios::ate);
+  if (!keys_in || !vecs_in) {
+    LOG(ERROR) << "Cannot open " << key_file << " or " << vec_file;
+    return -1;
+  }
+  const size_t key_bytes = keys_in.tellg();
+  const size_t vec_bytes = vecs_in.tellg();
+  if (emb_vec_size <= 0 || key_bytes % sizeof(long long) != 0 ||
+      vec_bytes != key_bytes / sizeof(long long) * vec_size) {
+    LOG(ERROR) << "Sparse model " << path << " does not match emb_vec_size " << emb_vec_size;
+    return -1;
+  }
+  keys_in.seekg(0);
+  vecs_in.seekg(0);
+
+  if (tables_.size() <= table_id) {
+    tables_.resize(table_id + 1);
+  }
+  table_info &table = tables_[table_id];
+  std::ostringstream name;
+  name << "table" << table_id;
+  table.name = name.str();
+  table.vec_size = vec_size;
+
+  const size_t num_keys = key_bytes / sizeof(long long);
+  std::vector<long long> keys(kLoadBatch);
+  std::vector<char> vecs(kLoadBatch * vec_size);
+  for (size_t i = 0; i < num_keys; i += kLoadBatch) {
+    const size_t n = std::min(kLoadBatch, num_keys - i);
+    keys_in.read(reinterpret_cast<char *>(keys.data()), n * sizeof(long long));
+    vecs_in.read(vecs.data(), n * vec_size);
+    if (!keys_in || !vecs_in) {
+      LOG(ERROR) << "Short read in sparse model " << path;
+      table.vec_size = 0;
+      return -1;
+    }
+    backend_->insert(table.name, n, keys.data(), vecs.data(), vec_size, vec_size);
+  }
+
+  LOG(INFO) << "Loaded " << num_keys << " keys of " << path << " as table " << table_id
+            << " (" << backend_->get_name() << ")";
+  return 0;
+}
+
+
+int embedding_service::Handle(const char *input, int input_len, char *output,
+                              int output_capacity) {
+  struct lookup_request_header request;
+  struct lookup_response_header response = {kLookupMagic, kLookupOk, 0, 0, 0};
+
+  if (input_len < (int)sizeof(request)) {
+    response.status = kLookupBadRequest;
+  } else {
+    memcpy(&request, input, sizeof(request));
+    if ((size_t)input_len != sizeof(request) + (size_t)request.num_keys * sizeof(int64_t)) {
+      response.status = kLookupBadRequest;
+    } else if (request.table_id >= tables_.size() || tables_[request.table_id].vec_size == 0) {
+      response.status = kLookupUnknownTable;
+    } else if (sizeof(response) + (size_t)request.num_keys * tables_[request.table_id].vec_size >
+               (size_t)output_capacity) {
+      response.status = kLookupTooLarge;
+    }
+  }
+  if (response.status != kLookupOk) {
+    memcpy(output, &response, sizeof(response));
+    return sizeof(response);
+  }
+
+  const table_info &table = tables_[request.table_id];
+  const char *key_ptr = input + sizeof(request);
+  char *values = output + sizeof(response);
+
+  /* Keys follow the session header and the request header, which keep them 8 bytes aligned in
+   * the receive buffers, but the callers' buffers may not be. */
+  thread_local std::vector<long long> aligned_keys;
+  const long long *keys = reinterpret_cast<const long long *>(key_ptr);
+  if (reinterpret_cast<uintptr_t>(key_ptr) % alignof(long long) != 0) {
+    aligned_keys.resize(request.num_keys);
+    memcpy(aligned_keys.data(), key_ptr, request.num_keys * sizeof(long long));
+    keys = aligned_keys.data();
+  }
+
+  const uint32_t vec_size = table.vec_size;
+  const size_t hits = backend_->fetch(
+      table.name, request.num_keys, keys, values, vec_size,
+      [values, vec_size](size_t index) { memset(values + index * vec_size, 0, vec_size); });
+
+  response.num_keys = request.num_keys;
+  response.vec_size = vec_size;
+  response.num_hits = hits;
+  memcpy(output, &response, sizeof(response));
+  return LookupResponseSize(request.num_keys, vec_size);
+}
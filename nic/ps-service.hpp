@@ -0,0 +1,41 @@
+#ifndef PS_SERVICE_HPP
+#define PS_SERVICE_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <hps/database_backend.hpp>
+
+#include "ps-protocol.hpp"
+
+
+/*
+ * Serves embedding lookups (see ps-protocol.hpp) from a HugeCTR HPS database backend. Handle()
+ * may be called by all IO engines concurrently.
+ */
+class embedding_service {
+ public:
+  using backend_type = HugeCTR::DatabaseBackendBase<long long>;
+
+  explicit embedding_service(std::unique_ptr<backend_type> backend)
+      : backend_(std::move(backend)) {}
+
+  // Loads a HugeCTR sparse model (files "key" and "emb_vector") as table `table_id`.
+  int LoadSparseModel(uint32_t table_id, const std::string &path, int emb_vec_size);
+
+  // Answers the request in `input`. `output` has room for `output_capacity` bytes. Returns the
+  // length of the response.
+  int Handle(const char *input, int input_len, char *output, int output_capacity);
+
+ private:
+  struct table_info {
+    std::string name;
+    uint32_t vec_size = 0;  // in bytes, 0 if there is no such table
+  };
+
+  std::unique_ptr<backend_type> backend_;
+  std::vector<table_info> tables_;
+};
+
+#endif
@@ -3,13 +3,21 @@
 #include <fstream>
 #include <iostream>
 #include <thread>
+#include <algorithm>
 #include "data.pb.h"
 #include <chrono>
 #include "rdma-memorynode.hpp"
+#include "ps-service.hpp"
+#include "work-protocol.hpp"
+#include <hps/hash_map_backend.hpp>
 
+DEFINE_string(sparse_models, "", "comma separated list of HugeCTR sparse model dirs, served as tables 0, 1, ...");
+DEFINE_int32(emb_vec_size, 16, "embedding vector size (floats) of the sparse models");
+DEFINE_int32(hps_partitions, 16, "number of HashMapBackend partitions");
 
 
 server_session session;
+std::unique_ptr<embedding_service> service;
 std::string original = "abcdefghijklmnopqrstuvwxyz";
 
 std::string generateRandomString(int n) {
@@ -26,17 +34,51 @@ std::string generateRandomString(int n) {
     return randomString;
 }
 
-void ReturnBytes(char *input, int input_len, char *output, int *output_len) {
+void ReturnBytes(char *input, int input_len, char *output, int *output_len, int capacity) {
     Data message;
     message.ParseFromArray(input, input_len);
     std::string content = message.content();
   
     std::this_thread::sleep_for(std::chrono::nanoseconds(message.inverval()));
     std::string s = generateRandomString(message.rsize());
-    const char* random_string = s.c_str();
-    *output_len = message.rsize();
-    memcpy(output, random_string, message.rsize());
-    memcpy(output,&original,message.rsize());
+    *output_len = std::min<int>((int)s.size(), capacity);
+    memcpy(output, s.data(), *output_len);
+    memcpy(output, original.data(), std::min<int>(*output_len, (int)original.size()));
+}
+
+// The request is read in place, the reply comes from the preallocated `original`.
+void ReturnWork(const work_request_header *request, char *output, int *output_len, int capacity) {
+  std::this_thread::sleep_for(std::chrono::nanoseconds(request->interval_ns));
+  *output_len = std::min<int>({(int)request->reply_size, capacity, (int)original.size()});
+  memcpy(output, original.data(), *output_len);
+}
+
+void Serve(char *input, int input_len, char *output, int *output_len, int capacity) {
+  const work_request_header *work;
+  if (service && IsLookupMessage(input, input_len)) {
+    *output_len = service->Handle(input, input_len, output, capacity);
+  } else if ((work = ReadWorkRequest(input, input_len)) != nullptr) {
+    ReturnWork(work, output, output_len, capacity);
+  } else {
+    ReturnBytes(input, input_len, output, output_len, capacity);
+  }
+}
+
+int LoadSparseModels() {
+  HugeCTR::HashMapBackendParams params;
+  params.num_partitions = FLAGS_hps_partitions;
+  service.reset(new embedding_service(
+      std::make_unique<HugeCTR::HashMapBackend<long long>>(params)));
+
+  std::istringstream iss(FLAGS_sparse_models);
+  std::string path;
+  uint32_t table_id = 0;
+  while (std::getline(iss, path, ',')) {
+    if (service->LoadSparseModel(table_id++, path, FLAGS_emb_vec_size)) {
+      return 1;
+    }
+  }
+  return 0;
 }
 
 int main(int argc, char* argv[]) {
@@ -49,7 +91,12 @@ int main(int argc, char* argv[]) {
     return 1;
   }
 
-  session.SetCallback(ReturnBytes);
+  if (!FLAGS_sparse_models.empty() && LoadSparseModels()) {
+    std::cout << "Loading sparse models failed." << std::endl;
+    return 1;
+  }
+
+  session.SetCallback(Serve);
   
   session.Start();
   
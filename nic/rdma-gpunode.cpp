@@ -1,18 +1,217 @@
 #include "rdma-gpunode.hpp"
 
+#include <algorithm>
 
-int client_engine::Send(void (*callback)(uint64_t, char *, int), uint64_t ctx, char *packet, int length, char *dest) {
-  struct send_task *stask = new send_task(callback, ctx, length, packet, dest);
+
+int client_engine::Send(void (*callback)(uint64_t, char *, int), uint64_t ctx, char *packet, int length, char *dest,
+                        int priority) {
+  return Send(callback, ctx, packet, length, dest, nullptr, priority);
+}
+
+int client_engine::Send(void (*callback)(uint64_t, char *, int), uint64_t ctx, char *source, int length, char *dest,
+                        payload_writer writer, int priority) {
+  struct send_task *stask = new send_task(callback, ctx, length, source, dest, priority, writer);
   if (!stask) {
     return -1;  // No more memory, upper programs should be responsible for this scenario.
   }
+  if (FLAGS_stage_stats) {
+    stask->enqueued = Now64Ns();
+  }
 
-  engine->PutTask(stask);
+  // Latency-critical tasks bypass the bulk ones queued on the regular engines.
+  rdma_io_engine *qos_engine = session ? session->g_context->GetQosEngine() : nullptr;
+  if (priority == kPriorityCritical && qos_engine) {
+    qos_engine->PutTask(stask);
+  }
+  else {
+    engine->PutTask(stask);
+  }
 
   return 0;   // Return correctly.
 }
 
 
+/* Key routing */
+static uint64_t MixKey(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ull;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
+hash_ring_router::hash_ring_router(int num_nodes, int vnodes) {
+  for (int n=0; n<num_nodes; ++n) {
+    for (int v=0; v<vnodes; ++v) {
+      ring_.emplace_back(MixKey(((uint64_t)n << 32) | (uint32_t)v), n);
+    }
+  }
+  std::sort(ring_.begin(), ring_.end());
+}
+
+int hash_ring_router::Owner(int64_t key) const {
+  if (ring_.empty()) {
+    return -1;
+  }
+  auto it = std::lower_bound(ring_.begin(), ring_.end(), std::make_pair(MixKey(key), 0));
+  return it == ring_.end() ? ring_.front().second : it->second;
+}
+
+int range_router::Owner(int64_t key) const {
+  size_t node = std::upper_bound(bounds_.begin(), bounds_.end(), key) - bounds_.begin();
+  return node < bounds_.size() ? (int)node : -1;
+}
+
+
+/* Scatter/gather lookups */
+struct lookup_batch;
+
+// The keys of one batch that go into one message.
+struct lookup_part {
+  lookup_batch *batch;
+  int node;
+  std::vector<int> positions;  // Index of each key in the batch.
+  std::vector<char> request;
+};
+
+struct lookup_batch {
+  char *output;
+  uint32_t vec_size;
+  void (*done)(uint64_t, int);
+  uint64_t context;
+
+  std::atomic<int> pending;
+  std::atomic<int> hits{0};
+  std::atomic<uint32_t> status{kLookupOk};
+  std::vector<lookup_part> parts;
+};
+
+static void ScatterLookup(uint64_t ctx, char *payload, int length) {
+  struct lookup_part *part = (struct lookup_part *)ctx;
+  struct lookup_batch *batch = part->batch;
+  struct lookup_response_header response;
+  const uint32_t num_keys = part->positions.size();
+
+  if (length < (int)sizeof(response) || !IsLookupMessage(payload, length)) {
+    batch->status = kLookupBadRequest;
+  }
+  else {
+    memcpy(&response, payload, sizeof(response));
+    if (response.status != kLookupOk) {
+      batch->status = response.status;
+    }
+    else if (response.num_keys != num_keys || response.vec_size != batch->vec_size ||
+             length != LookupResponseSize(num_keys, batch->vec_size)) {
+      batch->status = kLookupBadRequest;
+    }
+    else {
+      const char *vec = payload + sizeof(response);
+      for (uint32_t i=0; i<num_keys; ++i) {
+        memcpy(batch->output + (size_t)part->positions[i] * batch->vec_size, vec, batch->vec_size);
+        vec += batch->vec_size;
+      }
+      batch->hits += response.num_hits;
+    }
+  }
+
+  if (batch->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    uint32_t status = batch->status.load();
+    batch->done(batch->context, status == kLookupOk ? batch->hits.load() : -(int)status);
+    delete batch;
+  }
+}
+
+int client_engine::Lookup(uint32_t table_id, const int64_t *keys, int num_keys, char *output,
+                          uint32_t vec_size, void (*done)(uint64_t, int), uint64_t ctx,
+                          int priority) {
+  if (!session || !session->router || num_keys < 0 || vec_size == 0) {
+    return -1;
+  }
+  // Each message has to fit into a send buffer here and its response into a receive buffer.
+  const int max_keys = std::min(
+      (FLAGS_sbuf_size - kPacketHeaderSize - (int)sizeof(lookup_request_header)) / (int)sizeof(int64_t),
+      (FLAGS_rbuf_size - kPacketHeaderSize - (int)sizeof(lookup_response_header)) / (int)vec_size);
+  if (max_keys <= 0) {
+    return -1;
+  }
+  if (num_keys == 0) {
+    done(ctx, 0);
+    return 0;
+  }
+
+  const std::vector<std::string> &hosts = session->remote_hosts;
+  std::vector<std::vector<int>> owned(hosts.size());
+  for (int i=0; i<num_keys; ++i) {
+    int node = session->router->Owner(keys[i]);
+    if (node < 0 || node >= (int)hosts.size()) {
+      LOG(ERROR) << "No memory node owns key " << keys[i];
+      return -1;
+    }
+    owned[node].push_back(i);
+  }
+
+  struct lookup_batch *batch = new lookup_batch();
+  batch->output = output;
+  batch->vec_size = vec_size;
+  batch->done = done;
+  batch->context = ctx;
+
+  size_t num_parts = 0;
+  for (auto &positions : owned) {
+    num_parts += (positions.size() + max_keys - 1) / max_keys;
+  }
+  // No reallocation from here on, the parts are the contexts of the messages.
+  batch->parts.reserve(num_parts);
+  batch->pending = num_parts;
+
+  std::vector<int64_t> part_keys;
+  for (size_t node=0; node<owned.size(); ++node) {
+    for (size_t begin=0; begin<owned[node].size(); begin+=max_keys) {
+      size_t end = std::min(owned[node].size(), begin + max_keys);
+      batch->parts.emplace_back();
+      struct lookup_part &part = batch->parts.back();
+      part.batch = batch;
+      part.node = node;
+      part.positions.assign(owned[node].begin() + begin, owned[node].begin() + end);
+
+      part_keys.clear();
+      for (int pos : part.positions) {
+        part_keys.push_back(keys[pos]);
+      }
+      part.request.resize(LookupRequestSize(part_keys.size()));
+      WriteLookupRequest(part.request.data(), table_id, part_keys.data(), part_keys.size());
+    }
+  }
+
+  // Nothing may touch the batch after the last Send(), it can complete at any time.
+  for (size_t i=0; i<num_parts; ++i) {
+    struct lookup_part &part = batch->parts[i];
+    Send(ScatterLookup, (uint64_t)&part, part.request.data(), part.request.size(),
+         const_cast<char *>(hosts[part.node].c_str()), priority);
+  }
+
+  return 0;
+}
+
+static void CompletePromise(uint64_t ctx, int result) {
+  std::promise<int> *promise = (std::promise<int> *)ctx;
+  promise->set_value(result);
+  delete promise;
+}
+
+std::future<int> client_engine::Lookup(uint32_t table_id, const int64_t *keys, int num_keys,
+                                       char *output, uint32_t vec_size, int priority) {
+  std::promise<int> *promise = new std::promise<int>();
+  std::future<int> ret = promise->get_future();
+  if (Lookup(table_id, keys, num_keys, output, vec_size, CompletePromise, (uint64_t)promise,
+             priority)) {
+    promise->set_value(-kLookupBadRequest);
+    delete promise;
+  }
+
+  return ret;
+}
+
+
 /* Upper layer interface: SetHosts() */
 int client_session::SetHosts(std::vector< std::string > &vec) {
   int ret = 0;
@@ -28,130 +227,210 @@ int client_session::SetHosts(std::vector< std::string > &vec) {
 // Get Engine.
 client_engine client_session::GetEngine(int id) {
   struct rdma_io_engine *io_engine = g_context->GetEngine(id);
-  client_engine ret(io_engine);
+  client_engine ret(io_engine, this);
 
   return ret;
 }
 
 
 /* (Worker) IO Engine */
-/* Responsible for only data channel. */
-void client_session::data_channel(rdma_io_engine *engine) {
+/* Responsible for only data channel. One iteration, driven by an rdma_poller. */
+int client_session::data_channel(rdma_io_engine *engine) {
   struct send_task *task;
-  int n;
+  int n, work = 0;
   struct ibv_wc wc[CQ_POLL_DEPTH];
+  uint64_t ts[CQ_POLL_DEPTH];
+  stage_stats *stages = engine->stages;
 
-  while (1) {
-    task = engine->GetTask();
+  if (engine->srq_low.load(std::memory_order_relaxed)) {
+    engine->RefillSrq();
+  }
 
-    if (task) {
-      // Generate a new rdma_request.
-      struct rdma_request *rreq = new rdma_request();
-      struct ibv_sge sge;
+  task = engine->GetTask();
+
+  if (task) {
+    uint64_t dequeued = stages ? Now64Ns() : 0;
+    // Generate a new rdma_request.
+    struct rdma_request *rreq = new rdma_request();
+    struct rdma_endpoint *send_ep = engine->PickEp(task->dest);
+    struct rdma_host *send_host = (struct rdma_host *)send_ep->GetHost();
+
+    // A packet larger than a send buffer goes out as one multi-SGE send, it only has to fit into
+    // a receive buffer of the memory node.
+    int lreq_len = task->length;
+    int max_len = std::min(FLAGS_sbuf_size * kMaxSge, FLAGS_rbuf_size) - kPacketHeaderSize;
+    if (lreq_len > max_len) {
+      // If the length is bigger than the buffers, cut down the packet.
+      lreq_len = max_len;
+    }
+    int packet_len = lreq_len + kPacketHeaderSize;
+    int num_bufs = (packet_len + FLAGS_sbuf_size - 1) / FLAGS_sbuf_size;
 
-      // Allocate a buffer to store each sub-request.
+    // Allocate the buffers of the packet.
+    bool credited = FLAGS_credit_window <= 0 || send_host->ApplyCredit(
+        task->priority == kPriorityCritical ? 0 : FLAGS_qos_reserved_credits);
+    for (int j=0; credited && j<num_bufs; ++j) {
       auto buf = engine->PickNextBuffer(0);
       if (buf == nullptr) {
-        // No buffers left, put back the request.
-        delete rreq;
-        engine->PutTask(task);
+        break;
       }
-      else {
-        sge.addr = (uint64_t)buf;
-        sge.lkey = buf->local_K_;
-        sge.length = buf->size_;
-        rreq->sglist.push_back(sge);
-        rreq->sge_num = 1;
-        rreq->opcode = IBV_WR_SEND;
-
-        // Header
-        char *header = (char *)buf->addr_;
-      
-        // Payload
-        char *payload = header + 20;
-        int lreq_len = task->length;
+      struct ibv_sge sge;
+      sge.addr = (uint64_t)buf;
+      sge.lkey = buf->local_K_;
+      // Only the bytes of the packet go on the wire.
+      sge.length = std::min(packet_len - j * FLAGS_sbuf_size, FLAGS_sbuf_size);
+      rreq->sglist.push_back(sge);
+    }
+    rreq->sge_num = rreq->sglist.size();
+    rreq->opcode = IBV_WR_SEND;
 
-        if (FLAGS_sbuf_size < lreq_len + 20) {
-          // If the length is bigger than the buffer, cut down the packet.
-          lreq_len = FLAGS_sbuf_size - 20;
-        }
-        memcpy(header, &(task->callback), sizeof(void *));
-        memcpy(header+8, &(task->context), sizeof(uint64_t));
-        memcpy(header+16, &lreq_len, sizeof(int));
-        memcpy(payload, task->source, lreq_len);
-
-        // Post Send!
-        struct rdma_endpoint *send_ep = engine->PickEp(task->dest);
-        if (send_ep->PostSend(rreq)) {
-          // May be ENOMEM, which means that send queue is full.
-          engine->ReleaseBuffer(0, (struct rdma_buffer *)rreq->sglist[0].addr);
-          delete rreq;
-          engine->PutTask(task);
+    if (rreq->sge_num < num_bufs) {
+      // No credits or buffers left, put back the request.
+      for (int j=0; j<rreq->sge_num; ++j) {
+        engine->ReleaseBuffer(0, (struct rdma_buffer *)rreq->sglist[j].addr);
+      }
+      if (credited && FLAGS_credit_window > 0) {
+        send_host->ReturnCredit(1);
+      }
+      delete rreq;
+      engine->PutTask(task);
+    }
+    else {
+      uint64_t acquired = stages ? Now64Ns() : 0;
+
+      // Header
+      char *header = (char *)((struct rdma_buffer *)rreq->sglist[0].addr)->addr_;
+      int credits = 0;
+      memcpy(header, &(task->callback), sizeof(void *));
+      memcpy(header+8, &(task->context), sizeof(uint64_t));
+      memcpy(header+16, &lreq_len, sizeof(int));
+      memcpy(header+20, &credits, sizeof(int));
+
+      // Payload, written straight into the registered buffers.
+      int written = 0;
+      for (int j=0; j<rreq->sge_num; ++j) {
+        int skip = j ? 0 : kPacketHeaderSize;
+        char *payload = (char *)((struct rdma_buffer *)rreq->sglist[j].addr)->addr_ + skip;
+        int len = rreq->sglist[j].length - skip;
+        if (task->writer) {
+          task->writer(task->source, written, payload, len);
         }
         else {
-          delete task;
-        } 
+          memcpy(payload, task->source + written, len);
+        }
+        written += len;
       }
+      rreq->posted = stages ? Now64Ns() : 0;
+      memcpy(header+24, &rreq->posted, sizeof(uint64_t));
+
+      // Post Send!
+      if (send_ep->PostSend(rreq)) {
+        // May be ENOMEM, which means that send queue is full.
+        for (int j=0; j<rreq->sge_num; ++j) {
+          engine->ReleaseBuffer(0, (struct rdma_buffer *)rreq->sglist[j].addr);
+        }
+        delete rreq;
+        if (FLAGS_credit_window > 0) {
+          send_host->ReturnCredit(1);
+        }
+        engine->PutTask(task);
+      }
+      else {
+        if (stages) {
+          stages->Record(kStageQueue, task->enqueued, dequeued);
+          stages->Record(kStageBuffer, dequeued, acquired);
+          stages->Record(kStagePost, acquired, Now64Ns());
+        }
+        delete task;
+      } 
     }
+  }
 
-    // Poll CQ.
-    for (auto cq : engine->cqs) {
-      n = ibv_poll_cq(cq, CQ_POLL_DEPTH, wc);
-      if (n < 0) {
-        LOG(ERROR) << "Get incorrect return values in ibv_poll_cq()";
+  // Poll CQ.
+  for (size_t c=0; c<engine->cqs.size(); ++c) {
+    n = engine->PollCq(c, CQ_POLL_DEPTH, wc, ts);
+    if (n < 0) {
+      LOG(ERROR) << "Get incorrect return values in ibv_poll_cq()";
+      exit(-1);
+    }
+    work += n;
+    uint64_t polled = (stages && n) ? Now64Ns() : 0;
+    for (int i=0; i<n; ++i) {
+      if (wc[i].status != IBV_WC_SUCCESS) {
+        LOG(ERROR) << "Get bad WC status " << wc[i].status;
         exit(-1);
       }
-      for (int i=0; i<n; ++i) {
-        if (wc[i].status != IBV_WC_SUCCESS) {
-          LOG(ERROR) << "Get bad WC status " << wc[i].status;
-          exit(-1);
+      
+      switch (wc[i].opcode) {
+       case IBV_WC_SEND: {
+        // Release the send buffers.
+        struct rdma_transmit_status *status = (struct rdma_transmit_status *)wc[i].wr_id;
+        struct rdma_request *req = status->req;
+
+        for (int j=0; j<req->sge_num; ++j) {
+          engine->ReleaseBuffer(0, (struct rdma_buffer *)req->sglist[j].addr);
+        }
+        if (stages) {
+          stages->Record(kStageSendCompletion, req->posted, ts[i] ? ts[i] : polled);
         }
         
-        switch (wc[i].opcode) {
-         case IBV_WC_SEND: {
-          // Release the send buffers.
-          struct rdma_transmit_status *status = (struct rdma_transmit_status *)wc[i].wr_id;
-          struct rdma_request *req = status->req;
-
-          for (int j=0; j<req->sge_num; ++j) {
-            engine->ReleaseBuffer(0, (struct rdma_buffer *)req->sglist[j].addr);
-          }
-          
-          // Relevant data structure can be freed.
-          delete req;
-          delete status;
-          break;
-         }
-         case IBV_WC_RECV: {
-          // Get relevant information.
-          struct rdma_transmit_status *status = (struct rdma_transmit_status *)wc[i].wr_id;
-          struct rdma_request *req = status->req;
-          struct rdma_endpoint *recv_ep = status->ep;
-
-          // Callback!
-          char *recv_packet = (char *)((struct rdma_buffer *)req->sglist[0].addr)->addr_;
-          void (*recv_callback)(uint64_t, char *, int);
-          uint64_t recv_context;
-          int recv_length;
-          char *recv_payload = recv_packet + 20;
-          memcpy(&recv_callback, recv_packet, sizeof(void *));
-          memcpy(&recv_context, recv_packet+8, sizeof(uint64_t));
-          memcpy(&recv_length, recv_packet+16, sizeof(int));
+        // Relevant data structure can be freed.
+        delete req;
+        delete status;
+        break;
+       }
+       case IBV_WC_RECV: {
+        // Get relevant information.
+        struct rdma_transmit_status *status = (struct rdma_transmit_status *)wc[i].wr_id;
+        struct rdma_request *req = status->req;
+        struct rdma_endpoint *recv_ep = engine->RecvEndpoint(wc[i], status);
+
+        // Callback!
+        char *recv_packet = (char *)((struct rdma_buffer *)req->sglist[0].addr)->addr_;
+        void (*recv_callback)(uint64_t, char *, int);
+        uint64_t recv_context;
+        int recv_length, recv_credits;
+        char *recv_payload = recv_packet + kPacketHeaderSize;
+        memcpy(&recv_callback, recv_packet, sizeof(void *));
+        memcpy(&recv_context, recv_packet+8, sizeof(uint64_t));
+        memcpy(&recv_length, recv_packet+16, sizeof(int));
+        memcpy(&recv_credits, recv_packet+20, sizeof(int));
+
+        // The memory node gives back the window of the request.
+        if (FLAGS_credit_window > 0 && recv_credits > 0 && recv_ep) {
+          ((struct rdma_host *)recv_ep->GetHost())->ReturnCredit(recv_credits);
+        }
 
+        if (stages) {
+          uint64_t sent;
+          memcpy(&sent, recv_packet+24, sizeof(uint64_t));
+          if (ts[i]) {
+            stages->Record(kStageRecvPickup, ts[i], polled);
+          }
+          if (sent) {
+            stages->Record(kStageRoundTrip, sent, ts[i] ? ts[i] : polled);
+          }
+          uint64_t start = Now64Ns();
+          recv_callback(recv_context, recv_payload, recv_length);
+          stages->Record(kStageCallback, start, Now64Ns());
+        }
+        else {
           recv_callback(recv_context, recv_payload, recv_length);
-          delete status;
+        }
+        delete status;
 
-          // Another Post Recv.
-          recv_ep->PostRecv(req);          
-         }
+        // Another Post Recv.
+        engine->Repost(recv_ep, req);
+       }
 
-         default:
-          // Nothing to do here.
-          break;
-        }
+       default:
+        // Nothing to do here.
+        break;
       }
     }
   }
+
+  return work;
 }
 
 
@@ -182,6 +461,7 @@ bool client_session::Init(int argc, char **argv) {
       goto destroy;
     }
   }
+  g_context->ReportFootprint();
 
   return false;
 
@@ -192,11 +472,28 @@ bool client_session::Init(int argc, char **argv) {
 
 /* Start program */
 void client_session::Start() {
-  for (auto engine : g_context->GetEngines()) {
-    // Launch a thread of this engine.
-    std::thread engine_thread = std::thread(&client_session::data_channel, this, engine);
+  if (!router) {
+    router = std::make_shared<hash_ring_router>(remote_hosts.size());
+  }
+
+  // Launch a poller thread for every engines_per_poller engines.
+  auto engines = g_context->GetEngines();
+  for (size_t i=0; i<engines.size(); i+=FLAGS_engines_per_poller) {
+    std::vector<rdma_io_engine *> group(engines.begin() + i,
+        engines.begin() + std::min(engines.size(), i + FLAGS_engines_per_poller));
+    std::thread engine_thread = std::thread([this, i, group]() {
+      rdma_poller(i / FLAGS_engines_per_poller, group,
+                  [this](rdma_io_engine *engine) { return data_channel(engine); }).Run();
+    });
     engine_thread.detach();
   }
+  if (auto qos_engine = g_context->GetQosEngine()) {
+    int id = (engines.size() + FLAGS_engines_per_poller - 1) / FLAGS_engines_per_poller;
+    std::thread([this, id, qos_engine]() {
+      rdma_poller(id, {qos_engine},
+                  [this](rdma_io_engine *engine) { return data_channel(engine); }).Run();
+    }).detach();
+  }
 
   g_init_flag = true;
 }
\ No newline at end of file
@@ -8,11 +8,15 @@
 #include <ctime>
 #include <mutex>
 #include <atomic>
+#include <future>
+#include <memory>
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 
 #include "context.hpp"
+#include "poller.hpp"
+#include "ps-protocol.hpp"
 
 #define CQ_POLL_DEPTH 10
 
@@ -27,14 +31,74 @@
  * The first 8 bytes are necessary.
  */
 
+/*
+ * Decides which memory node (index into the hosts given to SetHosts()) owns a key. It has to
+ * match the way the sparse models were sharded across the memory nodes.
+ */
+class key_router {
+ public:
+  virtual ~key_router() = default;
+  // -1 if no node owns the key.
+  virtual int Owner(int64_t key) const = 0;
+};
+
+// Consistent hashing, each node owns `vnodes` points of the ring.
+class hash_ring_router : public key_router {
+ public:
+  hash_ring_router(int num_nodes, int vnodes = 64);
+  int Owner(int64_t key) const override;
+
+ private:
+  std::vector<std::pair<uint64_t, int>> ring_;  // (point, node), sorted by point
+};
+
+// Node i owns the keys in [bounds[i-1], bounds[i]), node 0 also owns everything below. Keys from
+// bounds.back() on are owned by no node.
+class range_router : public key_router {
+ public:
+  explicit range_router(std::vector<int64_t> bounds) : bounds_(std::move(bounds)) {}
+  int Owner(int64_t key) const override;
+
+ private:
+  std::vector<int64_t> bounds_;
+};
+
+
+class client_session;
+
 class client_engine {
   private:
     struct rdma_io_engine *engine;
+    client_session *session;
 
   public:
-    int Send(void (*callback)(uint64_t, char *, int), uint64_t ctx, char *packet, int length, char *dest);
-
-    client_engine(rdma_io_engine *engine_) : engine(engine_)  {}
+    // Latency-critical tasks go through the QoS engine if there is one (--qos_engine).
+    int Send(void (*callback)(uint64_t, char *, int), uint64_t ctx, char *packet, int length, char *dest,
+             int priority = kPriorityBulk);
+    /*
+     * Same as above, but the `length` bytes of the payload are produced by `writer` directly into
+     * the registered send buffers when the task goes out, e.g. WriteWorkRequest for a
+     * work_request in `source`. `source` must live until then.
+     */
+    int Send(void (*callback)(uint64_t, char *, int), uint64_t ctx, char *source, int length, char *dest,
+             payload_writer writer, int priority = kPriorityBulk);
+
+    /*
+     * Looks up `num_keys` keys of `table_id`. Keys are coalesced into one message per owning node
+     * (more if it does not fit into a buffer) and the vectors are scattered back to
+     * output[i * vec_size] in the order of the keys. `done` is called once with the number of hits,
+     * or with -status (see lookup_status) if any node failed. `keys` may be reused when Lookup()
+     * returns, `output` must live until `done`. Lookups are latency-critical by default.
+     */
+    int Lookup(uint32_t table_id, const int64_t *keys, int num_keys, char *output,
+               uint32_t vec_size, void (*done)(uint64_t, int), uint64_t ctx,
+               int priority = kPriorityCritical);
+    // Same as above, but completes a future instead.
+    std::future<int> Lookup(uint32_t table_id, const int64_t *keys, int num_keys, char *output,
+                            uint32_t vec_size, int priority = kPriorityCritical);
+
+    client_engine(rdma_io_engine *engine_, client_session *session_ = nullptr)
+        : engine(engine_), session(session_) {}
 };
 
 
@@ -46,17 +110,21 @@ class client_session {
   bool g_init_flag = false;
 
   std::vector<std::string> remote_hosts;
+  std::shared_ptr<key_router> router;
 
+  friend class client_engine;
 
  public:
   // Send operation
   int SetHosts(std::vector< std::string > &vec);
+  // Key ownership for client_engine::Lookup(), a hash_ring_router over the hosts by default.
+  void SetRouter(std::shared_ptr<key_router> router_) { router = std::move(router_); }
   bool Init(int argc, char **argv);
   void Start();
   client_engine GetEngine(int id);
 
  private:
   /* Definitions of following functions */
-  void data_channel(rdma_io_engine *engine);
+  int data_channel(rdma_io_engine *engine);
 
 };  // class client_session
\ No newline at end of file
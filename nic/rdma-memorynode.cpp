@@ -1,107 +1,139 @@
 #include "rdma-memorynode.hpp"
 
 
-void server_session::data_channel(rdma_io_engine *engine) {
-  int n = 0;
+/* One iteration of an engine's data channel, driven by an rdma_poller. */
+int server_session::data_channel(rdma_io_engine *engine) {
+  int n = 0, work = 0;
   struct ibv_wc wc[CQ_POLL_DEPTH];
-  char callback_ret[FLAGS_sbuf_size] = {0};  /* The size of return value from the callback function */
+  uint64_t ts[CQ_POLL_DEPTH];
+  stage_stats *stages = engine->stages;
+  /* The size of return value from the callback function */
   int callback_ret_len = 0;
 
-  while (1) {
-    // First, poll recv cq to launch a task.
-    for (auto cq : engine->cqs) {
-      n = ibv_poll_cq(cq, CQ_POLL_DEPTH, wc);
-      if (n < 0) {
-        LOG(ERROR) << "Get incorrect return values in ibv_poll_cq()";
+  if (engine->srq_low.load(std::memory_order_relaxed)) {
+    engine->RefillSrq();
+  }
+
+  // First, poll recv cq to launch a task.
+  for (size_t c=0; c<engine->cqs.size(); ++c) {
+    n = engine->PollCq(c, CQ_POLL_DEPTH, wc, ts);
+    if (n < 0) {
+      LOG(ERROR) << "Get incorrect return values in ibv_poll_cq()";
+      exit(-1);
+    }
+    work += n;
+    uint64_t polled = (stages && n) ? Now64Ns() : 0;
+    for (int i=0; i<n; ++i) {
+      if (wc[i].status != IBV_WC_SUCCESS) {
+        LOG(ERROR) << "Get bad WC status " << wc[i].status;
         exit(-1);
       }
-      for (int i=0; i<n; ++i) {
-        if (wc[i].status != IBV_WC_SUCCESS) {
-          LOG(ERROR) << "Get bad WC status " << wc[i].status;
-          exit(-1);
+      switch (wc[i].opcode) {
+       case IBV_WC_RECV: {
+        struct rdma_transmit_status *status = (struct rdma_transmit_status *)wc[i].wr_id;
+        struct rdma_endpoint *ep = engine->RecvEndpoint(wc[i], status);
+        struct rdma_request *recv_req = status->req;
+        char *recv_packet, *recv_payload;
+        int recv_length;
+        uint64_t recv_callback, recv_context, recv_timestamp;
+        uint64_t start, callback_start, callback_end;
+
+        // 1. Parse the recv packet, the payload is handed to the callback in place.
+        callback_ret_len = 0;
+
+        recv_packet = (char *)((struct rdma_buffer *)recv_req->sglist[0].addr)->addr_;
+        memcpy(&recv_callback, recv_packet, sizeof(uint64_t));
+        memcpy(&recv_context, recv_packet+8, sizeof(uint64_t));
+        memcpy(&recv_length, recv_packet+16, sizeof(int));
+        memcpy(&recv_timestamp, recv_packet+24, sizeof(uint64_t));
+        recv_payload = recv_packet + kPacketHeaderSize;
+        if (stages && ts[i]) {
+          stages->Record(kStageRecvPickup, ts[i], polled);
         }
-        switch (wc[i].opcode) {
-         case IBV_WC_RECV: {
-          struct rdma_transmit_status *status = (struct rdma_transmit_status *)wc[i].wr_id;
-          struct rdma_endpoint *ep = status->ep;
-          struct rdma_request *recv_req = status->req;
-          char *recv_packet, *recv_payload;
-          int recv_length;
-          uint64_t recv_callback, recv_context;
-
-          // 1. Parse the recv packet.
-          callback_ret_len = 0;
-          memset(callback_ret, 0, FLAGS_sbuf_size);
-
-          recv_packet = (char *)((struct rdma_buffer *)recv_req->sglist[0].addr)->addr_;
-          memcpy(&recv_callback, recv_packet, sizeof(uint64_t));
-          memcpy(&recv_context, recv_packet+8, sizeof(uint64_t));
-          memcpy(&recv_length, recv_packet+16, sizeof(int));
-          recv_payload = recv_packet + 20;
-
-          Callback(recv_payload, recv_length, callback_ret, &callback_ret_len);
-
-          // 2. Another post recv.
-          ep->PostRecv(recv_req);
-
-          // 3. Send back the return value filled by the callback function.
-          struct rdma_request *send_req = new rdma_request();
-
-          send_req->sge_num = 1;
-          send_req->opcode = IBV_WR_SEND;
-
-          struct ibv_sge sge;
-          auto buf = engine->PickNextBuffer(0);
-          while (buf == nullptr) {
-            usleep(50);
-            buf = engine->PickNextBuffer(0);
-          }
-          sge.addr = (uint64_t)buf;
-          sge.lkey = buf->local_K_;
-          sge.length = buf->size_;
-          send_req->sglist.push_back(sge);
-
-          char *header = (char *)buf->addr_;
-          char *payload = header + 20;
-
-          if (FLAGS_sbuf_size < callback_ret_len + 20) {
-            /* If the length is bigger than the buffer, cut down the packet. */
-            callback_ret_len = FLAGS_sbuf_size - 20;
-          }
-          memcpy(header, &recv_callback, sizeof(uint64_t));
-          memcpy(header+8, &recv_context, sizeof(uint64_t));
-          memcpy(header+16, &callback_ret_len, sizeof(int));
-          memcpy(payload, callback_ret, callback_ret_len);
-
-          /* ibv_post_send. */
-          while (ep->PostSend(send_req)) {
-            usleep(50);
-          }
-          
-          delete status;
-          break;
-         }
-         case IBV_WC_SEND: {
-          // Release the send buffers.
-          struct rdma_transmit_status *sstatus = (struct rdma_transmit_status *)wc[i].wr_id;
-          struct rdma_request *req = sstatus->req;
-
-          for (int j=0; j<req->sge_num; ++j) {
-            engine->ReleaseBuffer(0, (struct rdma_buffer *)req->sglist[j].addr);
-          }
-          
-          // Relevant data structure can be freed.
-          delete req;
-          delete sstatus;
-         }
-          
-         default:
-          // Nothing to do here.
-          break;
+        start = stages ? Now64Ns() : 0;
+
+        // 2. The callback writes its return value straight into the send buffer.
+        struct rdma_request *send_req = new rdma_request();
+
+        send_req->sge_num = 1;
+        send_req->opcode = IBV_WR_SEND;
+
+        struct ibv_sge sge;
+        auto buf = engine->PickNextBuffer(0);
+        while (buf == nullptr) {
+          usleep(50);
+          buf = engine->PickNextBuffer(0);
         }
-      } 
-    }
+
+        char *header = (char *)buf->addr_;
+        char *payload = header + kPacketHeaderSize;
+        /* Give back the credit the request took from the client's window. */
+        int credits = 1;
+
+        callback_start = stages ? Now64Ns() : 0;
+        Callback(recv_payload, recv_length, payload, &callback_ret_len,
+                 FLAGS_sbuf_size - kPacketHeaderSize);
+        callback_end = stages ? Now64Ns() : 0;
+
+        // 3. Another post recv.
+        engine->Repost(ep, recv_req);
+
+        // 4. Send back the return value filled by the callback function.
+        if (FLAGS_sbuf_size < callback_ret_len + kPacketHeaderSize) {
+          /* If the length is bigger than the buffer, cut down the packet. */
+          callback_ret_len = FLAGS_sbuf_size - kPacketHeaderSize;
+        }
+        memcpy(header, &recv_callback, sizeof(uint64_t));
+        memcpy(header+8, &recv_context, sizeof(uint64_t));
+        memcpy(header+16, &callback_ret_len, sizeof(int));
+        memcpy(header+20, &credits, sizeof(int));
+        memcpy(header+24, &recv_timestamp, sizeof(uint64_t));
+
+        sge.addr = (uint64_t)buf;
+        sge.lkey = buf->local_K_;
+        /* Only the bytes of the packet go on the wire. */
+        sge.length = callback_ret_len + kPacketHeaderSize;
+        send_req->sglist.push_back(sge);
+
+        /* ibv_post_send. */
+        send_req->posted = stages ? Now64Ns() : 0;
+        while (ep->PostSend(send_req)) {
+          usleep(50);
+        }
+        if (stages) {
+          stages->Record(kStageCallback, callback_start, callback_end);
+          /* Everything but the callback: waiting for the send buffer, reposting and posting. */
+          stages->Record(kStageReplyPost, start + (callback_end - callback_start), Now64Ns());
+        }
+        
+        delete status;
+        break;
+       }
+       case IBV_WC_SEND: {
+        // Release the send buffers.
+        struct rdma_transmit_status *sstatus = (struct rdma_transmit_status *)wc[i].wr_id;
+        struct rdma_request *req = sstatus->req;
+
+        for (int j=0; j<req->sge_num; ++j) {
+          engine->ReleaseBuffer(0, (struct rdma_buffer *)req->sglist[j].addr);
+        }
+        if (stages) {
+          stages->Record(kStageSendCompletion, req->posted, ts[i] ? ts[i] : polled);
+        }
+        
+        // Relevant data structure can be freed.
+        delete req;
+        delete sstatus;
+       }
+        
+       default:
+        // Nothing to do here.
+        break;
+      }
+    } 
   }
+
+  return work;
 }
 
 
@@ -137,10 +169,25 @@ bool server_session::Init(int argc, char **argv) {
 
 /* Start program */
 void server_session::Start() {
-  for (auto engine : g_context->GetEngines()) {
-    // Launch a thread of this engine.
-    LOG(INFO) << "A worker thread is launched!";
-    std::thread engine_thread = std::thread(&server_session::data_channel, this, engine);
+  // Launch a poller thread for every engines_per_poller engines.
+  auto engines = g_context->GetEngines();
+  for (size_t i=0; i<engines.size(); i+=FLAGS_engines_per_poller) {
+    std::vector<rdma_io_engine *> group(engines.begin() + i,
+        engines.begin() + std::min(engines.size(), i + FLAGS_engines_per_poller));
+    LOG(INFO) << "A worker thread is launched for " << group.size() << " engines!";
+    std::thread engine_thread = std::thread([this, i, group]() {
+      rdma_poller(i / FLAGS_engines_per_poller, group,
+                  [this](rdma_io_engine *engine) { return data_channel(engine); }).Run();
+    });
     engine_thread.detach();
   }
+  // The QoS engine gets its own poller, so critical requests never wait behind bulk ones.
+  if (auto qos_engine = g_context->GetQosEngine()) {
+    int id = (engines.size() + FLAGS_engines_per_poller - 1) / FLAGS_engines_per_poller;
+    LOG(INFO) << "A worker thread is launched for the QoS engine!";
+    std::thread([this, id, qos_engine]() {
+      rdma_poller(id, {qos_engine},
+                  [this](rdma_io_engine *engine) { return data_channel(engine); }).Run();
+    }).detach();
+  }
 }
\ No newline at end of file
@@ -10,6 +10,7 @@
 #include <unistd.h>
 
 #include "context.hpp"
+#include "poller.hpp"
 
 #define CQ_POLL_DEPTH 10
 
@@ -18,12 +19,17 @@ class server_session {
 
  private:
   /* Definitions of following functions */
-  void data_channel(rdma_io_engine *engine);
+  int data_channel(rdma_io_engine *engine);
 
  public:
   bool Init(int argc, char **argv);
   void Start();
-  void SetCallback(void (*callback)(char *, int, char *, int *)) {
+  /*
+   * The callback gets the payload in place in the receive buffer and writes its return value
+   * straight into a send buffer. The last argument is the room in that buffer, which is
+   * FLAGS_sbuf_size - kPacketHeaderSize bytes.
+   */
+  void SetCallback(void (*callback)(char *, int, char *, int *, int)) {
     Callback = callback;
   }
 
@@ -31,6 +37,6 @@ class server_session {
   /* Definitions of global variables */
   rdma_context *g_context;
 
-  void (*Callback)(char *, int, char *, int *);
+  void (*Callback)(char *, int, char *, int *, int);
 
 };  // class rdma_server_engine
\ No newline at end of file
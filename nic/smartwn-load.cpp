@@ -0,0 +1,316 @@
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <algorithm>
+#include <ctime>
+#include <nlohmann/json.hpp>
+#include "rdma-gpunode.hpp"
+#include "work-protocol.hpp"
+#include "hdr-histogram.hpp"
+
+/*
+ * Open-loop load generator for the SmartWN trace (same format as smartwn-test).
+ *
+ * Unlike smartwn-test, IO threads do not wait for a request before sending the next one: each
+ * request has an intended start time, drawn from a Poisson process at --target_qps or taken from
+ * the "timestamp" field (us) of the trace with --arrival=trace. Its latency is measured from that
+ * intended time, so a stalled client or server shows up in the percentiles instead of silently
+ * lowering the offered load (coordinated omission).
+ *
+ * Everything the hot path needs is prepared up front: the work requests (work-protocol.hpp) are
+ * built when the trace is loaded, and each thread owns --max_outstanding request slots with inline timestamps.
+ * Latencies go into per thread HDR histograms, merged and written to --report_file as JSON.
+ */
+
+DEFINE_double(target_qps, 10000, "offered load in requests/s over all IO threads (poisson)");
+DEFINE_string(arrival, "poisson", "poisson or trace (replay the timestamp field of the trace)");
+DEFINE_double(trace_speedup, 1.0, "divide the trace timestamps by this much");
+DEFINE_int32(duration_s, 10, "length of the poisson run, the trace is cycled as needed");
+DEFINE_int32(warmup_s, 1, "requests intended in the first seconds are not recorded");
+DEFINE_int32(max_outstanding, 1024, "request slots per IO thread");
+DEFINE_string(report_file, "smartwn-load.json", "where to write the JSON report");
+
+using json = nlohmann::json;
+
+client_session session;
+
+struct trace_subreq {
+  std::string dest;
+  std::string message;  // A work request.
+};
+
+struct trace_request {
+  uint64_t timestamp;  // ns from the start of the trace.
+  std::vector<trace_subreq> subreqs;
+};
+
+std::vector<trace_request> trace;
+
+struct request_slot;
+
+struct subreq_slot {
+  request_slot *owner;
+  uint64_t sent;
+  uint64_t done;
+};
+
+struct request_slot {
+  std::atomic<int> pending{0};
+  bool record;
+  uint64_t intended;
+  uint64_t sent;
+  int num_subreqs;
+  std::vector<subreq_slot> subreqs;
+  tbb::concurrent_queue<request_slot *> *completed;
+};
+
+struct thread_result {
+  hdr_histogram request;          // From the intended start to the last response.
+  hdr_histogram request_service;  // From the first send to the last response.
+  hdr_histogram subrequest;       // From send to response.
+  uint64_t sent = 0;
+  uint64_t completed = 0;
+  uint64_t late = 0;              // Requests sent more than 1us after their intended time.
+  uint64_t max_lateness = 0;
+
+  // Owned here rather than by the IO thread, so that responses after the drain still find them.
+  std::vector<request_slot> slots;
+  tbb::concurrent_queue<request_slot *> completed_slots;
+};
+
+static inline uint64_t NowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+  return ts.tv_sec * 1000000000llu + ts.tv_nsec;
+}
+
+// Runs on the poller threads: only stamps the slot and hands it back to its IO thread.
+void ReceiveFromMem(uint64_t ctx, char *arg, int length) {
+  subreq_slot *sub = reinterpret_cast<subreq_slot *>(ctx);
+  sub->done = NowNs();
+
+  request_slot *slot = sub->owner;
+  if (slot->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    slot->completed->push(slot);
+  }
+}
+
+// Records a finished request and returns its slot to the free list.
+static void Harvest(request_slot *slot, thread_result *result, std::vector<request_slot *> *free) {
+  uint64_t done = 0;
+  for (int i = 0; i < slot->num_subreqs; i++) {
+    const subreq_slot &sub = slot->subreqs[i];
+    done = std::max(done, sub.done);
+    if (slot->record) {
+      result->subrequest.Record(sub.done - sub.sent);
+    }
+  }
+  if (slot->record) {
+    result->request.Record(done - slot->intended);
+    result->request_service.Record(done - slot->sent);
+  }
+  result->completed++;
+  free->push_back(slot);
+}
+
+void thread_task(int thread_num, int thread_count, uint64_t start, uint64_t end,
+                 thread_result *result) {
+  auto engine = session.GetEngine(thread_num);
+  const uint64_t warmup_end = start + (uint64_t)FLAGS_warmup_s * 1000000000llu;
+  const bool replay = FLAGS_arrival == "trace";
+
+  size_t max_subreqs = 1;
+  for (auto &request : trace) {
+    max_subreqs = std::max(max_subreqs, request.subreqs.size());
+  }
+  tbb::concurrent_queue<request_slot *> &completed = result->completed_slots;
+  std::vector<request_slot> &slots = result->slots;
+  std::vector<request_slot *> free;
+  for (auto &slot : slots) {
+    slot.subreqs.resize(max_subreqs);
+    for (auto &sub : slot.subreqs) {
+      sub.owner = &slot;
+    }
+    slot.completed = &completed;
+    free.push_back(&slot);
+  }
+
+  // Threads take every thread_count-th request; their Poisson processes add up to target_qps.
+  std::mt19937_64 rng(thread_num);
+  std::exponential_distribution<double> gap(FLAGS_target_qps / thread_count / 1e9);
+  uint64_t intended = start;
+  request_slot *done;
+
+  for (size_t i = thread_num;; i += thread_count) {
+    if (replay) {
+      if (i >= trace.size()) {
+        break;
+      }
+      intended = start + (uint64_t)(trace[i].timestamp / FLAGS_trace_speedup);
+    } else {
+      intended += (uint64_t)gap(rng);
+      if (intended >= end) {
+        break;
+      }
+    }
+    const trace_request &request = trace[i % trace.size()];
+
+    // Wait for the intended time, and for a slot if all of them are in flight.
+    uint64_t now;
+    while ((now = NowNs()) < intended || free.empty()) {
+      while (completed.try_pop(done)) {
+        Harvest(done, result, &free);
+      }
+    }
+    if (now - intended > 1000) {
+      result->late++;
+      result->max_lateness = std::max(result->max_lateness, now - intended);
+    }
+
+    request_slot *slot = free.back();
+    free.pop_back();
+    slot->record = intended >= warmup_end;
+    slot->intended = intended;
+    slot->num_subreqs = request.subreqs.size();
+    slot->pending.store(slot->num_subreqs, std::memory_order_relaxed);
+    slot->sent = NowNs();
+    for (int j = 0; j < slot->num_subreqs; j++) {
+      const trace_subreq &sub = request.subreqs[j];
+      slot->subreqs[j].sent = NowNs();
+      engine.Send(ReceiveFromMem, reinterpret_cast<uint64_t>(&slot->subreqs[j]),
+                  const_cast<char *>(sub.message.data()), sub.message.size(),
+                  const_cast<char *>(sub.dest.c_str()));
+    }
+    result->sent++;
+  }
+
+  // Drain, but give up on responses that never come.
+  const uint64_t deadline = NowNs() + 5000000000llu;
+  while (free.size() < slots.size() && NowNs() < deadline) {
+    while (completed.try_pop(done)) {
+      Harvest(done, result, &free);
+    }
+  }
+}
+
+static json Summary(const hdr_histogram &h) {
+  json j;
+  j["count"] = h.Count();
+  j["mean"] = h.Mean();
+  j["min"] = h.Min();
+  j["p50"] = h.ValueAtPercentile(50);
+  j["p90"] = h.ValueAtPercentile(90);
+  j["p99"] = h.ValueAtPercentile(99);
+  j["p99.9"] = h.ValueAtPercentile(99.9);
+  j["p99.99"] = h.ValueAtPercentile(99.99);
+  j["max"] = h.Max();
+  return j;
+}
+
+static int LoadTrace(const std::string &filename) {
+  std::ifstream ifs(filename);
+  std::string line;
+  std::string content;
+  while (std::getline(ifs, line)) {
+    json j = json::parse(line);
+    trace_request request;
+    request.timestamp = j.contains("timestamp") ? (uint64_t)(j["timestamp"].get<double>() * 1000) : 0;
+    for (const auto &sub : j["subreq"]) {
+      int send_size = sub["send"].get<int>();
+      if ((int)content.size() < send_size) {
+        content.resize(send_size, 'a');
+      }
+      work_request work(sub["receive"].get<int>(), sub["lookup"].get<int>(), content.data(),
+                        send_size);
+      std::string message(WorkRequestSize(send_size), '\0');
+      WriteWorkRequest(reinterpret_cast<const char *>(&work), 0, &message[0], message.size());
+      request.subreqs.push_back({sub["dest"].get<std::string>(), std::move(message)});
+    }
+    if (!request.subreqs.empty()) {
+      trace.push_back(std::move(request));
+    }
+  }
+  return trace.empty() ? -1 : 0;
+}
+
+int main(int argc, char *argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  std::vector<std::string> hosts;
+  std::istringstream iss(FLAGS_mem_nodes);
+  std::string node;
+  while (std::getline(iss, node, ',')) {
+    hosts.push_back(node);
+  }
+  if (hosts.empty() || FLAGS_max_outstanding <= 0 || FLAGS_trace_speedup <= 0 ||
+      (FLAGS_arrival == "poisson" && (FLAGS_target_qps <= 0 || FLAGS_duration_s <= 0)) ||
+      (FLAGS_arrival != "poisson" && FLAGS_arrival != "trace")) {
+    std::cout << "Need --mem_nodes, positive --max_outstanding/--trace_speedup, and "
+              << "--arrival=trace or --arrival=poisson with positive --target_qps/--duration_s"
+              << std::endl;
+    return 1;
+  }
+  if (LoadTrace(FLAGS_trace_file)) {
+    std::cout << "Cannot read requests from " << FLAGS_trace_file << std::endl;
+    return 1;
+  }
+
+  session.SetHosts(hosts);
+  if (session.Init(argc, argv)) {
+    std::cout << "session init fail" << std::endl;
+    return 1;
+  }
+  session.Start();
+
+  const int thread_count = FLAGS_io_thread;
+  std::vector<thread_result> results(thread_count);
+  for (auto &r : results) {
+    r.slots = std::vector<request_slot>(FLAGS_max_outstanding);
+  }
+  std::vector<std::thread> threads;
+
+  // Leave the threads some time to set up their slots before the first intended start.
+  const uint64_t start = NowNs() + 100000000llu;
+  const uint64_t end = start + (uint64_t)FLAGS_duration_s * 1000000000llu;
+  for (int i = 0; i < thread_count; i++) {
+    threads.emplace_back(thread_task, i, thread_count, start, end, &results[i]);
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+  const double elapsed = (double)(NowNs() - start) / 1e9;
+
+  thread_result total;
+  for (auto &r : results) {
+    total.request.Merge(r.request);
+    total.request_service.Merge(r.request_service);
+    total.subrequest.Merge(r.subrequest);
+    total.sent += r.sent;
+    total.completed += r.completed;
+    total.late += r.late;
+    total.max_lateness = std::max(total.max_lateness, r.max_lateness);
+  }
+
+  json report;
+  report["arrival"] = FLAGS_arrival;
+  report["target_qps"] = FLAGS_arrival == "poisson" ? FLAGS_target_qps : 0;
+  report["io_threads"] = thread_count;
+  report["elapsed_s"] = elapsed;
+  report["sent"] = total.sent;
+  report["completed"] = total.completed;
+  report["achieved_qps"] = total.completed / elapsed;
+  report["late_sends"] = total.late;
+  report["max_lateness_ns"] = total.max_lateness;
+  report["latency_ns"]["request"] = Summary(total.request);
+  report["latency_ns"]["request_service"] = Summary(total.request_service);
+  report["latency_ns"]["subrequest"] = Summary(total.subrequest);
+
+  std::ofstream out_file(FLAGS_report_file);
+  out_file << report.dump(2) << std::endl;
+  std::cout << report.dump(2) << std::endl;
+  return total.completed == total.sent ? 0 : 2;
+}
@@ -5,8 +5,8 @@
 #include <nlohmann/json.hpp>
 #include <argparse/argparse.hpp>
 #include <thread>
-#include "data.pb.h"
 #include "rdma-gpunode.hpp"
+#include "work-protocol.hpp"
 #include <chrono>
 #include <tbb/concurrent_vector.h>
 #include <array>
@@ -25,6 +25,7 @@ struct Subreq
     struct timespec* start_timastamp;
     struct timespec* end_timestamp;
     Request* father;
+    work_request work{0, 0, nullptr, 0};
 };
 
 struct Request
@@ -114,14 +115,9 @@ void thread_task(int thread_num, int part_size){
         for (int subInd = 0; subInd < subreqs->size(); subInd++){
             Subreq* subreq = subreqs->at(subInd);
             // std::cout << "IOThread " << thread_num << ",send" << subreq->send << std::endl;
-            Data* d = new Data;
-            d->set_rsize(subreq->receive);
-            d->set_inverval(subreq->lookup);
-            std::string random_string = original.substr(0, subreq->send);
-            d->set_content(random_string);
-            int max_length = d->ByteSizeLong(); 
-            char* buffer = new char[max_length]; 
-            d->SerializeToArray(buffer, max_length);
+            // Written by the engine straight into its send buffers, see work-protocol.hpp.
+            subreq->work = work_request(subreq->receive, subreq->lookup, original.data(), subreq->send);
+            int max_length = WorkRequestSize(subreq->send);
 
             // auto now = std::chrono::high_resolution_clock::now();
             // long nanoseconds = std::chrono::time_point_cast<std::chrono::nanoseconds>(now).time_since_epoch().count();
@@ -136,7 +132,8 @@ void thread_task(int thread_num, int part_size){
             clock_gettime(CLOCK_MONOTONIC, tn);
             subreq->start_timastamp = tn;
             
-            engine.Send(ReveiveFromMem, ptrValue, buffer, max_length, dest_ptr);
+            engine.Send(ReveiveFromMem, ptrValue, reinterpret_cast<char*>(&subreq->work), max_length,
+                        dest_ptr, WriteWorkRequest);
             // engine.Receive();
             // while (!engine.Receive()){
             //     ;
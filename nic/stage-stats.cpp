@@ -0,0 +1,31 @@
+#include "stage-stats.hpp"
+
+#include <sstream>
+
+
+static const char *kStageNames[kNumStages] = {
+  "queue", "buffer", "post", "send_completion", "round_trip", "recv_pickup", "callback",
+  "reply_post",
+};
+
+
+stage_stats::stage_stats() : stages_(kNumStages, hdr_histogram(10000000000llu, 3)) {}
+
+
+std::string stage_stats::Dump() {
+  std::ostringstream oss;
+  oss.precision(3);
+  oss << std::fixed;
+
+  for (int i=0; i<kNumStages; ++i) {
+    hdr_histogram &h = stages_[i];
+    if (h.Count() == 0) {
+      continue;
+    }
+    oss << (oss.tellp() ? "; " : "") << kStageNames[i] << " " << h.Count() << "x p50 " << h.ValueAtPercentile(50) / 1e3
+        << " p99 " << h.ValueAtPercentile(99) / 1e3 << " max " << h.Max() / 1e3 << " us";
+    h.Reset();
+  }
+
+  return oss.str();
+}
@@ -0,0 +1,55 @@
+#ifndef STAGE_STATS_HPP
+#define STAGE_STATS_HPP
+
+#include <string>
+#include <vector>
+
+#include "hdr-histogram.hpp"
+
+
+/*
+ * Where the time of a request goes, per IO engine (--stage_stats). GPU node stages:
+ *
+ *  Queue           client_engine::Send() until the engine picks the task up.
+ *  Buffer          Waiting for credits and send buffers.
+ *  Post            Writing the packet into the buffers and ibv_post_send().
+ *  SendCompletion  Post until the send completes, i.e. is acked by the memory node.
+ *  RoundTrip       Post until the response is polled (or lands, with --hw_ts).
+ *  RecvPickup      A completion landing in the CQ until it is polled (--hw_ts only).
+ *  Callback        The response callback.
+ *
+ * The memory node records RecvPickup, Callback (the request handler), ReplyPost (waiting for a
+ * send buffer and posting the response) and SendCompletion (of the response).
+ *
+ * Only the poller thread of the engine records and dumps (every --poller_report_s), so nothing is
+ * synchronized.
+ */
+enum latency_stage {
+  kStageQueue = 0,
+  kStageBuffer,
+  kStagePost,
+  kStageSendCompletion,
+  kStageRoundTrip,
+  kStageRecvPickup,
+  kStageCallback,
+  kStageReplyPost,
+  kNumStages,
+};
+
+class stage_stats {
+ public:
+  // Up to 10 s per stage.
+  stage_stats();
+
+  // Timestamps in Now64Ns() time. NIC and host clocks may disagree a bit, hence the check.
+  void Record(latency_stage stage, uint64_t start, uint64_t end) {
+    stages_[stage].Record(end > start ? end - start : 0);
+  }
+  // One line with the count and percentiles (us) of each stage seen since the last dump.
+  std::string Dump();
+
+ private:
+  std::vector<hdr_histogram> stages_;
+};
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef WORK_PROTOCOL_HPP
+#define WORK_PROTOCOL_HPP
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+
+
+/*
+ * Flat replacement of the Data message (data.proto) used by the SmartWN traces: the memory node
+ * waits Interval ns and replies with Reply size bytes.
+ *
+ *  +---------+--------------+----------------+---------------+---------------------+
+ *  |  Magic  |  Reply size  |  Interval (ns) |  Content len  |  Content            |
+ *  |  (4B)   |     (4B)     |      (4B)      |     (4B)      |  (Content len)      |
+ *  +---------+--------------+----------------+---------------+---------------------+
+ *
+ * The layout is fixed, so nothing is serialized or parsed: the client writes the message straight
+ * into the registered send buffers (see WriteWorkRequest) and the memory node reads the header in
+ * place from the receive buffer, where it follows the kPacketHeaderSize bytes session header and
+ * is therefore 8 bytes aligned. Messages without the magic are handled as before (Data).
+ */
+
+constexpr uint32_t kWorkMagic = 0x4b524f57;  // "WORK"
+
+struct work_request_header {
+  uint32_t magic;
+  uint32_t reply_size;
+  uint32_t interval_ns;
+  uint32_t content_len;
+};
+
+static_assert(sizeof(work_request_header) == 16, "Unexpected padding.");
+
+
+inline int WorkRequestSize(uint32_t content_len) {
+  return sizeof(work_request_header) + content_len;
+}
+
+// Returns the header in place, or nullptr if msg is not a well formed work request.
+inline const work_request_header *ReadWorkRequest(const char *msg, int length) {
+  if (length < (int)sizeof(work_request_header)) return nullptr;
+  const work_request_header *header = reinterpret_cast<const work_request_header *>(msg);
+  if (header->magic != kWorkMagic) return nullptr;
+  if ((size_t)length != sizeof(work_request_header) + (size_t)header->content_len) return nullptr;
+  return header;
+}
+
+/*
+ * A work request to be sent with client_engine::Send(..., WriteWorkRequest). The content is not
+ * copied until the engine writes the message into its send buffers, so it must stay valid until
+ * the response arrives.
+ */
+struct work_request {
+  work_request_header header;
+  const char *content;
+
+  work_request(uint32_t reply_size, uint32_t interval_ns, const char *content_,
+               uint32_t content_len)
+      : header{kWorkMagic, reply_size, interval_ns, content_len}, content(content_) {}
+};
+
+// A payload_writer (see engine.hpp) for work_request.
+inline void WriteWorkRequest(const char *source, int offset, char *buf, int len) {
+  const work_request *request = reinterpret_cast<const work_request *>(source);
+  const int header_len = sizeof(work_request_header);
+
+  if (offset < header_len) {
+    int n = std::min(len, header_len - offset);
+    memcpy(buf, reinterpret_cast<const char *>(&request->header) + offset, n);
+    buf += n;
+    offset += n;
+    len -= n;
+  }
+  if (len > 0) {
+    memcpy(buf, request->content + (offset - header_len), len);
+  }
+}
+
+#endif
@@ -0,0 +1,554 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cuda_runtime.h>
+#include <parallel_hashmap/phmap.h>
+
+#include <algorithm>
+#include <argparse/argparse.hpp>
+#include <cmath>
+#include <core23/logger.hpp>
+#include <cstring>
+#include <fstream>
+#include <hash_functions.cuh>
+#include <hps/database_backend_detail.hpp>
+#include <hps/inference_utils.hpp>
+#include <hps/key_trace.hpp>
+#include <hps/near_cache.hpp>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <list>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread_pool.hpp>
+#include <unordered_map>
+#include <vector>
+
+using namespace HugeCTR;
+
+/**
+ * Replays key traces against models of the HPS caches, and reports hit rates for a range of cache
+ * capacities. All models are simulated in parallel.
+ *
+ * Supported inputs:
+ * - Key traces recorded by the HPS (`key_trace_path` in the HPS configuration).
+ * - Flat files of little endian keys (e.g., created by `tools/keyset_scripts`), which are replayed
+ *   in batches of `--batch_size` keys.
+ */
+
+struct Trace final {
+  uint32_t key_size{sizeof(uint64_t)};  // Size of the keys in the original lookups.
+  std::vector<uint64_t> keys;
+  // Lookup `i` covers `keys[batch_offsets[i]..batch_offsets[i + 1])`.
+  std::vector<size_t> batch_offsets{0};
+};
+
+struct SimResult final {
+  size_t num_hits{0};
+  size_t num_lookups{0};
+
+  inline double hit_rate() const {
+    return num_lookups ? static_cast<double>(num_hits) / static_cast<double>(num_lookups) : 0.0;
+  }
+};
+
+/**
+ * Keys of different tables must not collide. Mixing the table index into the upper bits keeps keys
+ * of the same table distinct, and separates tables for all practical key ranges.
+ */
+inline uint64_t make_trace_key(const int64_t key, const size_t table_index) {
+  return static_cast<uint64_t>(key) ^ (table_index * 0x9e3779b97f4a7c15ULL);
+}
+
+Trace load_key_trace(const std::vector<std::string>& paths, const std::string& table_filter) {
+  Trace trace;
+  std::unordered_map<std::string, size_t> table_indices;
+
+  std::string tag;
+  uint64_t time;
+  std::vector<int64_t> keys;
+  for (const std::string& path : paths) {
+    KeyTraceReader reader{path};
+    HCTR_CHECK_HINT(path == paths.front() || reader.key_size() == trace.key_size,
+                    "Key size of '", path, "' differs from the previous traces.");
+    trace.key_size = reader.key_size();
+    while (reader.next(tag, time, keys)) {
+      if (!table_filter.empty() && tag != table_filter) {
+        continue;
+      }
+      const size_t table_index{table_indices.emplace(tag, table_indices.size()).first->second};
+      for (const int64_t key : keys) {
+        trace.keys.emplace_back(make_trace_key(key, table_index));
+      }
+      trace.batch_offsets.emplace_back(trace.keys.size());
+    }
+  }
+
+  HCTR_LOG_S(INFO, WORLD) << "Loaded " << trace.batch_offsets.size() - 1 << " lookups ("
+                          << trace.keys.size() << " keys) of " << table_indices.size()
+                          << " tables." << std::endl;
+  return trace;
+}
+
+Trace load_keyset(const std::vector<std::string>& paths, const size_t key_size,
+                  const size_t batch_size) {
+  HCTR_CHECK(key_size == sizeof(uint32_t) || key_size == sizeof(uint64_t));
+  HCTR_CHECK(batch_size > 0);
+
+  Trace trace;
+  trace.key_size = static_cast<uint32_t>(key_size);
+  std::vector<char> buffer;
+  for (const std::string& path : paths) {
+    std::ifstream file{path, std::ios::binary | std::ios::ate};
+    HCTR_CHECK_HINT(file.is_open(), "Unable to open '", path, "'.");
+    buffer.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    HCTR_CHECK(file);
+
+    const size_t num_keys{buffer.size() / key_size};
+    for (size_t i{0}; i < num_keys; ++i) {
+      if (key_size == sizeof(uint32_t)) {
+        uint32_t key;
+        std::memcpy(&key, &buffer[i * key_size], sizeof(uint32_t));
+        trace.keys.emplace_back(key);
+      } else {
+        uint64_t key;
+        std::memcpy(&key, &buffer[i * key_size], sizeof(uint64_t));
+        trace.keys.emplace_back(key);
+      }
+    }
+  }
+
+  for (size_t i{batch_size}; i < trace.keys.size(); i += batch_size) {
+    trace.batch_offsets.emplace_back(i);
+  }
+  trace.batch_offsets.emplace_back(trace.keys.size());
+
+  HCTR_LOG_S(INFO, WORLD) << "Loaded " << trace.keys.size() << " keys ("
+                          << trace.batch_offsets.size() - 1 << " batches)." << std::endl;
+  return trace;
+}
+
+/**
+ * Set hash of `gpu_cache::gpu_cache` and `gpu_cache::cpu_cache` (`MurmurHash3_32` over the key in
+ * its original width).
+ */
+inline size_t slab_set_hash(const uint64_t key, const uint32_t key_size) {
+  if (key_size == sizeof(uint32_t)) {
+    return MurmurHash3_32<unsigned int>::hash(static_cast<unsigned int>(key));
+  }
+  return MurmurHash3_32<long long>::hash(static_cast<long long>(key));
+}
+
+/**
+ * Model of `gpu_cache::gpu_cache` as used by the `EmbeddingCache`: Each lookup batch is
+ * deduplicated and queried. Afterwards, the missing keys are inserted using the slab-set LRU
+ * replacement.
+ */
+SimResult simulate_slab_set_lru(const Trace& trace, const size_t capacity,
+                                const size_t set_associativity, const size_t slab_size) {
+  constexpr uint64_t empty_key{std::numeric_limits<uint64_t>::max()};
+  const size_t set_size{set_associativity * slab_size};
+  const size_t num_sets{std::max<size_t>((capacity + set_size - 1) / set_size, 1)};
+
+  std::vector<uint64_t> slots(num_sets * set_size, empty_key);
+  std::vector<uint64_t> slot_counters(slots.size(), 0);
+  uint64_t global_counter{0};
+
+  const auto find_slot = [&](const uint64_t key, const size_t set, size_t slab, bool& found,
+                             size_t& lr_slot) -> size_t {
+    const size_t set_offset{set * set_size};
+    uint64_t min_counter{std::numeric_limits<uint64_t>::max()};
+    for (size_t i{0}; i < set_associativity; ++i) {
+      const size_t slab_offset{set_offset + slab * slab_size};
+      for (size_t lane{0}; lane < slab_size; ++lane) {
+        if (slots[slab_offset + lane] == key) {
+          found = true;
+          return slab_offset + lane;
+        }
+      }
+      for (size_t lane{0}; lane < slab_size; ++lane) {
+        if (slots[slab_offset + lane] == empty_key) {
+          found = false;
+          return slab_offset + lane;
+        }
+      }
+      for (size_t lane{0}; lane < slab_size; ++lane) {
+        if (slot_counters[slab_offset + lane] < min_counter) {
+          min_counter = slot_counters[slab_offset + lane];
+          lr_slot = slab_offset + lane;
+        }
+      }
+      slab = (slab + 1) % set_associativity;
+    }
+    found = false;
+    return slots.size();
+  };
+
+  SimResult result;
+  std::vector<uint64_t> batch;
+  std::vector<uint64_t> missing;
+  for (size_t b{0}; b + 1 < trace.batch_offsets.size(); ++b) {
+    batch.assign(&trace.keys[trace.batch_offsets[b]], &trace.keys[trace.batch_offsets[b + 1]]);
+    std::sort(batch.begin(), batch.end());
+    result.num_lookups += batch.size();
+
+    // Query.
+    ++global_counter;
+    missing.clear();
+    for (auto it{batch.begin()}; it != batch.end();) {
+      const uint64_t key{*it};
+      const auto run_end{std::find_if(it, batch.end(), [&](const uint64_t k) { return k != key; })};
+
+      const size_t set{slab_set_hash(key, trace.key_size) % num_sets};
+      const size_t slab{key % set_associativity};
+      bool found;
+      size_t lr_slot;
+      const size_t slot{find_slot(key, set, slab, found, lr_slot)};
+      if (found) {
+        slot_counters[slot] = global_counter;
+        result.num_hits += static_cast<size_t>(run_end - it);
+      } else {
+        missing.emplace_back(key);
+      }
+      it = run_end;
+    }
+
+    // Replace.
+    for (const uint64_t key : missing) {
+      const size_t set{slab_set_hash(key, trace.key_size) % num_sets};
+      const size_t slab{key % set_associativity};
+      bool found;
+      size_t lr_slot;
+      size_t slot{find_slot(key, set, slab, found, lr_slot)};
+      if (slot == slots.size()) {
+        slot = lr_slot;
+      }
+      slots[slot] = key;
+      slot_counters[slot] = global_counter;
+    }
+  }
+  return result;
+}
+
+/**
+ * Model of the `HashMapBackend` with `cache_missed_embeddings` enabled. Each lookup batch is
+ * fetched, and the missing keys are inserted afterwards. Like the backend, the insertion proceeds
+ * in chunks of `max_batch_size` keys, and only checks before each chunk whether the table has
+ * reached `capacity` (= `overflow_margin`) entries. If so, the overflow policy evicts
+ * `max_batch_size` keys at a time, until at most `overflow_resolution_target * capacity` remain.
+ * Fetches within the same lookup batch share their timestamp.
+ */
+SimResult simulate_hash_map(const Trace& trace, const size_t capacity,
+                            const DatabaseOverflowPolicy_t policy, const double resolution_target,
+                            const size_t max_batch_size, const uint64_t seed) {
+  struct Meta final {
+    uint64_t last_access;
+    uint64_t num_accesses;
+  };
+  phmap::flat_hash_map<uint64_t, Meta> entries;
+  entries.reserve(capacity + max_batch_size);
+
+  const size_t target_size{static_cast<size_t>(static_cast<double>(capacity) * resolution_target +
+                                               0.5)};
+  std::mt19937_64 gen{seed};
+  std::vector<std::pair<uint64_t, uint64_t>> candidates;  // (metadata, key)
+
+  const auto resolve_overflow = [&]() {
+    candidates.clear();
+    candidates.reserve(entries.size());
+    for (const auto& entry : entries) {
+      uint64_t meta;
+      switch (policy) {
+        case DatabaseOverflowPolicy_t::EvictRandom:
+          meta = gen();
+          break;
+        case DatabaseOverflowPolicy_t::EvictLeastUsed:
+          meta = entry.second.num_accesses;
+          break;
+        case DatabaseOverflowPolicy_t::EvictOldest:
+          meta = entry.second.last_access;
+          break;
+        default:
+          HCTR_DIE("Unsupported overflow policy!");
+      }
+      candidates.emplace_back(meta, entry.first);
+    }
+
+    // Evicts whole batches, so the table may end up below the target size.
+    const size_t num_excess{entries.size() - target_size};
+    const size_t num_evictions{std::min(
+        (num_excess + max_batch_size - 1) / max_batch_size * max_batch_size, entries.size())};
+    std::nth_element(candidates.begin(),
+                     candidates.begin() + static_cast<std::ptrdiff_t>(num_evictions),
+                     candidates.end());
+    for (size_t i{0}; i < num_evictions; ++i) {
+      entries.erase(candidates[i].second);
+    }
+  };
+
+  SimResult result;
+  std::vector<uint64_t> missing;
+  for (size_t b{0}; b + 1 < trace.batch_offsets.size(); ++b) {
+    const uint64_t time{b + 1};
+    const auto batch_begin{trace.keys.begin() +
+                           static_cast<std::ptrdiff_t>(trace.batch_offsets[b])};
+    const auto batch_end{trace.keys.begin() +
+                         static_cast<std::ptrdiff_t>(trace.batch_offsets[b + 1])};
+
+    // Fetch.
+    missing.clear();
+    for (auto k{batch_begin}; k != batch_end; ++k) {
+      const auto it{entries.find(*k)};
+      if (it != entries.end()) {
+        it->second.last_access = time;
+        ++it->second.num_accesses;
+        ++result.num_hits;
+      } else {
+        missing.emplace_back(*k);
+      }
+    }
+    result.num_lookups += static_cast<size_t>(batch_end - batch_begin);
+
+    // Insert. The overflow condition is only checked before each chunk.
+    for (size_t i{0}; i < missing.size(); i += max_batch_size) {
+      if (entries.size() >= capacity) {
+        resolve_overflow();
+      }
+      const size_t chunk_end{std::min(i + max_batch_size, missing.size())};
+      for (size_t j{i}; j < chunk_end; ++j) {
+        entries.insert_or_assign(missing[j], Meta{time, 0});
+      }
+    }
+  }
+  return result;
+}
+
+/**
+ * LRU cache with optional frequency-based admission (TinyLFU): A missing key only replaces the LRU
+ * entry if it was accessed more frequently in the recent past.
+ */
+SimResult simulate_lru(const Trace& trace, const size_t capacity, const bool admission) {
+  std::list<uint64_t> lru;  // Front = most recently used.
+  phmap::flat_hash_map<uint64_t, std::list<uint64_t>::iterator> index;
+  index.reserve(capacity + 1);
+  FrequencySketch sketch{std::max<size_t>(capacity, 1)};
+
+  SimResult result;
+  for (const uint64_t key : trace.keys) {
+    const uint64_t hash{rrxmrrxmsx_0(key)};
+    if (admission) {
+      sketch.increment(hash);
+    }
+
+    const auto it{index.find(key)};
+    if (it != index.end()) {
+      lru.splice(lru.begin(), lru, it->second);
+      ++result.num_hits;
+    } else if (lru.size() < capacity) {
+      lru.emplace_front(key);
+      index.emplace(key, lru.begin());
+    } else if (capacity) {
+      const uint64_t victim{lru.back()};
+      if (admission && sketch.estimate(hash) <= sketch.estimate(rrxmrrxmsx_0(victim))) {
+        continue;
+      }
+      index.erase(victim);
+      lru.back() = key;
+      lru.splice(lru.begin(), lru, std::prev(lru.end()));
+      index.emplace(key, lru.begin());
+    }
+  }
+  result.num_lookups = trace.keys.size();
+  return result;
+}
+
+std::vector<std::string> split(const std::string& s, const char delim) {
+  std::vector<std::string> parts;
+  std::istringstream is{s};
+  for (std::string part; std::getline(is, part, delim);) {
+    if (!part.empty()) {
+      parts.emplace_back(part);
+    }
+  }
+  return parts;
+}
+
+int main(int argc, char** argv) {
+  argparse::ArgumentParser args;
+
+  args.add_argument("--trace")
+      .help("Comma-separated list of HPS key traces.")
+      .default_value<std::string>("");
+  args.add_argument("--keyset")
+      .help("Comma-separated list of flat key files.")
+      .default_value<std::string>("");
+  args.add_argument("--key_size")
+      .help("Size of the keys in --keyset files (in bytes).")
+      .default_value<size_t>(8)
+      .scan<'u', size_t>();
+  args.add_argument("--batch_size")
+      .help("Number of --keyset keys per lookup.")
+      .default_value<size_t>(1024)
+      .scan<'u', size_t>();
+  args.add_argument("--table")
+      .help("Only replay lookups of this table (tag name). Default: all tables.")
+      .default_value<std::string>("");
+
+  args.add_argument("--policies")
+      .help("Comma-separated list of models to simulate.")
+      .default_value<std::string>(
+          "slab_set_lru,evict_random,evict_least_used,evict_oldest,lru,tinylfu");
+  args.add_argument("--min_capacity")
+      .help("Smallest simulated capacity (in keys).")
+      .default_value<size_t>(1024)
+      .scan<'u', size_t>();
+  args.add_argument("--max_capacity")
+      .help("Largest simulated capacity (in keys). Default: number of unique keys.")
+      .default_value<size_t>(0)
+      .scan<'u', size_t>();
+  args.add_argument("--num_capacities")
+      .help("Number of capacities (geometrically spaced).")
+      .default_value<size_t>(12)
+      .scan<'u', size_t>();
+
+  args.add_argument("--set_associativity")
+      .help("Slabs per set of the slab-set LRU (SET_ASSOCIATIVITY).")
+      .default_value<size_t>(2)
+      .scan<'u', size_t>();
+  args.add_argument("--slab_size")
+      .help("Keys per slab of the slab-set LRU (SLAB_SIZE).")
+      .default_value<size_t>(32)
+      .scan<'u', size_t>();
+  args.add_argument("--overflow_resolution_target")
+      .help("Fill level after overflow handling of the hash map models.")
+      .default_value<double>(0.8)
+      .scan<'g', double>();
+  args.add_argument("--max_batch_size")
+      .help("Batch size of inserts and evictions of the hash map models (max_batch_size).")
+      .default_value<size_t>(64L * 1024)
+      .scan<'u', size_t>();
+  args.add_argument("--seed").default_value<uint64_t>(42).scan<'u', uint64_t>();
+
+  try {
+    args.parse_args(argc, argv);
+  } catch (const std::runtime_error& err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << args;
+    return 1;
+  }
+
+  const auto trace_paths = split(args.get<std::string>("--trace"), ',');
+  const auto keyset_paths = split(args.get<std::string>("--keyset"), ',');
+  const auto key_size = args.get<size_t>("--key_size");
+  const auto batch_size = args.get<size_t>("--batch_size");
+  const auto table = args.get<std::string>("--table");
+  const auto policies = split(args.get<std::string>("--policies"), ',');
+  const auto min_capacity = args.get<size_t>("--min_capacity");
+  auto max_capacity = args.get<size_t>("--max_capacity");
+  const auto num_capacities = args.get<size_t>("--num_capacities");
+  const auto set_associativity = args.get<size_t>("--set_associativity");
+  const auto slab_size = args.get<size_t>("--slab_size");
+  const auto overflow_resolution_target = args.get<double>("--overflow_resolution_target");
+  const auto max_batch_size = args.get<size_t>("--max_batch_size");
+  const auto seed = args.get<uint64_t>("--seed");
+
+  HCTR_CHECK_HINT(trace_paths.empty() != keyset_paths.empty(),
+                  "Either --trace or --keyset must be provided.");
+  HCTR_CHECK(set_associativity > 0 && slab_size > 0);
+  HCTR_CHECK(overflow_resolution_target > 0 && overflow_resolution_target <= 1);
+  HCTR_CHECK(num_capacities > 0);
+  HCTR_CHECK(max_batch_size > 0);
+
+  const Trace trace{trace_paths.empty() ? load_keyset(keyset_paths, key_size, batch_size)
+                                       : load_key_trace(trace_paths, table)};
+
+  // An infinite cache only misses the first access to each key.
+  size_t num_unique_keys;
+  {
+    std::vector<uint64_t> keys{trace.keys};
+    std::sort(keys.begin(), keys.end());
+    num_unique_keys = static_cast<size_t>(std::unique(keys.begin(), keys.end()) - keys.begin());
+  }
+  if (!max_capacity) {
+    max_capacity = std::max(num_unique_keys, min_capacity);
+  }
+  HCTR_CHECK(min_capacity > 0 && min_capacity <= max_capacity);
+
+  std::vector<size_t> capacities;
+  for (size_t i{0}; i < num_capacities; ++i) {
+    const double f{num_capacities > 1 ? static_cast<double>(i) / (num_capacities - 1) : 1.0};
+    const size_t capacity{static_cast<size_t>(std::llround(
+        static_cast<double>(min_capacity) *
+        std::pow(static_cast<double>(max_capacity) / static_cast<double>(min_capacity), f)))};
+    if (capacities.empty() || capacity != capacities.back()) {
+      capacities.emplace_back(capacity);
+    }
+  }
+
+  // Simulate all (policy, capacity) combinations concurrently.
+  std::vector<SimResult> results(policies.size() * capacities.size());
+  ThreadPool::get().parallel_for(results.size(), [&](const size_t i) {
+    const std::string& policy{policies[i / capacities.size()]};
+    const size_t capacity{capacities[i % capacities.size()]};
+
+    if (policy == "slab_set_lru") {
+      results[i] = simulate_slab_set_lru(trace, capacity, set_associativity, slab_size);
+    } else if (policy == "evict_random") {
+      results[i] = simulate_hash_map(trace, capacity, DatabaseOverflowPolicy_t::EvictRandom,
+                                     overflow_resolution_target, max_batch_size, seed);
+    } else if (policy == "evict_least_used") {
+      results[i] = simulate_hash_map(trace, capacity, DatabaseOverflowPolicy_t::EvictLeastUsed,
+                                     overflow_resolution_target, max_batch_size, seed);
+    } else if (policy == "evict_oldest") {
+      results[i] = simulate_hash_map(trace, capacity, DatabaseOverflowPolicy_t::EvictOldest,
+                                     overflow_resolution_target, max_batch_size, seed);
+    } else if (policy == "lru") {
+      results[i] = simulate_lru(trace, capacity, false);
+    } else if (policy == "tinylfu") {
+      results[i] = simulate_lru(trace, capacity, true);
+    } else {
+      HCTR_DIE("Unknown policy '", policy, "'!");
+    }
+  });
+
+  // Report hit rate curves (CSV).
+  const double max_hit_rate{
+      trace.keys.empty()
+          ? 0.0
+          : 1.0 - static_cast<double>(num_unique_keys) / static_cast<double>(trace.keys.size())};
+  HCTR_LOG_S(INFO, WORLD) << "Unique keys = " << num_unique_keys
+                          << ", max. achievable hit rate = " << max_hit_rate << std::endl;
+
+  std::cout << "capacity";
+  for (const std::string& policy : policies) {
+    std::cout << ',' << policy;
+  }
+  std::cout << std::endl;
+  for (size_t c{0}; c < capacities.size(); ++c) {
+    std::cout << capacities[c];
+    for (size_t p{0}; p < policies.size(); ++p) {
+      std::cout << ',' << std::fixed << std::setprecision(4)
+                << results[p * capacities.size() + c].hit_rate();
+    }
+    std::cout << std::endl;
+  }
+
+  return 0;
+}
@@ -15,6 +15,7 @@
  */
 
 #include <argparse/argparse.hpp>
+#include <atomic>
 #include <core/memory.hpp>
 #include <core23/logger.hpp>
 #include <hps/hash_map_backend.hpp>
@@ -22,9 +23,11 @@
 #include <hps/mp_hash_map_backend.hpp>
 #include <hps/redis_backend.hpp>
 #include <hps/rocksdb_backend.hpp>
+#include <initializer_list>
 #include <iostream>
 #include <random>
 #include <sstream>
+#include <thread_pool.hpp>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -33,6 +36,18 @@ using namespace HugeCTR;
 
 typedef long long Key;
 
+// Looks up the value of `Enum` that is named `name`. Returns false if there is none.
+template <typename Enum>
+bool parse_enum(const std::string& name, const std::initializer_list<Enum> values, Enum& value) {
+  for (const Enum v : values) {
+    if (name == hctr_enum_to_c_str(v)) {
+      value = v;
+      return true;
+    }
+  }
+  return false;
+}
+
 int main(int argc, char** argv) {
   argparse::ArgumentParser args;
 
@@ -61,6 +76,11 @@ int main(int argc, char** argv) {
       .default_value(false)
       .implicit_value(true);
 
+  args.add_argument("--test_dispatch")
+      .help("Measure the ThreadPool dispatch overhead for hm_parts tasks and exit.")
+      .default_value(false)
+      .implicit_value(true);
+
   args.add_argument("--seed")
       .help("Seed for the random number generator.")
       .default_value<uint64_t>(4711)
@@ -87,6 +107,27 @@ int main(int argc, char** argv) {
       .default_value<size_t>(8L * 1024 * 1024)
       .scan<'u', size_t>();
 
+  args.add_argument("--hm_overflow_policy")
+      .help("Overflow policy for hashmap (evict_random, evict_least_used, evict_oldest).")
+      .default_value<std::string>("evict_random");
+
+  args.add_argument("--hm_access_tracking")
+      .help("How hits are accounted for by the hashmap overflow policy (immediate, deferred).")
+      .default_value<std::string>("immediate");
+
+  args.add_argument("--hm_access_sample_rate")
+      .help("Deferred access tracking: Record every n-th hit.")
+      .default_value<size_t>(1)
+      .scan<'u', size_t>();
+
+  args.add_argument("--hm_value_codec")
+      .help("Format in which the hashmap stores values (none, fp16, bf16, int8).")
+      .default_value<std::string>("none");
+
+  args.add_argument("--hm_numa_placement")
+      .help("NUMA placement of hashmap partitions (default, local, interleaved).")
+      .default_value<std::string>("default");
+
   // Redis parameters.
   args.add_argument("--re_address")
       .help("Redis server address.")
@@ -102,6 +143,21 @@ int main(int argc, char** argv) {
       .default_value<size_t>(5)
       .scan<'u', size_t>();
 
+  args.add_argument("--re_slots")
+      .help("Number of hash tags (cluster slots) per Redis partition.")
+      .default_value<size_t>(1)
+      .scan<'u', size_t>();
+
+  args.add_argument("--re_refresh_workers")
+      .help("Number of background workers that refresh Redis LRU/LFU metadata.")
+      .default_value<size_t>(4)
+      .scan<'u', size_t>();
+
+  args.add_argument("--re_near_cache")
+      .help("Memory budget of the Redis near cache per table (in bytes; 0 = disabled).")
+      .default_value<size_t>(0)
+      .scan<'u', size_t>();
+
   args.add_argument("--re_batch_size")
       .help("Batch size for Redis.")
       .default_value<size_t>(256 * 1024)
@@ -164,16 +220,25 @@ int main(int argc, char** argv) {
   const auto no_test_insert_evict = args.get<bool>("--no_test_insert_evict");
   const auto no_test_upsert = args.get<bool>("--no_test_upsert");
   const auto no_test_fetch = args.get<bool>("--no_test_fetch");
+  const auto test_dispatch = args.get<bool>("--test_dispatch");
   const auto seed = args.get<uint64_t>("--seed");
   // HM parameters.
   const auto hm_parts = args.get<size_t>("--hm_parts");
   const auto hm_alloc_rate = args.get<size_t>("--hm_alloc_rate");
   const auto hm_sm_size = args.get<size_t>("--hm_sm_size");
   const auto hm_batch_size = args.get<size_t>("--hm_batch_size");
+  const auto hm_overflow_policy = args.get<std::string>("--hm_overflow_policy");
+  const auto hm_access_tracking = args.get<std::string>("--hm_access_tracking");
+  const auto hm_access_sample_rate = args.get<size_t>("--hm_access_sample_rate");
+  const auto hm_value_codec = args.get<std::string>("--hm_value_codec");
+  const auto hm_numa_placement = args.get<std::string>("--hm_numa_placement");
   // Redis parameters.
   const auto re_address = args.get<std::string>("--re_address");
   const auto re_parts = args.get<size_t>("--re_parts");
   const auto re_connections = args.get<size_t>("--re_connections");
+  const auto re_slots = args.get<size_t>("--re_slots");
+  const auto re_refresh_workers = args.get<size_t>("--re_refresh_workers");
+  const auto re_near_cache = args.get<size_t>("--re_near_cache");
   const auto re_batch_size = args.get<size_t>("--re_batch_size");
   // RocksDB parameters.
   const auto ro_path = args.get<std::string>("--ro_path");
@@ -191,6 +256,7 @@ int main(int argc, char** argv) {
             << "  no_test_insert_evict = " << no_test_insert_evict << std::endl
             << "  no_test_upsert       = " << no_test_upsert << std::endl
             << "  no_test_fetch        = " << no_test_fetch << std::endl
+            << "  test_dispatch        = " << test_dispatch << std::endl
             << "  seed                 = " << seed << std::endl
             << "  -----------------------------" << std::endl
             << "  broker = " << kafka_broker << std::endl
@@ -203,10 +269,18 @@ int main(int argc, char** argv) {
             << "  hm_alloc_rate  = " << hm_alloc_rate << std::endl
             << "  hm_sm_size     = " << hm_sm_size << std::endl
             << "  hm_batch_size  = " << hm_batch_size << std::endl
+            << "  hm_overflow_policy    = " << hm_overflow_policy << std::endl
+            << "  hm_access_tracking    = " << hm_access_tracking << std::endl
+            << "  hm_access_sample_rate = " << hm_access_sample_rate << std::endl
+            << "  hm_value_codec        = " << hm_value_codec << std::endl
+            << "  hm_numa_placement     = " << hm_numa_placement << std::endl
             << std::endl
             << "  re_address     = " << re_address << std::endl
             << "  re_parts       = " << re_parts << std::endl
             << "  re_connections = " << re_connections << std::endl
+            << "  re_slots       = " << re_slots << std::endl
+            << "  re_refresh_workers = " << re_refresh_workers << std::endl
+            << "  re_near_cache  = " << re_near_cache << std::endl
             << "  re_batch_size  = " << re_batch_size << std::endl
             << std::endl
             << "  ro_path        = " << ro_path << std::endl
@@ -220,14 +294,86 @@ int main(int argc, char** argv) {
             << "  query_repeat = " << query_repeat << std::endl
             << "  -----------------------------" << std::endl;
 
+  if (test_dispatch) {
+    ThreadPool& pool = ThreadPool::get();
+    std::atomic<size_t> counter{0};
+
+    for (size_t k = 0; k < query_repeat; ++k) {
+      const size_t num_rounds = 100'000;
+
+      const auto t0 = std::chrono::high_resolution_clock::now();
+      for (size_t j = 0; j < num_rounds; ++j) {
+        std::vector<std::future<void>> tasks;
+        tasks.reserve(hm_parts);
+        for (size_t part_index = 0; part_index < hm_parts; ++part_index) {
+          tasks.emplace_back(pool.submit([&]() { ++counter; }));
+        }
+        ThreadPool::await(tasks.begin(), tasks.end());
+      }
+      const auto t1 = std::chrono::high_resolution_clock::now();
+      for (size_t j = 0; j < num_rounds; ++j) {
+        pool.parallel_for(hm_parts, [&](const size_t) { ++counter; });
+      }
+      const auto t2 = std::chrono::high_resolution_clock::now();
+
+      const auto dur0 = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0);
+      const auto dur1 = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1);
+      HCTR_LOG_S(INFO, WORLD) << "k = " << k << ", pool size = " << pool.size()
+                              << ", tasks = " << hm_parts << ", submit/await = " << std::fixed
+                              << std::setprecision(3) << (dur0.count() / 1000.0 / num_rounds)
+                              << " us, parallel_for = " << (dur1.count() / 1000.0 / num_rounds)
+                              << " us" << std::endl;
+    }
+    HCTR_CHECK(counter == 2 * query_repeat * 100'000 * hm_parts);
+    return 0;
+  }
+
   const std::string tag_name = HierParameterServerBase::make_tag_name(model_name, table_name);
 
+  DatabaseOverflowPolicy_t overflow_policy;
+  DatabaseAccessTracking_t access_tracking;
+  DatabaseValueCodec_t value_codec;
+  DatabaseNumaPlacement_t numa_placement;
+  const auto usage_error = [&args](const std::string& flag, const std::string& value) {
+    std::cerr << "Invalid value for " << flag << ": " << value << std::endl;
+    std::cout << args;
+    return 1;
+  };
+  if (!parse_enum(hm_overflow_policy,
+                  {DatabaseOverflowPolicy_t::EvictRandom, DatabaseOverflowPolicy_t::EvictLeastUsed,
+                   DatabaseOverflowPolicy_t::EvictOldest},
+                  overflow_policy)) {
+    return usage_error("--hm_overflow_policy", hm_overflow_policy);
+  }
+  if (!parse_enum(hm_access_tracking,
+                  {DatabaseAccessTracking_t::Immediate, DatabaseAccessTracking_t::Deferred},
+                  access_tracking)) {
+    return usage_error("--hm_access_tracking", hm_access_tracking);
+  }
+  if (!parse_enum(hm_value_codec,
+                  {DatabaseValueCodec_t::None, DatabaseValueCodec_t::FP16,
+                   DatabaseValueCodec_t::BF16, DatabaseValueCodec_t::Int8},
+                  value_codec)) {
+    return usage_error("--hm_value_codec", hm_value_codec);
+  }
+  if (!parse_enum(hm_numa_placement,
+                  {DatabaseNumaPlacement_t::Default, DatabaseNumaPlacement_t::Local,
+                   DatabaseNumaPlacement_t::Interleaved},
+                  numa_placement)) {
+    return usage_error("--hm_numa_placement", hm_numa_placement);
+  }
+
   std::unique_ptr<DatabaseBackendBase<Key>> db;
   if (db_type == "hashmap") {
     HashMapBackendParams params;
     params.max_batch_size = hm_batch_size;
     params.num_partitions = hm_parts;
     params.allocation_rate = hm_alloc_rate;
+    params.overflow_policy = overflow_policy;
+    params.access_tracking = access_tracking;
+    params.access_sample_rate = hm_access_sample_rate;
+    params.value_codec = value_codec;
+    params.numa_placement = numa_placement;
     db = std::make_unique<HashMapBackend<Key>>(params);
   } else if (db_type == "mp_hashmap") {
     MultiProcessHashMapBackendParams params;
@@ -235,6 +381,7 @@ int main(int argc, char** argv) {
     params.num_partitions = hm_parts;
     params.allocation_rate = hm_alloc_rate;
     params.shared_memory_size = hm_sm_size;
+    params.value_codec = value_codec;
     db = std::make_unique<MultiProcessHashMapBackend<Key>>(params);
 #ifdef HCTR_USE_REDIS
   } else if (db_type == "redis") {
@@ -243,6 +390,9 @@ int main(int argc, char** argv) {
     params.num_partitions = re_parts;
     params.address = re_address;
     params.num_node_connections = re_connections;
+    params.num_slots_per_partition = re_slots;
+    params.num_refresh_workers = re_refresh_workers;
+    params.near_cache.capacity = re_near_cache;
     db = std::make_unique<RedisClusterBackend<Key>>(params);
 #endif  // HCTR_USE_REDIS
 #ifdef HCTR_USE_ROCKS_DB
@@ -258,6 +408,14 @@ int main(int argc, char** argv) {
   }
 
   const size_t kv_size = sizeof(Key) + emb_size * sizeof(float);
+  if (db_type == "hashmap" || db_type == "mp_hashmap") {
+    const uint32_t value_size = static_cast<uint32_t>(emb_size * sizeof(float));
+    const uint32_t encoded_value_size = value_codec_encoded_size(value_codec, value_size);
+    HCTR_LOG_S(INFO, WORLD) << "Value storage = " << encoded_value_size << " / " << value_size
+                            << " bytes per row (" << std::fixed << std::setprecision(2)
+                            << (static_cast<double>(value_size) / encoded_value_size)
+                            << "x more rows per allocation)." << std::endl;
+  }
 
   std::mt19937_64 gen(seed);
   std::uniform_real_distribution<float> val_dist(-1.0f, 1.0f);
@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <argparse/argparse.hpp>
+#include <chrono>
+#include <dlrm_raw_cpu_utils.hpp>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+using namespace DLRM_RAW_CPU;
+
+namespace {
+
+// Rows [row_begin, row_end) of an input file go to `out`.
+struct OutputRange {
+  int64_t row_begin;
+  int64_t row_end;
+  std::ofstream *out;
+};
+
+struct InputFile {
+  std::string path;
+  int64_t num_rows = 0;
+  std::vector<OutputRange> ranges;
+};
+
+std::vector<std::string> split(const std::string &s, const char delim) {
+  std::vector<std::string> parts;
+  std::istringstream is{s};
+  for (std::string part; std::getline(is, part, delim);) {
+    if (!part.empty()) {
+      parts.emplace_back(part);
+    }
+  }
+  return parts;
+}
+
+// First pass: count the keys of all files and the rows of each file.
+void count_keys(HugeCTR::ThreadPool &pool, std::vector<InputFile> &inputs, const size_t chunk_size,
+                const uint32_t hash_bucket, VocabularyCounter &counter) {
+  for (auto &input : inputs) {
+    const MappedFile file(input.path);
+    const size_t num_chunks = (file.size() + chunk_size - 1) / chunk_size;
+    std::atomic<int64_t> num_rows{0};
+
+    pool.parallel_for(num_chunks, [&](const size_t i) {
+      VocabularyCounter::LocalCounts local;
+      int64_t n = 0;
+      Sample sample;
+      const char *bad_line =
+          for_each_line(file, i * chunk_size, (i + 1) * chunk_size, [&](auto line, auto end) {
+            if (!parse_line(line, end, hash_bucket, sample)) return false;
+            local.add(sample);
+            if (local.size() >= VocabularyCounter::LOCAL_LIMIT) counter.merge(local);
+            n++;
+            return true;
+          });
+      die_on_bad_line(file, bad_line);
+      counter.merge(local);
+      num_rows += n;
+    });
+
+    input.num_rows = num_rows;
+    HCTR_LOG_S(INFO, ROOT) << input.path << "'s total rows number = " << input.num_rows
+                           << std::endl;
+  }
+}
+
+// Second pass: write the rows of `input` that are covered by its output ranges. Each round, every
+// thread converts one chunk into its own buffer. The buffers are written in order while the next
+// round is being converted.
+size_t convert_file(HugeCTR::ThreadPool &pool, const InputFile &input, const size_t num_threads,
+                    const size_t chunk_size, const uint32_t hash_bucket,
+                    const std::vector<Vocabulary> &vocabularies, const int32_t dense_bias) {
+  int64_t rows_end = 0;
+  for (const auto &range : input.ranges) {
+    rows_end = std::max(rows_end, range.row_end);
+  }
+  if (rows_end <= 0) {
+    return 0;
+  }
+
+  const MappedFile file(input.path);
+  std::vector<std::vector<int32_t>> buffers[2]{std::vector<std::vector<int32_t>>(num_threads),
+                                               std::vector<std::vector<int32_t>>(num_threads)};
+  std::future<void> writer;
+  int64_t row = 0;
+  size_t bytes_written = 0;
+
+  for (size_t round = 0, round_begin = 0; round_begin < file.size() && row < rows_end; ++round) {
+    auto &round_buffers = buffers[round % 2];
+    pool.parallel_for(num_threads, [&](const size_t i) {
+      auto &buffer = round_buffers[i];
+      buffer.clear();
+      const size_t begin = round_begin + i * chunk_size;
+      if (begin >= file.size()) return;
+      Sample sample;
+      const char *bad_line =
+          for_each_line(file, begin, begin + chunk_size, [&](auto line, auto end) {
+            if (!parse_line(line, end, hash_bucket, sample)) return false;
+            buffer.push_back(sample.numericals[0]);
+            for (int j = 1; j < NUM_NUMERICALS; ++j) {
+              buffer.push_back(sample.numericals[j] + dense_bias);
+            }
+            for (int c = 0; c < NUM_CATEGORICALS; ++c) {
+              buffer.push_back(vocabularies[c].lookup(sample.keys[c]));
+            }
+            return true;
+          });
+      die_on_bad_line(file, bad_line);
+    });
+    round_begin += num_threads * chunk_size;
+
+    if (writer.valid()) writer.get();
+    const int64_t round_row = row;
+    for (const auto &buffer : round_buffers) {
+      row += static_cast<int64_t>(buffer.size() / NUM_FIELDS);
+    }
+    writer = std::async(std::launch::async, [&input, &round_buffers, &bytes_written, round_row]() {
+      int64_t row = round_row;
+      for (const auto &buffer : round_buffers) {
+        const int64_t n = static_cast<int64_t>(buffer.size() / NUM_FIELDS);
+        for (const auto &range : input.ranges) {
+          const int64_t first = std::max(row, range.row_begin);
+          const int64_t last = std::min(row + n, range.row_end);
+          if (first < last) {
+            const size_t size = static_cast<size_t>(last - first) * NUM_FIELDS * sizeof(int32_t);
+            range.out->write(reinterpret_cast<const char *>(&buffer[(first - row) * NUM_FIELDS]),
+                             static_cast<std::streamsize>(size));
+            bytes_written += size;
+          }
+        }
+        row += n;
+      }
+    });
+  }
+  if (writer.valid()) writer.get();
+
+  HCTR_LOG_S(INFO, ROOT) << "Processed file: " << input.path << std::endl;
+  return bytes_written;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  argparse::ArgumentParser args("dlrm_raw_cpu");
+  args.add_argument("input_dir");
+  args.add_argument("output_dir");
+  args.add_argument("--train")
+      .help("TeraBytes datasets: days for training, separated with comma. Default: Kaggle.")
+      .default_value<std::string>("");
+  args.add_argument("--test")
+      .help("TeraBytes datasets: days for testing, separated with comma.")
+      .default_value<std::string>("");
+  args.add_argument("--freq_threshold")
+      .help("Categorical values that occur at most this many times are mapped to id 0.")
+      .default_value<size_t>(0)
+      .scan<'u', size_t>();
+  args.add_argument("--hash_bucket")
+      .help("Hex values are mapped to [0, hash_bucket). Default: 10M (Kaggle), 40M (TeraBytes).")
+      .default_value<size_t>(0)
+      .scan<'u', size_t>();
+  args.add_argument("--num_threads")
+      .help("Number of threads. Default: all hardware threads.")
+      .default_value<size_t>(0)
+      .scan<'u', size_t>();
+  args.add_argument("--chunk_size")
+      .help("Bytes of input per task.")
+      .default_value<size_t>(32 * 1024 * 1024)
+      .scan<'u', size_t>();
+  args.add_argument("--memory_limit")
+      .help("Bytes for key counts in memory. Beyond that, counts are spilled to --spill_dir.")
+      .default_value<size_t>(size_t{16} * 1024 * 1024 * 1024)
+      .scan<'u', size_t>();
+  args.add_argument("--spill_dir")
+      .help("Directory for spilled key counts. Default: output_dir.")
+      .default_value<std::string>("");
+
+  try {
+    args.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << args;
+    return 1;
+  }
+
+  const auto input_dir_path = args.get<std::string>("input_dir");
+  const auto output_dir_path = args.get<std::string>("output_dir");
+  const auto train_days = split(args.get<std::string>("--train"), ',');
+  const auto test_days = split(args.get<std::string>("--test"), ',');
+  const auto freq_threshold = args.get<size_t>("--freq_threshold");
+  auto hash_bucket = args.get<size_t>("--hash_bucket");
+  auto num_threads = args.get<size_t>("--num_threads");
+  const auto chunk_size = std::max<size_t>(args.get<size_t>("--chunk_size"), 4096);
+  const auto memory_limit = args.get<size_t>("--memory_limit");
+  auto spill_dir = args.get<std::string>("--spill_dir");
+
+  const bool is_kaggle = train_days.empty() && test_days.empty();
+  HCTR_CHECK_HINT(is_kaggle || (!train_days.empty() && !test_days.empty()),
+                  "TeraBytes datasets need both --train and --test days.");
+  if (hash_bucket == 0) {
+    hash_bucket = is_kaggle ? 10000000 : 40000000;
+  }
+  HCTR_CHECK_HINT(hash_bucket < std::numeric_limits<int32_t>::max(),
+                  "--hash_bucket must be less than 2^31 - 1.");
+  if (num_threads == 0) {
+    num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  if (spill_dir.empty()) {
+    spill_dir = output_dir_path;
+  }
+
+  HCTR_LOG_S(INFO, ROOT) << "Processing " << (is_kaggle ? "Kaggle" : "TeraBytes") << " datasets"
+                         << std::endl;
+  HCTR_LOG_S(INFO, ROOT) << "input_dir: " << input_dir_path << std::endl;
+  HCTR_LOG_S(INFO, ROOT) << "output_dir: " << output_dir_path << std::endl;
+
+  // Same files, splits and dense bias as `dlrm_raw`.
+  std::ofstream train_writer(output_dir_path + "/train_data.bin", std::ios::binary);
+  std::ofstream val_writer;
+  std::ofstream test_writer(output_dir_path + "/test_data.bin", std::ios::binary);
+  std::vector<InputFile> inputs;
+  int32_t dense_bias;
+  if (is_kaggle) {
+    val_writer.open(output_dir_path + "/val_data.bin", std::ios::binary);
+    inputs.push_back({input_dir_path + "/train.txt"});
+    dense_bias = 3;
+  } else {
+    for (const auto &day : train_days) inputs.push_back({input_dir_path + "/day_" + day});
+    for (const auto &day : test_days) inputs.push_back({input_dir_path + "/day_" + day});
+    dense_bias = 1;
+  }
+  HCTR_CHECK_HINT(train_writer.is_open() && test_writer.is_open() &&
+                      (!is_kaggle || val_writer.is_open()),
+                  "Cannot create output files in '", output_dir_path, "'.");
+
+  HugeCTR::ThreadPool pool("dlrm_raw_cpu", num_threads);
+
+  // Build vocabularies.
+  const auto time_map_start = std::chrono::steady_clock::now();
+  std::vector<Vocabulary> vocabularies(NUM_CATEGORICALS);
+  {
+    // Approximate footprint of one count in a shard.
+    constexpr size_t bytes_per_entry = 2 * sizeof(KeyCount);
+    VocabularyCounter counter(spill_dir, memory_limit / bytes_per_entry);
+    count_keys(pool, inputs, chunk_size, static_cast<uint32_t>(hash_bucket), counter);
+    pool.parallel_for(NUM_CATEGORICALS, [&](const size_t c) {
+      vocabularies[c] = counter.finalize(static_cast<int>(c), freq_threshold);
+    });
+    HCTR_LOG_S(INFO, ROOT) << "Number of spilled runs: " << counter.num_runs() << std::endl;
+  }
+  {
+    auto log = HCTR_LOG_S(INFO, ROOT);
+    log << "Slot size array, frequency threshold " << freq_threshold << ": ";
+    for (const auto &vocabulary : vocabularies) {
+      log << vocabulary.size << ", ";
+    }
+    log << "\b\b" << std::endl;
+  }
+  HCTR_LOG_S(INFO, ROOT) << "Time used to build map: "
+                         << std::chrono::duration_cast<std::chrono::milliseconds>(
+                                std::chrono::steady_clock::now() - time_map_start)
+                                .count()
+                         << " milliseconds." << std::endl;
+
+  // Assign rows to outputs.
+  if (is_kaggle) {
+    inputs[0].ranges = {{0, 36672493, &train_writer},
+                        {36672493, 41256555, &val_writer},
+                        {41256555, 45840617, &test_writer}};
+  } else {
+    int64_t needed_train = 4195197692;
+    int64_t needed_test = 89137319;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      int64_t &needed = i < train_days.size() ? needed_train : needed_test;
+      const int64_t n = std::min(needed, inputs[i].num_rows);
+      inputs[i].ranges = {{0, n, i < train_days.size() ? &train_writer : &test_writer}};
+      needed -= n;
+    }
+  }
+
+  // Convert.
+  const auto time_convert_start = std::chrono::steady_clock::now();
+  size_t bytes_written = 0;
+  for (const auto &input : inputs) {
+    bytes_written += convert_file(pool, input, num_threads, chunk_size,
+                                  static_cast<uint32_t>(hash_bucket), vocabularies, dense_bias);
+  }
+  for (auto *writer : {&train_writer, &val_writer, &test_writer}) {
+    if (writer->is_open()) {
+      writer->close();
+      HCTR_CHECK_HINT(!writer->fail(), "Writing output files failed.");
+    }
+  }
+  HCTR_LOG_S(INFO, ROOT) << "Time to process binaries: "
+                         << std::chrono::duration_cast<std::chrono::milliseconds>(
+                                std::chrono::steady_clock::now() - time_convert_start)
+                                .count()
+                         << " milliseconds, " << bytes_written << " Bytes written." << std::endl;
+
+  HCTR_LOG(INFO, ROOT, "Done.\n");
+  return 0;
+}
@@ -0,0 +1,466 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <fcntl.h>
+#include <parallel_hashmap/phmap.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <core23/logger.hpp>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <shared_mutex>
+#include <string>
+#include <thread_pool.hpp>
+#include <vector>
+
+// CPU counterpart of `tools/dlrm_script`. Vocabularies are built with sharded hash maps instead of
+// the cuDF/RMM `concurrent_unordered_map`, and the output is the same as `convert_input_binaries`:
+// 40 int32 per sample (label, 13 dense features, 26 categorical ids).
+namespace DLRM_RAW_CPU {
+
+constexpr int NUM_NUMERICALS = 14;    // label + 13 int-dense-feature
+constexpr int NUM_CATEGORICALS = 26;  // 26 hex-categorical-feature
+constexpr int NUM_FIELDS = NUM_NUMERICALS + NUM_CATEGORICALS;
+
+struct Sample {
+  int32_t numericals[NUM_NUMERICALS];
+  uint32_t keys[NUM_CATEGORICALS];  // hex value % hash_bucket; hash_bucket if missing
+};
+
+// Parses one tab separated Criteo line in [p, end). Missing numericals become 0. Returns false if
+// the line is malformed.
+inline bool parse_line(const char *p, const char *const end, const uint32_t hash_bucket,
+                       Sample &sample) {
+  for (int j = 0; j < NUM_FIELDS; ++j) {
+    if (j > 0) {
+      if (p == end || *p != '\t') return false;
+      ++p;
+    }
+    if (j < NUM_NUMERICALS) {
+      bool negative = false;
+      if (p != end && *p == '-') {
+        negative = true;
+        ++p;
+      }
+      int64_t v = 0;
+      for (; p != end && static_cast<unsigned char>(*p - '0') < 10; ++p) {
+        v = v * 10 + (*p - '0');
+      }
+      sample.numericals[j] = static_cast<int32_t>(negative ? -v : v);
+    } else {
+      // Same as `build_categorical_index`: convert hex to int.
+      const char *const digits = p;
+      uint32_t number = 0;
+      for (; p != end; ++p) {
+        const unsigned char c = static_cast<unsigned char>(*p);
+        uint32_t digit;
+        if (c - '0' < 10u) {
+          digit = c - '0';
+        } else if ((c | 0x20) - 'a' < 6u) {
+          digit = (c | 0x20) - 'a' + 10;
+        } else {
+          break;
+        }
+        number = 16 * number + digit;
+      }
+      sample.keys[j - NUM_NUMERICALS] = p == digits ? hash_bucket : number % hash_bucket;
+    }
+  }
+  if (p != end && *p == '\r') ++p;
+  return p == end;
+}
+
+// Read-only memory mapping of an input file.
+class MappedFile {
+ public:
+  HCTR_DISALLOW_COPY_AND_MOVE(MappedFile);
+
+  MappedFile(const std::string &path) : path_{path} {
+    fd_ = open(path.c_str(), O_RDONLY);
+    HCTR_CHECK_HINT(fd_ >= 0, "Cannot open '", path, "': ", std::strerror(errno));
+    struct stat st;
+    HCTR_CHECK_HINT(fstat(fd_, &st) == 0, "fstat '", path, "' failed: ", std::strerror(errno));
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+      void *ptr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+      HCTR_CHECK_HINT(ptr != MAP_FAILED, "mmap '", path, "' failed: ", std::strerror(errno));
+      madvise(ptr, size_, MADV_SEQUENTIAL);
+      data_ = static_cast<const char *>(ptr);
+    }
+  }
+
+  ~MappedFile() {
+    if (data_) munmap(const_cast<char *>(data_), size_);
+    close(fd_);
+  }
+
+  const std::string &path() const { return path_; }
+  const char *data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  std::string path_;
+  int fd_ = -1;
+  const char *data_ = nullptr;
+  size_t size_ = 0;
+};
+
+// Calls `fn(line, line_end)` for each non-empty line that *starts* in [begin, end) of `file`.
+// Returns the first line for which `fn` returns false, or nullptr.
+template <typename Function>
+const char *for_each_line(const MappedFile &file, size_t begin, const size_t end, Function &&fn) {
+  const char *const data = file.data();
+  const size_t size = file.size();
+  // Skip the line that started in the previous chunk.
+  if (begin > 0 && data[begin - 1] != '\n') {
+    const void *nl = std::memchr(data + begin, '\n', size - begin);
+    begin = nl ? static_cast<const char *>(nl) - data + 1 : size;
+  }
+  for (const char *line = data + begin; line < data + std::min(end, size);) {
+    const char *nl = static_cast<const char *>(std::memchr(line, '\n', data + size - line));
+    const char *const line_end = nl ? nl : data + size;
+    if (line_end != line && !(line_end - line == 1 && *line == '\r')) {
+      if (!fn(line, line_end)) return line;
+    }
+    line = line_end + 1;
+  }
+  return nullptr;
+}
+
+inline void die_on_bad_line(const MappedFile &file, const char *line) {
+  if (line) {
+    const char *end = file.data() + file.size();
+    const char *line_end = std::find(line, std::min(line + 512, end), '\n');
+    HCTR_DIE("Malformed line in '", file.path(), "' at byte offset ", line - file.data(), ": ",
+             std::string(line, line_end));
+  }
+}
+
+struct KeyCount {
+  uint32_t key;
+  uint64_t count;
+};
+
+/**
+ * Vocabulary of one categorical feature after thresholding. Ids are dense and ordered by
+ * descending frequency. With a threshold, id 0 is reserved for the dropped keys, even if no key
+ * was dropped (same as `cull_and_assign_idx`).
+ */
+struct Vocabulary {
+  phmap::flat_hash_map<uint32_t, int32_t> ids;
+  uint32_t size = 0;  // number of ids, including the one of the dropped keys
+  uint64_t num_dropped_keys = 0;
+
+  int32_t lookup(const uint32_t key) const {
+    const auto it = ids.find(key);
+    return it != ids.end() ? it->second : 0;
+  }
+};
+
+/**
+ * Counts the occurrences of the keys of every categorical feature.
+ *
+ * Each feature is counted in `NUM_SHARDS` hash maps with their own locks. Threads first
+ * aggregate into a `LocalCounts` and merge it once it holds `LOCAL_LIMIT` keys, so that shard
+ * locks are taken once per batch rather than once per key. If more than `max_entries` counts are
+ * held in memory, all shards are sorted by key and spilled to a run file in `spill_dir`.
+ * `finalize` merges the runs of each feature, so memory use of the counting stays bounded
+ * regardless of the number of rows. At most `MAX_MERGE_FAN_IN` runs are merged at once. More runs
+ * are first merged into intermediate runs, so that the number of open files stays bounded when
+ * all features are finalized in parallel.
+ */
+class VocabularyCounter {
+ public:
+  static constexpr size_t NUM_SHARDS = 64;
+  static constexpr size_t LOCAL_LIMIT = 1 << 16;
+  static constexpr size_t MAX_MERGE_FAN_IN = 16;
+
+  class LocalCounts {
+   public:
+    void add(const Sample &sample) {
+      for (int c = 0; c < NUM_CATEGORICALS; ++c) {
+        counts_[c][sample.keys[c]]++;
+      }
+      size_ += NUM_CATEGORICALS;
+    }
+
+    size_t size() const { return size_; }
+
+   private:
+    friend class VocabularyCounter;
+
+    phmap::flat_hash_map<uint32_t, uint64_t> counts_[NUM_CATEGORICALS];
+    size_t size_ = 0;  // upper bound of the number of entries
+  };
+
+  HCTR_DISALLOW_COPY_AND_MOVE(VocabularyCounter);
+
+  VocabularyCounter(const std::string &spill_dir, const size_t max_entries)
+      : spill_dir_{spill_dir}, max_entries_{std::max<size_t>(max_entries, NUM_SHARDS)} {
+    for (auto &shard : shards_) {
+      shard = std::make_unique<Shard>();
+    }
+  }
+
+  ~VocabularyCounter() {
+    for (const auto &runs : runs_) {
+      for (const auto &run : runs) {
+        std::remove(run.c_str());
+      }
+    }
+  }
+
+  // Merges and clears `local`.
+  void merge(LocalCounts &local) {
+    {
+      std::shared_lock<std::shared_mutex> spill_lock(spill_mutex_);
+      std::vector<KeyCount> batches[NUM_SHARDS];
+      for (int c = 0; c < NUM_CATEGORICALS; ++c) {
+        for (const auto &kc : local.counts_[c]) {
+          batches[shard_of(kc.first)].push_back({kc.first, kc.second});
+        }
+        local.counts_[c].clear();
+
+        for (size_t s = 0; s < NUM_SHARDS; ++s) {
+          if (batches[s].empty()) continue;
+          Shard &shard = *shards_[c * NUM_SHARDS + s];
+          std::lock_guard<std::mutex> lock(shard.mutex);
+          const size_t prev_size = shard.counts.size();
+          for (const KeyCount &kc : batches[s]) {
+            shard.counts[kc.key] += kc.count;
+          }
+          num_entries_ += shard.counts.size() - prev_size;
+          batches[s].clear();
+        }
+      }
+    }
+    local.size_ = 0;
+
+    if (num_entries_ > max_entries_) {
+      std::unique_lock<std::shared_mutex> spill_lock(spill_mutex_);
+      if (num_entries_ > max_entries_) {
+        spill();
+      }
+    }
+  }
+
+  size_t num_runs() const { return num_spills_; }
+
+  // Merges all counts of feature `c`. Keys that occur at most `threshold` times are dropped.
+  Vocabulary finalize(const int c, const uint64_t threshold) {
+    std::vector<std::string> &runs = runs_[c];
+    while (runs.size() >= MAX_MERGE_FAN_IN) {
+      const std::string path = run_path(c);
+      {
+        std::vector<std::unique_ptr<RunReader>> readers;
+        for (size_t i = 0; i < MAX_MERGE_FAN_IN; ++i) {
+          readers.emplace_back(std::make_unique<RunReader>(runs[i]));
+        }
+        RunWriter writer(path);
+        merge_runs(readers, [&](const KeyCount &kc) { writer.write(kc); });
+        writer.close();
+      }
+      for (size_t i = 0; i < MAX_MERGE_FAN_IN; ++i) {
+        std::remove(runs[i].c_str());
+      }
+      runs.erase(runs.begin(), runs.begin() + MAX_MERGE_FAN_IN);
+      runs.emplace_back(path);
+    }
+
+    std::vector<std::unique_ptr<RunReader>> readers;
+    for (const auto &run : runs) {
+      readers.emplace_back(std::make_unique<RunReader>(run));
+    }
+    readers.emplace_back(std::make_unique<RunReader>(take_sorted(c)));
+
+    std::vector<KeyCount> kept;
+    Vocabulary vocabulary;
+    merge_runs(readers, [&](const KeyCount &kc) {
+      if (kc.count > threshold) {
+        kept.push_back(kc);
+      } else {
+        vocabulary.num_dropped_keys++;
+      }
+    });
+
+    std::sort(kept.begin(), kept.end(), [](const KeyCount &a, const KeyCount &b) {
+      return a.count != b.count ? a.count > b.count : a.key < b.key;
+    });
+    const int32_t first_id = threshold > 0 ? 1 : 0;
+    vocabulary.ids.reserve(kept.size());
+    for (size_t i = 0; i < kept.size(); ++i) {
+      vocabulary.ids.emplace(kept[i].key, first_id + static_cast<int32_t>(i));
+    }
+    vocabulary.size = static_cast<uint32_t>(first_id + kept.size());
+    return vocabulary;
+  }
+
+ private:
+  struct Shard {
+    std::mutex mutex;
+    phmap::flat_hash_map<uint32_t, uint64_t> counts;
+  };
+
+  // Reads a run file, or a sorted in-memory run.
+  struct RunReader {
+    std::ifstream file;
+    std::vector<KeyCount> memory;
+    size_t pos = 0;
+    KeyCount current;
+
+    RunReader(const std::string &path) : file(path, std::ios::binary) {
+      HCTR_CHECK_HINT(file.is_open(), "Cannot open spill file '", path, "'.");
+    }
+    RunReader(std::vector<KeyCount> &&run) : memory{std::move(run)} {}
+
+    bool next() {
+      if (!file.is_open()) {
+        if (pos == memory.size()) return false;
+        current = memory[pos++];
+        return true;
+      }
+      return static_cast<bool>(file.read(reinterpret_cast<char *>(&current), sizeof(KeyCount)));
+    }
+  };
+
+  // Writes a run file in large pieces.
+  class RunWriter {
+   public:
+    RunWriter(const std::string &path) : path_{path}, file_(path, std::ios::binary) {
+      HCTR_CHECK_HINT(file_.is_open(), "Cannot create spill file '", path, "'.");
+      buffer_.reserve(BUFFER_SIZE);
+    }
+
+    void write(const KeyCount &kc) {
+      buffer_.push_back(kc);
+      if (buffer_.size() == BUFFER_SIZE) flush();
+    }
+
+    void write(const std::vector<KeyCount> &run) {
+      flush();
+      file_.write(reinterpret_cast<const char *>(run.data()),
+                  static_cast<std::streamsize>(run.size() * sizeof(KeyCount)));
+    }
+
+    void close() {
+      flush();
+      file_.close();
+      HCTR_CHECK_HINT(!file_.fail(), "Writing spill file '", path_, "' failed.");
+    }
+
+   private:
+    static constexpr size_t BUFFER_SIZE = 1 << 16;
+
+    void flush() {
+      file_.write(reinterpret_cast<const char *>(buffer_.data()),
+                  static_cast<std::streamsize>(buffer_.size() * sizeof(KeyCount)));
+      buffer_.clear();
+    }
+
+    const std::string path_;
+    std::ofstream file_;
+    std::vector<KeyCount> buffer_;
+  };
+
+  // Merges runs that are sorted by key, and calls `fn` with the total count of each key, in key
+  // order.
+  template <typename Function>
+  static void merge_runs(std::vector<std::unique_ptr<RunReader>> &readers, Function &&fn) {
+    using Head = std::pair<uint32_t, size_t>;  // (key, reader)
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+    for (size_t i = 0; i < readers.size(); ++i) {
+      if (readers[i]->next()) heads.emplace(readers[i]->current.key, i);
+    }
+
+    while (!heads.empty()) {
+      const uint32_t key = heads.top().first;
+      uint64_t count = 0;
+      while (!heads.empty() && heads.top().first == key) {
+        RunReader &reader = *readers[heads.top().second];
+        count += reader.current.count;
+        const size_t i = heads.top().second;
+        heads.pop();
+        if (reader.next()) heads.emplace(reader.current.key, i);
+      }
+      fn(KeyCount{key, count});
+    }
+  }
+
+  static size_t shard_of(const uint32_t key) {
+    return static_cast<size_t>((key * UINT64_C(0x9E3779B97F4A7C15)) >> 58) % NUM_SHARDS;
+  }
+
+  // Moves the in-memory counts of feature `c` into a vector that is sorted by key.
+  std::vector<KeyCount> take_sorted(const int c) {
+    std::vector<KeyCount> run;
+    for (size_t s = 0; s < NUM_SHARDS; ++s) {
+      Shard &shard = *shards_[c * NUM_SHARDS + s];
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      run.reserve(run.size() + shard.counts.size());
+      for (const auto &kc : shard.counts) {
+        run.push_back({kc.first, kc.second});
+      }
+      num_entries_ -= shard.counts.size();
+      phmap::flat_hash_map<uint32_t, uint64_t>().swap(shard.counts);
+    }
+    std::sort(run.begin(), run.end(),
+              [](const KeyCount &a, const KeyCount &b) { return a.key < b.key; });
+    return run;
+  }
+
+  // Name of the next run file of feature `c`.
+  std::string run_path(const int c) {
+    return spill_dir_ + "/vocab_spill_C" + std::to_string(c + 1) + "_" +
+           std::to_string(num_run_files_[c]++) + ".bin";
+  }
+
+  // Requires exclusive `spill_mutex_`.
+  void spill() {
+    const size_t num_entries = num_entries_;
+    for (int c = 0; c < NUM_CATEGORICALS; ++c) {
+      const std::string path = run_path(c);
+      RunWriter writer(path);
+      writer.write(take_sorted(c));
+      writer.close();
+      runs_[c].emplace_back(path);
+    }
+    num_spills_++;
+    HCTR_LOG_S(INFO, ROOT) << "Spilled " << num_entries << " key counts to disk (run "
+                           << num_spills_ << ")." << std::endl;
+  }
+
+  const std::string spill_dir_;
+  const size_t max_entries_;
+
+  std::shared_mutex spill_mutex_;
+  std::unique_ptr<Shard> shards_[NUM_CATEGORICALS * NUM_SHARDS];
+  std::atomic<size_t> num_entries_{0};
+  std::vector<std::string> runs_[NUM_CATEGORICALS];
+  size_t num_run_files_[NUM_CATEGORICALS] = {};
+  size_t num_spills_ = 0;
+};
+
+}  // namespace DLRM_RAW_CPU
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Evaluates prediction dumps on the CPU with the streaming metrics. The predictions and the labels
+// are raw float32 arrays in separate files of the same length, e.g. written by numpy's `tofile`.
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <argparse/argparse.hpp>
+#include <chrono>
+#include <core23/logger.hpp>
+#include <core23/shape.hpp>
+#include <core23/tensor.hpp>
+#include <iostream>
+#include <sstream>
+#include <streaming_metrics.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace HugeCTR;
+
+namespace {
+
+metrics::Type parse_metric_type(const std::string& name) {
+  if (name == "AUC") return metrics::Type::AUC;
+  if (name == "AverageLoss") return metrics::Type::AverageLoss;
+  if (name == "HitRate") return metrics::Type::HitRate;
+  if (name == "NDCG") return metrics::Type::NDCG;
+  HCTR_OWN_THROW(Error_t::WrongInput, "Unknown metric: " + name);
+}
+
+size_t num_floats(int fd, const std::string& path) {
+  struct stat st;
+  HCTR_CHECK_HINT(fstat(fd, &st) == 0, "Cannot stat ", path, "!");
+  HCTR_CHECK_HINT(st.st_size % sizeof(float) == 0, path, " is not a float32 array!");
+  return st.st_size / sizeof(float);
+}
+
+void read_floats(int fd, size_t offset, size_t count, float* dst) {
+  char* buf = reinterpret_cast<char*>(dst);
+  size_t remaining = count * sizeof(float);
+  off_t pos = offset * sizeof(float);
+  while (remaining) {
+    const ssize_t n = pread(fd, buf, remaining, pos);
+    HCTR_CHECK_HINT(n > 0, "Failed to read the prediction dump!");
+    buf += n;
+    pos += n;
+    remaining -= n;
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  argparse::ArgumentParser args;
+
+  args.add_argument("--preds").help("File with the predictions (float32).").required();
+  args.add_argument("--labels").help("File with the labels (float32).").required();
+
+  args.add_argument("--metrics")
+      .help("Comma separated list of AUC, AverageLoss, HitRate and NDCG.")
+      .default_value<std::string>("AUC,AverageLoss,HitRate,NDCG");
+
+  args.add_argument("--threads")
+      .help("Number of threads, each with its own accumulators.")
+      .default_value<size_t>(std::max(std::thread::hardware_concurrency(), 1u))
+      .scan<'u', size_t>();
+
+  args.add_argument("--chunk_size")
+      .help("Samples read and reduced at a time by a thread.")
+      .default_value<size_t>(1024 * 1024)
+      .scan<'u', size_t>();
+
+  args.add_argument("--auc_bins")
+      .help("Number of prediction bins of the AUC.")
+      .default_value<size_t>(metrics::StreamingMetricParams().auc_num_bins)
+      .scan<'u', size_t>();
+
+  args.add_argument("--pred_min")
+      .help("Lowest prediction (AUC).")
+      .default_value<float>(0.0f)
+      .scan<'g', float>();
+
+  args.add_argument("--pred_max")
+      .help("Highest prediction (AUC).")
+      .default_value<float>(1.0f)
+      .scan<'g', float>();
+
+  args.add_argument("--hit_threshold")
+      .help("Predictions above it count towards the HitRate.")
+      .default_value<float>(metrics::StreamingMetricParams().hit_threshold)
+      .scan<'g', float>();
+
+  args.add_argument("--ndcg_k")
+      .help("Cutoff of the NDCG.")
+      .default_value<size_t>(metrics::StreamingMetricParams().ndcg_k)
+      .scan<'u', size_t>();
+
+  try {
+    args.parse_args(argc, argv);
+  } catch (const std::runtime_error& err) {
+    std::cerr << err.what() << std::endl;
+    std::cout << args;
+    return 1;
+  }
+
+  metrics::StreamingMetricParams params;
+  params.num_workers = args.get<size_t>("--threads");
+  params.auc_num_bins = args.get<size_t>("--auc_bins");
+  params.pred_min = args.get<float>("--pred_min");
+  params.pred_max = args.get<float>("--pred_max");
+  params.hit_threshold = args.get<float>("--hit_threshold");
+  params.ndcg_k = args.get<size_t>("--ndcg_k");
+  const size_t chunk_size = args.get<size_t>("--chunk_size");
+  HCTR_CHECK_HINT(params.num_workers > 0 && chunk_size > 0, "Need threads and a chunk size!");
+
+  std::vector<std::pair<metrics::Type, std::unique_ptr<metrics::Metric>>> evaluated;
+  std::istringstream metric_names(args.get<std::string>("--metrics"));
+  for (std::string name; std::getline(metric_names, name, ',');) {
+    const metrics::Type type = parse_metric_type(name);
+    evaluated.emplace_back(type, metrics::create_streaming_metric(type, params));
+  }
+
+  const std::string preds_path = args.get<std::string>("--preds");
+  const std::string labels_path = args.get<std::string>("--labels");
+  const int preds_fd = open(preds_path.c_str(), O_RDONLY);
+  const int labels_fd = open(labels_path.c_str(), O_RDONLY);
+  HCTR_CHECK_HINT(preds_fd >= 0 && labels_fd >= 0, "Cannot open the prediction dump!");
+  const size_t num_samples = num_floats(preds_fd, preds_path);
+  HCTR_CHECK_HINT(num_floats(labels_fd, labels_path) == num_samples,
+                  "Predictions and labels differ in length!");
+  const size_t num_chunks = (num_samples + chunk_size - 1) / chunk_size;
+
+  // Thread `i` reduces every `num_workers`-th chunk into accumulator `i` of each metric.
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (size_t worker_id = 0; worker_id < params.num_workers; ++worker_id) {
+    workers.emplace_back([&, worker_id]() {
+      std::vector<float> preds(chunk_size);
+      std::vector<float> labels(chunk_size);
+      const core23::Device host(core23::DeviceType::CPU);
+      for (size_t chunk = worker_id; chunk < num_chunks; chunk += params.num_workers) {
+        const size_t offset = chunk * chunk_size;
+        const size_t count = std::min(chunk_size, num_samples - offset);
+        read_floats(preds_fd, offset, count, preds.data());
+        read_floats(labels_fd, offset, count, labels.data());
+
+        const core23::Shape shape({static_cast<int64_t>(count)});
+        metrics::Core23RawMetricMap raw_metrics{
+            {metrics::RawType::Pred,
+             core23::Tensor::bind(preds.data(), shape, core23::ScalarType::Float, host)},
+            {metrics::RawType::Label,
+             core23::Tensor::bind(labels.data(), shape, core23::ScalarType::Float, host)}};
+        for (auto& metric : evaluated) {
+          metric.second->local_reduce(worker_id, raw_metrics);
+        }
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  close(preds_fd);
+  close(labels_fd);
+  const double elapsed =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  HCTR_LOG_S(INFO, WORLD) << "Evaluated " << num_samples << " samples in " << elapsed << " s ("
+                          << num_samples / elapsed << " samples/s)" << std::endl;
+  for (auto& metric : evaluated) {
+    const float value = metric.second->finalize_metric();
+    if (metric.first == metrics::Type::AUC) {
+      const auto* auc = static_cast<metrics::StreamingMetric<metrics::BinnedAUCSketch>*>(
+          metric.second.get());
+      HCTR_LOG_S(INFO, WORLD) << metric.second->name() << " = " << value << " (+/- "
+                              << auc->result().error_bound() << ")" << std::endl;
+    } else {
+      HCTR_LOG_S(INFO, WORLD) << metric.second->name() << " = " << value << std::endl;
+    }
+  }
+  return 0;
+}
@@ -14,69 +14,328 @@
  * limitations under the License.
  */
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <argparse/argparse.hpp>
+#include <cerrno>
+#include <chrono>
+#include <core23/logger.hpp>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
-#include <ios>
+#include <future>
 #include <iostream>
-#include <sstream>
-#include <utils.hpp>
+#include <limits>
+#include <thread_pool.hpp>
 #include <vector>
 
 using namespace HugeCTR;
 
-static std::string usage_str = "usage: ./criteo2raw in.txt out.bin";
-
 static const int dense_dim = 13;
 static const int label_dim = 1;
 static const int SLOT_NUM = 26;
+static const int NUM_FIELDS = label_dim + dense_dim + SLOT_NUM;
+
+namespace {
+
+/**
+ * Input formats.
+ * - raw: space separated, all fields numeric. Writes label and dense features as float and the
+ *   slots as int (the layout of the Raw data reader).
+ * - criteo: tab separated Criteo logs (Kaggle and 1TB). Label and dense features are integers and
+ *   may be missing (written as 0, negative values are clamped to 0). Slots are hex strings, which
+ *   are hashed like `tools/dlrm_script` does: `hex % hash_bucket`, missing values map to
+ *   `hash_bucket`. Writes 40 int32 per sample.
+ */
+enum class InputFormat { Raw, Criteo };
+
+// Hand-written tokenizers. `p` points into the current line and `end` to its end (the '\n' or the
+// end of the file), so none of them may read past `end`.
 
-std::vector<std::string> &split(const std::string &s, char delim, std::vector<std::string> &elems) {
-  std::istringstream is(s);
-  std::string item;
-  while (std::getline(is, item, delim)) {
-    elems.push_back(item);
+inline bool parse_int(const char*& p, const char* end, int64_t& value) {
+  bool negative = false;
+  if (p != end && (*p == '-' || *p == '+')) {
+    negative = *p == '-';
+    ++p;
   }
-  return elems;
+  const char* const digits = p;
+  uint64_t v = 0;
+  for (; p != end && static_cast<unsigned char>(*p - '0') < 10; ++p) {
+    v = v * 10 + static_cast<uint64_t>(*p - '0');
+  }
+  value = negative ? -static_cast<int64_t>(v) : static_cast<int64_t>(v);
+  return p != digits;
 }
 
-int main(int argc, char *argv[]) {
-  if (argc != 3) {
-    HCTR_LOG_S(INFO, WORLD) << usage_str << std::endl;
-    exit(-1);
+inline bool parse_hex(const char*& p, const char* end, uint32_t& value) {
+  const char* const digits = p;
+  uint32_t v = 0;
+  for (; p != end; ++p) {
+    const unsigned char c = static_cast<unsigned char>(*p);
+    uint32_t digit;
+    if (c - '0' < 10u) {
+      digit = c - '0';
+    } else if ((c | 0x20) - 'a' < 6u) {
+      digit = (c | 0x20) - 'a' + 10;
+    } else {
+      break;
+    }
+    v = (v << 4) | digit;
   }
+  value = v;
+  return p != digits;
+}
 
-  // open txt file
-  std::ifstream txt_file(argv[1], std::ifstream::binary);
-  if (!txt_file.is_open()) {
-    HCTR_LOG_S(ERROR, WORLD) << "Cannot open argv[1]" << std::endl;
+// Decimal numbers without exponent take the fast path. Anything else ("1e-3", "nan", ...) is
+// handed to strtof.
+inline bool parse_float(const char*& p, const char* end, float& value) {
+  const char* const begin = p;
+  bool negative = false;
+  if (p != end && (*p == '-' || *p == '+')) {
+    negative = *p == '-';
+    ++p;
+  }
+  double v = 0;
+  bool has_digits = false;
+  for (; p != end && static_cast<unsigned char>(*p - '0') < 10; ++p) {
+    v = v * 10 + (*p - '0');
+    has_digits = true;
+  }
+  if (p != end && *p == '.') {
+    double scale = 0.1;
+    for (++p; p != end && static_cast<unsigned char>(*p - '0') < 10; ++p) {
+      v += (*p - '0') * scale;
+      scale *= 0.1;
+      has_digits = true;
+    }
+  }
+  if (p == end || *p == ' ' || *p == '\t' || *p == '\r') {
+    value = static_cast<float>(negative ? -v : v);
+    return has_digits;
   }
 
-  std::ofstream out_file(argv[2], std::ofstream::out);
-  int num_samples = 0;
-  do {
-    std::string line;
-    std::getline(txt_file, line);
-    if (txt_file.eof()) {
-      txt_file.close();
-      out_file.close();
-      HCTR_LOG_S(DEBUG, WORLD) << "#samples: " << num_samples << std::endl;
-      break;
+  char buf[64];
+  const char* token_end = std::find_if(begin, end, [](char c) { return c == ' ' || c == '\t'; });
+  const size_t n = std::min(static_cast<size_t>(token_end - begin), sizeof(buf) - 1);
+  std::memcpy(buf, begin, n);
+  buf[n] = '\0';
+  char* parsed;
+  value = std::strtof(buf, &parsed);
+  p = begin + (parsed - buf);
+  return parsed != buf;
+}
+
+// Parses one line. Returns false if the line is malformed.
+inline bool convert_line(const char* p, const char* const end, const InputFormat format,
+                         const uint32_t hash_bucket, char* const out) {
+  if (format == InputFormat::Raw) {
+    float* const dense = reinterpret_cast<float*>(out);
+    int* const sparse = reinterpret_cast<int*>(out + (label_dim + dense_dim) * sizeof(float));
+    for (int j = 0; j < NUM_FIELDS; ++j) {
+      while (p != end && *p == ' ') ++p;
+      if (j < label_dim + dense_dim) {
+        float f;
+        if (!parse_float(p, end, f)) return false;
+        std::memcpy(&dense[j], &f, sizeof(float));
+      } else {
+        int64_t v;
+        if (!parse_int(p, end, v)) return false;
+        // Same as the former std::stod(...) -> int.
+        if (p != end && *p == '.') {
+          for (++p; p != end && static_cast<unsigned char>(*p - '0') < 10; ++p) {
+          }
+        }
+        const int s = static_cast<int>(v);
+        std::memcpy(&sparse[j - label_dim - dense_dim], &s, sizeof(int));
+      }
     }
-    std::vector<std::string> vec_string;
-    split(line, ' ', vec_string);
-    if (vec_string.size() != dense_dim + label_dim + SLOT_NUM) {
-      HCTR_LOG_S(ERROR, WORLD) << "Error: vec_string.size() != dense_dim+label_dim+SLOT_NUM"
-                               << std::endl;
-      exit(-1);
+    while (p != end && (*p == ' ' || *p == '\r')) ++p;
+    return p == end;
+  }
+
+  int32_t* const fields = reinterpret_cast<int32_t*>(out);
+  for (int j = 0; j < NUM_FIELDS; ++j) {
+    if (j > 0) {
+      if (p == end || *p != '\t') return false;
+      ++p;
     }
-    for (int j = 0; j < dense_dim + label_dim; j++) {
-      float label_dense = std::stod(vec_string[j]);
-      out_file.write(reinterpret_cast<char *>(&label_dense), sizeof(float));
+    int32_t value;
+    if (j < label_dim + dense_dim) {
+      int64_t v = 0;
+      if (p != end && *p != '\t' && *p != '\r' && !parse_int(p, end, v)) return false;
+      value = static_cast<int32_t>(std::max<int64_t>(v, 0));
+    } else {
+      uint32_t v;
+      value = static_cast<int32_t>(parse_hex(p, end, v) ? v % hash_bucket : hash_bucket);
     }
-    for (int j = dense_dim + label_dim; j < dense_dim + label_dim + SLOT_NUM; j++) {
-      int sparse = std::stod(vec_string[j]);
-      out_file.write(reinterpret_cast<char *>(&sparse), sizeof(int));
+    std::memcpy(&fields[j], &value, sizeof(int32_t));
+  }
+  if (p != end && *p == '\r') ++p;
+  return p == end;
+}
+
+struct ChunkResult {
+  std::vector<char> output;
+  size_t num_samples = 0;
+  const char* bad_line = nullptr;  // first malformed line, if any
+};
+
+// Converts all lines that *start* in [begin, end). The last of them may extend past `end`.
+void convert_chunk(const char* const data, const size_t size, size_t begin, size_t end,
+                   const InputFormat format, const uint32_t hash_bucket, const size_t sample_size,
+                   ChunkResult& result) {
+  result.output.clear();
+  result.num_samples = 0;
+  result.bad_line = nullptr;
+
+  // Skip the line that started in the previous chunk.
+  if (begin > 0 && data[begin - 1] != '\n') {
+    const void* nl = std::memchr(data + begin, '\n', size - begin);
+    begin = nl ? static_cast<const char*>(nl) - data + 1 : size;
+  }
+  if (begin >= end) {
+    return;
+  }
+  // Every line has at least NUM_FIELDS - 1 separators.
+  result.output.reserve((end - begin) / NUM_FIELDS * sample_size + sample_size);
+
+  for (const char* line = data + begin; line < data + end;) {
+    const char* nl = static_cast<const char*>(std::memchr(line, '\n', data + size - line));
+    const char* const line_end = nl ? nl : data + size;
+    if (line_end != line && !(line_end - line == 1 && *line == '\r')) {
+      const size_t pos = result.output.size();
+      result.output.resize(pos + sample_size);
+      if (!convert_line(line, line_end, format, hash_bucket, &result.output[pos])) {
+        result.bad_line = line;
+        result.output.resize(pos);
+        return;
+      }
+      result.num_samples++;
     }
-    num_samples++;
-  } while (1);
+    line = line_end + 1;
+  }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  argparse::ArgumentParser args("criteo2raw");
+  args.add_argument("input").help("Input text file.");
+  args.add_argument("output").help("Output binary file.");
+  args.add_argument("--format")
+      .help("Input format: 'raw' (space separated numbers) or 'criteo' (tab separated, hex slots).")
+      .default_value<std::string>("raw");
+  args.add_argument("--hash_bucket")
+      .help("Criteo format: slot values are mapped to [0, hash_bucket], missing to hash_bucket.")
+      .default_value<size_t>(10000000)
+      .scan<'u', size_t>();
+  args.add_argument("--num_threads")
+      .help("Number of parser threads. Default: all hardware threads.")
+      .default_value<size_t>(0)
+      .scan<'u', size_t>();
+  args.add_argument("--chunk_size")
+      .help("Bytes of input per thread and round.")
+      .default_value<size_t>(32 * 1024 * 1024)
+      .scan<'u', size_t>();
+
+  try {
+    args.parse_args(argc, argv);
+  } catch (const std::runtime_error& err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << args;
+    return 1;
+  }
+
+  const auto input_path = args.get<std::string>("input");
+  const auto output_path = args.get<std::string>("output");
+  const auto format_name = args.get<std::string>("--format");
+  const auto hash_bucket = args.get<size_t>("--hash_bucket");
+  auto num_threads = args.get<size_t>("--num_threads");
+  const auto chunk_size = std::max<size_t>(args.get<size_t>("--chunk_size"), 4096);
+
+  InputFormat format;
+  if (format_name == "raw") {
+    format = InputFormat::Raw;
+  } else if (format_name == "criteo") {
+    format = InputFormat::Criteo;
+  } else {
+    HCTR_DIE("Unknown input format '", format_name, "'.");
+  }
+  HCTR_CHECK_HINT(hash_bucket > 0 && hash_bucket < std::numeric_limits<int32_t>::max(),
+                  "--hash_bucket must be in [1, 2^31 - 1).");
+  if (num_threads == 0) {
+    num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  const size_t sample_size = (label_dim + dense_dim) * sizeof(float) + SLOT_NUM * sizeof(int);
+  static_assert(sizeof(float) == sizeof(int32_t) && sizeof(int) == sizeof(int32_t));
+
+  // map input
+  const int fd = open(input_path.c_str(), O_RDONLY);
+  HCTR_CHECK_HINT(fd >= 0, "Cannot open '", input_path, "': ", std::strerror(errno));
+  struct stat st;
+  HCTR_CHECK_HINT(fstat(fd, &st) == 0, "fstat failed: ", std::strerror(errno));
+  const size_t size = static_cast<size_t>(st.st_size);
+  const char* data = nullptr;
+  if (size > 0) {
+    void* ptr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    HCTR_CHECK_HINT(ptr != MAP_FAILED, "mmap failed: ", std::strerror(errno));
+    madvise(ptr, size, MADV_SEQUENTIAL);
+    data = static_cast<const char*>(ptr);
+  }
+
+  std::ofstream out_file(output_path, std::ofstream::binary);
+  HCTR_CHECK_HINT(out_file.is_open(), "Cannot open '", output_path, "'.");
+
+  // Each round, every thread converts one chunk into its own buffer. The buffers of a round are
+  // written in order while the next round is being converted.
+  ThreadPool pool("criteo2raw", num_threads);
+  std::vector<ChunkResult> results[2]{std::vector<ChunkResult>(num_threads),
+                                      std::vector<ChunkResult>(num_threads)};
+  std::future<void> writer;
+  size_t num_samples = 0;
+  const auto start_time = std::chrono::steady_clock::now();
+
+  for (size_t round = 0, round_begin = 0; round_begin < size; ++round) {
+    auto& round_results = results[round % 2];
+    pool.parallel_for(num_threads, [&](const size_t i) {
+      const size_t begin = std::min(round_begin + i * chunk_size, size);
+      const size_t end = std::min(begin + chunk_size, size);
+      convert_chunk(data, size, begin, end, format, static_cast<uint32_t>(hash_bucket),
+                    sample_size, round_results[i]);
+    });
+    round_begin = std::min(round_begin + num_threads * chunk_size, size);
+
+    if (writer.valid()) writer.get();
+    for (const auto& result : round_results) {
+      if (result.bad_line) {
+        const char* line_end =
+            std::find(result.bad_line, std::min(result.bad_line + 512, data + size), '\n');
+        HCTR_LOG_S(ERROR, WORLD) << "Malformed line at byte offset " << (result.bad_line - data)
+                                 << ": " << std::string(result.bad_line, line_end) << std::endl;
+        exit(-1);
+      }
+      num_samples += result.num_samples;
+    }
+    writer = std::async(std::launch::async, [&out_file, &round_results]() {
+      for (const auto& result : round_results) {
+        out_file.write(result.output.data(), static_cast<std::streamsize>(result.output.size()));
+      }
+    });
+  }
+  if (writer.valid()) writer.get();
+  out_file.close();
+  HCTR_CHECK_HINT(!out_file.fail(), "Writing '", output_path, "' failed.");
+
+  if (data) munmap(const_cast<char*>(data), size);
+  close(fd);
+
+  const double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+  HCTR_LOG_S(INFO, WORLD) << "#samples: " << num_samples << ", " << size / (1024. * 1024.) / seconds
+                          << " MiB/s" << std::endl;
   return 0;
 }